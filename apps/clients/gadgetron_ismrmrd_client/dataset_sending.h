@@ -0,0 +1,146 @@
+#pragma once
+
+#include <ismrmrd/ismrmrd.h>
+#include <ismrmrd/waveform.h>
+
+#include <algorithm>
+#include <deque>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <variant>
+
+#include "MPMCChannel.h"
+#include "ThreadPool.h"
+
+typedef std::variant<ISMRMRD::Acquisition, ISMRMRD::Waveform> DatasetItem;
+
+// Reads the acquisitions and waveforms of the dataset, chunk_size at a time, and passes them on in time stamp order.
+// A waveform goes before the acquisitions with later time stamps. The dataset is only read holding dataset_mutex.
+template <typename DATASET, typename F>
+void for_each_dataset_item(DATASET& dataset, std::mutex& dataset_mutex, uint32_t acquisitions, uint32_t waveforms,
+    uint32_t chunk_size, bool verbose, F f)
+{
+    std::deque<ISMRMRD::Acquisition> acqs;
+    std::deque<ISMRMRD::Waveform> wavs;
+
+    uint32_t i(0), j(0); // i : index over the acquisition; j : index over the waveform
+    uint32_t sent_acqs(0), sent_wavs(0);
+
+    while (true)
+    {
+        if (acqs.empty() && i < acquisitions)
+        {
+            std::lock_guard<std::mutex> scoped_lock(dataset_mutex);
+            for (uint32_t end = std::min(acquisitions, i + chunk_size); i < end; i++) {
+                acqs.emplace_back();
+                dataset.readAcquisition(i, acqs.back());
+            }
+        }
+
+        if (wavs.empty() && j < waveforms)
+        {
+            std::lock_guard<std::mutex> scoped_lock(dataset_mutex);
+            for (uint32_t end = std::min(waveforms, j + chunk_size); j < end; j++) {
+                wavs.emplace_back();
+                dataset.readWaveform(j, wavs.back());
+            }
+        }
+
+        if (acqs.empty() && wavs.empty()) {
+            break;
+        }
+
+        if (!wavs.empty() && (acqs.empty() || wavs.front().head.time_stamp < acqs.front().getHead().acquisition_time_stamp))
+        {
+            ISMRMRD::Waveform& wav_tmp = wavs.front();
+            if (verbose)
+            {
+                std::cout << "--> Send out ismrmrd waveform : " << sent_wavs << " - " << wav_tmp.head.scan_counter
+                    << " - " << wav_tmp.head.time_stamp
+                    << " - " << wav_tmp.head.channels
+                    << " - " << wav_tmp.head.number_of_samples
+                    << " - " << wav_tmp.head.waveform_id
+                    << std::endl;
+            }
+
+            f(DatasetItem(std::move(wav_tmp)));
+            wavs.pop_front();
+            sent_wavs++;
+        }
+        else
+        {
+            ISMRMRD::Acquisition& acq_tmp = acqs.front();
+            if (verbose && waveforms > 0)
+            {
+                std::cout << "==> Send out ismrmrd acq : " << sent_acqs << " - " << acq_tmp.getHead().scan_counter << " - " << acq_tmp.getHead().acquisition_time_stamp << std::endl;
+            }
+
+            f(DatasetItem(std::move(acq_tmp)));
+            acqs.pop_front();
+            sent_acqs++;
+        }
+    }
+}
+
+// Sends the acquisitions and waveforms of the dataset. They are read ahead, at most prefetch of them, and encoded on
+// a pool of threads while earlier ones are sent; they are sent in order.
+template <typename CONNECTOR, typename DATASET, typename ENCODE>
+void send_dataset(CONNECTOR& con, DATASET& dataset, std::mutex& dataset_mutex, ENCODE encode,
+    unsigned int threads, unsigned int prefetch, bool verbose)
+{
+    using Frame = decltype(encode(std::declval<DatasetItem&>()));
+
+    uint32_t acquisitions = 0;
+    uint32_t waveforms = 0;
+    {
+        std::lock_guard<std::mutex> scoped_lock(dataset_mutex);
+        acquisitions = dataset.getNumberOfAcquisitions();
+        waveforms = dataset.getNumberOfWaveforms();
+    }
+
+    if(verbose)
+    {
+        std::cout << "Find " << acquisitions << " ismrmrd acquisitions" << std::endl;
+        std::cout << "Find " << waveforms << " ismrmrd waveforms" << std::endl;
+    }
+
+    prefetch = std::max(prefetch, 1u);
+    uint32_t chunk_size = std::max(prefetch / 4, 1u);
+
+    Gadgetron::Core::ThreadPool pool(std::max(threads, 1u));
+    Gadgetron::Core::MPMCChannel<std::future<Frame>> frames(prefetch);
+
+    std::exception_ptr read_error;
+    std::thread reader([&]() {
+        try {
+            for_each_dataset_item(dataset, dataset_mutex, acquisitions, waveforms, chunk_size, verbose, [&](DatasetItem item) {
+                frames.push(pool.async([&encode](DatasetItem item) { return encode(item); }, std::move(item)));
+            });
+        } catch (const Gadgetron::Core::ChannelClosed&) {
+            // Sending failed; the error is reported below.
+        } catch (...) {
+            read_error = std::current_exception();
+        }
+        frames.close();
+    });
+
+    std::exception_ptr send_error;
+    try {
+        while (true) {
+            con.send_frame(frames.pop().get());
+        }
+    } catch (const Gadgetron::Core::ChannelClosed&) {
+    } catch (...) {
+        send_error = std::current_exception();
+    }
+
+    frames.close();
+    reader.join();
+    pool.join();
+
+    if (send_error) std::rethrow_exception(send_error);
+    if (read_error) std::rethrow_exception(read_error);
+}
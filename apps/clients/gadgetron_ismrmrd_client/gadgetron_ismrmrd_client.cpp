@@ -24,6 +24,10 @@
 #include <ismrmrd/xml.h>
 #include <ismrmrd/waveform.h>
 
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <future>
 #include <streambuf>
 #include <time.h>
 #include <iomanip>
@@ -33,9 +37,14 @@
 #include <thread>
 #include <chrono>
 #include <condition_variable>
+#include <variant>
+#include <vector>
 
 #include "NHLBICompression.h"
 #include "GadgetronTimer.h"
+#include "MPMCChannel.h"
+#include "ThreadPool.h"
+#include "dataset_sending.h"
 
 #if defined GADGETRON_COMPRESSION_ZFP
 #include <zfp.h>
@@ -406,13 +415,42 @@ public:
     GadgetronClientImageMessageReader(std::string filename, std::string groupname)
         : file_name_(filename)
         , group_name_(groupname)
+        , writes_(64)
     {
-
+        writer_thread_ = std::thread([this]() { this->write_task(); });
     }
 
     ~GadgetronClientImageMessageReader() {
+        close();
     } 
 
+    // Waits for the pending images to be written, and rethrows the first failure to write one.
+    void finish()
+    {
+        close();
+        if (write_error_) {
+            std::rethrow_exception(write_error_);
+        }
+    }
+
+    void write_task()
+    {
+        try {
+            while (true) {
+                auto write = writes_.pop();
+                try {
+                    write();
+                } catch (std::exception& ex) {
+                    std::cerr << "Failed writing image: " << ex.what() << std::endl;
+                    if (!write_error_) {
+                        write_error_ = std::current_exception();
+                    }
+                }
+            }
+        } catch (const Gadgetron::Core::ChannelClosed&) {
+        }
+    }
+
     template <typename T> 
     void read_data_attrib(tcp::socket* stream, const ISMRMRD::ImageHeader& h, ISMRMRD::Image<T>& im)
     {
@@ -433,27 +471,20 @@ public:
 
         //Read image data
         boost::asio::read(*stream, boost::asio::buffer(im.getDataPtr(), im.getDataSize()));
-        {
-            if (!dataset_) {
-
-                {
-                    mtx.lock();
-                    dataset_ = std::shared_ptr<ISMRMRD::Dataset>(new ISMRMRD::Dataset(file_name_.c_str(), group_name_.c_str(), true)); // create if necessary
-                    mtx.unlock();
-                }
-            }
 
-            std::stringstream st1;
-            st1 << "image_" << h.image_series_index;
-            std::string image_varname = st1.str();
+        std::stringstream st1;
+        st1 << "image_" << h.image_series_index;
+        std::string image_varname = st1.str();
 
-            {
-                mtx.lock();
-                //TODO should this be wrapped in a try/catch?
-                dataset_->appendImage(image_varname, im);
-                mtx.unlock();
+        //Write the image on the writer thread, so the next image can be read meanwhile
+        auto image = std::make_shared<ISMRMRD::Image<T>>(std::move(im));
+        writes_.push([this, image_varname, image]() {
+            std::lock_guard<std::mutex> scoped_lock(mtx);
+            if (!dataset_) {
+                dataset_ = std::shared_ptr<ISMRMRD::Dataset>(new ISMRMRD::Dataset(file_name_.c_str(), group_name_.c_str(), true)); // create if necessary
             }
-        }
+            dataset_->appendImage(image_varname, *image);
+        });
     }
 
     virtual void read(tcp::socket* stream) 
@@ -509,9 +540,24 @@ public:
     }
 
 protected:
+    void close()
+    {
+        writes_.close();
+        if (writer_thread_.joinable()) {
+            writer_thread_.join();
+        }
+
+        // Closing the dataset touches HDF5, as do the readers of other connections.
+        std::lock_guard<std::mutex> scoped_lock(mtx);
+        dataset_.reset();
+    }
+
     std::string group_name_;
     std::string file_name_;
     std::shared_ptr<ISMRMRD::Dataset> dataset_;
+    Gadgetron::Core::MPMCChannel<std::function<void()>> writes_;
+    std::thread writer_thread_;
+    std::exception_ptr write_error_;
 };
 
 // ----------------------------------------------------------------
@@ -1083,6 +1129,33 @@ protected:
 
 };
 
+// A message encoded for sending. Encoding into a frame, rather than straight to the socket, lets acquisitions be
+// compressed on other threads while earlier ones are sent.
+struct GadgetronClientFrame
+{
+    std::vector<char> bytes;
+    double header_bytes = 0;
+    double uncompressed_bytes = 0;
+    double compressed_bytes = 0;
+
+    // Lets boost::asio::write append to the frame, as it would write to a socket.
+    template <typename ConstBufferSequence>
+    size_t write_some(const ConstBufferSequence& buffers)
+    {
+        size_t length = boost::asio::buffer_size(buffers);
+        size_t offset = bytes.size();
+        bytes.resize(offset + length);
+        return boost::asio::buffer_copy(boost::asio::buffer(&bytes[offset], length), buffers);
+    }
+
+    template <typename ConstBufferSequence>
+    size_t write_some(const ConstBufferSequence& buffers, boost::system::error_code& ec)
+    {
+        ec = boost::system::error_code();
+        return write_some(buffers);
+    }
+};
+
 class GadgetronClientConnector
 {
 
@@ -1279,52 +1352,44 @@ public:
         header_bytes_sent_ += boost::asio::write(*socket_, boost::asio::buffer(xml_string.c_str(), conf.script_length));
     }
 
-    void send_ismrmrd_acquisition(ISMRMRD::Acquisition& acq) 
+    static void encode_ismrmrd_acquisition(GadgetronClientFrame& frame, ISMRMRD::Acquisition& acq) 
     {
-        if (!socket_) {
-            throw GadgetronClientException("Invalid socket.");
-        }
-
         GadgetMessageIdentifier id;
         id.id = GADGET_MESSAGE_ISMRMRD_ACQUISITION;;
 
-        header_bytes_sent_ += boost::asio::write(*socket_, boost::asio::buffer(&id, sizeof(GadgetMessageIdentifier)));
-        header_bytes_sent_ += boost::asio::write(*socket_, boost::asio::buffer(&acq.getHead(), sizeof(ISMRMRD::AcquisitionHeader)));
+        frame.header_bytes += boost::asio::write(frame, boost::asio::buffer(&id, sizeof(GadgetMessageIdentifier)));
+        frame.header_bytes += boost::asio::write(frame, boost::asio::buffer(&acq.getHead(), sizeof(ISMRMRD::AcquisitionHeader)));
 
         unsigned long trajectory_elements = acq.getHead().trajectory_dimensions*acq.getHead().number_of_samples;
         unsigned long data_elements = acq.getHead().active_channels*acq.getHead().number_of_samples;
 
         if (trajectory_elements) {
-            header_bytes_sent_ += boost::asio::write(*socket_, boost::asio::buffer(&acq.getTrajPtr()[0], sizeof(float)*trajectory_elements));
+            frame.header_bytes += boost::asio::write(frame, boost::asio::buffer(&acq.getTrajPtr()[0], sizeof(float)*trajectory_elements));
         }
 
 
         if (data_elements) {
-            uncompressed_bytes_sent_ +=boost::asio::write(*socket_, boost::asio::buffer(&acq.getDataPtr()[0], 2*sizeof(float)*data_elements));
+            frame.uncompressed_bytes +=boost::asio::write(frame, boost::asio::buffer(&acq.getDataPtr()[0], 2*sizeof(float)*data_elements));
         }
     }
 
 
-    void send_ismrmrd_compressed_acquisition_precision(ISMRMRD::Acquisition& acq, unsigned int compression_precision) 
+    static void encode_ismrmrd_compressed_acquisition_precision(GadgetronClientFrame& frame, ISMRMRD::Acquisition& acq, unsigned int compression_precision) 
     {
-        if (!socket_) {
-            throw GadgetronClientException("Invalid socket.");
-        }
-
         GadgetMessageIdentifier id;
         id.id = GADGET_MESSAGE_ISMRMRD_ACQUISITION;
 
         ISMRMRD::AcquisitionHeader h = acq.getHead(); //We will make a copy because we will be setting some flags
         h.setFlag(ISMRMRD::ISMRMRD_ACQ_COMPRESSION2);
 
-        header_bytes_sent_ += boost::asio::write(*socket_, boost::asio::buffer(&id, sizeof(GadgetMessageIdentifier)));
-        header_bytes_sent_ += boost::asio::write(*socket_, boost::asio::buffer(&h, sizeof(ISMRMRD::AcquisitionHeader)));
+        frame.header_bytes += boost::asio::write(frame, boost::asio::buffer(&id, sizeof(GadgetMessageIdentifier)));
+        frame.header_bytes += boost::asio::write(frame, boost::asio::buffer(&h, sizeof(ISMRMRD::AcquisitionHeader)));
 
         unsigned long trajectory_elements = acq.getHead().trajectory_dimensions*acq.getHead().number_of_samples;
         unsigned long data_elements = acq.getHead().active_channels*acq.getHead().number_of_samples;
 
         if (trajectory_elements) {
-            header_bytes_sent_ += boost::asio::write(*socket_, boost::asio::buffer(&acq.getTrajPtr()[0], sizeof(float)*trajectory_elements));
+            frame.header_bytes += boost::asio::write(frame, boost::asio::buffer(&acq.getTrajPtr()[0], sizeof(float)*trajectory_elements));
         }
 
 
@@ -1335,37 +1400,33 @@ public:
             comp_buffer->compress(input_data, -1.0, compression_precision);
             std::vector<uint8_t> serialized_buffer = comp_buffer->serialize();
  
-            compressed_bytes_sent_ += serialized_buffer.size();
-            uncompressed_bytes_sent_ += data_elements*2*sizeof(float);
+            frame.compressed_bytes += serialized_buffer.size();
+            frame.uncompressed_bytes += data_elements*2*sizeof(float);
                             
             uint32_t bs = (uint32_t)serialized_buffer.size();
-            boost::asio::write(*socket_, boost::asio::buffer(&bs, sizeof(uint32_t)));
-            boost::asio::write(*socket_, boost::asio::buffer(&serialized_buffer[0], serialized_buffer.size()));
+            boost::asio::write(frame, boost::asio::buffer(&bs, sizeof(uint32_t)));
+            boost::asio::write(frame, boost::asio::buffer(&serialized_buffer[0], serialized_buffer.size()));
         }
         
     }
 
 
-    void send_ismrmrd_compressed_acquisition_tolerance(ISMRMRD::Acquisition& acq, float compression_tolerance, NoiseStatistics& stat) 
+    static void encode_ismrmrd_compressed_acquisition_tolerance(GadgetronClientFrame& frame, ISMRMRD::Acquisition& acq, float compression_tolerance, const NoiseStatistics& stat) 
     {
-        if (!socket_) {
-            throw GadgetronClientException("Invalid socket.");
-        }
-
         GadgetMessageIdentifier id;
         id.id = GADGET_MESSAGE_ISMRMRD_ACQUISITION;
 
         ISMRMRD::AcquisitionHeader h = acq.getHead(); //We will make a copy because we will be setting some flags
         h.setFlag(ISMRMRD::ISMRMRD_ACQ_COMPRESSION2);
 
-        header_bytes_sent_ += boost::asio::write(*socket_, boost::asio::buffer(&id, sizeof(GadgetMessageIdentifier)));
-        header_bytes_sent_ += boost::asio::write(*socket_, boost::asio::buffer(&h, sizeof(ISMRMRD::AcquisitionHeader)));
+        frame.header_bytes += boost::asio::write(frame, boost::asio::buffer(&id, sizeof(GadgetMessageIdentifier)));
+        frame.header_bytes += boost::asio::write(frame, boost::asio::buffer(&h, sizeof(ISMRMRD::AcquisitionHeader)));
 
         unsigned long trajectory_elements = acq.getHead().trajectory_dimensions*acq.getHead().number_of_samples;
         unsigned long data_elements = acq.getHead().active_channels*acq.getHead().number_of_samples;
 
         if (trajectory_elements) {
-            header_bytes_sent_ += boost::asio::write(*socket_, boost::asio::buffer(&acq.getTrajPtr()[0], sizeof(float)*trajectory_elements));
+            frame.header_bytes += boost::asio::write(frame, boost::asio::buffer(&acq.getTrajPtr()[0], sizeof(float)*trajectory_elements));
         }
 
 
@@ -1382,23 +1443,19 @@ public:
             comp_buffer->compress(input_data, local_tolerance);
             std::vector<uint8_t> serialized_buffer = comp_buffer->serialize();
 
-            compressed_bytes_sent_ += serialized_buffer.size();
-            uncompressed_bytes_sent_ += data_elements*2*sizeof(float);
+            frame.compressed_bytes += serialized_buffer.size();
+            frame.uncompressed_bytes += data_elements*2*sizeof(float);
 
             uint32_t bs = (uint32_t)serialized_buffer.size();
-            boost::asio::write(*socket_, boost::asio::buffer(&bs, sizeof(uint32_t)));
-            boost::asio::write(*socket_, boost::asio::buffer(&serialized_buffer[0], serialized_buffer.size()));
+            boost::asio::write(frame, boost::asio::buffer(&bs, sizeof(uint32_t)));
+            boost::asio::write(frame, boost::asio::buffer(&serialized_buffer[0], serialized_buffer.size()));
         }
     }
 
-    void send_ismrmrd_zfp_compressed_acquisition_precision(ISMRMRD::Acquisition& acq, unsigned int compression_precision) 
+    static void encode_ismrmrd_zfp_compressed_acquisition_precision(GadgetronClientFrame& frame, ISMRMRD::Acquisition& acq, unsigned int compression_precision) 
     {
 
 #if defined GADGETRON_COMPRESSION_ZFP
-        if (!socket_) {
-            throw GadgetronClientException("Invalid socket.");
-        }
-
         GadgetMessageIdentifier id;
         //TODO: switch data type
         id.id = GADGET_MESSAGE_ISMRMRD_ACQUISITION;
@@ -1406,14 +1463,14 @@ public:
         ISMRMRD::AcquisitionHeader h = acq.getHead(); //We will make a copy because we will be setting some flags
         h.setFlag(ISMRMRD::ISMRMRD_ACQ_COMPRESSION1);
 
-        header_bytes_sent_ += boost::asio::write(*socket_, boost::asio::buffer(&id, sizeof(GadgetMessageIdentifier)));
-        header_bytes_sent_ += boost::asio::write(*socket_, boost::asio::buffer(&h, sizeof(ISMRMRD::AcquisitionHeader)));
+        frame.header_bytes += boost::asio::write(frame, boost::asio::buffer(&id, sizeof(GadgetMessageIdentifier)));
+        frame.header_bytes += boost::asio::write(frame, boost::asio::buffer(&h, sizeof(ISMRMRD::AcquisitionHeader)));
 
         unsigned long trajectory_elements = acq.getHead().trajectory_dimensions*acq.getHead().number_of_samples;
         unsigned long data_elements = acq.getHead().active_channels*acq.getHead().number_of_samples;
 
         if (trajectory_elements) {
-            header_bytes_sent_ += boost::asio::write(*socket_, boost::asio::buffer(&acq.getTrajPtr()[0], sizeof(float)*trajectory_elements));
+            frame.header_bytes += boost::asio::write(frame, boost::asio::buffer(&acq.getTrajPtr()[0], sizeof(float)*trajectory_elements));
         }
 
 
@@ -1426,8 +1483,8 @@ public:
                                                          acq.getHead().number_of_samples*2, acq.getHead().active_channels,
                                                          compression_precision, comp_buffer, comp_buffer_size);
 
-                compressed_bytes_sent_ += compressed_size;
-                uncompressed_bytes_sent_ += data_elements*2*sizeof(float);
+                frame.compressed_bytes += compressed_size;
+                frame.uncompressed_bytes += data_elements*2*sizeof(float);
                 float compression_ratio = (1.0*data_elements*2*sizeof(float))/(float)compressed_size;
                 //std::cout << "Compression ratio: " << compression_ratio << std::endl;
                 
@@ -1440,8 +1497,8 @@ public:
 
             //TODO: Write compressed buffer
             uint32_t bs = (uint32_t)compressed_size;
-            boost::asio::write(*socket_, boost::asio::buffer(&bs, sizeof(uint32_t)));
-            boost::asio::write(*socket_, boost::asio::buffer(comp_buffer, compressed_size));
+            boost::asio::write(frame, boost::asio::buffer(&bs, sizeof(uint32_t)));
+            boost::asio::write(frame, boost::asio::buffer(comp_buffer, compressed_size));
 
             delete [] comp_buffer;
         }
@@ -1451,13 +1508,9 @@ public:
 #endif //GADGETRON_COMPRESSION_ZFP
     }
 
-    void send_ismrmrd_zfp_compressed_acquisition_tolerance(ISMRMRD::Acquisition& acq, float compression_tolerance, NoiseStatistics& stat) 
+    static void encode_ismrmrd_zfp_compressed_acquisition_tolerance(GadgetronClientFrame& frame, ISMRMRD::Acquisition& acq, float compression_tolerance, const NoiseStatistics& stat) 
     {
 #if defined GADGETRON_COMPRESSION_ZFP
-        if (!socket_) {
-            throw GadgetronClientException("Invalid socket.");
-        }
-
         GadgetMessageIdentifier id;
         //TODO: switch data type
         id.id = GADGET_MESSAGE_ISMRMRD_ACQUISITION;
@@ -1465,14 +1518,14 @@ public:
         ISMRMRD::AcquisitionHeader h = acq.getHead(); //We will make a copy because we will be setting some flags
         h.setFlag(ISMRMRD::ISMRMRD_ACQ_COMPRESSION1);
 
-        header_bytes_sent_ += boost::asio::write(*socket_, boost::asio::buffer(&id, sizeof(GadgetMessageIdentifier)));
-        header_bytes_sent_ += boost::asio::write(*socket_, boost::asio::buffer(&h, sizeof(ISMRMRD::AcquisitionHeader)));
+        frame.header_bytes += boost::asio::write(frame, boost::asio::buffer(&id, sizeof(GadgetMessageIdentifier)));
+        frame.header_bytes += boost::asio::write(frame, boost::asio::buffer(&h, sizeof(ISMRMRD::AcquisitionHeader)));
 
         unsigned long trajectory_elements = acq.getHead().trajectory_dimensions*acq.getHead().number_of_samples;
         unsigned long data_elements = acq.getHead().active_channels*acq.getHead().number_of_samples;
 
         if (trajectory_elements) {
-            header_bytes_sent_ += boost::asio::write(*socket_, boost::asio::buffer(&acq.getTrajPtr()[0], sizeof(float)*trajectory_elements));
+            frame.header_bytes += boost::asio::write(frame, boost::asio::buffer(&acq.getTrajPtr()[0], sizeof(float)*trajectory_elements));
         }
 
         float local_tolerance = compression_tolerance;
@@ -1490,8 +1543,8 @@ public:
                                                          acq.getHead().number_of_samples*2, acq.getHead().active_channels,
                                                          local_tolerance, comp_buffer, comp_buffer_size);
 
-                compressed_bytes_sent_ += compressed_size;
-                uncompressed_bytes_sent_ += data_elements*2*sizeof(float);
+                frame.compressed_bytes += compressed_size;
+                frame.uncompressed_bytes += data_elements*2*sizeof(float);
                 float compression_ratio = (1.0*data_elements*2*sizeof(float))/(float)compressed_size;
                 //std::cout << "Compression ratio: " << compression_ratio << std::endl;
                 
@@ -1504,8 +1557,8 @@ public:
 
             //TODO: Write compressed buffer
             uint32_t bs = (uint32_t)compressed_size;
-            boost::asio::write(*socket_, boost::asio::buffer(&bs, sizeof(uint32_t)));
-            boost::asio::write(*socket_, boost::asio::buffer(comp_buffer, compressed_size));
+            boost::asio::write(frame, boost::asio::buffer(&bs, sizeof(uint32_t)));
+            boost::asio::write(frame, boost::asio::buffer(comp_buffer, compressed_size));
 
             delete [] comp_buffer;
         }
@@ -1515,27 +1568,77 @@ public:
 
     }
 
-    void send_ismrmrd_waveform(ISMRMRD::Waveform& wav)
+    static void encode_ismrmrd_waveform(GadgetronClientFrame& frame, ISMRMRD::Waveform& wav)
     {
-        if (!socket_)
-        {
-            throw GadgetronClientException("Invalid socket.");
-        }
-
         GadgetMessageIdentifier id;
         id.id = GADGET_MESSAGE_ISMRMRD_WAVEFORM;;
 
-        header_bytes_sent_ += boost::asio::write(*socket_, boost::asio::buffer(&id, sizeof(GadgetMessageIdentifier)));
-        header_bytes_sent_ += boost::asio::write(*socket_, boost::asio::buffer(&wav.head, sizeof(ISMRMRD::ISMRMRD_WaveformHeader)));
+        frame.header_bytes += boost::asio::write(frame, boost::asio::buffer(&id, sizeof(GadgetMessageIdentifier)));
+        frame.header_bytes += boost::asio::write(frame, boost::asio::buffer(&wav.head, sizeof(ISMRMRD::ISMRMRD_WaveformHeader)));
 
         unsigned long data_elements = wav.head.channels*wav.head.number_of_samples;
 
         if (data_elements)
         {
-            header_bytes_sent_ += boost::asio::write(*socket_, boost::asio::buffer(wav.begin_data(), sizeof(uint32_t)*data_elements));
+            frame.header_bytes += boost::asio::write(frame, boost::asio::buffer(wav.begin_data(), sizeof(uint32_t)*data_elements));
         }
     }
 
+    void send_frame(const GadgetronClientFrame& frame)
+    {
+        if (!socket_) {
+            throw GadgetronClientException("Invalid socket.");
+        }
+
+        boost::asio::write(*socket_, boost::asio::buffer(frame.bytes));
+
+        header_bytes_sent_ += frame.header_bytes;
+        uncompressed_bytes_sent_ += frame.uncompressed_bytes;
+        compressed_bytes_sent_ += frame.compressed_bytes;
+    }
+
+    void send_ismrmrd_acquisition(ISMRMRD::Acquisition& acq)
+    {
+        GadgetronClientFrame frame;
+        encode_ismrmrd_acquisition(frame, acq);
+        send_frame(frame);
+    }
+
+    void send_ismrmrd_compressed_acquisition_precision(ISMRMRD::Acquisition& acq, unsigned int compression_precision)
+    {
+        GadgetronClientFrame frame;
+        encode_ismrmrd_compressed_acquisition_precision(frame, acq, compression_precision);
+        send_frame(frame);
+    }
+
+    void send_ismrmrd_compressed_acquisition_tolerance(ISMRMRD::Acquisition& acq, float compression_tolerance, NoiseStatistics& stat)
+    {
+        GadgetronClientFrame frame;
+        encode_ismrmrd_compressed_acquisition_tolerance(frame, acq, compression_tolerance, stat);
+        send_frame(frame);
+    }
+
+    void send_ismrmrd_zfp_compressed_acquisition_precision(ISMRMRD::Acquisition& acq, unsigned int compression_precision)
+    {
+        GadgetronClientFrame frame;
+        encode_ismrmrd_zfp_compressed_acquisition_precision(frame, acq, compression_precision);
+        send_frame(frame);
+    }
+
+    void send_ismrmrd_zfp_compressed_acquisition_tolerance(ISMRMRD::Acquisition& acq, float compression_tolerance, NoiseStatistics& stat)
+    {
+        GadgetronClientFrame frame;
+        encode_ismrmrd_zfp_compressed_acquisition_tolerance(frame, acq, compression_tolerance, stat);
+        send_frame(frame);
+    }
+
+    void send_ismrmrd_waveform(ISMRMRD::Waveform& wav)
+    {
+        GadgetronClientFrame frame;
+        encode_ismrmrd_waveform(frame, wav);
+        send_frame(frame);
+    }
+
     void register_reader(unsigned short slot, std::shared_ptr<GadgetronClientMessageReader> r) {
         readers_[slot] = r;
     }
@@ -1664,40 +1767,59 @@ NoiseStatistics get_noise_statistics(std::string dependency_name, std::string ho
     return stat;
 }
 
-void send_ismrmrd_acq(GadgetronClientConnector& con, ISMRMRD::Acquisition& acq_tmp, 
-    unsigned int compression_precision, bool use_zfp_compression, float compression_tolerance, NoiseStatistics& noise_stats)
+void encode_ismrmrd_acq(GadgetronClientFrame& frame, ISMRMRD::Acquisition& acq_tmp, 
+    unsigned int compression_precision, bool use_zfp_compression, float compression_tolerance, const NoiseStatistics& noise_stats)
 {
     try
     {
         if (compression_precision > 0)
         {
             if (use_zfp_compression) {
-                con.send_ismrmrd_zfp_compressed_acquisition_precision(acq_tmp, compression_precision);
+                GadgetronClientConnector::encode_ismrmrd_zfp_compressed_acquisition_precision(frame, acq_tmp, compression_precision);
             }
             else {
-                con.send_ismrmrd_compressed_acquisition_precision(acq_tmp, compression_precision);
+                GadgetronClientConnector::encode_ismrmrd_compressed_acquisition_precision(frame, acq_tmp, compression_precision);
             }
         }
         else if (compression_tolerance > 0.0)
         {
             if (use_zfp_compression) {
-                con.send_ismrmrd_zfp_compressed_acquisition_tolerance(acq_tmp, compression_tolerance, noise_stats);
+                GadgetronClientConnector::encode_ismrmrd_zfp_compressed_acquisition_tolerance(frame, acq_tmp, compression_tolerance, noise_stats);
             }
             else {
-                con.send_ismrmrd_compressed_acquisition_tolerance(acq_tmp, compression_tolerance, noise_stats);
+                GadgetronClientConnector::encode_ismrmrd_compressed_acquisition_tolerance(frame, acq_tmp, compression_tolerance, noise_stats);
             }
         }
         else
         {
-            con.send_ismrmrd_acquisition(acq_tmp);
+            GadgetronClientConnector::encode_ismrmrd_acquisition(frame, acq_tmp);
         }
     }
     catch(...)
     {
-        throw GadgetronClientException("send_ismrmrd_acq failed ... ");
+        throw GadgetronClientException("encode_ismrmrd_acq failed ... ");
     }
 }
 
+struct AcquisitionEncoding
+{
+    unsigned int compression_precision;
+    bool use_zfp_compression;
+    float compression_tolerance;
+    NoiseStatistics noise_stats;
+};
+
+GadgetronClientFrame encode_dataset_item(DatasetItem& item, const AcquisitionEncoding& encoding)
+{
+    GadgetronClientFrame frame;
+    if (auto acq = std::get_if<ISMRMRD::Acquisition>(&item)) {
+        encode_ismrmrd_acq(frame, *acq, encoding.compression_precision, encoding.use_zfp_compression, encoding.compression_tolerance, encoding.noise_stats);
+    } else {
+        GadgetronClientConnector::encode_ismrmrd_waveform(frame, std::get<ISMRMRD::Waveform>(item));
+    }
+    return frame;
+}
+
 int main(int argc, char **argv)
 {
 
@@ -1718,7 +1840,9 @@ int main(int argc, char **argv)
     float compression_tolerance = 0.0;
     bool use_zfp_compression = false;
     bool verbose = false;
-    Gadgetron::GadgetronTimer timer(false);
+    unsigned int threads = 1;
+    unsigned int prefetch = 256;
+    unsigned int connections = 1;
 
     po::options_description desc("Allowed options");
 
@@ -1740,6 +1864,9 @@ int main(int argc, char **argv)
         ("outformat,F", po::value<std::string>(&out_fileformat)->default_value("h5"), "Out format, h5 for hdf5 and hdr for analyze image")
         ("precision,P", po::value<unsigned int>(&compression_precision)->default_value(0), "Compression precision (bits)")
         ("tolerance,T", po::value<float>(&compression_tolerance)->default_value(0.0), "Compression tolerance (fraction of sigma, if no noise stats, assume sigma 1)")
+        ("threads,n", po::value<unsigned int>(&threads)->default_value(1), "Threads encoding and compressing acquisitions while earlier ones are sent")
+        ("prefetch", po::value<unsigned int>(&prefetch)->default_value(256), "Acquisitions and waveforms read from the input file ahead of sending")
+        ("connections,N", po::value<unsigned int>(&connections)->default_value(1), "Concurrent connections sending the input file, for load testing; each writes to its own output group")
 #if defined GADGETRON_COMPRESSION_ZFP
         ("ZFP,Z", po::value<bool>(&use_zfp_compression)->default_value(false), "Use ZFP library for compression");
 #endif //GADGETRON_COMPRESSION_ZFP
@@ -1847,196 +1974,105 @@ int main(int argc, char **argv)
         }
     }
 
-    GadgetronClientConnector con;
-    con.set_timeout(timeout_ms);
+    AcquisitionEncoding encoding{ compression_precision, use_zfp_compression, compression_tolerance, noise_stats };
 
-    if ( out_fileformat == "hdr" )
+    auto run_connection = [&](const std::string& out_group) -> int
     {
-        con.register_reader(GADGET_MESSAGE_ISMRMRD_IMAGE, std::shared_ptr<GadgetronClientMessageReader>(new GadgetronClientAnalyzeImageMessageReader(hdf5_out_group)));
-    }
-    else
-    {
-        con.register_reader(GADGET_MESSAGE_ISMRMRD_IMAGE, std::shared_ptr<GadgetronClientMessageReader>(new GadgetronClientImageMessageReader(out_filename, hdf5_out_group)));
-    }
+        Gadgetron::GadgetronTimer timer(false);
 
-    con.register_reader(GADGET_MESSAGE_DICOM_WITHNAME, std::shared_ptr<GadgetronClientMessageReader>(new GadgetronClientBlobMessageReader(std::string(hdf5_out_group), std::string("dcm"))));
+        GadgetronClientConnector con;
+        con.set_timeout(timeout_ms);
 
-    con.register_reader(GADGET_MESSAGE_DEPENDENCY_QUERY, std::shared_ptr<GadgetronClientMessageReader>(new GadgetronClientDependencyQueryReader(std::string(out_filename))));
-    con.register_reader(GADGET_MESSAGE_TEXT, std::shared_ptr<GadgetronClientMessageReader>(new GadgetronClientTextReader()));
-    con.register_reader(7, std::shared_ptr<GadgetronClientResponseReader>(new GadgetronClientResponseReader()));
-
-    try
-    {
-        timer.start();
-        con.connect(host_name,port);
-
-        if (vm.count("info")) {
-            con.send_gadgetron_info_query(vm["info"].as<std::string>());
-        }
-        else if (vm.count("config-local"))
+        std::shared_ptr<GadgetronClientImageMessageReader> image_reader;
+        if ( out_fileformat == "hdr" )
         {
-            con.send_gadgetron_configuration_script(config_xml_local);
+            con.register_reader(GADGET_MESSAGE_ISMRMRD_IMAGE, std::shared_ptr<GadgetronClientMessageReader>(new GadgetronClientAnalyzeImageMessageReader(out_group)));
         }
         else
         {
-            con.send_gadgetron_configuration_file(config_file);
+            image_reader = std::make_shared<GadgetronClientImageMessageReader>(out_filename, out_group);
+            con.register_reader(GADGET_MESSAGE_ISMRMRD_IMAGE, image_reader);
         }
 
-        if (open_input_file)
+        con.register_reader(GADGET_MESSAGE_DICOM_WITHNAME, std::shared_ptr<GadgetronClientMessageReader>(new GadgetronClientBlobMessageReader(std::string(out_group), std::string("dcm"))));
+
+        con.register_reader(GADGET_MESSAGE_DEPENDENCY_QUERY, std::shared_ptr<GadgetronClientMessageReader>(new GadgetronClientDependencyQueryReader(std::string(out_filename))));
+        con.register_reader(GADGET_MESSAGE_TEXT, std::shared_ptr<GadgetronClientMessageReader>(new GadgetronClientTextReader()));
+        con.register_reader(7, std::shared_ptr<GadgetronClientResponseReader>(new GadgetronClientResponseReader()));
+
+        try
         {
-            con.send_gadgetron_parameters(xml_config);
+            timer.start();
+            con.connect(host_name,port);
 
-            uint32_t acquisitions = 0;
-            {
-                mtx.lock();
-                acquisitions = ismrmrd_dataset->getNumberOfAcquisitions();
-                mtx.unlock();
+            if (vm.count("info")) {
+                con.send_gadgetron_info_query(vm["info"].as<std::string>());
             }
-
-            uint32_t waveforms = 0;
+            else if (vm.count("config-local"))
             {
-                mtx.lock();
-                waveforms = ismrmrd_dataset->getNumberOfWaveforms();
-                mtx.unlock();
+                con.send_gadgetron_configuration_script(config_xml_local);
             }
-
-            if(verbose)
+            else
             {
-                std::cout << "Find " << acquisitions << " ismrmrd acquisitions" << std::endl;
-                std::cout << "Find " << waveforms << " ismrmrd waveforms" << std::endl;
+                con.send_gadgetron_configuration_file(config_file);
             }
 
-            ISMRMRD::Acquisition acq_tmp;
-            ISMRMRD::Waveform wav_tmp;
-
-            uint32_t i(0), j(0); // i : index over the acquisition; j : index over the waveform
-
-            if(waveforms>0)
+            if (open_input_file)
             {
-                {
-                    std::lock_guard<std::mutex> scoped_lock(mtx);
-                    ismrmrd_dataset->readAcquisition(i, acq_tmp);
-                }
-
-                {
-                    std::lock_guard<std::mutex> scoped_lock(mtx);
-                    ismrmrd_dataset->readWaveform(j, wav_tmp);
-                }
-
-                while(i<acquisitions && j<waveforms)
-                {
-                    while(wav_tmp.head.time_stamp < acq_tmp.getHead().acquisition_time_stamp)
-                    {
-                        con.send_ismrmrd_waveform(wav_tmp);
-
-                        if (verbose)
-                        {
-                            std::cout << "--> Send out ismrmrd waveform : " << j << " - " << wav_tmp.head.scan_counter 
-                                << " - " << wav_tmp.head.time_stamp 
-                                << " - " << wav_tmp.head.channels
-                                << " - " << wav_tmp.head.number_of_samples
-                                << " - " << wav_tmp.head.waveform_id
-                                << std::endl;
-                        }
-
-                        j++;
-
-                        if(j<waveforms)
-                        {
-                            std::lock_guard<std::mutex> scoped_lock(mtx);
-                            ismrmrd_dataset->readWaveform(j, wav_tmp);
-                        }
-                        else
-                        {
-                            break;
-                        }
-                    }
+                con.send_gadgetron_parameters(xml_config);
+                send_dataset(con, *ismrmrd_dataset, mtx, [&encoding](DatasetItem& item) { return encode_dataset_item(item, encoding); },
+                    threads, prefetch, verbose);
+            }
 
-                    while (acq_tmp.getHead().acquisition_time_stamp <= wav_tmp.head.time_stamp)
-                    {
-                        send_ismrmrd_acq(con, acq_tmp, compression_precision, use_zfp_compression, compression_tolerance, noise_stats);
-
-                        if (verbose)
-                        {
-                            std::cout << "==> Send out ismrmrd acq : " << i << " - " << acq_tmp.getHead().scan_counter << " - " << acq_tmp.getHead().acquisition_time_stamp << std::endl;
-                        }
-
-                        i++;
-
-                        if(i<acquisitions)
-                        {
-                            std::lock_guard<std::mutex> scoped_lock(mtx);
-                            ismrmrd_dataset->readAcquisition(i, acq_tmp);
-                        }
-                        else
-                        {
-                            break;
-                        }
-                    }
+            if (compression_precision > 0 || compression_tolerance > 0.0) {
+                std::cout << "Compression ratio: " << con.compression_ratio() << std::endl;
+            }
 
-                    if(j==waveforms && i<acquisitions)
-                    {
-                        send_ismrmrd_acq(con, acq_tmp, compression_precision, use_zfp_compression, compression_tolerance, noise_stats);
+            if (verbose) {
+                double transmission_time_s = timer.stop()/1e6;
+                double transmitted_mb = con.get_bytes_transmitted()/(1024*1024);
+                std::cout << "Time sending: " << transmission_time_s << "s" << std::endl;
+                std::cout << "Data sent: " << transmitted_mb << "MB" << std::endl;
+                std::cout << "Transmission rate: " << transmitted_mb/transmission_time_s << "MB/s" << std::endl;
+            }
 
-                        for (uint32_t ia=i+1; ia<acquisitions; ia++)
-                        {
-                            {
-                                std::lock_guard<std::mutex> scoped_lock(mtx);
-                                ismrmrd_dataset->readAcquisition(ia, acq_tmp);
-                            }
+            con.send_gadgetron_close();
+            con.wait();
 
-                            send_ismrmrd_acq(con, acq_tmp, compression_precision, use_zfp_compression, compression_tolerance, noise_stats);
-                        }
-                    }
+            if (image_reader) {
+                image_reader->finish();
+            }
+        }
+        catch (std::exception& ex)
+        {
+            std::cerr << "Error caught: " << ex.what() << std::endl;
+            return -1;
+        }
 
-                    if (i==acquisitions && j<waveforms)
-                    {
-                        con.send_ismrmrd_waveform(wav_tmp);
+        return 0;
+    };
 
-                        for (uint32_t iw = j + 1; iw<waveforms; iw++)
-                        {
-                            {
-                                std::lock_guard<std::mutex> scoped_lock(mtx);
-                                ismrmrd_dataset->readWaveform(iw, wav_tmp);
-                            }
+    if (connections <= 1) {
+        return run_connection(hdf5_out_group);
+    }
 
-                            con.send_ismrmrd_waveform(wav_tmp);
-                        }
-                    }
-                }
-            }
-            else
-            {
-                for (i=0; i<acquisitions; i++)
-                {
-                    {
-                        std::lock_guard<std::mutex> scoped_lock(mtx);
-                        ismrmrd_dataset->readAcquisition(i, acq_tmp);
-                    }
+    auto start = std::chrono::steady_clock::now();
 
-                    send_ismrmrd_acq(con, acq_tmp, compression_precision, use_zfp_compression, compression_tolerance, noise_stats);
-                }
-            }
-        }
+    std::vector<std::future<int>> results;
+    for (unsigned int k = 0; k < connections; k++) {
+        results.push_back(std::async(std::launch::async, run_connection, hdf5_out_group + "_" + std::to_string(k)));
+    }
 
-        if (compression_precision > 0 || compression_tolerance > 0.0) {
-            std::cout << "Compression ratio: " << con.compression_ratio() << std::endl;
-        }
+    unsigned int failures = 0;
+    for (auto& result : results) {
+        if (result.get()) failures++;
+    }
 
-        if (verbose) {
-            double transmission_time_s = timer.stop()/1e6;
-            double transmitted_mb = con.get_bytes_transmitted()/(1024*1024);
-            std::cout << "Time sending: " << transmission_time_s << "s" << std::endl;
-            std::cout << "Data sent: " << transmitted_mb << "MB" << std::endl;
-            std::cout << "Transmission rate: " << transmitted_mb/transmission_time_s << "MB/s" << std::endl;
-        }
+    double elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Connections: " << connections << ", failed: " << failures << std::endl;
+    std::cout << "Time: " << elapsed_s << "s, " << connections/elapsed_s << " connections/s" << std::endl;
 
-        con.send_gadgetron_close();
-        con.wait();
-    }
-    catch (std::exception& ex)
-    {
-        std::cerr << "Error caught: " << ex.what() << std::endl;
+    if (failures) {
         return -1;
     }
 
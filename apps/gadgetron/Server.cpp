@@ -7,6 +7,7 @@
 
 #include "Server.h"
 #include "Connection.h"
+#include "WorkerPool.h"
 #include "connection/SocketStreamBuf.h"
 #include "system_info.h"
 
@@ -31,12 +32,26 @@ Server::Server(
 
     acceptor.set_option(boost::asio::socket_base::reuse_address(true));
 
+    std::unique_ptr<Connection::WorkerPool> pool;
+    if (args["workers"].as<unsigned int>() > 0) {
+        pool = std::make_unique<Connection::WorkerPool>(paths, args, storage_address, Connection::WorkerPool::Settings{
+                args["workers"].as<unsigned int>(),
+                args["preload"].as<std::vector<std::string>>(),
+                args["preload_python"].as<bool>()
+        });
+    }
+
     while(true) {
         auto socket = std::make_unique<boost::asio::ip::tcp::socket>(executor);
         acceptor.accept(*socket);
 
         GINFO_STREAM("Accepted connection from: " << socket->remote_endpoint().address());
 
+        if (pool) {
+            pool->handle(std::move(socket));
+            continue;
+        }
+
         Connection::handle(paths, args, storage_address, Gadgetron::Connection::stream_from_socket(std::move(socket)));
     }
 }
@@ -0,0 +1,229 @@
+#include "WorkerPool.h"
+
+#include "log.h"
+
+#include "Connection.h"
+#include "connection/SocketStreamBuf.h"
+
+#if !(_WIN32 || !NDEBUG || GADGETRON_DISABLE_FORK || __clang__)
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <system_error>
+#include <thread>
+
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <boost/dll/shared_library.hpp>
+
+#include "connection/ConfigConnection.h"
+#include "connection/Core.h"
+#include "system_info.h"
+#endif
+
+namespace Gadgetron::Server::Connection {
+
+#if _WIN32 || !NDEBUG || GADGETRON_DISABLE_FORK || __clang__
+
+    WorkerPool::WorkerPool(
+            Core::StreamContext::Paths paths,
+            Core::StreamContext::Args args,
+            Core::StreamContext::StorageAddress storage_address,
+            Settings settings
+    ) : paths(std::move(paths)), args(std::move(args)), storage_address(std::move(storage_address)),
+        settings(std::move(settings)) {
+        if (this->settings.workers)
+            GWARN_STREAM("Connections are not handled in separate processes on this build; worker pool is disabled.");
+    }
+
+    WorkerPool::~WorkerPool() = default;
+
+    void WorkerPool::handle(std::unique_ptr<boost::asio::ip::tcp::socket> socket) {
+        Connection::handle(paths, args, storage_address, Gadgetron::Connection::stream_from_socket(std::move(socket)));
+    }
+
+#else
+
+    namespace {
+
+        // The socket is passed as ancillary data, along with a single byte of regular data.
+        bool send_socket(int channel, int fd) {
+            char byte = 0;
+            iovec iov{ &byte, 1 };
+
+            union {
+                cmsghdr header;
+                char buffer[CMSG_SPACE(sizeof(int))];
+            } control{};
+
+            msghdr message{};
+            message.msg_iov = &iov;
+            message.msg_iovlen = 1;
+            message.msg_control = control.buffer;
+            message.msg_controllen = sizeof(control.buffer);
+
+            cmsghdr *header = CMSG_FIRSTHDR(&message);
+            header->cmsg_level = SOL_SOCKET;
+            header->cmsg_type = SCM_RIGHTS;
+            header->cmsg_len = CMSG_LEN(sizeof(int));
+            std::memcpy(CMSG_DATA(header), &fd, sizeof(int));
+
+            return sendmsg(channel, &message, MSG_NOSIGNAL) == 1;
+        }
+
+        // Returns -1 if the channel is closed without a socket being passed.
+        int receive_socket(int channel) {
+            char byte;
+            iovec iov{ &byte, 1 };
+
+            union {
+                cmsghdr header;
+                char buffer[CMSG_SPACE(sizeof(int))];
+            } control{};
+
+            msghdr message{};
+            message.msg_iov = &iov;
+            message.msg_iovlen = 1;
+            message.msg_control = control.buffer;
+            message.msg_controllen = sizeof(control.buffer);
+
+            ssize_t received;
+            do {
+                received = recvmsg(channel, &message, MSG_CMSG_CLOEXEC);
+            } while (received < 0 && errno == EINTR);
+
+            if (received <= 0) return -1;
+
+            cmsghdr *header = CMSG_FIRSTHDR(&message);
+            if (!header || header->cmsg_level != SOL_SOCKET || header->cmsg_type != SCM_RIGHTS) return -1;
+
+            int fd;
+            std::memcpy(&fd, CMSG_DATA(header), sizeof(int));
+            return fd;
+        }
+
+        boost::dll::shared_library preload_library(const std::string &name) {
+            return boost::dll::shared_library(
+                    name,
+                    boost::dll::load_mode::append_decorations |
+                    boost::dll::load_mode::rtld_global |
+                    boost::dll::load_mode::search_system_folders
+            );
+        }
+    }
+
+    WorkerPool::WorkerPool(
+            Core::StreamContext::Paths paths,
+            Core::StreamContext::Args args,
+            Core::StreamContext::StorageAddress storage_address,
+            Settings settings
+    ) : paths(std::move(paths)), args(std::move(args)), storage_address(std::move(storage_address)),
+        settings(std::move(settings)) {
+        // Workers inherit the parsed configs.
+        ConfigConnection::preload(this->paths);
+
+        for (size_t i = 0; i < this->settings.workers; i++) spawn();
+        GINFO_STREAM("Started " << idle.size() << " pre-forked workers");
+    }
+
+    WorkerPool::~WorkerPool() {
+        // Idle workers exit once their channel is closed.
+        for (auto &worker : idle) close(worker.channel);
+    }
+
+    void WorkerPool::handle(std::unique_ptr<boost::asio::ip::tcp::socket> socket) {
+
+        bool handed_over = false;
+        while (!handed_over && !idle.empty()) {
+            auto worker = idle.front();
+            idle.pop_front();
+
+            handed_over = send_socket(worker.channel, socket->native_handle());
+            close(worker.channel);
+
+            if (handed_over) {
+                GDEBUG_STREAM("Connection handed over to worker " << worker.pid);
+            } else {
+                GWARN_STREAM("Unable to hand connection over to worker " << worker.pid << ": " << std::strerror(errno));
+            }
+        }
+
+        if (!handed_over) {
+            Connection::handle(paths, args, storage_address, Gadgetron::Connection::stream_from_socket(std::move(socket)));
+        }
+
+        // The socket is closed in this process once it is released; the worker holds its own descriptor.
+        socket.reset();
+
+        try {
+            while (idle.size() < settings.workers) spawn();
+        } catch (const std::exception &e) {
+            GWARN_STREAM("Unable to start a replacement worker: " << e.what());
+        }
+    }
+
+    void WorkerPool::spawn() {
+        int channels[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, channels) != 0)
+            throw std::system_error(errno, std::generic_category(), "Failed to create worker channel");
+
+        auto pid = fork();
+        if (pid < 0) {
+            close(channels[0]);
+            close(channels[1]);
+            throw std::system_error(errno, std::generic_category(), "Failed to fork worker");
+        }
+
+        if (pid == 0) {
+            close(channels[0]);
+            run_worker(channels[1]);
+        }
+
+        close(channels[1]);
+        idle.push_back(Worker{ pid, channels[0] });
+
+        auto listen_for_close = [](auto pid) {int status; waitpid(pid,&status,0);};
+        std::thread t(listen_for_close,pid);
+        t.detach();
+    }
+
+    void WorkerPool::run_worker(int channel) {
+        for (auto &worker : idle) close(worker.channel);
+        idle.clear();
+
+        // Warm up while waiting for a connection; the libraries stay loaded for the lifetime of the worker.
+        std::vector<boost::dll::shared_library> libraries;
+        for (auto &name : settings.libraries) {
+            try {
+                libraries.push_back(preload_library(name));
+            } catch (const std::exception &e) {
+                GWARN_STREAM("Worker unable to preload library " << name << ": " << e.what());
+            }
+        }
+
+        if (settings.python) {
+            try {
+                auto library = preload_library("gadgetron_toolbox_python");
+                library.get_alias<void()>("initialize_python_export")();
+                libraries.push_back(library);
+            } catch (const std::exception &e) {
+                GWARN_STREAM("Worker unable to initialize Python: " << e.what());
+            }
+        }
+
+        int fd = receive_socket(channel);
+        close(channel);
+        if (fd < 0) std::quick_exit(0);
+
+        boost::asio::io_context executor;
+        auto socket = std::make_unique<boost::asio::ip::tcp::socket>(executor);
+        socket->assign(Info::tcp_protocol(), fd);
+
+        handle_connection(Gadgetron::Connection::stream_from_socket(std::move(socket)), paths, args, storage_address);
+        std::quick_exit(0);
+    }
+
+#endif
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/asio/ip/tcp.hpp>
+
+#include "Context.h"
+
+namespace Gadgetron::Server::Connection {
+
+    /**
+     * A pool of pre-forked worker processes, each handling a single connection.
+     *
+     * Workers are forked ahead of time, and preload the commonly used gadget libraries (and optionally initialize
+     * the Python interpreter) while they are idle. Accepted sockets are passed to an idle worker over a unix domain
+     * socket, and a new worker is forked to replace it. Workers still exit once their connection is closed, so
+     * connections are isolated from each other as before.
+     *
+     * On builds which do not fork for each connection, connections are handled as by Connection::handle.
+     */
+    class WorkerPool {
+    public:
+        struct Settings {
+            size_t workers;
+            std::vector<std::string> libraries;
+            bool python;
+        };
+
+        WorkerPool(
+                Core::StreamContext::Paths paths,
+                Core::StreamContext::Args args,
+                Core::StreamContext::StorageAddress storage_address,
+                Settings settings
+        );
+        ~WorkerPool();
+
+        void handle(std::unique_ptr<boost::asio::ip::tcp::socket> socket);
+
+    private:
+        struct Worker {
+            int pid;
+            int channel;
+        };
+
+        void spawn();
+        [[noreturn]] void run_worker(int channel);
+
+        const Core::StreamContext::Paths paths;
+        const Core::StreamContext::Args args;
+        const Core::StreamContext::StorageAddress storage_address;
+        const Settings settings;
+
+        std::deque<Worker> idle;
+    };
+}
@@ -9,6 +9,7 @@
 #include "Handlers.h"
 #include "HeaderConnection.h"
 #include "config/Config.h"
+#include "config/ConfigCache.h"
 
 #include "io/primitives.h"
 #include "Context.h"
@@ -52,8 +53,9 @@ namespace {
         : callback(std::move(callback)) {}
 
         void handle_callback(std::istream &config_stream) {
-
-            callback(parse_config(config_stream));
+            SetupTimer timer{"config"};
+            auto content = std::string(std::istreambuf_iterator<char>(config_stream), {});
+            callback(*ConfigCache::parse(content));
         }
 
     private:
@@ -165,4 +167,22 @@ namespace Gadgetron::Server::Connection::ConfigConnection {
             HeaderConnection::process(stream, paths, args, sessions_address, context.config.value(), error_handler);
         }
     }
+
+    void preload(const Core::StreamContext::Paths &paths) {
+        SetupTimer timer{"config preload"};
+
+        auto folder = paths.gadgetron_home / GADGETRON_CONFIG_PATH;
+        if (!boost::filesystem::is_directory(folder)) return;
+
+        for (auto &entry : boost::filesystem::directory_iterator(folder)) {
+            if (entry.path().extension() != ".xml") continue;
+            try {
+                auto config_stream = open_and_verify_config(entry.path().string());
+                ConfigCache::parse(std::string(std::istreambuf_iterator<char>(*config_stream), {}));
+            } catch (const std::exception &e) {
+                GDEBUG_STREAM("Config " << entry.path() << " not preloaded: " << e.what());
+            }
+        }
+        GINFO_STREAM("Preloaded " << ConfigCache::size() << " configs");
+    }
 }
\ No newline at end of file
@@ -11,4 +11,8 @@ namespace Gadgetron::Server::Connection::ConfigConnection {
         const Core::StreamContext::StorageAddress& session_address,
         ErrorHandler &error_handler
     );
+
+    // Parses the configs in the config folder, so connections handled by processes forked afterwards
+    // skip parsing them.
+    void preload(const Core::StreamContext::Paths &paths);
 }
@@ -1,5 +1,10 @@
 #pragma once
 
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <future>
+#include <sstream>
 #include <thread>
 #include <memory>
 #include <functional>
@@ -9,6 +14,8 @@
 #include "Writer.h"
 #include "Channel.h"
 #include "Context.h"
+#include "ThreadPool.h"
+#include "log.h"
 
 namespace Gadgetron::Server::Connection {
 
@@ -117,8 +124,98 @@ namespace Gadgetron::Server::Connection {
         }
     }
 
+    /**
+     * Serializes messages on a pool of threads, while the frames of earlier messages are sent. Frames are sent in
+     * the order of the messages, and at most two frames per thread are in flight.
+     *
+     * Only stateless writers are called on the pool, and so concurrently; other writers serialize their messages
+     * one at a time, on the thread reading the messages.
+     */
+    template<class F>
+    void process_output_pipelined(
+            std::iostream &stream,
+            Core::GenericInputChannel messages,
+            F writer_factory,
+            size_t threads
+    ) {
+        auto writers = writer_factory();
+
+        Core::ThreadPool pool(threads);
+        Core::MPMCChannel<std::future<std::string>> frames(2 * threads);
+
+        auto serialize = [](Core::Writer *writer, Core::Message message) {
+            std::ostringstream frame;
+            writer->write(frame, std::move(message));
+            return frame.str();
+        };
+
+        std::exception_ptr serializer_error;
+        std::thread serializer([&]() {
+            try {
+                for (auto message : messages) {
+                    auto writer = std::find_if(writers.begin(), writers.end(),
+                                               [&](auto &writer) { return writer->accepts(message); }
+                    );
+
+                    if (writer == writers.end()) continue;
+
+                    if ((*writer)->stateless()) {
+                        frames.push(pool.async(serialize, writer->get(), std::move(message)));
+                        continue;
+                    }
+
+                    std::packaged_task<std::string(Core::Writer *, Core::Message)> task(serialize);
+                    auto frame = task.get_future();
+                    task(writer->get(), std::move(message));
+                    frames.push(std::move(frame));
+                }
+            } catch (const Core::ChannelClosed &) {
+                // Sending failed; the error is reported below.
+            } catch (...) {
+                serializer_error = std::current_exception();
+            }
+            frames.close();
+        });
+
+        std::exception_ptr error;
+        try {
+            while (true) {
+                auto frame = frames.pop().get();
+                stream.write(frame.data(), frame.size());
+            }
+        } catch (const Core::ChannelClosed &) {
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        frames.close();
+        serializer.join();
+        pool.join();
+
+        if (error) std::rethrow_exception(error);
+        if (serializer_error) std::rethrow_exception(serializer_error);
+    }
+
     std::vector<std::unique_ptr<Core::Writer>> default_writers();
 
+    // Reports the time spent on a phase of the connection setup, when it goes out of scope.
+    class SetupTimer {
+    public:
+        explicit SetupTimer(std::string phase)
+                : phase{std::move(phase)}, start{std::chrono::steady_clock::now()} {}
+
+        ~SetupTimer() {
+            auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - start
+            );
+            GINFO_STREAM("Connection setup: " << phase << " took " << elapsed.count() / 1000.0 << " ms");
+        }
+
+    private:
+        const std::string phase;
+        const std::chrono::steady_clock::time_point start;
+    };
+
     template<class F>
     std::thread start_input_thread(
             std::iostream &stream,
@@ -137,8 +234,18 @@ namespace Gadgetron::Server::Connection {
             std::iostream &stream,
             Core::GenericInputChannel channel,
             F writer_factory,
-            ErrorHandler &error_handler
+            ErrorHandler &error_handler,
+            size_t serializer_threads = 0
     ) {
+        if (serializer_threads) {
+            return ErrorHandler(error_handler, "Connection Output Thread").run(
+                    [&stream, serializer_threads](auto c, auto w) {
+                        process_output_pipelined(stream, std::move(c), w, serializer_threads);
+                    },
+                    std::move(channel), writer_factory
+            );
+        }
+
         return ErrorHandler(error_handler,"Connection Output Thread").run(
                 [&stream](auto c, auto w) { process_output(stream, std::move(c), w); },
                 std::move(channel), writer_factory
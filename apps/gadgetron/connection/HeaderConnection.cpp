@@ -109,12 +109,16 @@ namespace Gadgetron::Server::Connection::HeaderConnection {
         output_thread.join();
 
         auto header = context.header.value_or(Header());
+        auto storage = [&]() {
+            SetupTimer timer{"storage"};
+            return setup_storage_spaces(storage_address, header);
+        }();
         StreamContext stream_context{
             header,
             paths,
             args,
             storage_address,
-            setup_storage_spaces(storage_address, header)
+            std::move(storage)
         };
 
         auto process = context.header ? StreamConnection::process : VoidConnection::process;
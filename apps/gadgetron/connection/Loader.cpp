@@ -1,6 +1,8 @@
 #include "Loader.h"
 
+#include <map>
 #include <memory>
+#include <mutex>
 
 #include "nodes/Stream.h"
 
@@ -9,6 +11,10 @@ namespace {
 
     using reader_factory = std::unique_ptr<Reader>();
     using writer_factory = std::unique_ptr<Writer>();
+
+    std::mutex cache_mutex;
+    std::map<std::string, boost::dll::shared_library> libraries;
+    std::map<std::pair<std::string, std::string>, void *> factories;
 }
 
 namespace Gadgetron::Server::Connection {
@@ -16,6 +22,11 @@ namespace Gadgetron::Server::Connection {
     Loader::Loader(const StreamContext &context) : context(context) {}
 
     boost::dll::shared_library Loader::load_library(const std::string &shared_library_name) {
+        std::lock_guard<std::mutex> guard(cache_mutex);
+
+        auto cached = libraries.find(shared_library_name);
+        if (cached != libraries.end()) return cached->second;
+
         try
         {
             auto lib = boost::dll::shared_library(
@@ -24,7 +35,7 @@ namespace Gadgetron::Server::Connection {
                     boost::dll::load_mode::rtld_global |
                     boost::dll::load_mode::search_system_folders
             );
-            libraries.push_back(lib);
+            libraries.emplace(shared_library_name, lib);
             return lib;
         }
         catch( const std::exception & ex )
@@ -34,6 +45,17 @@ namespace Gadgetron::Server::Connection {
         }
     }
 
+    void *Loader::cached_factory(const std::string &dll, const std::string &symbol) {
+        std::lock_guard<std::mutex> guard(cache_mutex);
+        auto cached = factories.find({dll, symbol});
+        return cached != factories.end() ? cached->second : nullptr;
+    }
+
+    void Loader::cache_factory(const std::string &dll, const std::string &symbol, void *factory) {
+        std::lock_guard<std::mutex> guard(cache_mutex);
+        factories[{dll, symbol}] = factory;
+    }
+
     std::unique_ptr<Reader> Loader::load(const Config::Reader &conf) {
         auto factory = load_factory<reader_factory>("reader_factory_export_", conf.classname, conf.dll);
         return factory();
@@ -38,9 +38,14 @@ namespace Gadgetron::Server::Connection {
 
         template<class FACTORY>
         FACTORY& load_factory(const std::string &prefix, const std::string &classname, const std::string &dll) {
+            auto symbol = prefix + classname;
+            if (auto factory = cached_factory(dll, symbol)) return *reinterpret_cast<FACTORY *>(factory);
+
             GINFO_STREAM("loading " << prefix << " - " << classname << " from the dll " << dll);
             auto library = load_library(dll);
-            return library.get_alias<FACTORY>(prefix + classname);
+            auto &factory = library.get_alias<FACTORY>(symbol);
+            cache_factory(dll, symbol, reinterpret_cast<void *>(&factory));
+            return factory;
         }
 
         std::map<uint16_t, std::unique_ptr<Reader>> load_readers(const std::vector<Config::Reader> &);
@@ -91,11 +96,13 @@ namespace Gadgetron::Server::Connection {
         }
 
     private:
-        boost::dll::shared_library load_library(const std::string &shared_library_name);
+        // Libraries are kept loaded, and factories resolved, for the lifetime of the process, so connections
+        // using the same gadgets skip the library loading and symbol lookup.
+        static boost::dll::shared_library load_library(const std::string &shared_library_name);
+        static void *cached_factory(const std::string &dll, const std::string &symbol);
+        static void cache_factory(const std::string &dll, const std::string &symbol, void *factory);
 
         const Core::StreamContext context;
-
-        std::vector<boost::dll::shared_library> libraries = std::vector<boost::dll::shared_library>();
     };
 }
 
@@ -4,6 +4,8 @@
 
 #include "SocketStreamBuf.h"
 
+#include <algorithm>
+#include <chrono>
 #include <thread>
 
 #include "Types.h"
@@ -12,40 +14,40 @@
 namespace {
     using boost::asio::ip::tcp;
 
+    // Retries for as long as the previous ten attempts, two seconds apart, did; but the first retries come quickly,
+    // as a peer that is still starting up is usually ready within a fraction of a second.
     std::unique_ptr<tcp::socket> connect_socket(
         const std::string& host, const std::string& service, boost::asio::io_service& context) {
         tcp::resolver resolver{ context };
         boost::system::error_code ec;
-        for (int remaining_attemps = 10; remaining_attemps > 0; remaining_attemps--) {
-            if (ec.failed()) {
-                GDEBUG_STREAM("Waiting to retry after receiving error when connecting to service " << service << " on host " << host << ": " << ec.message());
-                std::this_thread::sleep_for(std::chrono::seconds(2));
-                ec.clear();
-            }
 
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(18);
+        auto delay = std::chrono::milliseconds(100);
+        while (true) {
             auto result = resolver.resolve(host, service, ec);
-            if (ec.failed()) {
-                continue;
+            if (!ec.failed()) {
+                auto socket = std::make_unique<tcp::socket>(context);
+                boost::asio::connect(*socket, result, ec);
+                if (!ec.failed()) return std::move(socket);
             }
 
-            auto socket = std::make_unique<tcp::socket>(context);
-            auto endpoint = *result;
-            socket->connect(endpoint, ec);
-            if (ec.failed()) {
-                continue;
-            } 
-            return std::move(socket);
-    }
+            if (std::chrono::steady_clock::now() + delay > deadline) break;
+
+            GDEBUG_STREAM("Waiting to retry after receiving error when connecting to service " << service << " on host " << host << ": " << ec.message());
+            std::this_thread::sleep_for(delay);
+            delay = std::min<std::chrono::milliseconds>(2 * delay, std::chrono::seconds(2));
+        }
 
         throw std::runtime_error("Failed to connect to service " + service + " on host " + host + ": " + ec.message());
     }
 
     class SocketStreamBuf : public std::streambuf {
     public:
-        explicit SocketStreamBuf(std::unique_ptr<boost::asio::ip::tcp::socket> socket, size_t buffer_size = 1024);
+        explicit SocketStreamBuf(std::unique_ptr<boost::asio::ip::tcp::socket> socket, size_t buffer_size = 64 * 1024);
 
     protected:
         std::streamsize xsputn(const char_type* data, std::streamsize length) override;
+        std::streamsize xsgetn(char_type* data, std::streamsize length) override;
 
         int sync() override;
         int underflow() override;
@@ -85,6 +87,20 @@ namespace {
         this->overflow();
         return boost::asio::write(*socket, boost::asio::buffer(data, length));
     }
+    std::streamsize SocketStreamBuf::xsgetn(char* data, std::streamsize length) {
+        auto buffered = std::min<std::streamsize>(length, std::distance(this->gptr(), this->egptr()));
+        std::copy(this->gptr(), this->gptr() + buffered, data);
+        this->gbump(int(buffered));
+
+        auto remaining = length - buffered;
+        if (remaining < std::streamsize(input_buffer.size())) {
+            return buffered + std::streambuf::xsgetn(data + buffered, remaining);
+        }
+
+        // Large payloads, e.g. acquisition or image data, are read straight into place.
+        return buffered + std::streamsize(boost::asio::read(*socket, boost::asio::buffer(data + buffered, remaining)));
+    }
+
     SocketStreamBuf::SocketStreamBuf(std::unique_ptr<boost::asio::ip::tcp::socket> socket, size_t buffer_size)
         : socket(std::move(socket)), input_buffer(buffer_size), output_buffer(buffer_size) {
         this->setg(input_buffer.data(), input_buffer.data() + buffer_size, input_buffer.data() + buffer_size);
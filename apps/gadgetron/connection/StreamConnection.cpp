@@ -57,6 +57,10 @@ namespace {
         return handlers;
     }
 
+    size_t serializer_threads(const StreamContext::Args &args) {
+        return args.count("io_threads") ? args["io_threads"].as<unsigned int>() : 0;
+    }
+
     std::vector<std::unique_ptr<Writer>> prepare_writers(std::vector<std::unique_ptr<Writer>> &writers) {
         auto ws = default_writers();
         for (auto &writer : writers) { ws.emplace_back(std::move(writer)); }
@@ -80,8 +84,14 @@ namespace Gadgetron::Server::Connection::StreamConnection {
         auto ichannel = make_channel<MessageChannel>();
         auto ochannel = make_channel<MessageChannel>();
 
-        auto readers = loader.load_readers(config);
-        auto writers = loader.load_writers(config);
+        auto readers = [&]() {
+            SetupTimer timer{"readers"};
+            return loader.load_readers(config);
+        }();
+        auto writers = [&]() {
+            SetupTimer timer{"writers"};
+            return loader.load_writers(config);
+        }();
 
         std::thread input_thread = start_input_thread(
                 stream,
@@ -94,10 +104,14 @@ namespace Gadgetron::Server::Connection::StreamConnection {
                 stream,
                 std::move(ochannel.input),
                 [&]() { return prepare_writers(writers); },
-                error_handler
+                error_handler,
+                serializer_threads(context.args)
         );
 
-        auto processable = loader.load(config.stream);
+        auto processable = [&]() {
+            SetupTimer timer{"stream"};
+            return loader.load(config.stream);
+        }();
         processable->process(
             std::move(ichannel.input),
             std::move(ochannel.output),
@@ -7,11 +7,13 @@ namespace Gadgetron::Server::Connection::Writers {
 
     class ResponseWriter : public Core::TypedWriter<Core::Response> {
     public:
+            bool stateless() const override { return true; }
             void serialize(std::ostream &, const Core::Response& ) override;
     };
 
     class TextWriter : public Core::TypedWriter<std::string> {
     public:
+        bool stateless() const override { return true; }
         void serialize(std::ostream &, const std::string&) override;
     };
 }
@@ -110,6 +110,14 @@ namespace {
             return gadget_node;
         }
 
+        static pugi::xml_node add_node(const Config::Gadget &gadget, pugi::xml_node &node) {
+            auto gadget_node = add_basenode(gadget, node);
+            add_name(gadget, gadget_node);
+            if (gadget.threads) gadget_node.append_attribute("threads").set_value((long long unsigned int)*gadget.threads);
+            for (auto &property : gadget.properties) add_property(property, gadget_node);
+            return gadget_node;
+        }
+
         static pugi::xml_node add_node(const Config::Parallel &parallel, pugi::xml_node &node) {
             auto parallel_node = node.append_child("parallel");
             add_node(parallel.merge, parallel_node);
@@ -324,6 +332,25 @@ namespace {
                         parse_properties(gadget_node)};
         }
 
+        Config::Gadget parse_gadget(const pugi::xml_node &gadget_node) {
+            auto gadget = parse_node<Config::Gadget>(gadget_node);
+            gadget.threads = parse_threads(gadget_node);
+            return gadget;
+        }
+
+        // Thread budget of a gadget, given as <gadget threads="n"> or as a <threads>n</threads> child
+        static optional<size_t> parse_threads(const pugi::xml_node &gadget_node) {
+            std::string threads = gadget_node.attribute("threads").value();
+            if (threads.empty()) threads = gadget_node.child_value("threads");
+            if (threads.empty()) return none;
+
+            try {
+                return size_t(std::stoul(threads));
+            } catch (const std::exception &) {
+                throw ConfigNodeError("Unable to parse thread count", gadget_node);
+            }
+        }
+
     private:
         PropertyMap referenceable_properties;
 
@@ -439,7 +466,7 @@ namespace {
         std::vector<Config::Gadget> parse_gadgets(const pugi::xml_node &gadget_node) {
             std::vector<Config::Gadget> gadgets{};
             for (const auto &node : gadget_node.children("gadget")) {
-                gadgets.push_back(parse_node<Config::Gadget>(node));
+                gadgets.push_back(parse_gadget(node));
             }
             return gadgets;
         }
@@ -478,7 +505,7 @@ namespace {
     private:
 
         explicit V2(const pugi::xml_document &doc) : Parser<V2Source, LegacySource>(doc) {
-            node_parsers["gadget"] = [&](const pugi::xml_node &n) { return this->parse_node<Config::Gadget>(n); };
+            node_parsers["gadget"] = [&](const pugi::xml_node &n) { return this->parse_gadget(n); };
             node_parsers["parallel"] = [&](const pugi::xml_node &n) { return this->parse_parallel(n); };
             node_parsers["external"] = [&](const pugi::xml_node &n) { return this->parse_external(n); };
             node_parsers["distributed"] = [&](const pugi::xml_node &n) { return this->parse_distributed(n); };
@@ -529,7 +556,7 @@ namespace {
         Config::PureStream parse_purestream(const pugi::xml_node &purestream_node){
             std::vector<Config::Gadget> gadgets;
             boost::transform(purestream_node.children(), std::back_inserter(gadgets),
-                [&,this](auto node) { return this->parse_node<Config::Gadget>(node); });
+                [&,this](auto node) { return this->parse_gadget(node); });
             return {gadgets};
         }
 
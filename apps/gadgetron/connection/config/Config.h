@@ -44,6 +44,7 @@ namespace Gadgetron::Server::Connection {
         struct Gadget {
             std::string name, dll, classname;
             std::unordered_map<std::string, std::string> properties;
+            Core::optional<size_t> threads;
             Gadget(std::string name, std::string dll, std::string classname, std::unordered_map<std::string, std::string> properties):
             name(std::move(name)), dll(std::move(dll)), classname(std::move(classname)), properties(std::move(properties))
             {
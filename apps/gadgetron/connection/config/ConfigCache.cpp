@@ -0,0 +1,44 @@
+#include "ConfigCache.h"
+
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+
+#include "log.h"
+
+namespace {
+    using namespace Gadgetron::Server::Connection;
+
+    // Configs sent as strings may differ in every connection; the cache is cleared rather than growing unbounded.
+    constexpr size_t max_cached_configs = 256;
+
+    std::mutex cache_mutex;
+    std::unordered_map<std::string, std::shared_ptr<const Config>> cache;
+}
+
+namespace Gadgetron::Server::Connection::ConfigCache {
+
+    std::shared_ptr<const Config> parse(const std::string &content) {
+        {
+            std::lock_guard<std::mutex> guard(cache_mutex);
+            auto cached = cache.find(content);
+            if (cached != cache.end()) {
+                GDEBUG_STREAM("Using cached config");
+                return cached->second;
+            }
+        }
+
+        std::stringstream stream(content);
+        auto config = std::make_shared<const Config>(parse_config(stream));
+
+        std::lock_guard<std::mutex> guard(cache_mutex);
+        if (cache.size() >= max_cached_configs) cache.clear();
+        cache.emplace(content, config);
+        return config;
+    }
+
+    size_t size() {
+        std::lock_guard<std::mutex> guard(cache_mutex);
+        return cache.size();
+    }
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "Config.h"
+
+namespace Gadgetron::Server::Connection::ConfigCache {
+
+    /**
+     * Parses a config, or returns the config parsed earlier from the same content.
+     *
+     * Configs are keyed by the hash of their content, and kept for the lifetime of the process. Processes forked
+     * after a config has been parsed start out with it in the cache.
+     */
+    std::shared_ptr<const Config> parse(const std::string &content);
+
+    size_t size();
+}
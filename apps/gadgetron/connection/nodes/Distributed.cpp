@@ -1,5 +1,8 @@
 
 #include <list>
+#include <mutex>
+#include <condition_variable>
+#include <tuple>
 #include <algorithm>
 
 #include "Distributed.h"
@@ -8,6 +11,9 @@
 #include "common/Discovery.h"
 #include "common/ExternalChannel.h"
 
+#include "distributed/ConnectionPool.h"
+#include "distributed/Scheduler.h"
+
 #include "io/iostream_operators.h"
 
 namespace {
@@ -17,44 +23,213 @@ namespace {
     using namespace Gadgetron::Server::Connection;
     using namespace Gadgetron::Server::Connection::Nodes;
 
+    // Runs one channel on a peer chosen by the scheduler. Until the peer produces its first message, up to
+    // replay_limit of the messages sent to it are kept, so the channel can be moved to another peer if this one fails.
+    // Channels sending more messages than that before the first response fail with their peer.
     class ChannelWrapper {
     public:
         ChannelWrapper(
-                const Address &peer,
-                std::shared_ptr<Serialization> serialization,
-                std::shared_ptr<Configuration> configuration
+                std::shared_ptr<Scheduler> scheduler,
+                std::shared_ptr<ConnectionPool> connections,
+                size_t replay_limit
         );
 
         void process_input(GenericInputChannel input);
         void process_output(OutputChannel output);
+        void close();
 
     private:
+        using Connection = std::pair<Scheduler::Ticket, std::shared_ptr<ExternalChannel>>;
+
+        Connection connect_to_peer();
+        void peer_failed(const Scheduler::Ticket &failed_ticket);
+        bool reroute(const std::shared_ptr<ExternalChannel> &failed_external);
+        void push_message(Message message);
+        Message pop();
+
+        const std::shared_ptr<Scheduler> scheduler;
+        const std::shared_ptr<ConnectionPool> connections;
+        const size_t replay_limit;
+
+        // Connecting and replaying happen outside the lock; the channel is only swapped under it.
+        std::mutex mutex;
+        std::condition_variable rerouted;
+        Scheduler::Ticket ticket;
         std::shared_ptr<ExternalChannel> external;
+        std::list<Message> sent;
+        bool replayable = true;
+        bool rerouting = false;
+        bool input_closed = false;
     };
 
     ChannelWrapper::ChannelWrapper(
-            const Address &peer,
-            std::shared_ptr<Serialization> serialization,
-            std::shared_ptr<Configuration> configuration
-    ) {
-        GINFO_STREAM("Connecting to peer: " << peer);
-        external = std::make_shared<ExternalChannel>(
-                connect(peer, configuration),
-                std::move(serialization),
-                std::move(configuration)
-        );
+            std::shared_ptr<Scheduler> scheduler,
+            std::shared_ptr<ConnectionPool> connections,
+            size_t replay_limit
+    ) : scheduler(std::move(scheduler)),
+        connections(std::move(connections)),
+        replay_limit(replay_limit) {
+        std::tie(ticket, external) = connect_to_peer();
+    }
+
+    ChannelWrapper::Connection ChannelWrapper::connect_to_peer() {
+        while (true) {
+            auto selected = scheduler->select();
+            auto &peer = scheduler->address(selected);
+            try {
+                GINFO_STREAM("Connecting to peer: " << peer);
+                return Connection{selected, connections->take(peer)};
+            }
+            catch (const std::exception &e) {
+                GWARN_STREAM("Failed connecting to peer " << peer << "; it will not be used again. [" << e.what() << "]");
+                peer_failed(selected);
+            }
+        }
+    }
+
+    void ChannelWrapper::peer_failed(const Scheduler::Ticket &failed_ticket) {
+        connections->discard(scheduler->address(failed_ticket));
+        scheduler->failed(failed_ticket);
+    }
+
+    // Returns false if the channel cannot be moved, because messages it needs have not been kept.
+    bool ChannelWrapper::reroute(const std::shared_ptr<ExternalChannel> &failed_external) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+
+            // Both threads may notice the same failure; only the first moves the channel.
+            rerouted.wait(lock, [&]() { return !rerouting; });
+            if (failed_external != external) return true;
+
+            peer_failed(ticket);
+            if (!replayable) return false;
+
+            GWARN_STREAM("Peer " << scheduler->address(ticket) << " failed; moving channel to another peer.");
+            rerouting = true;
+        }
+
+        auto done = [&](const Connection &connection) {
+            std::lock_guard<std::mutex> guard(mutex);
+            std::tie(ticket, external) = connection;
+            rerouting = false;
+            rerouted.notify_all();
+        };
+
+        while (true) {
+            Connection connection;
+            try {
+                connection = connect_to_peer();
+            }
+            catch (const std::exception &) {
+                done(Connection{ticket, external});
+                throw;
+            }
+
+            try {
+                // Both threads wait while the channel is moved, so sent does not change meanwhile.
+                for (auto &message : sent) connection.second->push_message(message.clone());
+                if (input_closed) connection.second->close();
+                done(connection);
+                return true;
+            }
+            catch (const std::exception &e) {
+                GWARN_STREAM("Peer " << scheduler->address(connection.first) << " failed. [" << e.what() << "]");
+                peer_failed(connection.first);
+            }
+        }
+    }
+
+    void ChannelWrapper::push_message(Message message) {
+        std::shared_ptr<ExternalChannel> current;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            rerouted.wait(lock, [&]() { return !rerouting; });
+            current = external;
+
+            if (replayable && sent.size() < replay_limit) {
+                sent.push_back(message.clone());
+            } else if (replayable) {
+                GDEBUG_STREAM("Channel sent " << replay_limit << " messages without a response; it will not be moved if its peer fails.");
+                replayable = false;
+                sent.clear();
+            }
+        }
+
+        try {
+            current->push_message(std::move(message));
+        }
+        catch (const ChannelClosed &) {
+            throw;
+        }
+        catch (const std::exception &) {
+            if (!reroute(current)) throw;
+        }
+    }
+
+    Message ChannelWrapper::pop() {
+        while (true) {
+            std::shared_ptr<ExternalChannel> current;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                rerouted.wait(lock, [&]() { return !rerouting; });
+                current = external;
+            }
+
+            try {
+                auto message = current->pop();
+
+                std::unique_lock<std::mutex> lock(mutex);
+                rerouted.wait(lock, [&]() { return !rerouting; });
+
+                // The channel was moved; its new peer produces the message again.
+                if (current != external) continue;
+
+                replayable = false;
+                sent.clear();
+                return message;
+            }
+            catch (const ChannelClosed &) {
+                std::unique_lock<std::mutex> lock(mutex);
+                rerouted.wait(lock, [&]() { return !rerouting; });
+                if (current != external) continue;
+                scheduler->completed(ticket);
+                throw;
+            }
+            catch (const RemoteError &) {
+                std::unique_lock<std::mutex> lock(mutex);
+                rerouted.wait(lock, [&]() { return !rerouting; });
+                if (current != external) continue;
+                scheduler->completed(ticket);
+                throw;
+            }
+            catch (const std::exception &) {
+                if (!reroute(current)) throw;
+            }
+        }
+    }
+
+    void ChannelWrapper::close() {
+        std::shared_ptr<ExternalChannel> current;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            rerouted.wait(lock, [&]() { return !rerouting; });
+            input_closed = true;
+            current = external;
+        }
+        current->close();
     }
 
     void ChannelWrapper::process_input(GenericInputChannel input) {
-        auto closer = make_closer(external);
+        auto self = this;
+        auto closer = make_closer(self);
         for (auto message : input) {
-            external->push_message(std::move(message));
+            push_message(std::move(message));
         }
     }
 
     void ChannelWrapper::process_output(OutputChannel output) {
         while(true) {
-            output.push_message(external->pop());
+            output.push_message(pop());
             GDEBUG_STREAM("Pushed message to distributed output.");
         }
     }
@@ -72,14 +247,14 @@ namespace {
         );
 
     private:
-        Address next_peer();
-
         OutputChannel output;
 
         std::shared_ptr<Serialization> serialization;
         std::shared_ptr<Configuration> configuration;
 
-        std::list<Address> peers;
+        std::shared_ptr<Scheduler> scheduler;
+        std::shared_ptr<ConnectionPool> connections;
+        size_t replay_limit;
         std::list<std::thread> threads;
 
         ErrorHandler error_handler;
@@ -95,8 +270,14 @@ namespace {
         output(std::move(output_channel)),
         error_handler(error_handler, "Distributed") {
 
-        auto ps = discover_peers();
-        std::copy(ps.begin(), ps.end(), std::back_inserter(peers));
+        auto &args = this->configuration->context.args;
+        auto saturation = args.count("peer_saturation") ? args["peer_saturation"].as<unsigned int>() : 0;
+
+        auto spares = args.count("spare_peer_connections") ? args["spare_peer_connections"].as<unsigned int>() : 0;
+        replay_limit = args.count("peer_replay_messages") ? args["peer_replay_messages"].as<unsigned int>() : 0;
+
+        scheduler = std::make_shared<Scheduler>(discover_peers(), saturation);
+        connections = std::make_shared<ConnectionPool>(this->serialization, this->configuration, spares);
     }
 
     OutputChannel ChannelCreatorImpl::create() {
@@ -104,9 +285,9 @@ namespace {
         auto pair = Core::make_channel<MessageChannel>();
 
         auto channel = std::make_shared<ChannelWrapper>(
-                next_peer(),
-                serialization,
-                configuration
+                scheduler,
+                connections,
+                replay_limit
         );
 
         threads.push_back(error_handler.run(
@@ -124,12 +305,6 @@ namespace {
     void ChannelCreatorImpl::join() {
         for (auto &thread : threads) thread.join();
     }
-
-    Address ChannelCreatorImpl::next_peer() {
-        auto peer = peers.front(); peers.pop_front();
-        peers.push_back(peer);
-        return peer;
-    }
 }
 
 namespace {
@@ -1,5 +1,7 @@
 #include "PureStream.h"
 
+#include "ThreadBudget.h"
+
 namespace {
     using namespace Gadgetron::Core;
     using namespace Gadgetron::Server::Connection;
@@ -8,6 +10,8 @@ namespace {
         auto factory
             = loader.load_factory<Loader::generic_factory<Node>>("gadget_factory_export_", conf.classname, conf.dll);
 
+        // A configured budget also covers the construction of the gadget, as for the nodes of a stream.
+        ThreadBudget budget(conf.threads.value_or(0));
         auto gadget = factory(context, conf.properties);
 
         if (dynamic_cast<GenericPureGadget*>(gadget.get())) {
@@ -17,14 +21,17 @@ namespace {
         throw std::runtime_error("Non-pure Gadget \"" + conf.classname + "\" in pure stream.");
     }
 
-    std::vector<std::unique_ptr<GenericPureGadget>> load_pure_gadgets(
+    template<class BudgetedGadget>
+    std::vector<BudgetedGadget> load_pure_gadgets(
         const std::vector<Config::Gadget>& configs,
         const Context& context,
         Loader& loader
     ) {
-        std::vector<std::unique_ptr<GenericPureGadget>> gadgets;
+        std::vector<BudgetedGadget> gadgets;
         for (auto& config : configs) {
-            gadgets.emplace_back(load_pure_gadget(config, context, loader));
+            auto gadget = load_pure_gadget(config, context, loader);
+            auto threads = config.threads.value_or(gadget->thread_budget());
+            gadgets.push_back(BudgetedGadget{std::move(gadget), threads});
         }
         return gadgets;
     }
@@ -34,7 +41,7 @@ Gadgetron::Server::Connection::Nodes::PureStream::PureStream(
     const Gadgetron::Server::Connection::Config::PureStream& conf,
     const Gadgetron::Core::Context& context,
     Loader& loader
-) : pure_gadgets{ load_pure_gadgets(conf.gadgets, context, loader) } {}
+) : pure_gadgets{ load_pure_gadgets<BudgetedGadget>(conf.gadgets, context, loader) } {}
 
 Gadgetron::Core::Message Gadgetron::Server::Connection::Nodes::PureStream::process_function(
     Gadgetron::Core::Message message
@@ -43,8 +50,9 @@ Gadgetron::Core::Message Gadgetron::Server::Connection::Nodes::PureStream::proce
             pure_gadgets.begin(),
             pure_gadgets.end(),
             std::move(message),
-            [](auto&& message, auto&& gadget) {
-                return gadget->process_function(std::move(message));
+            [](auto&& message, auto&& budgeted) {
+                ThreadBudget budget(budgeted.threads);
+                return budgeted.gadget->process_function(std::move(message));
             }
     );
 }
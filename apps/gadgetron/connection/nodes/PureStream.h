@@ -5,12 +5,21 @@
 #include "connection/config/Config.h"
 
 namespace Gadgetron::Server::Connection::Nodes {
+    /**
+     * Runs the gadgets of a pure stream in turn on the calling thread. Each gadget runs within its thread budget,
+     * configured or declared as for the gadgets of a regular stream.
+     */
     class PureStream {
     public:
         PureStream(const Config::PureStream&, const Core::Context&, Loader&);
         Core::Message process_function(Core::Message) const;
 
     private:
-        const std::vector<std::unique_ptr<Core::GenericPureGadget>> pure_gadgets;
+        struct BudgetedGadget {
+            std::unique_ptr<Core::GenericPureGadget> gadget;
+            size_t threads;
+        };
+
+        const std::vector<BudgetedGadget> pure_gadgets;
     };
 }
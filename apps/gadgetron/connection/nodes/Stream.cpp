@@ -10,6 +10,8 @@
 #include "connection/Loader.h"
 
 #include "Node.h"
+#include "ThreadBudget.h"
+#include "log.h"
 
 namespace {
     using namespace Gadgetron::Core;
@@ -31,13 +33,24 @@ namespace {
 
     class NodeProcessable : public Processable {
     public:
-        NodeProcessable(std::function<std::unique_ptr<Node>()> factory, std::string name) : factory(std::move(factory)), name_(std::move(name)) {}
+        NodeProcessable(std::function<std::unique_ptr<Node>()> factory, std::string name, optional<size_t> threads)
+            : factory(std::move(factory)), name_(std::move(name)), threads(threads) {}
 
         void process(GenericInputChannel input,
                 OutputChannel output,
                 ErrorHandler &
         ) override {
+            // A configured budget also covers the construction of the node; a declared one is known only after.
+            ThreadBudget configured_budget(threads.value_or(0));
             auto node = factory();
+
+            ThreadBudget budget(threads.value_or(node->thread_budget()));
+            // Measuring runs a parallel region, so it is only done once per node, and only when it will be logged.
+            if (Gadgetron::GadgetronLogger::instance()->isLevelEnabled(Gadgetron::GADGETRON_LOG_LEVEL_DEBUG)) {
+                GDEBUG_STREAM("Node " << name_ << " has a thread budget of " << budget.threads
+                                      << " and runs parallel regions with " << ThreadBudget::measure() << " threads");
+            }
+
             node->process(input, output);
         }
 
@@ -48,6 +61,7 @@ namespace {
     private:
         std::function<std::unique_ptr<Node>()> factory;
         const std::string name_;
+        const optional<size_t> threads;
     };
 
     std::shared_ptr<Processable> load_node(const Config::Gadget &conf, const StreamContext &context, Loader &loader) {
@@ -58,7 +72,8 @@ namespace {
                 GDEBUG("Loading Gadget %s of class %s from %s\n", conf.name.c_str(), conf.classname.c_str(), conf.dll.c_str());
                 return factory(context, conf.properties);
             },
-            Config::name(conf)
+            Config::name(conf),
+            conf.threads
         );
     }
 
@@ -0,0 +1,31 @@
+#include "ConnectionPool.h"
+
+using namespace Gadgetron::Core;
+
+namespace {
+    using namespace Gadgetron::Server::Connection::Nodes;
+
+    std::unique_ptr<ExternalChannel> connect_to_peer(
+            Address peer,
+            std::shared_ptr<Serialization> serialization,
+            std::shared_ptr<Configuration> configuration
+    ) {
+        return std::make_unique<ExternalChannel>(
+                connect(peer, configuration),
+                std::move(serialization),
+                std::move(configuration)
+        );
+    }
+}
+
+namespace Gadgetron::Server::Connection::Nodes {
+
+    ConnectionPool::ConnectionPool(
+            std::shared_ptr<Serialization> serialization,
+            std::shared_ptr<Configuration> configuration,
+            size_t spares
+    ) : BasicConnectionPool<ExternalChannel>(
+                [=](const Address &peer) { return connect_to_peer(peer, serialization, configuration); },
+                spares
+        ) {}
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+
+#include "connection/nodes/common/Configuration.h"
+#include "connection/nodes/common/External.h"
+#include "connection/nodes/common/ExternalChannel.h"
+#include "connection/nodes/common/Serialization.h"
+
+namespace Gadgetron::Server::Connection::Nodes {
+
+    /**
+     * Keeps connections to the peers of a Distributed node open ahead of time.
+     *
+     * Once a peer has been used, spare connections to it are opened in the background, and sent the configuration and
+     * header, so the peer builds its chain while earlier channels are running. A channel taking a spare connection
+     * starts without waiting on connection setup, and a replacement is opened. No spares are opened to peers that
+     * failed.
+     *
+     * Spares to peers that failed, and spares left over when the pool is destroyed, are closed without being sent any
+     * data. Neither waits for spares still being opened; they are closed once they open.
+     */
+    template<class CHANNEL>
+    class BasicConnectionPool {
+    public:
+        using Connect = std::function<std::unique_ptr<CHANNEL>(const Address &)>;
+
+        BasicConnectionPool(Connect open_connection, size_t spares);
+        ~BasicConnectionPool();
+
+        std::shared_ptr<CHANNEL> take(const Address &peer);
+        void discard(const Address &peer);
+
+    private:
+        struct Spare;
+
+        struct PeerOrder {
+            bool operator()(const Address &a, const Address &b) const;
+        };
+
+        std::shared_ptr<Spare> open(const Address &peer);
+        static void abandon(const std::shared_ptr<Spare> &spare);
+
+        const Connect open_connection;
+        const size_t spares;
+
+        std::mutex mutex;
+        std::map<Address, std::list<std::shared_ptr<Spare>>, PeerOrder> pending;
+        std::set<Address, PeerOrder> failed;
+    };
+
+    class ConnectionPool : public BasicConnectionPool<ExternalChannel> {
+    public:
+        ConnectionPool(
+                std::shared_ptr<Serialization> serialization,
+                std::shared_ptr<Configuration> configuration,
+                size_t spares
+        );
+    };
+}
+
+#include "ConnectionPool.hpp"
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <thread>
+#include <tuple>
+
+#include "log.h"
+
+namespace Gadgetron::Server::Connection::Nodes {
+
+    // Shared with the thread opening the connection, so the pool never waits for it.
+    template<class CHANNEL>
+    struct BasicConnectionPool<CHANNEL>::Spare {
+        std::mutex mutex;
+        std::condition_variable opened;
+        std::unique_ptr<CHANNEL> channel;
+        std::exception_ptr error;
+        bool done = false;
+        bool abandoned = false;
+
+        void close() {
+            if (!channel) return;
+            try {
+                channel->close();
+            }
+            catch (const std::exception &e) {
+                GDEBUG_STREAM("Closing spare connection failed: " << e.what());
+            }
+            channel.reset();
+        }
+    };
+
+    template<class CHANNEL>
+    bool BasicConnectionPool<CHANNEL>::PeerOrder::operator()(const Address &a, const Address &b) const {
+        if (a.index() != b.index()) return a.index() < b.index();
+
+        auto remote_a = std::get_if<Remote>(&a), remote_b = std::get_if<Remote>(&b);
+        if (!remote_a) return false;
+        return std::tie(remote_a->address, remote_a->port) < std::tie(remote_b->address, remote_b->port);
+    }
+
+    template<class CHANNEL>
+    BasicConnectionPool<CHANNEL>::BasicConnectionPool(
+            Connect open_connection,
+            size_t spares
+    ) : open_connection(std::move(open_connection)),
+        spares(spares) {}
+
+    template<class CHANNEL>
+    BasicConnectionPool<CHANNEL>::~BasicConnectionPool() {
+        std::lock_guard<std::mutex> guard(mutex);
+        for (auto &peer : pending) {
+            for (auto &spare : peer.second) abandon(spare);
+        }
+    }
+
+    template<class CHANNEL>
+    std::shared_ptr<CHANNEL> BasicConnectionPool<CHANNEL>::take(const Address &peer) {
+
+        std::shared_ptr<Spare> spare;
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            auto &connections = pending[peer];
+
+            if (!connections.empty()) {
+                spare = std::move(connections.front());
+                connections.pop_front();
+            }
+
+            if (!failed.count(peer)) {
+                while (connections.size() < spares) connections.push_back(open(peer));
+            }
+        }
+
+        if (!spare) return open_connection(peer);
+
+        std::unique_lock<std::mutex> lock(spare->mutex);
+        spare->opened.wait(lock, [&]() { return spare->done; });
+        if (spare->error) std::rethrow_exception(spare->error);
+        return std::move(spare->channel);
+    }
+
+    // Closes the spare connections to a peer that failed, and opens no more.
+    template<class CHANNEL>
+    void BasicConnectionPool<CHANNEL>::discard(const Address &peer) {
+        std::lock_guard<std::mutex> guard(mutex);
+
+        failed.insert(peer);
+
+        auto connections = pending.find(peer);
+        if (connections == pending.end()) return;
+
+        for (auto &spare : connections->second) abandon(spare);
+        pending.erase(connections);
+    }
+
+    template<class CHANNEL>
+    std::shared_ptr<typename BasicConnectionPool<CHANNEL>::Spare> BasicConnectionPool<CHANNEL>::open(const Address &peer) {
+        auto spare = std::make_shared<Spare>();
+
+        std::thread([=, open_connection = open_connection]() {
+            std::unique_ptr<CHANNEL> channel;
+            std::exception_ptr error;
+            try {
+                channel = open_connection(peer);
+            }
+            catch (...) {
+                error = std::current_exception();
+            }
+
+            std::lock_guard<std::mutex> guard(spare->mutex);
+            spare->channel = std::move(channel);
+            spare->error = error;
+            spare->done = true;
+            spare->opened.notify_all();
+
+            if (spare->abandoned) spare->close();
+        }).detach();
+
+        return spare;
+    }
+
+    template<class CHANNEL>
+    void BasicConnectionPool<CHANNEL>::abandon(const std::shared_ptr<Spare> &spare) {
+        std::lock_guard<std::mutex> guard(spare->mutex);
+        spare->abandoned = true;
+        if (spare->done) spare->close();
+    }
+}
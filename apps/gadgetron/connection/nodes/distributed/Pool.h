@@ -1,13 +1,17 @@
 #pragma once
 
+#include <chrono>
 #include <mutex>
+#include <condition_variable>
 #include <vector>
+#include <list>
+#include <deque>
+#include <map>
+#include <thread>
 #include <memory>
 #include <future>
 #include <algorithm>
 
-#include "connection/nodes/common/External.h"
-
 #include "Worker.h"
 
 #include "Message.h"
@@ -15,12 +19,56 @@
 
 namespace Gadgetron::Server::Connection::Nodes {
 
-    class Pool {
+    /**
+     * Jobs are queued in the pool, and taken by workers as they have room for them; a fast worker takes more jobs
+     * than a slow one, and no job waits behind a busy worker while another is idle. Each worker is kept at most
+     * `depth` jobs ahead, to hide the round trip.
+     *
+     * Jobs failed by a worker are retried on the remaining workers. A worker that can no longer be pushed to takes no
+     * more jobs, and jobs no remaining worker may take are failed.
+     *
+     * Once the pool is being destroyed and the queue is empty, idle workers also run copies of jobs that have been
+     * running for more than twice the usual job time. Whichever copy finishes first is the result; the other is
+     * discarded. Copies only speed up delivering the result: workers finish every job pushed to them, so destroying
+     * the pool still waits for the slower copy.
+     */
+    template<class WORKER>
+    class BasicPool {
     public:
-        explicit Pool(std::list<std::unique_ptr<Worker>> workers);
+        explicit BasicPool(std::list<std::unique_ptr<WORKER>> workers, size_t depth = 2);
+        ~BasicPool();
+
         std::future<Core::Message> push(Core::Message message);
 
     private:
-        std::shared_ptr<std::list<std::unique_ptr<Worker>>> workers;
+        struct Job;
+
+        std::shared_ptr<Job> next_job(const WORKER &worker);
+        std::shared_ptr<Job> straggler(const WORKER &worker, std::chrono::steady_clock::time_point now);
+        bool takeable(const Job &job) const;
+        void requeue(const std::shared_ptr<Job> &job);
+        void fail_untakeable_jobs();
+        void complete(const std::shared_ptr<Job> &job, Core::Message message);
+        void fail(const std::shared_ptr<Job> &job, const WORKER &worker, std::exception_ptr error);
+        void abandon(const std::shared_ptr<Job> &job, const WORKER &worker);
+        void process_jobs(WORKER &worker);
+
+        std::list<std::unique_ptr<WORKER>> workers;
+
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::deque<std::shared_ptr<Job>> queue;
+        std::list<std::shared_ptr<Job>> running;
+        std::chrono::milliseconds job_time{0};
+        std::map<const WORKER *, size_t> live_threads;
+        bool closed = false;
+
+        std::vector<std::thread> threads;
     };
-}
\ No newline at end of file
+
+    using Pool = BasicPool<Worker>;
+
+    extern template class BasicPool<Worker>;
+}
+
+#include "Pool.hpp"
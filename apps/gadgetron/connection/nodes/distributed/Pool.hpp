@@ -0,0 +1,240 @@
+#pragma once
+
+#include "log.h"
+#include "io/iostream_operators.h"
+
+namespace Gadgetron::Server::Connection::Nodes {
+
+    namespace {
+        namespace gadgetron_pool_detail {
+            template<class T>
+            bool contains(const std::list<T> &list, const T &item) {
+                return std::find(list.begin(), list.end(), item) != list.end();
+            }
+
+            inline std::chrono::milliseconds time_since(std::chrono::steady_clock::time_point instance) {
+                return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - instance);
+            }
+        }
+    }
+
+    template<class WORKER>
+    struct BasicPool<WORKER>::Job {
+        Core::Message message;
+        std::promise<Core::Message> response;
+        std::chrono::steady_clock::time_point start;
+        std::list<const WORKER *> workers;
+        std::list<const WORKER *> failed_on;
+        std::exception_ptr error;
+        bool done = false;
+    };
+
+    template<class WORKER>
+    BasicPool<WORKER>::BasicPool(
+            std::list<std::unique_ptr<WORKER>> workers,
+            size_t depth
+    ) : workers(std::move(workers)) {
+        for (auto &worker : this->workers) {
+            live_threads[worker.get()] = depth;
+            for (size_t i = 0; i < depth; i++) {
+                threads.emplace_back([this, &worker = *worker]() { process_jobs(worker); });
+            }
+        }
+    }
+
+    template<class WORKER>
+    BasicPool<WORKER>::~BasicPool() {
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            closed = true;
+        }
+        cv.notify_all();
+        for (auto &thread : threads) thread.join();
+    }
+
+    template<class WORKER>
+    std::future<Core::Message> BasicPool<WORKER>::push(Core::Message message) {
+        auto job = std::make_shared<Job>(Job{std::move(message)});
+        auto future = job->response.get_future();
+
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            if (!takeable(*job)) {
+                job->response.set_exception(std::make_exception_ptr(
+                        std::runtime_error("Every worker failed; cannot distribute work.")
+                ));
+                return future;
+            }
+            queue.push_back(job);
+        }
+
+        cv.notify_one();
+        return future;
+    }
+
+    template<class WORKER>
+    void BasicPool<WORKER>::process_jobs(WORKER &worker) {
+        while (auto job = next_job(worker)) {
+            std::future<Core::Message> response;
+            try {
+                response = worker.push(job->message.clone());
+                GDEBUG_STREAM("Pushed message; waiting for response from worker " << worker.address);
+            }
+            catch (const std::exception &e) {
+                GWARN_STREAM("Worker " << worker.address << " failed; it will not be given more jobs. [" << e.what() << "]");
+                abandon(job, worker);
+                break;
+            }
+
+            try {
+                complete(job, response.get());
+            }
+            catch (const std::exception &e) {
+                GWARN_STREAM("Worker " << worker.address << " failed processing job. The job will be retried. [" << e.what() << "]");
+                fail(job, worker, std::current_exception());
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            live_threads[&worker]--;
+            fail_untakeable_jobs();
+        }
+        cv.notify_all();
+    }
+
+    template<class WORKER>
+    std::shared_ptr<typename BasicPool<WORKER>::Job> BasicPool<WORKER>::next_job(const WORKER &worker) {
+        using namespace gadgetron_pool_detail;
+        std::unique_lock<std::mutex> lock(mutex);
+
+        while (true) {
+            auto eligible = std::find_if(queue.begin(), queue.end(), [&](auto &job) {
+                return !contains(job->failed_on, &worker);
+            });
+
+            if (eligible != queue.end()) {
+                auto job = *eligible;
+                queue.erase(eligible);
+
+                running.push_back(job);
+                job->start = std::chrono::steady_clock::now();
+                job->workers.push_back(&worker);
+                return job;
+            }
+
+            if (!closed) {
+                cv.wait(lock);
+                continue;
+            }
+
+            if (auto job = straggler(worker, std::chrono::steady_clock::now())) return job;
+            if (queue.empty() && running.empty()) return nullptr;
+
+            cv.wait_for(lock, std::chrono::milliseconds(100));
+        }
+    }
+
+    template<class WORKER>
+    std::shared_ptr<typename BasicPool<WORKER>::Job> BasicPool<WORKER>::straggler(
+            const WORKER &worker,
+            std::chrono::steady_clock::time_point now
+    ) {
+        using namespace gadgetron_pool_detail;
+        if (!job_time.count()) return nullptr;
+
+        for (auto &job : running) {
+            if (job->done || job->workers.size() != 1) continue;
+            if (contains(job->workers, &worker) || contains(job->failed_on, &worker)) continue;
+            if (now - job->start < 2 * job_time) continue;
+
+            GDEBUG_STREAM("Running a copy of a slow job on worker " << worker.address);
+            job->workers.push_back(&worker);
+            return job;
+        }
+        return nullptr;
+    }
+
+    // A job may be taken by any worker with live threads that has not failed it.
+    template<class WORKER>
+    bool BasicPool<WORKER>::takeable(const Job &job) const {
+        using namespace gadgetron_pool_detail;
+        return std::any_of(live_threads.begin(), live_threads.end(), [&](auto &worker) {
+            return worker.second && !contains(job.failed_on, worker.first);
+        });
+    }
+
+    template<class WORKER>
+    void BasicPool<WORKER>::requeue(const std::shared_ptr<Job> &job) {
+        running.remove(job);
+        queue.push_front(job);
+        fail_untakeable_jobs();
+        cv.notify_all();
+    }
+
+    template<class WORKER>
+    void BasicPool<WORKER>::fail_untakeable_jobs() {
+        for (auto job = queue.begin(); job != queue.end();) {
+            if (takeable(**job)) {
+                job++;
+                continue;
+            }
+
+            (*job)->done = true;
+            (*job)->response.set_exception((*job)->error ? (*job)->error : std::make_exception_ptr(
+                    std::runtime_error("Every worker failed; cannot distribute work.")
+            ));
+            job = queue.erase(job);
+        }
+    }
+
+    template<class WORKER>
+    void BasicPool<WORKER>::complete(const std::shared_ptr<Job> &job, Core::Message message) {
+        using namespace gadgetron_pool_detail;
+        std::lock_guard<std::mutex> guard(mutex);
+
+        // Another copy of the job finished first.
+        if (job->done) return;
+
+        auto latency = std::max(time_since(job->start), std::chrono::milliseconds(1));
+        job_time = job_time.count() ? (3 * job_time + latency) / 4 : latency;
+
+        job->done = true;
+        running.remove(job);
+        job->response.set_value(std::move(message));
+        cv.notify_all();
+    }
+
+    template<class WORKER>
+    void BasicPool<WORKER>::fail(const std::shared_ptr<Job> &job, const WORKER &worker, std::exception_ptr error) {
+        std::lock_guard<std::mutex> guard(mutex);
+
+        job->workers.remove(&worker);
+        if (job->done) return;
+
+        job->failed_on.push_back(&worker);
+        job->error = error;
+        if (!job->workers.empty()) return;
+
+        if (job->failed_on.size() >= std::min<size_t>(3, workers.size())) {
+            GWARN_STREAM("Multiple workers failed processing job; aborting.");
+            job->done = true;
+            running.remove(job);
+            job->response.set_exception(error);
+            cv.notify_all();
+        } else {
+            requeue(job);
+        }
+    }
+
+    // The worker could not be pushed to; the job is returned to the queue without counting against it.
+    template<class WORKER>
+    void BasicPool<WORKER>::abandon(const std::shared_ptr<Job> &job, const WORKER &worker) {
+        std::lock_guard<std::mutex> guard(mutex);
+
+        job->workers.remove(&worker);
+        if (job->done || !job->workers.empty()) return;
+
+        requeue(job);
+    }
+}
@@ -0,0 +1,93 @@
+#include "Scheduler.h"
+
+#include <algorithm>
+
+using namespace Gadgetron::Core;
+
+namespace {
+
+    template<class T>
+    std::chrono::milliseconds time_since(std::chrono::time_point<T> instance, std::chrono::time_point<T> now) {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(now - instance);
+    }
+}
+
+namespace Gadgetron::Server::Connection::Nodes {
+
+    Scheduler::Scheduler(std::vector<Address> addresses, size_t saturation) : saturation(saturation) {
+
+        for (auto &address : addresses) peers.push_back(Peer{address, false});
+
+        auto is_local = [](auto &address) { return Core::holds_alternative<Local>(address); };
+        if (saturation && std::none_of(addresses.begin(), addresses.end(), is_local)) {
+            peers.push_back(Peer{Local{}, true});
+        }
+    }
+
+    Scheduler::Ticket Scheduler::select() {
+        std::lock_guard<std::mutex> guard(mutex);
+
+        auto now = clock::now();
+        auto best = peers.end();
+
+        auto consider = [&](auto peer) {
+            if (best == peers.end() || expected_wait(*peer, now) < expected_wait(*best, now)) best = peer;
+        };
+
+        for (auto peer = peers.begin(); peer != peers.end(); peer++) {
+            if (peer->failed || peer->fallback) continue;
+            if (saturation && peer->open.size() >= saturation) continue;
+            consider(peer);
+        }
+
+        if (best == peers.end()) {
+            for (auto peer = peers.begin(); peer != peers.end(); peer++) {
+                if (!peer->failed && peer->fallback) consider(peer);
+            }
+        }
+
+        if (best == peers.end()) {
+            for (auto peer = peers.begin(); peer != peers.end(); peer++) {
+                if (!peer->failed) consider(peer);
+            }
+        }
+
+        if (best == peers.end()) throw std::runtime_error("Every peer failed; cannot distribute work.");
+
+        best->open.insert(now);
+        return Ticket{size_t(best - peers.begin()), now};
+    }
+
+    void Scheduler::completed(const Ticket &ticket) {
+        std::lock_guard<std::mutex> guard(mutex);
+
+        auto &peer = peers[ticket.peer];
+        close(peer, ticket);
+
+        auto latency = std::max(time_since(ticket.start, clock::now()), std::chrono::milliseconds(1));
+        peer.latency = peer.completed++ ? (3 * peer.latency + latency) / 4 : latency;
+    }
+
+    void Scheduler::failed(const Ticket &ticket) {
+        std::lock_guard<std::mutex> guard(mutex);
+
+        auto &peer = peers[ticket.peer];
+        close(peer, ticket);
+        peer.failed = true;
+    }
+
+    const Address &Scheduler::address(const Ticket &ticket) const {
+        return peers[ticket.peer].address;
+    }
+
+    long long Scheduler::expected_wait(const Peer &peer, clock::time_point now) const {
+        auto latency = peer.latency;
+        if (!peer.open.empty()) latency = std::max(latency, time_since(*peer.open.begin(), now));
+        return latency.count() * (peer.open.size() + 1);
+    }
+
+    void Scheduler::close(Peer &peer, const Ticket &ticket) {
+        auto open = peer.open.find(ticket.start);
+        if (open != peer.open.end()) peer.open.erase(open);
+    }
+}
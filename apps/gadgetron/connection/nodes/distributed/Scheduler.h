@@ -0,0 +1,57 @@
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <vector>
+
+#include "connection/nodes/common/External.h"
+
+namespace Gadgetron::Server::Connection::Nodes {
+
+    /**
+     * Chooses the peer each new channel of a Distributed node is sent to.
+     *
+     * Peers are ranked by their expected wait: the number of channels they are working on, times the time a channel
+     * takes them. That time is estimated from the channels the peer has completed, and from how long its oldest open
+     * channel has been running, so a stalled peer is avoided before its channels complete.
+     *
+     * When saturation is nonzero, and every remote peer has that many open channels, channels are processed on this
+     * machine instead. Peers that failed are not chosen again.
+     */
+    class Scheduler {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        struct Ticket {
+            size_t peer;
+            clock::time_point start;
+        };
+
+        Scheduler(std::vector<Address> peers, size_t saturation);
+
+        Ticket select();
+        void completed(const Ticket &ticket);
+        void failed(const Ticket &ticket);
+
+        const Address &address(const Ticket &ticket) const;
+
+    private:
+        struct Peer {
+            Address address;
+            bool fallback;
+            bool failed = false;
+            size_t completed = 0;
+            std::chrono::milliseconds latency = std::chrono::seconds(5);
+            std::multiset<clock::time_point> open;
+        };
+
+        long long expected_wait(const Peer &peer, clock::time_point now) const;
+        void close(Peer &peer, const Ticket &ticket);
+
+        const size_t saturation;
+
+        std::mutex mutex;
+        std::vector<Peer> peers;
+    };
+}
@@ -55,6 +55,37 @@ int main(int argc, char *argv[]) {
             ("port,p",
                 value<unsigned short>()->default_value(9002),
                 "Listen for incoming connections on this port.")
+            ("workers",
+                value<unsigned int>()->default_value(0),
+                "Number of pre-forked worker processes kept ready to handle incoming connections. "
+                "If 0, a process is forked when a connection is accepted.")
+            ("preload",
+                value<std::vector<std::string>>()->default_value(
+                        {"gadgetron_core_readers", "gadgetron_core_writers", "gadgetron_mricore"},
+                        "gadgetron_core_readers gadgetron_core_writers gadgetron_mricore"),
+                "Gadget library preloaded by the pre-forked workers. Multiple libraries can be passed.")
+            ("preload_python",
+                value<bool>()->default_value(false),
+                "Initialize the Python interpreter in the pre-forked workers.")
+            ("io_threads",
+                value<unsigned int>()->default_value(0),
+                "Number of threads serializing outgoing messages while earlier messages are sent. "
+                "If 0, each message is serialized and sent in turn.")
+            ("peer_saturation",
+                value<unsigned int>()->default_value(0),
+                "Number of open channels at which a remote peer of a Distributed node counts as saturated. "
+                "Once every remote peer is saturated, channels are processed on this machine. "
+                "If 0, channels are only processed locally when no remote peer is available.")
+            ("spare_peer_connections",
+                value<unsigned int>()->default_value(0),
+                "Number of connections kept open ahead of time to each peer of a Distributed node, "
+                "so new channels do not wait for the peer to connect and build its chain. "
+                "If 0, each channel connects to its peer when it starts.")
+            ("peer_replay_messages",
+                value<unsigned int>()->default_value(128),
+                "Number of messages kept for each channel of a Distributed node until its peer responds, "
+                "so the channel can be moved to another peer if that peer fails. "
+                "Channels sending more messages before the first response fail with their peer.")
             ("from_stream, s",
                 "Perform reconstruction from a local data stream")
             ("input_path,i",
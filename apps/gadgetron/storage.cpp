@@ -13,6 +13,7 @@
 
 #include "IsmrmrdContextVariables.h"
 #include "Process.h"
+#include "StorageClients.h"
 #include "gadgetron_paths.h"
 #include "log.h"
 
@@ -26,9 +27,9 @@ namespace Gadgetron::Server {
 
 void invoke_storage_server_health_check(std::string base_address) {
     GINFO_STREAM("Verifying connectivity to storage server...")
-    StorageClient c(base_address);
+    auto client = make_storage_client(base_address);
     for (int i = 0;; i++) {
-        auto err = c.health_check();
+        auto err = client->health_check();
         if (!err.has_value()) {
             GINFO_STREAM("Received successful response from storage server.");
             break;
@@ -83,7 +84,8 @@ std::tuple<std::string, std::optional<boost::process::child>> ensure_storage_ser
 }
 
 StorageSpaces setup_storage_spaces(const std::string& address, const ISMRMRD::IsmrmrdHeader& header) {
-    auto client = std::make_shared<StorageClient>(address);
+    // Each connection gets its own cache; pending writes are completed when the spaces are released.
+    auto client = std::make_shared<AsyncStorageClient>(make_storage_client(address));
     IsmrmrdContextVariables variables(header);
     auto ttl = std::chrono::hours(48);
 
@@ -0,0 +1,38 @@
+#include <gtest/gtest.h>
+
+#include "../connection/config/ConfigCache.h"
+
+using namespace Gadgetron::Server::Connection;
+
+namespace {
+    std::string config_with_gadget(const std::string& classname) {
+        return "<?xml version=\"1.0\"?>"
+               "<configuration>"
+               "<version>2</version>"
+               "<stream>"
+               "<gadget><dll>gadgetron_mricore</dll><classname>" + classname + "</classname></gadget>"
+               "</stream>"
+               "</configuration>";
+    }
+}
+
+TEST(ConfigCacheTest, same_content_is_parsed_once) {
+    auto first  = ConfigCache::parse(config_with_gadget("NoiseAdjustGadget"));
+    auto second = ConfigCache::parse(config_with_gadget("NoiseAdjustGadget"));
+
+    EXPECT_EQ(first, second);
+    ASSERT_EQ(first->stream.nodes.size(), 1);
+    EXPECT_EQ(std::get<Config::Gadget>(first->stream.nodes[0]).classname, "NoiseAdjustGadget");
+}
+
+TEST(ConfigCacheTest, different_content_is_parsed_separately) {
+    auto first  = ConfigCache::parse(config_with_gadget("NoiseAdjustGadget"));
+    auto second = ConfigCache::parse(config_with_gadget("PCACoilGadget"));
+
+    EXPECT_NE(first, second);
+    EXPECT_EQ(std::get<Config::Gadget>(second->stream.nodes[0]).classname, "PCACoilGadget");
+}
+
+TEST(ConfigCacheTest, invalid_config_throws) {
+    EXPECT_THROW(ConfigCache::parse("<configuration>"), std::runtime_error);
+}
@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+
+#include "connection/nodes/distributed/ConnectionPool.h"
+
+using namespace Gadgetron::Server::Connection::Nodes;
+using namespace std::chrono_literals;
+
+namespace {
+
+    struct FakeChannel {
+        std::atomic<int> &closed;
+        void close() { closed++; }
+    };
+
+    // Counts the connections opened and closed. Spares, which are opened on other threads, can be held back until
+    // released.
+    class ConnectionPoolTest : public ::testing::Test {
+    protected:
+        std::unique_ptr<BasicConnectionPool<FakeChannel>> make_pool(size_t spares) {
+            return std::make_unique<BasicConnectionPool<FakeChannel>>(
+                    [this](const Address &) {
+                        opened++;
+                        if (hold_spares && std::this_thread::get_id() != test_thread) released.wait();
+                        return std::make_unique<FakeChannel>(FakeChannel{closed});
+                    },
+                    spares
+            );
+        }
+
+        template<class F>
+        static bool eventually(F condition) {
+            for (int i = 0; i < 500 && !condition(); i++) std::this_thread::sleep_for(10ms);
+            return condition();
+        }
+
+        void release_held() {
+            if (!held) return;
+            held = false;
+            release.set_value();
+        }
+
+        void TearDown() override {
+            release_held();
+            ASSERT_TRUE(eventually([&]() { return opened == closed + taken; }));
+        }
+
+        const Address peer = Remote{"peer", "9002"};
+
+        std::atomic<int> opened{0}, closed{0};
+        int taken = 0;
+        bool hold_spares = false;
+        const std::thread::id test_thread = std::this_thread::get_id();
+        bool held = true;
+
+        std::promise<void> release;
+        std::shared_future<void> released = release.get_future().share();
+    };
+}
+
+TEST_F(ConnectionPoolTest, opens_no_spares_when_none_are_requested) {
+    auto pool = make_pool(0);
+
+    pool->take(peer); taken++;
+    pool->take(peer); taken++;
+
+    EXPECT_EQ(opened, 2);
+}
+
+TEST_F(ConnectionPoolTest, spares_are_taken_and_replaced) {
+    auto pool = make_pool(1);
+
+    pool->take(peer); taken++;
+    ASSERT_TRUE(eventually([&]() { return opened == 2; }));
+
+    pool->take(peer); taken++;
+    ASSERT_TRUE(eventually([&]() { return opened == 3; }));
+
+    pool.reset();
+    EXPECT_TRUE(eventually([&]() { return closed == 1; }));
+}
+
+TEST_F(ConnectionPoolTest, spares_to_failed_peers_are_closed) {
+    auto pool = make_pool(1);
+
+    pool->take(peer); taken++;
+    ASSERT_TRUE(eventually([&]() { return opened == 2; }));
+
+    pool->discard(peer);
+    EXPECT_TRUE(eventually([&]() { return closed == 1; }));
+
+    pool->take(peer); taken++;
+    std::this_thread::sleep_for(50ms);
+    EXPECT_EQ(opened, 3);
+}
+
+TEST_F(ConnectionPoolTest, destruction_does_not_wait_for_spares_being_opened) {
+    hold_spares = true;
+    auto pool = make_pool(2);
+
+    pool->take(peer); taken++;
+    ASSERT_TRUE(eventually([&]() { return opened == 3; }));
+
+    auto start = std::chrono::steady_clock::now();
+    pool.reset();
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 1s);
+
+    EXPECT_EQ(closed, 0);
+    release_held();
+    EXPECT_TRUE(eventually([&]() { return closed == 2; }));
+}
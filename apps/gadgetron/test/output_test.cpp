@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <sstream>
+
+#include "connection/Core.h"
+
+using namespace Gadgetron::Core;
+using namespace Gadgetron::Server::Connection;
+
+namespace {
+
+    // Writes numbers after a delay that varies between messages, so later messages are often serialized first.
+    class SlowNumberWriter : public TypedWriter<int> {
+    public:
+        bool stateless() const override { return true; }
+
+    protected:
+        void serialize(std::ostream &stream, const int &number) override {
+            std::this_thread::sleep_for(std::chrono::microseconds((number * 7919) % 500));
+            stream << number << ';';
+        }
+    };
+
+    // Records whether it was ever called while already writing.
+    class TextWriter : public TypedWriter<std::string> {
+    public:
+        explicit TextWriter(std::atomic<bool> &called_concurrently) : called_concurrently(called_concurrently) {}
+
+    protected:
+        void serialize(std::ostream &stream, const std::string &text) override {
+            if (writing++) called_concurrently = true;
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+            stream << text << ';';
+            writing--;
+        }
+
+    private:
+        std::atomic<int> writing{0};
+        std::atomic<bool> &called_concurrently;
+    };
+}
+
+TEST(OutputTest, pipelined_frames_are_written_in_message_order) {
+
+    auto channel = make_channel<MessageChannel>();
+    std::stringstream expected;
+    {
+        auto output = std::move(channel.output);
+        for (int i = 0; i < 200; i++) {
+            if (i % 5 == 0) {
+                output.push(std::to_string(-i));
+                expected << -i << ';';
+            } else {
+                output.push(i);
+                expected << i << ';';
+            }
+        }
+    }
+
+    std::atomic<bool> called_concurrently{false};
+
+    std::stringstream stream;
+    process_output_pipelined(
+            stream,
+            std::move(channel.input),
+            [&]() {
+                std::vector<std::unique_ptr<Writer>> writers;
+                writers.emplace_back(std::make_unique<SlowNumberWriter>());
+                writers.emplace_back(std::make_unique<TextWriter>(called_concurrently));
+                return writers;
+            },
+            4
+    );
+
+    EXPECT_EQ(stream.str(), expected.str());
+    EXPECT_FALSE(called_concurrently);
+}
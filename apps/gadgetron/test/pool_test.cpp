@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+
+#include "connection/nodes/distributed/Pool.h"
+
+using namespace Gadgetron::Core;
+using namespace Gadgetron::Server::Connection::Nodes;
+using namespace std::chrono_literals;
+
+namespace {
+
+    // Responds to each job as its behaviour decides, counting the jobs pushed to it.
+    struct FakeWorker {
+        using Behaviour = std::function<std::future<Message>(Message)>;
+
+        FakeWorker(std::string address, Behaviour behaviour)
+                : address(std::move(address)), behaviour(std::move(behaviour)) {}
+
+        std::future<Message> push(Message message) {
+            pushes++;
+            return behaviour(std::move(message));
+        }
+
+        const std::string address;
+        const Behaviour behaviour;
+        std::atomic<int> pushes{0};
+    };
+
+    FakeWorker::Behaviour respond_after(std::chrono::milliseconds delay) {
+        return [=](Message message) {
+            return std::async(std::launch::async, [=](Message message) {
+                std::this_thread::sleep_for(delay);
+                return message;
+            }, std::move(message));
+        };
+    }
+
+    FakeWorker::Behaviour fail_jobs() {
+        return [](Message) {
+            std::promise<Message> response;
+            response.set_exception(std::make_exception_ptr(std::runtime_error("Job failed.")));
+            return response.get_future();
+        };
+    }
+
+    FakeWorker::Behaviour refuse_jobs() {
+        return [](Message) -> std::future<Message> { throw std::runtime_error("Worker closed."); };
+    }
+
+    template<class... WORKERS>
+    std::list<std::unique_ptr<FakeWorker>> make_workers(WORKERS *... workers) {
+        std::list<std::unique_ptr<FakeWorker>> list;
+        (list.emplace_back(workers), ...);
+        return list;
+    }
+}
+
+TEST(PoolTest, failed_jobs_are_retried_and_workers_keep_taking_jobs) {
+    auto failing = new FakeWorker("failing", fail_jobs());
+    auto working = new FakeWorker("working", respond_after(5ms));
+
+    BasicPool<FakeWorker> pool(make_workers(failing, working));
+
+    std::vector<std::future<Message>> responses;
+    for (int i = 0; i < 20; i++) responses.push_back(pool.push(Message(i)));
+
+    for (int i = 0; i < 20; i++) EXPECT_EQ(force_unpack<int>(responses[i].get()), i);
+    EXPECT_GT(failing->pushes, 2);
+}
+
+TEST(PoolTest, jobs_fail_when_every_worker_fails_them) {
+    BasicPool<FakeWorker> pool(make_workers(
+            new FakeWorker("a", fail_jobs()),
+            new FakeWorker("b", fail_jobs())
+    ));
+
+    auto response = pool.push(Message(1));
+    EXPECT_THROW(response.get(), std::runtime_error);
+}
+
+TEST(PoolTest, jobs_fail_when_no_live_worker_may_take_them) {
+    std::atomic<int> failures{0};
+    auto fail_once_then_refuse = [&](Message message) {
+        if (failures++) return refuse_jobs()(std::move(message));
+        return fail_jobs()(std::move(message));
+    };
+
+    std::future<Message> response;
+    {
+        BasicPool<FakeWorker> pool(make_workers(
+                new FakeWorker("a", fail_once_then_refuse),
+                new FakeWorker("b", refuse_jobs()),
+                new FakeWorker("c", refuse_jobs())
+        ));
+        response = pool.push(Message(1));
+    }
+
+    EXPECT_THROW(response.get(), std::runtime_error);
+}
+
+TEST(PoolTest, slow_jobs_are_copied_and_delivered_once) {
+    std::atomic<int> copies{0};
+    auto first_copy_is_slow = [&](Message message) {
+        auto delay = force_unpack<int>(message.clone()) == 99 && !copies++ ? 2s : 5ms;
+        return respond_after(std::chrono::duration_cast<std::chrono::milliseconds>(delay))(std::move(message));
+    };
+
+    auto pool = std::make_unique<BasicPool<FakeWorker>>(make_workers(
+            new FakeWorker("a", first_copy_is_slow),
+            new FakeWorker("b", first_copy_is_slow)
+    ), 1);
+
+    for (int i = 0; i < 4; i++) pool->push(Message(i)).get();
+
+    auto start = std::chrono::steady_clock::now();
+    auto response = pool->push(Message(99));
+    std::thread closing([&]() { pool.reset(); });
+
+    EXPECT_EQ(force_unpack<int>(response.get()), 99);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 1s);
+
+    closing.join();
+    EXPECT_EQ(copies, 2);
+}
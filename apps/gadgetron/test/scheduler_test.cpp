@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include "../connection/nodes/distributed/Scheduler.h"
+
+using namespace Gadgetron::Server::Connection::Nodes;
+
+namespace {
+    std::vector<Address> remote_peers(size_t count) {
+        std::vector<Address> peers;
+        for (size_t i = 0; i < count; i++) peers.emplace_back(Remote{"worker" + std::to_string(i), "9002"});
+        return peers;
+    }
+
+    bool is_local(const Address &address) {
+        return Gadgetron::Core::holds_alternative<Local>(address);
+    }
+}
+
+TEST(SchedulerTest, idle_peers_share_channels) {
+    Scheduler scheduler(remote_peers(2), 0);
+
+    auto first = scheduler.select();
+    auto second = scheduler.select();
+
+    EXPECT_NE(first.peer, second.peer);
+}
+
+TEST(SchedulerTest, faster_peers_get_more_channels) {
+    Scheduler scheduler(remote_peers(2), 0);
+
+    auto fast = scheduler.select();
+    auto slow = scheduler.select();
+    scheduler.completed(fast);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    scheduler.completed(slow);
+
+    auto tickets = std::vector<Scheduler::Ticket>{};
+    for (int i = 0; i < 4; i++) tickets.push_back(scheduler.select());
+
+    for (auto &ticket : tickets) EXPECT_EQ(ticket.peer, fast.peer);
+}
+
+TEST(SchedulerTest, saturated_peers_fall_back_to_local) {
+    Scheduler scheduler(remote_peers(1), 1);
+
+    auto remote = scheduler.select();
+    auto local = scheduler.select();
+
+    EXPECT_FALSE(is_local(scheduler.address(remote)));
+    EXPECT_TRUE(is_local(scheduler.address(local)));
+
+    scheduler.completed(remote);
+    EXPECT_FALSE(is_local(scheduler.address(scheduler.select())));
+}
+
+TEST(SchedulerTest, failed_peers_are_not_selected) {
+    Scheduler scheduler(remote_peers(2), 0);
+
+    auto failing = scheduler.select();
+    scheduler.failed(failing);
+
+    for (int i = 0; i < 4; i++) EXPECT_NE(scheduler.select().peer, failing.peer);
+
+    auto other = scheduler.select();
+    scheduler.failed(other);
+    EXPECT_THROW(scheduler.select(), std::runtime_error);
+}
@@ -1,6 +1,7 @@
 //
 // Created by dchansen on 9/10/19.
 //
+#include <numeric>
 #include <random>
 
 #include <boost/asio.hpp>
@@ -105,3 +106,29 @@ TEST_F(SocketTest, nulltest) {
     ASSERT_EQ(ref,data);
     thread.join();
 }
+
+TEST_F(SocketTest, large_read_test) {
+
+    auto header = std::vector<char>(3, 1);
+    auto payload = std::vector<char>(1u << 20);
+    std::iota(payload.begin(), payload.end(), 0);
+    auto trailer = std::vector<char>(5, 2);
+
+    auto thread = std::thread([&]() {
+        ba::write(*server_socket, ba::buffer(header.data(), header.size()));
+        ba::write(*server_socket, ba::buffer(payload.data(), payload.size()));
+        ba::write(*server_socket, ba::buffer(trailer.data(), trailer.size()));
+    });
+
+    auto header2 = std::vector<char>(header.size());
+    auto payload2 = std::vector<char>(payload.size());
+    auto trailer2 = std::vector<char>(trailer.size());
+    socketstream->read(header2.data(), header2.size());
+    socketstream->read(payload2.data(), payload2.size());
+    socketstream->read(trailer2.data(), trailer2.size());
+    thread.join();
+
+    ASSERT_EQ(header, header2);
+    ASSERT_EQ(payload, payload2);
+    ASSERT_EQ(trailer, trailer2);
+}
@@ -147,6 +147,7 @@ namespace Gadgetron { namespace Core {
         InputChannel& operator=(InputChannel&& other) noexcept = default;
 
         decltype(auto) pop() {
+            release_held();
             Message message = in.pop();
             while (!convertible_to<TYPELIST...>(message)) {
                 bypass.push_message(std::move(message));
@@ -156,6 +157,7 @@ namespace Gadgetron { namespace Core {
         }
 
         optional<decltype(force_unpack<TYPELIST...>(Message{}))> try_pop() {
+            release_held();
 
             optional<Message> message = in.try_pop();
 
@@ -170,9 +172,35 @@ namespace Gadgetron { namespace Core {
             return force_unpack<TYPELIST...>(std::move(*message));
         }
 
+        /***
+         * Nonblocking method returning the next message, if it is available and of the filtered types. Unlike
+         * try_pop, a message of any other type is not bypassed straight away, but held back until the next call to
+         * pop or try_pop, so it stays in order with the messages taken before it.
+         */
+        optional<decltype(force_unpack<TYPELIST...>(Message{}))> try_pop_next() {
+            if (held) return none;
+
+            optional<Message> message = in.try_pop();
+            if (!message) return none;
+
+            if (!convertible_to<TYPELIST...>(*message)) {
+                held = std::move(message);
+                return none;
+            }
+
+            return force_unpack<TYPELIST...>(std::move(*message));
+        }
+
     private:
+        void release_held() {
+            if (!held) return;
+            bypass.push_message(std::move(*held));
+            held = none;
+        }
+
         GenericInputChannel& in;
         OutputChannel& bypass;
+        optional<Message> held;
     };
 
 
@@ -6,6 +6,9 @@
 
 #include "Channel.h"
 
+#include <algorithm>
+#include <vector>
+
 namespace Gadgetron {
     namespace Core {
         namespace Algorithm {
@@ -60,6 +63,45 @@ namespace Gadgetron {
                 };
 
 
+                template<class CHANNEL, class PRED>
+                class BatchChannel : public ChannelRange<BatchChannel<CHANNEL,PRED>> {
+                public:
+                    using value_type = std::decay_t<decltype(std::declval<CHANNEL&>().pop())>;
+
+                    BatchChannel(CHANNEL &channel, size_t max_size, PRED pred)
+                        : channel{channel}, max_size{std::max<size_t>(max_size, 1)}, pred{std::move(pred)} {}
+
+                    auto pop() {
+                        std::vector<value_type> batch{};
+                        batch.reserve(max_size);
+
+                        if (pending) {
+                            batch.push_back(std::move(*pending));
+                            pending = none;
+                        } else {
+                            batch.push_back(channel.pop());
+                        }
+
+                        while (batch.size() < max_size) {
+                            auto message = channel.try_pop_next();
+                            if (!message) break;
+                            if (!pred(batch.front(), *message)) {
+                                pending = std::move(message);
+                                break;
+                            }
+                            batch.push_back(std::move(*message));
+                        }
+
+                        return batch;
+                    }
+
+                private:
+                    CHANNEL &channel;
+                    const size_t max_size;
+                    PRED pred;
+                    optional<value_type> pending;
+                };
+
                 template<class CHANNEL, class FUNCTION>
                 class TransformChannel : public ChannelRange<TransformChannel<CHANNEL,FUNCTION>> {
                 public:
@@ -109,6 +151,23 @@ namespace Gadgetron {
                 return channel_detail::BufferChannel<CHANNEL, PRED>(channel, pred);
             }
 
+            /**
+             * Takes a channel and produces a channel-view which gathers consecutive messages into batches of at most
+             * max_size messages. A batch holds the messages that are already waiting in the channel, so gathering
+             * never waits for more input, and ends at the first message for which pred(first, message) is false or
+             * which is not of the types of the channel. Messages keep their order.
+             * @tparam CHANNEL A type which supports .pop and .try_pop_next. Typically an InputChannel
+             * @tparam PRED
+             * @param channel
+             * @param max_size
+             * @param pred Whether a message can be batched together with the first message of the batch
+             * @return
+             */
+            template<class CHANNEL, class PRED>
+            auto batch(CHANNEL &channel, size_t max_size, PRED pred) {
+                return channel_detail::BatchChannel<CHANNEL, PRED>(channel, max_size, pred);
+            }
+
             /**
              * Produces a channel view, which lazily transforms the messages from the channel using the provided function.
              * @tparam CHANNEL
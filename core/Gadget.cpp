@@ -37,4 +37,8 @@ namespace Gadgetron {
         }
         gadget->close();
     }
+
+    size_t LegacyGadgetNode::thread_budget() const {
+        return gadget->thread_budget();
+    }
 }  // namespace Gadgetron
@@ -241,6 +241,13 @@ namespace Gadgetron {
             return 0;
         }
 
+        /**
+        *  The number of threads the Gadget wants for its parallel regions, or 0 for the default.
+        */
+        virtual size_t thread_budget() const {
+            return 0;
+        }
+
 
 
     protected:
@@ -620,6 +627,8 @@ namespace Gadgetron {
         void process(Core::GenericInputChannel& in,
                      Core::OutputChannel& out) override;
 
+        size_t thread_budget() const override;
+
     private:
 
         std::unique_ptr<Gadget> gadget;
@@ -10,6 +10,11 @@ namespace Gadgetron::Core {
     template <class T> class MPMCChannel {
     public:
         MPMCChannel() = default;
+
+        /**
+         * A channel holding at most capacity messages; push blocks while the channel is full.
+         */
+        explicit MPMCChannel(size_t capacity);
         MPMCChannel(MPMCChannel&&) noexcept;
         void push(T);
 
@@ -22,10 +27,13 @@ namespace Gadgetron::Core {
 
     private:
         T pop_impl(std::unique_lock<std::mutex> lock);
+        void wait_for_space(std::unique_lock<std::mutex>& lock);
         std::list<T> queue;
+        size_t capacity = 0;
         bool is_closed = false;
         std::mutex m;
         std::condition_variable cv;
+        std::condition_variable space_cv;
     };
 
     class ChannelClosed : public std::runtime_error {
@@ -35,6 +43,12 @@ namespace Gadgetron::Core {
 
     /** Implementation **/
 
+    template <class T> MPMCChannel<T>::MPMCChannel(size_t capacity) : capacity(capacity) {}
+
+    template <class T> void MPMCChannel<T>::wait_for_space(std::unique_lock<std::mutex>& lock) {
+        space_cv.wait(lock, [this]() { return !capacity || queue.size() < capacity || is_closed; });
+    }
+
     template <class T> T MPMCChannel<T>::pop_impl(std::unique_lock<std::mutex> lock) {
         cv.wait(lock, [this]() { return !this->queue.empty() || is_closed; });
         if (queue.empty()) {
@@ -42,6 +56,10 @@ namespace Gadgetron::Core {
         }
         T message = std::move(queue.front());
         queue.pop_front();
+        if (capacity) {
+            lock.unlock();
+            space_cv.notify_one();
+        }
         return message;
     }
 
@@ -60,7 +78,8 @@ namespace Gadgetron::Core {
 
     template <class T> void MPMCChannel<T>::push(T message) {
         {
-            std::lock_guard<std::mutex> lock(m);
+            std::unique_lock<std::mutex> lock(m);
+            wait_for_space(lock);
             if (is_closed)
                 throw ChannelClosed();
             queue.emplace_back(std::move(message));
@@ -74,11 +93,13 @@ namespace Gadgetron::Core {
             is_closed = true;
         }
         cv.notify_all();
+        space_cv.notify_all();
     }
 
     template <class T> template <class... ARGS> void MPMCChannel<T>::emplace(ARGS&&... args) {
         {
-            std::lock_guard<std::mutex> guard(m);
+            std::unique_lock<std::mutex> lock(m);
+            wait_for_space(lock);
             queue.emplace_back(std::forward<ARGS>(args)...);
         }
         cv.notify_one();
@@ -86,6 +107,7 @@ namespace Gadgetron::Core {
     template <class T> MPMCChannel<T>::MPMCChannel(MPMCChannel&& other) noexcept {
         std::lock_guard<std::mutex> guard(other.m);
         this->queue = std::move(other.queue);
+        this->capacity = other.capacity;
         this->is_closed = other.is_closed;
         other.is_closed = true;
     }
@@ -20,6 +20,12 @@ namespace Gadgetron::Core {
          * @param out Channel in which messages are sent on downstream
          */
         virtual void process(GenericInputChannel& in, OutputChannel& out) = 0;
+
+        /**
+         * The number of threads the Node wants for its parallel regions, or 0 for the default. A thread count
+         * configured for the Node in the stream configuration takes precedence.
+         */
+        virtual size_t thread_budget() const { return 0; }
     };
 
     class GenericChannelGadget : public Node, public PropertyMixin {
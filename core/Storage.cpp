@@ -1,6 +1,10 @@
 #include "StorageSetup.h"
 
 #include <iterator>
+#include <mutex>
+#include <vector>
+
+#include <boost/process/environment.hpp>
 
 #include <curl/curl.h>
 #include <date/date.h>
@@ -34,16 +38,72 @@ size_t content_read_callback(char* dest, size_t size, size_t nmemb, std::istream
 
 template <typename T> using CurlHandle = std::unique_ptr<T, std::function<void(T*)>>;
 
-CurlHandle<CURL> create_curl_handle() {
-    CurlHandle<CURL> handle(curl_easy_init(), curl_easy_cleanup);
-    if (!handle) {
-        throw std::runtime_error("unable to create CURL instance");
+void configure_curl_handle(CURL* handle) {
+    curl_easy_setopt(handle, CURLOPT_NOPROGRESS, 1L);
+    curl_easy_setopt(handle, CURLOPT_MAXREDIRS, 50L);
+    curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1L);
+}
+
+// Idle handles keep their connections to the storage server open, so they are reused rather than cleaned up.
+// Connections are not shared with forked processes; handles created before a fork are left alone.
+class CurlHandlePool {
+  public:
+    CURL* acquire() {
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            discard_if_forked();
+            if (!idle.empty()) {
+                auto handle = idle.back();
+                idle.pop_back();
+                return handle;
+            }
+        }
+
+        auto handle = curl_easy_init();
+        if (!handle) {
+            throw std::runtime_error("unable to create CURL instance");
+        }
+        return handle;
     }
 
-    curl_easy_setopt(handle.get(), CURLOPT_NOPROGRESS, 1L);
-    curl_easy_setopt(handle.get(), CURLOPT_MAXREDIRS, 50L);
-    curl_easy_setopt(handle.get(), CURLOPT_TCP_KEEPALIVE, 1L);
+    void release(CURL* handle) {
+        std::lock_guard<std::mutex> guard(mutex);
+        discard_if_forked();
+        if (idle.size() >= max_idle_handles) {
+            curl_easy_cleanup(handle);
+            return;
+        }
 
+        // Resets options, but keeps the connection cache.
+        curl_easy_reset(handle);
+        idle.push_back(handle);
+    }
+
+    ~CurlHandlePool() {
+        for (auto handle : idle)
+            curl_easy_cleanup(handle);
+    }
+
+  private:
+    void discard_if_forked() {
+        auto pid = boost::this_process::get_id();
+        if (pid == owner) return;
+        idle.clear();
+        owner = pid;
+    }
+
+    static constexpr size_t max_idle_handles = 8;
+
+    std::mutex mutex;
+    std::vector<CURL*> idle;
+    decltype(boost::this_process::get_id()) owner = boost::this_process::get_id();
+};
+
+static CurlHandlePool curl_handle_pool;
+
+CurlHandle<CURL> create_curl_handle() {
+    CurlHandle<CURL> handle(curl_handle_pool.acquire(), [](CURL* handle) { curl_handle_pool.release(handle); });
+    configure_curl_handle(handle.get());
     return handle;
 }
 
@@ -0,0 +1,463 @@
+#include "StorageClients.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <unordered_set>
+
+#include <pthread.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/iostreams/stream.hpp>
+#include <boost/process/environment.hpp>
+#include <nlohmann/json.hpp>
+
+#include "log.h"
+
+using json = nlohmann::json;
+using namespace Gadgetron::Storage;
+
+namespace {
+
+// Stream over data shared with the cache, so cached items are not copied when read.
+class SharedStringStream : public boost::iostreams::stream<boost::iostreams::array_source> {
+  public:
+    explicit SharedStringStream(std::shared_ptr<const std::string> data)
+        : boost::iostreams::stream<boost::iostreams::array_source>(data->data(), data->size()), data(std::move(data)) {
+    }
+
+  private:
+    std::shared_ptr<const std::string> data;
+};
+
+std::shared_ptr<const std::string> read_all(std::istream& stream) {
+    return std::make_shared<const std::string>(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+}
+
+long current_process() { return long(boost::this_process::get_id()); }
+
+// Length prefixed fields, so that no two sets of tags share a key.
+std::string tags_key(StorageItemTags const& tags) {
+    std::stringstream ss;
+    auto add = [&](std::string const& field) { ss << field.size() << ':' << field; };
+    auto add_optional = [&](std::optional<std::string> const& field) {
+        ss << (field ? '+' : '-');
+        if (field) add(*field);
+    };
+
+    add(tags.subject);
+    add_optional(tags.device);
+    add_optional(tags.session);
+    add_optional(tags.name);
+    for (auto const& tag : tags.custom_tags) {
+        add(tag.first);
+        add(tag.second);
+    }
+    return ss.str();
+}
+
+int64_t to_nanoseconds(std::chrono::time_point<std::chrono::system_clock> time) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+
+std::chrono::time_point<std::chrono::system_clock> from_nanoseconds(int64_t nanoseconds) {
+    return std::chrono::time_point<std::chrono::system_clock>(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(nanoseconds)));
+}
+
+json tags_to_json(StorageItemTags const& tags) {
+    json j;
+    j["subject"] = tags.subject;
+    if (tags.device) j["device"] = *tags.device;
+    if (tags.session) j["session"] = *tags.session;
+    if (tags.name) j["name"] = *tags.name;
+
+    json custom = json::array();
+    for (auto const& tag : tags.custom_tags) custom.push_back({tag.first, tag.second});
+    j["custom"] = custom;
+    return j;
+}
+
+StorageItemTags tags_from_json(json const& j) {
+    StorageItemTags::Builder builder(j["subject"].get<std::string>());
+    if (j.contains("device")) builder.with_device(j["device"].get<std::string>());
+    if (j.contains("session")) builder.with_session(j["session"].get<std::string>());
+    if (j.contains("name")) builder.with_name(j["name"].get<std::string>());
+    for (auto const& tag : j["custom"]) builder.with_custom_tag(tag[0].get<std::string>(), tag[1].get<std::string>());
+    return builder.build();
+}
+
+const std::string file_scheme = "file://";
+
+} // namespace
+
+namespace Gadgetron::Storage {
+
+bool tags_match(StorageItemTags const& query, StorageItemTags const& item) {
+    auto optional_matches = [](auto const& q, auto const& i) { return !q || q == i; };
+
+    if (query.subject != item.subject) return false;
+    if (!optional_matches(query.device, item.device)) return false;
+    if (!optional_matches(query.session, item.session)) return false;
+    if (!optional_matches(query.name, item.name)) return false;
+
+    return std::all_of(query.custom_tags.begin(), query.custom_tags.end(), [&](auto const& tag) {
+        auto [first, last] = item.custom_tags.equal_range(tag.first);
+        return std::any_of(first, last, [&](auto const& candidate) { return candidate.second == tag.second; });
+    });
+}
+
+std::shared_ptr<StorageClient> make_storage_client(std::string const& address) {
+    if (address.compare(0, file_scheme.size(), file_scheme) == 0) {
+        return std::make_shared<FileStorageClient>(address.substr(file_scheme.size()));
+    }
+    return std::make_shared<StorageClient>(address);
+}
+
+// ------------------------------------------------------------------------------------------------------------------
+
+FileStorageClient::FileStorageClient(boost::filesystem::path directory)
+    : StorageClient(file_scheme + directory.string()), directory(std::move(directory)) {
+    boost::filesystem::create_directories(this->directory);
+}
+
+std::vector<StorageItem> FileStorageClient::matching_items(StorageItemTags const& tags) {
+    std::lock_guard<std::mutex> guard(directory_mutex);
+
+    auto now = std::chrono::system_clock::now();
+    std::vector<StorageItem> items;
+    for (auto const& entry : boost::filesystem::directory_iterator(directory)) {
+        if (entry.path().extension() != ".json") continue;
+
+        std::ifstream file(entry.path().string());
+        auto j = json::parse(file);
+
+        StorageItem item;
+        item.tags = tags_from_json(j["tags"]);
+        item.location = file_scheme + boost::filesystem::path(entry.path()).replace_extension(".bin").string();
+        item.contentType = "application/octet-stream";
+        item.lastModified = from_nanoseconds(j["lastModified"].get<int64_t>());
+        if (j.contains("expires")) item.expires = from_nanoseconds(j["expires"].get<int64_t>());
+
+        if (item.expires && *item.expires < now) continue;
+        if (tags_match(tags, item.tags)) items.push_back(std::move(item));
+    }
+
+    std::sort(items.begin(), items.end(), [](auto const& a, auto const& b) {
+        return std::tie(a.lastModified, a.location) > std::tie(b.lastModified, b.location);
+    });
+    return items;
+}
+
+StorageItemList FileStorageClient::list_items(StorageItemTags const& tags, size_t limit) {
+    json continuation;
+    continuation["tags"] = tags_to_json(tags);
+    continuation["offset"] = 0;
+    continuation["limit"] = limit;
+
+    StorageItemList page{{}, false, continuation.dump()};
+    return get_next_page_of_items(page);
+}
+
+StorageItemList FileStorageClient::get_next_page_of_items(StorageItemList const& page) {
+    if (page.complete || page.continuation.empty()) {
+        return StorageItemList{.complete = true};
+    }
+
+    auto continuation = json::parse(page.continuation);
+    auto offset = continuation["offset"].get<size_t>();
+    auto limit = continuation["limit"].get<size_t>();
+
+    auto items = matching_items(tags_from_json(continuation["tags"]));
+
+    StorageItemList list;
+    auto first = std::min(offset, items.size());
+    auto last = std::min(offset + limit, items.size());
+    list.items.assign(items.begin() + first, items.begin() + last);
+    list.complete = last == items.size();
+    if (!list.complete) {
+        continuation["offset"] = last;
+        list.continuation = continuation.dump();
+    }
+    return list;
+}
+
+std::shared_ptr<std::istream> FileStorageClient::get_latest_item(StorageItemTags const& tags) {
+    auto items = matching_items(tags);
+    if (items.empty()) return {};
+    return get_item_by_url(items.front().location);
+}
+
+std::shared_ptr<std::istream> FileStorageClient::get_item_by_url(std::string const& url) {
+    auto path = url.compare(0, file_scheme.size(), file_scheme) == 0 ? url.substr(file_scheme.size()) : url;
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return {};
+
+    auto data = std::make_shared<std::stringstream>();
+    *data << file.rdbuf();
+    return data;
+}
+
+StorageItem FileStorageClient::store_item(StorageItemTags const& tags, std::istream& data,
+                                          std::optional<std::chrono::seconds> time_to_live) {
+    std::lock_guard<std::mutex> guard(directory_mutex);
+
+    StorageItem item;
+    item.tags = tags;
+    item.contentType = "application/octet-stream";
+    item.lastModified = std::chrono::system_clock::now();
+    if (time_to_live) item.expires = item.lastModified + *time_to_live;
+
+    auto stem = std::to_string(to_nanoseconds(item.lastModified)) + "-" + std::to_string(current_process()) + "-" +
+                std::to_string(sequence++);
+    auto data_path = directory / (stem + ".bin");
+    item.location = file_scheme + data_path.string();
+
+    {
+        std::ofstream file(data_path.string(), std::ios::binary);
+        file << data.rdbuf();
+        if (!file) throw std::runtime_error("Failed to store item in " + data_path.string());
+    }
+
+    // The metadata is written last, so that items are only found once their data is complete.
+    json j;
+    j["tags"] = tags_to_json(tags);
+    j["lastModified"] = to_nanoseconds(item.lastModified);
+    if (item.expires) j["expires"] = to_nanoseconds(*item.expires);
+
+    std::ofstream file((directory / (stem + ".json")).string());
+    file << j.dump();
+    return item;
+}
+
+std::optional<std::string> FileStorageClient::health_check() {
+    if (boost::filesystem::is_directory(directory)) return std::nullopt;
+    return "Storage directory " + directory.string() + " does not exist";
+}
+
+// ------------------------------------------------------------------------------------------------------------------
+
+namespace {
+// Clients with a writer thread, which are flushed whenever the process forks.
+std::mutex live_clients_mutex;
+std::unordered_set<AsyncStorageClient*> live_clients;
+std::once_flag fork_handlers_registered;
+} // namespace
+
+AsyncStorageClient::AsyncStorageClient(std::shared_ptr<StorageClient> backend, size_t cache_bytes,
+                                       size_t max_pending_writes)
+    : StorageClient(""), backend(std::move(backend)), cache_bytes(cache_bytes),
+      max_pending_writes(std::max<size_t>(max_pending_writes, 1)),
+      writer(std::make_unique<std::thread>(&AsyncStorageClient::write_behind, this)) {
+
+    std::call_once(fork_handlers_registered, []() {
+        pthread_atfork(&AsyncStorageClient::before_fork, &AsyncStorageClient::after_fork_in_parent,
+                       &AsyncStorageClient::after_fork_in_child);
+    });
+
+    std::lock_guard<std::mutex> guard(live_clients_mutex);
+    live_clients.insert(this);
+}
+
+AsyncStorageClient::~AsyncStorageClient() {
+    {
+        std::lock_guard<std::mutex> guard(live_clients_mutex);
+        live_clients.erase(this);
+    }
+
+    // In a forked process, items are stored directly, and there is no writer to stop.
+    if (!writer) return;
+
+    {
+        std::lock_guard<std::mutex> guard(write_mutex);
+        closed = true;
+    }
+    write_cv.notify_all();
+    writer->join();
+}
+
+// Pending writes are completed before forking, so that the forked process reads them. The locks are held across
+// fork, so that no other thread leaves them locked in the forked process.
+void AsyncStorageClient::before_fork() {
+    live_clients_mutex.lock();
+    for (auto client : live_clients) {
+        std::unique_lock<std::mutex> lock(client->write_mutex);
+        client->write_cv.wait(lock, [&]() { return client->pending.empty(); });
+        lock.release();
+        client->cache_mutex.lock();
+    }
+}
+
+void AsyncStorageClient::after_fork_in_parent() {
+    for (auto client : live_clients) {
+        client->cache_mutex.unlock();
+        client->write_mutex.unlock();
+    }
+    live_clients_mutex.unlock();
+}
+
+// The writer thread is not forked; its handle is released rather than detached, and the forked process stores items
+// directly.
+void AsyncStorageClient::after_fork_in_child() {
+    for (auto client : live_clients) {
+        client->writer.release();
+        client->cache_mutex.unlock();
+        client->write_mutex.unlock();
+    }
+    live_clients.clear();
+    live_clients_mutex.unlock();
+}
+
+void AsyncStorageClient::write_behind() {
+    std::unique_lock<std::mutex> lock(write_mutex);
+    while (true) {
+        write_cv.wait(lock, [&]() { return closed || !pending.empty(); });
+        if (pending.empty()) return;
+
+        // The write stays pending until it is stored, so that flush and reads affected by it wait for it.
+        auto write = pending.front();
+        lock.unlock();
+
+        try {
+            SharedStringStream stream(write.data);
+            backend->store_item(write.tags, stream, write.time_to_live);
+        } catch (std::exception const& e) {
+            GERROR_STREAM("Failed to store item " << write.tags.name.value_or("") << ": " << e.what());
+        }
+
+        lock.lock();
+        pending.pop_front();
+        write_cv.notify_all();
+    }
+}
+
+void AsyncStorageClient::flush() {
+    std::unique_lock<std::mutex> lock(write_mutex);
+    write_cv.wait(lock, [&]() { return pending.empty(); });
+}
+
+StorageItemList AsyncStorageClient::list_items(StorageItemTags const& tags, size_t limit) {
+    flush();
+    return backend->list_items(tags, limit);
+}
+
+StorageItemList AsyncStorageClient::get_next_page_of_items(StorageItemList const& page) {
+    return backend->get_next_page_of_items(page);
+}
+
+std::shared_ptr<std::istream> AsyncStorageClient::get_latest_item(StorageItemTags const& tags) {
+    auto key = tags_key(tags);
+    if (auto data = cached(key)) return std::make_shared<SharedStringStream>(data);
+
+    bool affected_by_pending_write;
+    {
+        std::lock_guard<std::mutex> guard(write_mutex);
+        affected_by_pending_write = std::any_of(pending.begin(), pending.end(),
+                                                [&](auto const& write) { return tags_match(tags, write.tags); });
+    }
+    if (affected_by_pending_write) flush();
+
+    size_t read_generation;
+    {
+        std::lock_guard<std::mutex> guard(cache_mutex);
+        read_generation = generation;
+    }
+
+    auto stream = backend->get_latest_item(tags);
+    if (!stream) return stream;
+
+    auto data = read_all(*stream);
+    {
+        // Items stored while reading may have replaced the item read.
+        std::lock_guard<std::mutex> guard(cache_mutex);
+        if (read_generation != generation) return std::make_shared<SharedStringStream>(data);
+    }
+    cache(tags, data);
+    return std::make_shared<SharedStringStream>(data);
+}
+
+std::shared_ptr<std::istream> AsyncStorageClient::get_item_by_url(std::string const& url) {
+    flush();
+    return backend->get_item_by_url(url);
+}
+
+StorageItem AsyncStorageClient::store_item(StorageItemTags const& tags, std::istream& data,
+                                           std::optional<std::chrono::seconds> time_to_live) {
+    auto content = read_all(data);
+
+    invalidate(tags);
+    cache(tags, content);
+
+    if (!writer) {
+        SharedStringStream stream(content);
+        return backend->store_item(tags, stream, time_to_live);
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(write_mutex);
+        write_cv.wait(lock, [&]() { return pending.size() < max_pending_writes; });
+        pending.push_back(PendingWrite{tags, content, time_to_live});
+    }
+    write_cv.notify_all();
+
+    // The server assigns the location once the item is stored.
+    StorageItem item;
+    item.tags = tags;
+    item.lastModified = std::chrono::system_clock::now();
+    if (time_to_live) item.expires = item.lastModified + *time_to_live;
+    return item;
+}
+
+std::optional<std::string> AsyncStorageClient::health_check() { return backend->health_check(); }
+
+std::shared_ptr<const std::string> AsyncStorageClient::cached(std::string const& key) {
+    std::lock_guard<std::mutex> guard(cache_mutex);
+    auto entry = entries.find(key);
+    if (entry == entries.end()) return {};
+
+    lru.splice(lru.begin(), lru, entry->second);
+    return entry->second->data;
+}
+
+void AsyncStorageClient::cache(StorageItemTags const& tags, std::shared_ptr<const std::string> data) {
+    if (data->size() > cache_bytes) return;
+
+    auto key = tags_key(tags);
+    std::lock_guard<std::mutex> guard(cache_mutex);
+
+    auto existing = entries.find(key);
+    if (existing != entries.end()) {
+        cached_bytes -= existing->second->data->size();
+        lru.erase(existing->second);
+        entries.erase(existing);
+    }
+
+    cached_bytes += data->size();
+    lru.push_front(CacheEntry{key, tags, std::move(data)});
+    entries[key] = lru.begin();
+
+    while (cached_bytes > cache_bytes) {
+        cached_bytes -= lru.back().data->size();
+        entries.erase(lru.back().key);
+        lru.pop_back();
+    }
+}
+
+void AsyncStorageClient::invalidate(StorageItemTags const& stored_tags) {
+    std::lock_guard<std::mutex> guard(cache_mutex);
+    generation++;
+
+    for (auto entry = lru.begin(); entry != lru.end();) {
+        if (tags_match(entry->tags, stored_tags)) {
+            cached_bytes -= entry->data->size();
+            entries.erase(entry->key);
+            entry = lru.erase(entry);
+        } else {
+            ++entry;
+        }
+    }
+}
+
+} // namespace Gadgetron::Storage
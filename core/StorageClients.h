@@ -0,0 +1,135 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include <boost/filesystem/path.hpp>
+
+#include "StorageSetup.h"
+
+namespace Gadgetron::Storage {
+
+/**
+ * Whether an item with the given tags is among the items matched by a query. Tags not specified in the query match
+ * any value.
+ */
+bool tags_match(StorageItemTags const& query, StorageItemTags const& item);
+
+/**
+ * Makes a client for the storage server at the address. Addresses of the form file://<directory> give a
+ * FileStorageClient, which stands in for the storage server when testing.
+ */
+std::shared_ptr<StorageClient> make_storage_client(std::string const& address);
+
+/**
+ * Stores items in a local directory, standing in for the storage server when testing.
+ *
+ * Every item is kept as a data file, next to a json file holding its tags. Queries scan the directory, so this is
+ * not meant for large numbers of items.
+ */
+class FileStorageClient : public StorageClient {
+  public:
+    explicit FileStorageClient(boost::filesystem::path directory);
+
+    StorageItemList list_items(StorageItemTags const& tags, size_t limit = 20) override;
+
+    StorageItemList get_next_page_of_items(StorageItemList const& page) override;
+
+    std::shared_ptr<std::istream> get_latest_item(StorageItemTags const& tags) override;
+
+    std::shared_ptr<std::istream> get_item_by_url(std::string const& url) override;
+
+    StorageItem store_item(StorageItemTags const& tags, std::istream& data,
+                           std::optional<std::chrono::seconds> time_to_live = {}) override;
+
+    std::optional<std::string> health_check() override;
+
+  private:
+    std::vector<StorageItem> matching_items(StorageItemTags const& tags);
+
+    const boost::filesystem::path directory;
+    std::mutex directory_mutex;
+    size_t sequence = 0;
+};
+
+/**
+ * Keeps storage latency off the reconstruction path.
+ *
+ * Items are stored by a background thread, in the order they were stored in. Until then, store_item only copies the
+ * data. Items read with get_latest_item, and items stored, are kept in an LRU cache bounded in bytes, so repeated
+ * reads of the same item, e.g. the noise covariance read by several gadgets, only reach the server once. Pending
+ * writes are completed before the client is destroyed, and before any read they could affect.
+ *
+ * Pending writes are also completed before the process forks, so a forked process reads them. The forked process
+ * has no background thread; the client stores items directly there.
+ */
+class AsyncStorageClient : public StorageClient {
+  public:
+    explicit AsyncStorageClient(std::shared_ptr<StorageClient> backend, size_t cache_bytes = 64 << 20,
+                                size_t max_pending_writes = 64);
+
+    ~AsyncStorageClient() override;
+
+    StorageItemList list_items(StorageItemTags const& tags, size_t limit = 20) override;
+
+    StorageItemList get_next_page_of_items(StorageItemList const& page) override;
+
+    std::shared_ptr<std::istream> get_latest_item(StorageItemTags const& tags) override;
+
+    std::shared_ptr<std::istream> get_item_by_url(std::string const& url) override;
+
+    StorageItem store_item(StorageItemTags const& tags, std::istream& data,
+                           std::optional<std::chrono::seconds> time_to_live = {}) override;
+
+    std::optional<std::string> health_check() override;
+
+    /**
+     * Blocks until all pending items have been stored.
+     */
+    void flush();
+
+  private:
+    struct PendingWrite {
+        StorageItemTags tags;
+        std::shared_ptr<const std::string> data;
+        std::optional<std::chrono::seconds> time_to_live;
+    };
+
+    struct CacheEntry {
+        std::string key;
+        StorageItemTags tags;
+        std::shared_ptr<const std::string> data;
+    };
+
+    void write_behind();
+
+    static void before_fork();
+    static void after_fork_in_parent();
+    static void after_fork_in_child();
+
+    std::shared_ptr<const std::string> cached(std::string const& key);
+    void cache(StorageItemTags const& tags, std::shared_ptr<const std::string> data);
+    void invalidate(StorageItemTags const& stored_tags);
+
+    const std::shared_ptr<StorageClient> backend;
+    const size_t cache_bytes;
+    const size_t max_pending_writes;
+
+    std::mutex write_mutex;
+    std::condition_variable write_cv;
+    std::deque<PendingWrite> pending;
+    bool closed = false;
+
+    std::mutex cache_mutex;
+    std::list<CacheEntry> lru;
+    std::unordered_map<std::string, std::list<CacheEntry>::iterator> entries;
+    size_t cached_bytes = 0;
+    size_t generation = 0;
+
+    std::unique_ptr<std::thread> writer;
+};
+} // namespace Gadgetron::Storage
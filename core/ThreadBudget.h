@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+
+#ifdef USE_OMP
+#include <omp.h>
+#endif
+
+namespace Gadgetron::Core {
+
+    /**
+     * Limits the number of threads of the OpenMP parallel regions run by the calling thread, for as long as the
+     * budget is in scope. Every node of a stream runs on a thread of its own, so a budget applied by the runtime on
+     * that thread only affects the node, and not other nodes or concurrent connections.
+     *
+     * A budget of 0 leaves the number of threads at the OpenMP default.
+     */
+    class ThreadBudget {
+    public:
+        explicit ThreadBudget(size_t threads) : threads(threads), previous_budget(budget()) {
+#ifdef USE_OMP
+            previous_threads = omp_get_max_threads();
+            if (threads > 0) omp_set_num_threads(int(threads));
+#endif
+            budget() = threads;
+        }
+
+        ~ThreadBudget() {
+#ifdef USE_OMP
+            omp_set_num_threads(previous_threads);
+#endif
+            budget() = previous_budget;
+        }
+
+        ThreadBudget(const ThreadBudget &) = delete;
+        ThreadBudget &operator=(const ThreadBudget &) = delete;
+
+        /**
+         * The budget of the calling thread, 0 if none has been applied.
+         */
+        static size_t current() { return budget(); }
+
+        /**
+         * The number of threads a parallel region started from the calling thread actually runs with.
+         */
+        static size_t measure() {
+            size_t team_size = 1;
+#ifdef USE_OMP
+#pragma omp parallel
+            {
+#pragma omp single
+                team_size = size_t(omp_get_num_threads());
+            }
+#endif
+            return team_size;
+        }
+
+        const size_t threads;
+
+    private:
+        static size_t &budget() {
+            thread_local size_t current_budget = 0;
+            return current_budget;
+        }
+
+        const size_t previous_budget;
+#ifdef USE_OMP
+        int previous_threads;
+#endif
+    };
+}
@@ -17,6 +17,11 @@ namespace Gadgetron::Core {
         virtual bool accepts(const Message &) = 0;
 
         virtual void write(std::ostream &stream, Message message) = 0;
+
+        /**
+         * Writers keeping no state between messages may write several messages at once, from different threads.
+         */
+        virtual bool stateless() const { return false; }
     };
 
 
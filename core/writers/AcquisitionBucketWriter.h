@@ -9,6 +9,9 @@
 namespace Gadgetron::Core::Writers {
 
     class AcquisitionBucketWriter : public TypedWriter<AcquisitionBucket> {
+    public:
+        bool stateless() const override { return true; }
+
     protected:
         void serialize(std::ostream& stream, const AcquisitionBucket& args) override;
     };
@@ -11,6 +11,9 @@ namespace Gadgetron::Core::Writers {
 
     class AcquisitionWriter :
             public TypedWriter<ISMRMRD::AcquisitionHeader, hoNDArray<std::complex<float>>, optional<hoNDArray<float>>> {
+    public:
+        bool stateless() const override { return true; }
+
     protected:
         void serialize(
                 std::ostream &stream,
@@ -7,6 +7,7 @@ namespace Gadgetron::Core::Writers {
 
 class BufferWriter : public TypedWriter<IsmrmrdReconData> {
 public:
+    bool stateless() const override { return true; }
     void serialize(std::ostream &stream, const IsmrmrdReconData & args) override;
 };
 }
@@ -10,6 +10,7 @@ namespace Gadgetron::Core::Writers {
     public:
         bool accepts(const Message &) override;
         void write(std::ostream &stream, Message message) override;
+        bool stateless() const override { return true; }
     };
 }
 
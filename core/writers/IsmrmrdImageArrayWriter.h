@@ -5,6 +5,9 @@
 
 namespace Gadgetron::Core::Writers {
     class IsmrmrdImageArrayWriter : public TypedWriter<IsmrmrdImageArray> {
+    public:
+        bool stateless() const override { return true; }
+
     protected:
         void serialize(std::ostream& stream, const IsmrmrdImageArray& args) override;
     };
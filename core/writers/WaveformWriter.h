@@ -11,6 +11,9 @@ namespace Gadgetron::Core::Writers {
 
     class WaveformWriter
             : public Core::TypedWriter<ISMRMRD::WaveformHeader, hoNDArray<uint32_t>> {
+    public:
+        bool stateless() const override { return true; }
+
     protected:
         void serialize(
                 std::ostream &stream,
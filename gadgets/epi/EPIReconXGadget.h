@@ -20,6 +20,8 @@ namespace Gadgetron{
     public:
       EPIReconXGadget();
       virtual ~EPIReconXGadget();
+
+      virtual size_t thread_budget() const { return 1; }
       
     protected:
       GADGET_PROPERTY(verboseMode, bool, "Verbose output", false);
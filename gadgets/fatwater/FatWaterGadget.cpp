@@ -56,6 +56,14 @@ namespace Gadgetron {
         config.do_gradient_descent = do_gradient_descent;
         config.downsamples = downsample_data;
 
+        if (graph_cut_solver.value() == "boykov_kolmogorov") {
+            config.graph_cut_solver = FatWater::GraphCutSolver::boykov_kolmogorov;
+        } else if (graph_cut_solver.value() == "grid") {
+            config.graph_cut_solver = FatWater::GraphCutSolver::grid;
+        } else {
+            config.graph_cut_solver = FatWater::GraphCutSolver::grid_parallel;
+        }
+
 
         return GADGET_OK;
     }
@@ -32,6 +32,8 @@ namespace Gadgetron{
       GADGET_PROPERTY(save_field_map , bool, "Save the field map",false);
       GADGET_PROPERTY(save_r2star_map, bool, "Save the R2* map",false);
       GADGET_PROPERTY(sample_time_us, float, "Sample time in microseconds for frequency offset correction. Set to 0 for disabled",0);
+      GADGET_PROPERTY_LIMITS(graph_cut_solver, std::string, "Max-flow solver for the field map graph-cut", "grid_parallel",
+                             GadgetPropertyLimitsEnumeration, "boykov_kolmogorov", "grid", "grid_parallel");
 
 
 	
@@ -5,7 +5,7 @@ namespace Gadgetron::Grappa::CPU {
     const hoNDArray<std::complex<float>> &WeightsCore::estimate_coil_map(const hoNDArray<std::complex<float>> &data) {
 
         hoNDFFT<float>::instance()->ifft2c(data, buffers.image);
-        Gadgetron::coil_map_2d_Inati(buffers.image, buffers.coil_map, coil_map_params.ks, coil_map_params.power);
+        Gadgetron::coil_map_2d_Inati_fast(buffers.image, buffers.coil_map, coil_map_params.ks, coil_map_params.power);
 
         return buffers.coil_map;
     }
@@ -1,6 +1,7 @@
 
 #include "DenoiseGadget.h"
 #include "GadgetronTimer.h"
+#include "hoNDArray_utils.h"
 #include "non_local_bayes.h"
 #include "non_local_means.h"
 
@@ -12,6 +13,8 @@ namespace Gadgetron {
             return Denoise::non_local_bayes(input, image_std, search_radius);
         } else if (denoiser == "non_local_means") {
             return Denoise::non_local_means(input, image_std, search_radius);
+        } else if (denoiser == "non_local_means_3d") {
+            return Denoise::non_local_means_3d(input, image_std, search_radius, temporal_search_radius);
         } else {
             throw std::invalid_argument(std::string("DenoiseGadget: Unknown denoiser type: ") + std::string(denoiser));
         }
@@ -29,6 +32,16 @@ namespace Gadgetron {
 
     IsmrmrdImageArray DenoiseGadget::denoise(IsmrmrdImageArray image_array) const {
         auto& input = image_array.data_;
+
+        // For 2D cine, denoise over [X, Y, N] rather than [X, Y, Z]
+        if (denoiser == "non_local_means_3d" && input.get_size(2) == 1 && input.get_number_of_dimensions() > 4) {
+            std::vector<size_t> order = { 0, 1, 4, 3, 2 };
+            for (size_t d = 5; d < input.get_number_of_dimensions(); d++)
+                order.push_back(d);
+            input = permute(denoise_function(permute(input, order)), order);
+            return std::move(image_array);
+        }
+
         input       = denoise_function(input);
         return std::move(image_array);
     }
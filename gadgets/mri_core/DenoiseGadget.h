@@ -27,7 +27,8 @@ namespace Gadgetron {
         DenoiseSupportedTypes process_function(DenoiseSupportedTypes input) const;
         NODE_PROPERTY(image_std, float, "Standard deviation of the noise in the produced image", 1);
         NODE_PROPERTY(search_radius, int, "Standard deviation of the noise in the produced image", 25);
-        NODE_PROPERTY(denoiser, std::string, "Type of denoiser - non_local_means or non_local_bayes", "non_local_bayes");
+        NODE_PROPERTY(temporal_search_radius, int, "Search radius along the third dimension, used by non_local_means_3d", 2);
+        NODE_PROPERTY(denoiser, std::string, "Type of denoiser - non_local_means, non_local_means_3d or non_local_bayes", "non_local_bayes");
 
     protected:
         template <class T>
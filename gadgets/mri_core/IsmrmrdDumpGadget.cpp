@@ -1,6 +1,7 @@
 #include "IsmrmrdDumpGadget.h"
 #include "network_utils.h"
 #include <boost/filesystem.hpp>
+#include <algorithm>
 #include <iomanip>
 #include <thread>
 #include <fstream>
@@ -158,21 +159,36 @@ std::string IsmrmrdDumpGadget::create_ismrmrd_dataset_name() const {
     return ismrmrd_filename;
 }
 
-static void append_to_dataset(const Core::Acquisition& acq, ISMRMRD::Dataset& dataset) {
-    const auto& [acq_head, data, traj] = acq;
-    ISMRMRD::Acquisition ismrmrd_acq;
-    ismrmrd_acq.setHead(acq_head);
-    ismrmrd_acq.setData(const_cast<std::complex<float>*>(data.data()));
-    if (traj)
-        ismrmrd_acq.setTraj(const_cast<float*>(traj->data()));
-    dataset.appendAcquisition(ismrmrd_acq);
-}
-static void append_to_dataset(const Core::Waveform& acq, ISMRMRD::Dataset& dataset) {
-    const auto& [wav_head, data] = acq;
-    ISMRMRD::Waveform ismrmrd_wav(wav_head.number_of_samples, wav_head.channels);
-    ismrmrd_wav.head = wav_head;
-    std::copy(data.begin(), data.end(), ismrmrd_wav.data);
-    dataset.appendWaveform(ismrmrd_wav);
+namespace {
+    // Reuses the ISMRMRD buffers between items, as most items in a dump have the same size.
+    class DatasetAppender {
+    public:
+        explicit DatasetAppender(ISMRMRD::Dataset& dataset) : dataset(dataset) {}
+
+        void operator()(const Core::Acquisition& acq) {
+            const auto& [acq_head, data, traj] = acq;
+            acquisition.setHead(acq_head);
+            std::copy(data.begin(), data.end(), acquisition.getDataPtr());
+            if (traj)
+                std::copy(traj->begin(), traj->end(), acquisition.getTrajPtr());
+            dataset.appendAcquisition(acquisition);
+        }
+
+        void operator()(const Core::Waveform& wav) {
+            const auto& [wav_head, data] = wav;
+            if (waveform.head.number_of_samples != wav_head.number_of_samples ||
+                waveform.head.channels != wav_head.channels)
+                waveform = ISMRMRD::Waveform(wav_head.number_of_samples, wav_head.channels);
+            waveform.head = wav_head;
+            std::copy(data.begin(), data.end(), waveform.data);
+            dataset.appendWaveform(waveform);
+        }
+
+    private:
+        ISMRMRD::Dataset& dataset;
+        ISMRMRD::Acquisition acquisition;
+        ISMRMRD::Waveform waveform;
+    };
 }
 
 void IsmrmrdDumpGadget::process(Core::InputChannel<Core::variant<Core::Acquisition, Core::Waveform>>& input,
@@ -196,7 +212,7 @@ void IsmrmrdDumpGadget::process(Core::InputChannel<Core::variant<Core::Acquisiti
         return;
     }
 
-    Core::MPMCChannel<Core::variant<Core::Acquisition, Core::Waveform>> data_buffer;
+    Core::MPMCChannel<Core::variant<Core::Acquisition, Core::Waveform>> data_buffer(dump_queue_size);
 
     auto save_thread = std::thread([&data_buffer, this]() {
 
@@ -220,17 +236,38 @@ void IsmrmrdDumpGadget::process(Core::InputChannel<Core::variant<Core::Acquisiti
                     dataset.writeHeader(stream.str());
                     GDEBUG_STREAM("IsmrmrdDumpGadget, save ismrmrd xml header ... ");
 
+                    DatasetAppender append(dataset);
+                    const size_t max_batch_size = std::max<size_t>(dump_batch_size, 1);
+                    std::vector<Core::variant<Core::Acquisition, Core::Waveform>> batch;
+                    batch.reserve(max_batch_size);
+
                     for (;;)
                     {
-                        Core::visit([&dataset](const auto& item) { append_to_dataset(item, dataset); }, data_buffer.pop());
+                        // Take whatever has queued up while the previous batch was written, so the chain is
+                        // released as soon as possible.
+                        batch.push_back(data_buffer.pop());
+                        while (batch.size() < max_batch_size) {
+                            auto item = data_buffer.try_pop();
+                            if (!item) break;
+                            batch.push_back(std::move(*item));
+                        }
+
+                        for (const auto& item : batch) Core::visit(append, item);
+                        batch.clear();
                     }
-                } 
+                }
+                catch (const Core::ChannelClosed&)
+                {
+                }
                 catch (...)
                 {
                     GDEBUG_STREAM("IsmrmrdDumpGadget, exceptions happened in process, append_to_dataset ... ");
                 }
             }
         }
+
+        // Nothing more is saved; the chain must not wait for space in the queue.
+        data_buffer.close();
     });
 
     if (save_xml_header_only) {
@@ -241,8 +278,15 @@ void IsmrmrdDumpGadget::process(Core::InputChannel<Core::variant<Core::Acquisiti
         return;
     }
 
+    bool saving = true;
     for (auto item : input) {
-        data_buffer.push(item);
+        if (saving) {
+            try {
+                data_buffer.push(item);
+            } catch (const Core::ChannelClosed&) {
+                saving = false;
+            }
+        }
         if (is_valid_type(item))
             output.push(std::move(item));
     }
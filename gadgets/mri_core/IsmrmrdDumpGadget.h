@@ -40,6 +40,10 @@ namespace Gadgetron {
         // TODO: remove this option
         NODE_PROPERTY(pass_waveform_downstream, bool, "If true, waveform data is passed downstream", true);
 
+        // data is written to the dump file on a separate thread; the chain only waits for it when the queue is full
+        NODE_PROPERTY(dump_queue_size, size_t, "Maximum number of items waiting to be saved; 0 for no limit", 4096);
+        NODE_PROPERTY(dump_batch_size, size_t, "Maximum number of items saved at a time", 64);
+
         void process(Core::InputChannel<Core::variant<Core::Acquisition,Core::Waveform>>& input, Core::OutputChannel& output) override;
 
     private:
@@ -1,4 +1,6 @@
 #include "NoiseAdjustGadget.h"
+#include "ChannelAlgorithms.h"
+#include "ReadoutBatch.h"
 #include "hoArmadillo.h"
 #include "hoMatrix.h"
 #include "hoNDArray_elemwise.h"
@@ -8,9 +10,6 @@
 #include "io/ismrmrd_types.h"
 #include "log.h"
 #include <boost/iterator/counting_iterator.hpp>
-#ifdef USE_OMP
-#include "omp.h"
-#endif // USE_OMP
 
 #include <boost/algorithm/string.hpp>
 #include <boost/algorithm/string/split.hpp>
@@ -183,6 +182,11 @@ namespace Gadgetron {
         , receiver_noise_bandwidth{ bandwidth_from_header(context.header) }
         , measurement_id{ value_or(context.header.measurementInformation->measurementID, ""s) }, measurement_storage(context.storage.measurement) {
 
+        scale_only_channels = current_ismrmrd_header.acquisitionSystemInformation
+                                  ? find_scale_only_channels(scale_only_channels_by_name,
+                                      current_ismrmrd_header.acquisitionSystemInformation->coilLabel)
+                                  : std::vector<size_t>{};
+
         if (!perform_noise_adjust)
             return;
 
@@ -191,10 +195,6 @@ namespace Gadgetron {
         GDEBUG("NoiseAdjustGadget::pass_nonconformant_data_ is %d\n", pass_nonconformant_data);
         GDEBUG("receiver_noise_bandwidth_ is %f\n", receiver_noise_bandwidth);
 
-#ifdef USE_OMP
-        omp_set_num_threads(1);
-#endif // USE_OMP
-
         if (context.parameters.find("noisecovariancein") != context.parameters.end()) {
             noise_covariance_in = context.parameters.at("noisecovariancein");
             GDEBUG_STREAM("Input noise covariance matrix is provided as a parameter: " << noise_covariance_in);
@@ -326,29 +326,13 @@ namespace Gadgetron {
 
 
     template <class NH>
-    NoiseAdjustGadget::NoiseHandler NoiseAdjustGadget::handle_acquisition(NH nh, Core::Acquisition& acq) {
+    NoiseAdjustGadget::NoiseHandler NoiseAdjustGadget::prepare_prewhitener(NH nh, const ISMRMRD::AcquisitionHeader& head) {
         return std::move(nh);
     };
 
     template <>
-    NoiseAdjustGadget::NoiseHandler NoiseAdjustGadget::handle_acquisition(
-        Prewhitener pw, Core::Acquisition& acq) {
-
-        auto& data = std::get<hoNDArray<std::complex<float>>>(acq);
-        if (data.get_size(1) == pw.prewhitening_matrix.get_size(0)) {
-            auto dataM = as_arma_matrix(data);
-            auto pwm = as_arma_matrix(pw.prewhitening_matrix);
-            dataM *= pwm;
-        } else if (!this->pass_nonconformant_data) {
-            throw std::runtime_error("Input data has different number of channels from noise data");
-        }
-        return std::move(pw);
-    }
-
-    template <>
-    NoiseAdjustGadget::NoiseHandler NoiseAdjustGadget::handle_acquisition(
-        NoiseGatherer ng, Core::Acquisition& acq) {
-        auto& head = std::get<ISMRMRD::AcquisitionHeader>(acq);
+    NoiseAdjustGadget::NoiseHandler NoiseAdjustGadget::prepare_prewhitener(
+        NoiseGatherer ng, const ISMRMRD::AcquisitionHeader& head) {
         if (ng.total_number_of_samples == 0)
             return std::move(ng);
 
@@ -359,41 +343,67 @@ namespace Gadgetron {
         auto prewhitening_matrix = computeNoisePrewhitener(masked_covariance);
         prewhitening_matrix
             *= calculate_scale_factor(head.sample_time_us, ng.noise_dwell_time_us, receiver_noise_bandwidth);
-        return handle_acquisition(Prewhitener{ prewhitening_matrix }, acq);
+        return Prewhitener{ prewhitening_matrix };
     }
 
     template <>
-    NoiseAdjustGadget::NoiseHandler NoiseAdjustGadget::handle_acquisition(
-        LoadedNoise ln, Core::Acquisition& acq)  {
-        auto& head               = std::get<ISMRMRD::AcquisitionHeader>(acq);
+    NoiseAdjustGadget::NoiseHandler NoiseAdjustGadget::prepare_prewhitener(
+        LoadedNoise ln, const ISMRMRD::AcquisitionHeader& head)  {
         auto masked_covariance   = mask_channels(std::move(ln.covariance), scale_only_channels);
         auto prewhitening_matrix = computeNoisePrewhitener(masked_covariance);
         prewhitening_matrix
             *= calculate_scale_factor(head.sample_time_us, ln.noise_dwell_time_us, receiver_noise_bandwidth);
-        return handle_acquisition(Prewhitener{ prewhitening_matrix }, acq);
+        return Prewhitener{ prewhitening_matrix };
     }
 
     template <>
-    NoiseAdjustGadget::NoiseHandler NoiseAdjustGadget::handle_acquisition(
-        NoiseHandler nh, Core::Acquisition& acq) {
-        return Core::visit([&](auto var) { return this->handle_acquisition<decltype(var)>(std::move(var), acq); }, std::move(nh));
+    NoiseAdjustGadget::NoiseHandler NoiseAdjustGadget::prepare_prewhitener(
+        NoiseHandler nh, const ISMRMRD::AcquisitionHeader& head) {
+        return Core::visit([&](auto var) { return this->prepare_prewhitener<decltype(var)>(std::move(var), head); }, std::move(nh));
     }
 
-    void NoiseAdjustGadget::process(Core::InputChannel<Core::Acquisition>& input, Core::OutputChannel& output) {
+    const hoNDArray<std::complex<float>>* NoiseAdjustGadget::prewhitening_matrix(size_t channels) const {
+        auto pw = std::get_if<Prewhitener>(&noisehandler);
+        if (pw && channels == pw->prewhitening_matrix.get_size(0))
+            return &pw->prewhitening_matrix;
+        if (pw && !this->pass_nonconformant_data)
+            throw std::runtime_error("Input data has different number of channels from noise data");
+        return nullptr;
+    }
 
-        scale_only_channels = current_ismrmrd_header.acquisitionSystemInformation
-                                  ? find_scale_only_channels(scale_only_channels_by_name,
-                                      current_ismrmrd_header.acquisitionSystemInformation->coilLabel)
-                                  : std::vector<size_t>{};
+    void NoiseAdjustGadget::prewhiten(std::vector<Core::Acquisition>& batch) {
+        auto& data = std::get<hoNDArray<std::complex<float>>>(batch.front());
+        auto matrix = prewhitening_matrix(data.get_size(1));
+        if (!matrix)
+            return;
 
+        auto pwm = as_arma_matrix(*matrix);
+        if (batch.size() == 1) {
+            auto dataM = as_arma_matrix(data);
+            dataM *= pwm;
+        } else {
+            // The readouts of the batch are stacked, so they are whitened in a single GEMM
+            auto readouts = ReadoutBatch::data_of(batch);
+            ReadoutBatch::stack_samples(readouts, stacked_samples);
+            auto dataM = as_arma_matrix(stacked_samples);
+            dataM *= pwm;
+            ReadoutBatch::unstack_samples(stacked_samples, readouts);
+        }
+    }
+
+    void NoiseAdjustGadget::process(Core::InputChannel<Core::Acquisition>& input, Core::OutputChannel& output) {
 
-        for (auto acq : input) {
-            if (is_noise(acq)) {
-                add_noise(noisehandler, acq);
+        // Batches never mix noise and data, and hold readouts of the same size only
+        for (auto batch : Core::Algorithm::batch(input, readout_batch_size, ReadoutBatch::compatible)) {
+            if (is_noise(batch.front())) {
+                for (auto& acq : batch)
+                    add_noise(noisehandler, acq);
                 continue;
             }
-            noisehandler = handle_acquisition(std::move(noisehandler), acq);
-            output.push(std::move(acq));
+            noisehandler = prepare_prewhitener(std::move(noisehandler), std::get<ISMRMRD::AcquisitionHeader>(batch.front()));
+            prewhiten(batch);
+            for (auto& acq : batch)
+                output.push(std::move(acq));
         }
 
         this->save_noisedata(noisehandler);
@@ -105,6 +105,8 @@ namespace Gadgetron {
 
         void process(Core::InputChannel<Core::Acquisition>& in, Core::OutputChannel& out) override;
 
+        size_t thread_budget() const override { return 1; }
+
         using NoiseHandler = Core::variant<NoiseGatherer, LoadedNoise, Prewhitener, IgnoringNoise>;
 
     protected:
@@ -114,6 +116,7 @@ namespace Gadgetron {
         NODE_PROPERTY(noise_dwell_time_us_preset, float, "Preset dwell time for noise measurement", 0.0);
         NODE_PROPERTY(scale_only_channels_by_name, std::string, "List of named channels that should only be scaled", "");
         NODE_PROPERTY(noise_dependency_folder, boost::filesystem::path, "Path to the working directory", boost::filesystem::temp_directory_path() / "gadgetron");
+        NODE_PROPERTY(readout_batch_size, size_t, "Maximum number of consecutive readouts prewhitened together", 32);
 
         const float receiver_noise_bandwidth;
 
@@ -128,8 +131,17 @@ namespace Gadgetron {
         template<class NOISEHANDLER>
         void add_noise(NOISEHANDLER& nh, const Core::Acquisition&) const ;
 
+        // Turns gathered or loaded noise into a Prewhitener, using the header of the first data acquisition
         template<class NOISEHANDLER>
-        NoiseHandler handle_acquisition(NOISEHANDLER nh, Core::Acquisition&);
+        NoiseHandler prepare_prewhitener(NOISEHANDLER nh, const ISMRMRD::AcquisitionHeader&);
+
+        // The prewhitening matrix for data with the given number of channels, or nullptr if the data is passed as is
+        const hoNDArray<std::complex<float>>* prewhitening_matrix(size_t channels) const;
+
+        void prewhiten(std::vector<Core::Acquisition>& batch);
+
+        // Readouts of a batch stacked as [RO*K, CHA]
+        hoNDArray<std::complex<float>> stacked_samples;
 
         Core::optional<NoiseCovariance> load_noisedata() const;
 
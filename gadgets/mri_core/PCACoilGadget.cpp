@@ -11,6 +11,7 @@
 #include "hoNDArray_fileio.h"
 #include "hoNDKLT.h"
 #include "hoNDArray_linalg.h"
+#include "ReadoutBatch.h"
 
 #include <boost/algorithm/string.hpp>
 #include <boost/algorithm/string/split.hpp>
@@ -62,10 +63,6 @@ namespace Gadgetron {
         present_uncombined_channels.value((int)uncombined_channels_.size());
         GDEBUG("Number of uncombined channels (present_uncombined_channels) set to %d\n", uncombined_channels_.size());
 
-#ifdef USE_OMP
-        omp_set_num_threads(1);
-#endif // USE_OMP
-
         return GADGET_OK;
     }
 
@@ -213,13 +210,47 @@ namespace Gadgetron {
                 //Switch off buffering for this slice
                 buffering_mode_[location] = false;
 
-                //Now we should pump all the profiles that we have buffered back through the system
+                //Now we should transform all the profiles that we have buffered. Profiles of the same size are
+                //stacked, so they are all transformed in a single matrix product
+                std::vector< hoNDArray< std::complex<float> >* > profiles;
                 for (size_t p = 0; p < profiles_available; p++) {
-                    ACE_Message_Block* mb = buffer_[location][p];
-                    if (inherited::process(mb) != GADGET_OK) {
-                        GDEBUG("Failed to reprocess buffered data\n");
+                    GadgetContainerMessage<hoNDArray<std::complex<float> > >* m_tmp =
+                        AsContainerMessage<hoNDArray< std::complex<float> > >(buffer_[location][p]->cont());
+                    if (m_tmp && m_tmp->getObjectPtr()->get_number_of_dimensions() == 2
+                        && m_tmp->getObjectPtr()->get_size(0) == (size_t)samples_per_profile
+                        && m_tmp->getObjectPtr()->get_size(1) == (size_t)channels) {
+                        profiles.push_back(m_tmp->getObjectPtr());
+                    }
+                }
+
+                if (profiles.size() == (size_t)profiles_available) {
+                    hoNDArray< std::complex<float> > stacked, stacked_coils;
+                    try {
+                        ReadoutBatch::stack_samples(profiles, stacked);
+                        VT->transform(stacked, stacked_coils, 1);
+                        ReadoutBatch::unstack_samples(stacked_coils, profiles);
+                    }
+                    catch (std::runtime_error& err) {
+                        GEXCEPTION(err, "Unable to transform buffered profiles to PCA coils\n");
                         return GADGET_FAIL;
                     }
+
+                    for (size_t p = 0; p < profiles_available; p++) {
+                        if (this->next()->putq(buffer_[location][p]) < 0) {
+                            GDEBUG("Unable to put message on Q");
+                            return GADGET_FAIL;
+                        }
+                    }
+                }
+                else {
+                    //Pump the profiles back through the system one at a time
+                    for (size_t p = 0; p < profiles_available; p++) {
+                        ACE_Message_Block* mb = buffer_[location][p];
+                        if (inherited::process(mb) != GADGET_OK) {
+                            GDEBUG("Failed to reprocess buffered data\n");
+                            return GADGET_FAIL;
+                        }
+                    }
                 }
                 //Remove references in this buffer
                 buffer_[location].clear();
@@ -22,6 +22,8 @@ namespace Gadgetron {
     PCACoilGadget();
     virtual ~PCACoilGadget();
 
+    virtual size_t thread_budget() const { return 1; }
+
   protected:
     virtual int process_config(ACE_Message_Block* mb);
     virtual int process(GadgetContainerMessage<ISMRMRD::AcquisitionHeader>* m1,
@@ -0,0 +1,107 @@
+/**
+    \brief  Helpers for processing consecutive readouts in batches
+
+    Per-acquisition gadgets spend most of their time on small transforms of a single readout. Batching readouts of the
+    same size lets the channel matrix products run as one GEMM over [RO*K, CHA], and the readout FFTs as one
+    transform over [RO, CHA, K].
+*/
+
+#pragma once
+
+#include "Types.h"
+#include "hoNDArray.h"
+
+#include <algorithm>
+#include <complex>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace Gadgetron { namespace ReadoutBatch {
+
+    /**
+     * Whether two acquisitions can be processed in the same batch: same number of samples and channels, and both or
+     * none of them noise.
+     */
+    inline bool compatible(const Core::Acquisition& first, const Core::Acquisition& acquisition) {
+        const auto& a = std::get<ISMRMRD::AcquisitionHeader>(first);
+        const auto& b = std::get<ISMRMRD::AcquisitionHeader>(acquisition);
+        return a.number_of_samples == b.number_of_samples && a.active_channels == b.active_channels
+               && a.isFlagSet(ISMRMRD::ISMRMRD_ACQ_IS_NOISE_MEASUREMENT)
+                      == b.isFlagSet(ISMRMRD::ISMRMRD_ACQ_IS_NOISE_MEASUREMENT);
+    }
+
+    inline std::vector<hoNDArray<std::complex<float>>*> data_of(std::vector<Core::Acquisition>& batch) {
+        std::vector<hoNDArray<std::complex<float>>*> readouts(batch.size());
+        std::transform(batch.begin(), batch.end(), readouts.begin(),
+            [](auto& acq) { return &std::get<hoNDArray<std::complex<float>>>(acq); });
+        return readouts;
+    }
+
+    /**
+     * Stacks K readouts of [RO, CHA] into [RO*K, CHA].
+     */
+    template <class T> void stack_samples(const std::vector<hoNDArray<T>*>& readouts, hoNDArray<T>& stacked) {
+        const size_t K   = readouts.size();
+        const size_t RO  = readouts.front()->get_size(0);
+        const size_t CHA = readouts.front()->get_size(1);
+
+        if (!stacked.dimensions_equal(std::vector<size_t>{ RO * K, CHA }))
+            stacked.create(RO * K, CHA);
+
+        for (size_t k = 0; k < K; k++) {
+            if (readouts[k]->get_number_of_elements() != RO * CHA)
+                throw std::runtime_error("ReadoutBatch::stack_samples: readouts differ in size");
+            for (size_t c = 0; c < CHA; c++)
+                memcpy(stacked.get_data_ptr() + c * RO * K + k * RO, readouts[k]->get_data_ptr() + c * RO, RO * sizeof(T));
+        }
+    }
+
+    /**
+     * Copies [RO*K, CHA'] back into K readouts of [RO, CHA'], creating the readouts if CHA' differs.
+     */
+    template <class T> void unstack_samples(const hoNDArray<T>& stacked, const std::vector<hoNDArray<T>*>& readouts) {
+        const size_t K   = readouts.size();
+        const size_t RO  = stacked.get_size(0) / K;
+        const size_t CHA = stacked.get_size(1);
+
+        for (size_t k = 0; k < K; k++) {
+            if (!readouts[k]->dimensions_equal(std::vector<size_t>{ RO, CHA }))
+                readouts[k]->create(RO, CHA);
+            for (size_t c = 0; c < CHA; c++)
+                memcpy(readouts[k]->get_data_ptr() + c * RO, stacked.get_data_ptr() + c * RO * K + k * RO, RO * sizeof(T));
+        }
+    }
+
+    /**
+     * Stacks K readouts of [RO, CHA] into [RO, CHA, K].
+     */
+    template <class T> void stack_readouts(const std::vector<hoNDArray<T>*>& readouts, hoNDArray<T>& stacked) {
+        const size_t K   = readouts.size();
+        const size_t RO  = readouts.front()->get_size(0);
+        const size_t CHA = readouts.front()->get_size(1);
+
+        if (!stacked.dimensions_equal(std::vector<size_t>{ RO, CHA, K }))
+            stacked.create(RO, CHA, K);
+
+        for (size_t k = 0; k < K; k++) {
+            if (readouts[k]->get_number_of_elements() != RO * CHA)
+                throw std::runtime_error("ReadoutBatch::stack_readouts: readouts differ in size");
+            memcpy(stacked.get_data_ptr() + k * RO * CHA, readouts[k]->get_data_ptr(), RO * CHA * sizeof(T));
+        }
+    }
+
+    /**
+     * Copies [RO', CHA, K] back into K readouts of [RO', CHA], creating the readouts if RO' differs.
+     */
+    template <class T> void unstack_readouts(const hoNDArray<T>& stacked, const std::vector<hoNDArray<T>*>& readouts) {
+        const size_t RO  = stacked.get_size(0);
+        const size_t CHA = stacked.get_size(1);
+
+        for (size_t k = 0; k < readouts.size(); k++) {
+            if (!readouts[k]->dimensions_equal(std::vector<size_t>{ RO, CHA }))
+                readouts[k]->create(RO, CHA);
+            memcpy(readouts[k]->get_data_ptr(), stacked.get_data_ptr() + k * RO * CHA, RO * CHA * sizeof(T));
+        }
+    }
+}}
@@ -0,0 +1,204 @@
+#include "ReadoutFrontEndGadget.h"
+#include "ChannelAlgorithms.h"
+#include "ReadoutBatch.h"
+#include "hoArmadillo.h"
+
+#include <boost/algorithm/string.hpp>
+#include <boost/algorithm/string/split.hpp>
+
+namespace Gadgetron {
+
+    namespace {
+        bool is_noise(const Core::Acquisition& acq) {
+            return std::get<ISMRMRD::AcquisitionHeader>(acq).isFlagSet(ISMRMRD::ISMRMRD_ACQ_IS_NOISE_MEASUREMENT);
+        }
+
+        // Readouts of a batch also need the same echo position, as they are zero filled together
+        bool compatible(const Core::Acquisition& first, const Core::Acquisition& acquisition) {
+            const auto& a = std::get<ISMRMRD::AcquisitionHeader>(first);
+            const auto& b = std::get<ISMRMRD::AcquisitionHeader>(acquisition);
+            return ReadoutBatch::compatible(first, acquisition) && a.center_sample == b.center_sample
+                   && a.encoding_space_ref == b.encoding_space_ref;
+        }
+    }
+
+    ReadoutFrontEndGadget::ReadoutFrontEndGadget(const Core::Context& context, const Core::GadgetProperties& props)
+        : NoiseAdjustGadget(context, props) {
+        auto& h = context.header;
+
+        maxRO_.resize(h.encoding.size());
+        for (size_t e = 0; e < h.encoding.size(); e++)
+            maxRO_[e] = h.encoding[e].encodedSpace.matrixSize.x;
+
+        remove_oversampling_ = false;
+        ratioFOV_            = 1.0f;
+        if (remove_ro_oversampling && !h.encoding.empty()) {
+            ISMRMRD::EncodingSpace e_space = h.encoding[0].encodedSpace;
+            ISMRMRD::EncodingSpace r_space = h.encoding[0].reconSpace;
+
+            remove_oversampling_ = (e_space.matrixSize.x != r_space.matrixSize.x)
+                                   || (e_space.fieldOfView_mm.x != r_space.fieldOfView_mm.x);
+            ratioFOV_ = e_space.fieldOfView_mm.x / r_space.fieldOfView_mm.x;
+        }
+
+        size_t coils_in = h.acquisitionSystemInformation && h.acquisitionSystemInformation->receiverChannels
+                              ? *h.acquisitionSystemInformation->receiverChannels
+                              : 128;
+
+        // An empty coil mask keeps all coils
+        std::string coil_mask_int = coil_mask;
+        if (coil_mask_int.empty()) {
+            if (coils_out > 0)
+                coil_mask_ = std::vector<unsigned short>(coils_out, 1);
+        } else {
+            std::vector<std::string> chm;
+            boost::split(chm, coil_mask_int, boost::is_any_of(" "));
+            for (auto& ch : chm) {
+                boost::algorithm::trim(ch);
+                if (ch.size() > 0)
+                    coil_mask_.push_back(std::stoi(ch) > 0 ? 1 : 0);
+            }
+        }
+        if (!coil_mask_.empty()) {
+            coil_mask_.resize(coils_in, 0);
+            GDEBUG("Readout front end: coil reduction from %d to %d\n", (int)coils_in,
+                (int)std::count(coil_mask_.begin(), coil_mask_.end(), 1));
+        }
+    }
+
+    void ReadoutFrontEndGadget::process(Core::InputChannel<Core::Acquisition>& in, Core::OutputChannel& out) {
+
+        for (auto batch : Core::Algorithm::batch(in, readout_batch_size, compatible)) {
+            if (is_noise(batch.front())) {
+                for (auto& acq : batch)
+                    add_noise(noisehandler, acq);
+                continue;
+            }
+
+            process_batch(batch);
+            for (auto& acq : batch)
+                out.push(std::move(acq));
+        }
+
+        this->save_noisedata(noisehandler);
+    }
+
+    void ReadoutFrontEndGadget::apply_channel_matrix(
+        std::vector<Core::Acquisition>& batch, const std::vector<size_t>& kept_channels) {
+
+        auto readouts = ReadoutBatch::data_of(batch);
+        ReadoutBatch::stack_samples(readouts, stacked_samples);
+
+        const size_t rows     = stacked_samples.get_size(0);
+        const size_t channels = stacked_samples.get_size(1);
+        const size_t kept     = kept_channels.size();
+
+        if (!channel_res_.dimensions_equal(std::vector<size_t>{ rows, kept }))
+            channel_res_.create(rows, kept);
+
+        auto prewhitener = prewhitening_matrix(channels);
+        if (prewhitener) {
+            // Coil reduction keeps columns of the prewhitening matrix, so both are done in one GEMM
+            if (!channel_matrix_.dimensions_equal(std::vector<size_t>{ channels, kept }))
+                channel_matrix_.create(channels, kept);
+            for (size_t c = 0; c < kept; c++)
+                memcpy(channel_matrix_.get_data_ptr() + c * channels,
+                    prewhitener->get_data_ptr() + kept_channels[c] * channels, channels * sizeof(std::complex<float>));
+
+            auto result = as_arma_matrix(channel_res_);
+            result      = as_arma_matrix(stacked_samples) * as_arma_matrix(channel_matrix_);
+        } else {
+            for (size_t c = 0; c < kept; c++)
+                memcpy(channel_res_.get_data_ptr() + c * rows, stacked_samples.get_data_ptr() + kept_channels[c] * rows,
+                    rows * sizeof(std::complex<float>));
+        }
+    }
+
+    void ReadoutFrontEndGadget::process_batch(std::vector<Core::Acquisition>& batch) {
+
+        auto& head = std::get<ISMRMRD::AcquisitionHeader>(batch.front());
+        noisehandler = prepare_prewhitener(std::move(noisehandler), head);
+
+        const size_t K        = batch.size();
+        const size_t samples  = head.number_of_samples;
+        const size_t channels = std::get<hoNDArray<std::complex<float>>>(batch.front()).get_size(1);
+
+        std::vector<size_t> kept_channels;
+        for (size_t c = 0; c < channels; c++) {
+            if (coil_mask_.empty() || (c < coil_mask_.size() && coil_mask_[c]))
+                kept_channels.push_back(c);
+        }
+        const size_t kept = kept_channels.size();
+
+        apply_channel_matrix(batch, kept_channels);
+
+        // Zero filling of asymmetric echoes, as in AsymmetricEchoAdjustROGadget
+        size_t RO = samples, offset = 0;
+        uint16_t discard_pre = head.discard_pre, discard_post = head.discard_post;
+        uint16_t center_sample = head.center_sample;
+
+        const size_t centre_column = head.center_sample;
+        const size_t maxRO         = head.encoding_space_ref < maxRO_.size() ? maxRO_[head.encoding_space_ref] : 0;
+        const bool asymmetric      = 2 * centre_column != samples && centre_column < samples;
+        if (adjust_asymmetric_echo && asymmetric && samples < maxRO) {
+            RO = maxRO;
+            if (2 * centre_column < samples) {
+                offset       = maxRO - samples;
+                discard_pre  = maxRO - samples;
+                discard_post = 0;
+            } else {
+                discard_pre  = 0;
+                discard_post = maxRO - samples;
+            }
+            center_sample = RO / 2;
+        }
+
+        // Readouts are moved to [RO, CHA_out, K], the layout of the readout FFTs
+        auto readouts = ReadoutBatch::data_of(batch);
+        auto& stacked = remove_oversampling_ ? ifft_buf_ : fft_res_;
+        if (!stacked.dimensions_equal(std::vector<size_t>{ RO, kept, K }))
+            stacked.create(RO, kept, K);
+        if (RO != samples)
+            stacked.fill(std::complex<float>(0));
+
+        for (size_t k = 0; k < K; k++)
+            for (size_t c = 0; c < kept; c++)
+                memcpy(stacked.get_data_ptr() + (k * kept + c) * RO + offset,
+                    channel_res_.get_data_ptr() + c * samples * K + k * samples, samples * sizeof(std::complex<float>));
+
+        size_t dRO = RO;
+        if (remove_oversampling_) {
+            dRO          = (size_t)(RO / ratioFOV_);
+            size_t start = (RO - dRO) / 2;
+
+            if (!fft_buf_.dimensions_equal(std::vector<size_t>{ dRO, kept, K }))
+                fft_buf_.create(dRO, kept, K);
+
+            hoNDFFT<float>::instance()->ifft1c(ifft_buf_, ifft_res_);
+
+            const size_t lines = kept * K;
+            for (size_t l = 0; l < lines; l++)
+                memcpy(fft_buf_.get_data_ptr() + l * dRO, ifft_res_.get_data_ptr() + l * RO + start,
+                    dRO * sizeof(std::complex<float>));
+
+            hoNDFFT<float>::instance()->fft1c(fft_buf_, fft_res_);
+
+            center_sample = (uint16_t)(center_sample / ratioFOV_);
+            discard_pre   = (uint16_t)(discard_pre / ratioFOV_);
+            discard_post  = (uint16_t)(discard_post / ratioFOV_);
+        }
+
+        ReadoutBatch::unstack_readouts(fft_res_, readouts);
+
+        for (auto& acq : batch) {
+            auto& header             = std::get<ISMRMRD::AcquisitionHeader>(acq);
+            header.number_of_samples = (uint16_t)dRO;
+            header.center_sample     = center_sample;
+            header.discard_pre       = discard_pre;
+            header.discard_post      = discard_post;
+            header.active_channels   = (uint16_t)kept;
+        }
+    }
+
+    GADGETRON_GADGET_EXPORT(ReadoutFrontEndGadget)
+}
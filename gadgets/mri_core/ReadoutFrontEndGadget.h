@@ -0,0 +1,51 @@
+/**
+    \brief  Prewhitening, asymmetric echo adjustment, readout oversampling removal and coil reduction in a single gadget
+    \test   Tested by: generic_grappa2x1_3d_frontend.cfg
+
+    Gives the same output as NoiseAdjustGadget, AsymmetricEchoAdjustROGadget, RemoveROOversamplingGadget and
+    CoilReductionGadget in sequence. Readouts are processed in batches of consecutive readouts of the same size. The
+    prewhitening matrix and the coil reduction are combined into a single [CHA, CHA_out] matrix, which is applied to
+    the batch in one GEMM, before the zero filling and the readout FFTs, so these run on the reduced channels only.
+*/
+
+#pragma once
+
+#include "NoiseAdjustGadget.h"
+#include "hoNDFFT.h"
+
+namespace Gadgetron {
+
+    class ReadoutFrontEndGadget : public NoiseAdjustGadget {
+    public:
+        ReadoutFrontEndGadget(const Core::Context& context, const Core::GadgetProperties& props);
+
+        void process(Core::InputChannel<Core::Acquisition>& in, Core::OutputChannel& out) override;
+
+    protected:
+        NODE_PROPERTY(adjust_asymmetric_echo, bool, "Whether to zero fill asymmetric echoes to the encoded matrix size", true);
+        NODE_PROPERTY(remove_ro_oversampling, bool, "Whether to remove the readout oversampling", true);
+        NODE_PROPERTY(coil_mask, std::string, "String mask of zeros and ones, e.g. 000111000 indicating which coils to keep", "");
+        NODE_PROPERTY(coils_out, int, "Number of coils to keep, coils with higher indices will be discarded. 0 keeps all coils", 0);
+
+        void process_batch(std::vector<Core::Acquisition>& batch);
+
+        // Applies the prewhitening and the coil reduction to the batch, leaving the result in channel_res_
+        void apply_channel_matrix(std::vector<Core::Acquisition>& batch, const std::vector<size_t>& kept_channels);
+
+        std::vector<unsigned int> maxRO_;
+        std::vector<unsigned short> coil_mask_;
+
+        bool remove_oversampling_;
+        float ratioFOV_;
+
+        // Readouts stacked as [RO*K, CHA], and after the channel matrix as [RO*K, CHA_out]
+        hoNDArray<std::complex<float>> channel_matrix_;
+        hoNDArray<std::complex<float>> channel_res_;
+
+        // Readouts stacked as [RO, CHA_out, K] for the readout FFTs
+        hoNDArray<std::complex<float>> ifft_buf_;
+        hoNDArray<std::complex<float>> ifft_res_;
+        hoNDArray<std::complex<float>> fft_buf_;
+        hoNDArray<std::complex<float>> fft_res_;
+    };
+}
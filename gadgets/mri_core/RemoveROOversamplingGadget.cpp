@@ -1,4 +1,6 @@
 #include "RemoveROOversamplingGadget.h"
+#include "ChannelAlgorithms.h"
+#include "ReadoutBatch.h"
 
 namespace Gadgetron {
 
@@ -21,11 +23,6 @@ RemoveROOversamplingGadget::RemoveROOversamplingGadget(const Core::Context& cont
     reconNx_ = r_space.matrixSize.x;
     reconFOV_ = r_space.fieldOfView_mm.x;
 
-#ifdef USE_OMP  // TODO: Should this be removed? Its from the old version
-    omp_set_num_threads(1);
-    GDEBUG_STREAM("RemoveROOversamplingGadget:omp_set_num_threads(1) ... ");
-#endif // USE_OMP
-
     // If the encoding and recon matrix size and FOV are the same
     // then the data is not oversampled and we can safely pass
     // the data onto the next gadget
@@ -37,64 +34,52 @@ RemoveROOversamplingGadget::RemoveROOversamplingGadget(const Core::Context& cont
 }
 
 void RemoveROOversamplingGadget::process(Core::InputChannel<Core::Acquisition>& in, Core::OutputChannel& out) {
-  for (auto [header, acq, traj] : in) {
-    if(dowork_){
-      hoNDArray<std::complex<float>>* temp = new hoNDArray<std::complex<float>>();
-      if (!temp)
-      {
-        GERROR("Error creating new temp  array");
-        return;
-      }
-      std::vector<size_t> data_out_dims = acq.get_dimensions();
-      if (!ifft_buf_.dimensions_equal(data_out_dims) )
-      {
-          ifft_buf_.create(data_out_dims);
-          ifft_res_.create(data_out_dims);
-      }
-      float ratioFOV = encodeFOV_/reconFOV_;
-      data_out_dims[0] = (size_t)(data_out_dims[0]/ratioFOV);
-      if ( !fft_buf_.dimensions_equal(data_out_dims) )
-      {
-          fft_buf_.create(data_out_dims);
-          fft_res_.create(data_out_dims);
-      }
-      try{ temp->create(data_out_dims);}
-      catch (std::runtime_error &err)
-      {
-          GEXCEPTION(err,"Unable to create new data array for downsampled data\n");
-          return;
-      }
-      size_t sRO = acq.get_size(0);
-      size_t start = (size_t)((acq.get_size(0)-data_out_dims[0]) / 2);
-
-      size_t dRO = temp->get_size(0);
-      size_t numOfBytes = data_out_dims[0]*sizeof(std::complex<float>);
-
-      int c;   
-      int CHA = (int)(data_out_dims[1]);
-
-      std::complex<float>* data_in, *data_out;
-      hoNDFFT<float>::instance()->ifft1c(acq, ifft_res_, ifft_buf_);
-      data_in  = ifft_res_.get_data_ptr();
-      data_out = temp->get_data_ptr();
-
-      for (c=0; c<CHA; c++)
-      {
-          memcpy( data_out+c*dRO, data_in+c*sRO+start, numOfBytes );
-      }
-
-      hoNDFFT<float>::instance()->fft1c(*temp, fft_res_, fft_buf_);
-
-      memcpy(temp->begin(), fft_res_.begin(), fft_res_.get_number_of_bytes());
-
-      header.number_of_samples = data_out_dims[0];
+  if (!dowork_) {
+    for (auto acq : in)
+      out.push(std::move(acq));
+    return;
+  }
+
+  // Consecutive readouts of the same size are transformed together, in one FFT over [RO, CHA, K]
+  for (auto batch : Core::Algorithm::batch(in, readout_batch_size, ReadoutBatch::compatible)) {
+    auto readouts = ReadoutBatch::data_of(batch);
+    ReadoutBatch::stack_readouts(readouts, ifft_buf_);
+
+    std::vector<size_t> data_out_dims = ifft_buf_.get_dimensions();
+    float ratioFOV = encodeFOV_/reconFOV_;
+    data_out_dims[0] = (size_t)(data_out_dims[0]/ratioFOV);
+    if ( !fft_buf_.dimensions_equal(data_out_dims) )
+        fft_buf_.create(data_out_dims);
+
+    size_t sRO = ifft_buf_.get_size(0);
+    size_t start = (size_t)((sRO-data_out_dims[0]) / 2);
+
+    size_t dRO = data_out_dims[0];
+    size_t numOfBytes = dRO*sizeof(std::complex<float>);
+    size_t lines = fft_buf_.get_number_of_elements() / dRO;
+
+    hoNDFFT<float>::instance()->ifft1c(ifft_buf_, ifft_res_);
+
+    std::complex<float>* data_in  = ifft_res_.get_data_ptr();
+    std::complex<float>* data_out = fft_buf_.get_data_ptr();
+
+    for (size_t l=0; l<lines; l++)
+    {
+        memcpy( data_out+l*dRO, data_in+l*sRO+start, numOfBytes );
+    }
+
+    hoNDFFT<float>::instance()->fft1c(fft_buf_, fft_res_);
+
+    ReadoutBatch::unstack_readouts(fft_res_, readouts);
+
+    for (auto& [header, acq, traj] : batch) {
+      header.number_of_samples = dRO;
       header.center_sample = (uint16_t)(header.center_sample/ratioFOV);
       header.discard_pre = (uint16_t)(header.discard_pre / ratioFOV);
       header.discard_post = (uint16_t)(header.discard_post / ratioFOV);
 
-      acq = *temp;
+      out.push(Core::Acquisition{header, std::move(acq), std::move(traj)});
     }
-    out.push(Core::Acquisition{header, std::move(acq), std::move(traj)});
   }
 }
 GADGETRON_GADGET_EXPORT(RemoveROOversamplingGadget)
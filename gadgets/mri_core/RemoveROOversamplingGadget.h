@@ -12,9 +12,6 @@
 #include "hoNDArray.h"
 #include "hoNDFFT.h"
 #include "ismrmrd/xml.h"
-#ifdef USE_OMP // TODO: Should this be removed? Its from the old version
-#include "omp.h"
-#endif // USE_OMP
 
 namespace Gadgetron {
 class RemoveROOversamplingGadget : public Core::ChannelGadget<Core::Acquisition> {
@@ -24,7 +21,12 @@ class RemoveROOversamplingGadget : public Core::ChannelGadget<Core::Acquisition>
     ~RemoveROOversamplingGadget() override = default;
     void process(Core::InputChannel<Core::Acquisition>& input, Core::OutputChannel& output) override;
 
+    // Runs single threaded, the readouts are too short to gain from threading
+    size_t thread_budget() const override { return 1; }
+
   protected:
+    NODE_PROPERTY(readout_batch_size, size_t, "Maximum number of consecutive readouts transformed together", 32);
+
     hoNDArray<std::complex<float>> fft_res_;
     hoNDArray<std::complex<float>> ifft_res_;
 
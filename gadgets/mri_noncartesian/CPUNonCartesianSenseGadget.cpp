@@ -0,0 +1,235 @@
+#include "CPUNonCartesianSenseGadget.h"
+#include "mri_core_coil_map_estimation.h"
+#include "vector_td_utilities.h"
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+#include "hoNFFT.h"
+#include "hoNDArray.h"
+#include "hoNDArray_elemwise.h"
+#include "hoNDArray_math.h"
+#include "ImageArraySendMixin.h"
+#include "NonCartesianTools.h"
+#include "NFFTOperator.h"
+#include "hoNDArray_converter.h"
+#include "GriddingReconGadgetBase.hpp"
+
+#include <algorithm>
+
+#ifdef USE_OMP
+#include <omp.h>
+#endif
+
+namespace Gadgetron{
+
+    CPUNonCartesianSenseGadget::CPUNonCartesianSenseGadget() : use_split_bregman_(false) {
+
+    }
+
+    CPUNonCartesianSenseGadget::~CPUNonCartesianSenseGadget() {
+
+    }
+
+    int CPUNonCartesianSenseGadget::process_config(ACE_Message_Block* mb)
+    {
+        int res = GriddingReconGadgetBase<hoNDArray>::process_config(mb);
+        if (res != GADGET_OK) return res;
+
+        use_split_bregman_ = (solver.value() == "sb");
+        toeplitz_plans_ = toeplitz.value();
+
+        E_ = boost::make_shared< hoNonCartesianSenseOperator<float,2> >();
+        D_ = boost::make_shared< hoCgPreconditioner<float_complext> >();
+
+        const auto output_mode = verbose.value() ? hoCgSolver<float_complext>::OUTPUT_VERBOSE : hoCgSolver<float_complext>::OUTPUT_SILENT;
+
+        if (use_split_bregman_) {
+            E_->set_weight(mu.value());
+
+            Rx_ = boost::make_shared< hoPartialDerivativeOperator<float_complext,2> >(0);
+            Rx_->set_weight(lambda.value());
+            Ry_ = boost::make_shared< hoPartialDerivativeOperator<float_complext,2> >(1);
+            Ry_->set_weight(lambda.value());
+
+            sb_.set_encoding_operator(E_);
+            sb_.add_regularization_group_operator(Rx_);
+            sb_.add_regularization_group_operator(Ry_);
+            sb_.add_group();
+            sb_.set_max_outer_iterations(number_of_sb_iterations.value());
+            sb_.set_max_inner_iterations(1);
+            sb_.set_output_mode(output_mode);
+
+            sb_.get_inner_solver()->set_max_iterations(number_of_cg_iterations.value());
+            sb_.get_inner_solver()->set_tc_tolerance(cg_limit.value());
+            sb_.get_inner_solver()->set_preconditioner(D_);
+        } else {
+            R_ = boost::make_shared< hoImageOperator<float_complext> >();
+            R_->set_weight(kappa.value());
+
+            cg_.set_encoding_operator(E_);
+            cg_.add_regularization_operator(R_);
+            cg_.set_preconditioner(D_);
+            cg_.set_max_iterations(number_of_cg_iterations.value());
+            cg_.set_tc_tolerance(cg_limit.value());
+            cg_.set_output_mode(output_mode);
+        }
+
+        return GADGET_OK;
+    }
+
+    int CPUNonCartesianSenseGadget::process(Gadgetron::GadgetContainerMessage< IsmrmrdReconData >* m1)
+    {
+        std::unique_ptr<GadgetronTimer> timer;
+        if (perform_timing) { timer = std::make_unique<GadgetronTimer>("CPU non-Cartesian Sense recon"); }
+        process_called_times++;
+
+        IsmrmrdReconData* recon_bit_ = m1->getObjectPtr();
+
+        // for every encoding space
+        for (size_t e = 0; e < recon_bit_->rbit_.size(); e++)
+        {
+            IsmrmrdDataBuffered* buffer = &(recon_bit_->rbit_[e].data_);
+
+            size_t E2 = buffer->data_.get_size(2);
+            size_t CHA = buffer->data_.get_size(3);
+
+            if (E2 > 1) {
+                GERROR("3D data is not supported in CPUNonCartesianSenseGadget\n");
+                m1->release();
+                return GADGET_FAIL;
+            }
+
+            if (buffer->trajectory_ == Core::none) {
+                GERROR("Trajectories not found. Bailing out.\n");
+                m1->release();
+                return GADGET_FAIL;
+            }
+
+            auto plan = acquire_plan(*buffer->trajectory_, buffer->headers_[0].trajectory_dimensions, true);
+
+            std::vector<size_t> new_order = {0,1,2,4,5,6,3};
+            auto data = permute(*(hoNDArray<float_complext>*)&buffer->data_,new_order);
+
+            // The trajectory either covers the whole buffer, or one frame shared by every N, S and SLC of it
+            const size_t samples = buffer->trajectory_->get_number_of_elements() / buffer->headers_[0].trajectory_dimensions;
+            const size_t frames = data.get_number_of_elements() / (samples * CHA);
+            const size_t N = data.get_size(3), S = data.get_size(4), SLC = data.get_size(5);
+
+            if (samples * frames * CHA != data.get_number_of_elements() || (frames > 1 && frames != N * S * SLC)) {
+                GERROR("The trajectory does not match the data of the buffer\n");
+                m1->release();
+                return GADGET_FAIL;
+            }
+
+            std::vector<size_t> image_dims = {image_dims_[0], image_dims_[1], 1, 1};
+            if (frames > 1) image_dims.insert(image_dims.end(), {N, S, SLC});
+            hoNDArray<float_complext> images(image_dims);
+
+            const size_t pixels = image_dims_[0] * image_dims_[1];
+            hoNDArray<float_complext> frame_data(samples, CHA);
+
+            for (size_t f = 0; f < frames; f++) {
+                for (size_t c = 0; c < CHA; c++) {
+                    std::copy_n(data.get_data_ptr() + (c * frames + f) * samples, samples,
+                                frame_data.get_data_ptr() + c * samples);
+                }
+
+                auto image = reconstruct_sense(frame_data, *plan, CHA);
+                std::copy_n(image.get_data_ptr(), pixels, images.get_data_ptr() + f * pixels);
+            }
+
+            IsmrmrdImageArray imarray;
+            imarray.data_ = std::move(reinterpret_cast<hoNDArray<std::complex<float>>&>(images));
+
+            NonCartesian::append_image_header(imarray,recon_bit_->rbit_[e], e);
+            this->prepare_image_array(imarray, e, ((int)e + 1), GADGETRON_IMAGE_REGULAR);
+
+            this->next()->putq(new GadgetContainerMessage<IsmrmrdImageArray>(std::move(imarray)));
+        }
+
+        m1->release();
+        return GADGET_OK;
+    }
+
+    hoNDArray<float_complext> CPUNonCartesianSenseGadget::reconstruct_sense(hoNDArray<float_complext>& data,
+        PlanCache::Entry& plan, size_t ncoils)
+    {
+        std::unique_ptr<GadgetronTimer> timer;
+        if (perform_timing) { timer = std::make_unique<GadgetronTimer>("Sense reconstruct"); }
+
+        // Grid the coils, for the coil sensitivities and the regularization image
+        //
+
+        std::vector<size_t> coil_dims = image_dims_;
+        coil_dims.push_back(ncoils);
+        hoNDArray<float_complext> coil_images(coil_dims);
+        plan.plan->compute(data, coil_images, plan.dcw.get(), NFFT_comp_mode::BACKWARDS_NC2C);
+
+        auto csm = boost::make_shared<hoNDArray<float_complext>>(estimate_b1_map<float,2>(coil_images));
+
+        E_->set_domain_dimensions(image_dims_);
+        E_->set_codomain_dimensions(data.get_dimensions());
+        E_->set_plan(plan.plan);
+        E_->set_dcw(plan.dcw_sqrt);
+        E_->set_csm(csm);
+
+        // The kernel is kept with the cached plan, so it is only computed for new trajectories
+        if (toeplitz.value())
+            E_->preprocess_toeplitz();
+
+        hoNDArray<float_complext> reg_image(image_dims_);
+        E_->mult_csm_conj_sum(&coil_images, &reg_image);
+
+        // Preconditioning weights, 1/sqrt(sum_c |csm_c|^2 + kappa*R)
+        //
+
+        boost::shared_ptr< hoNDArray<float> > R_diag;
+        if (!use_split_bregman_) {
+            R_->compute(&reg_image);
+            R_diag = R_->get();
+        }
+
+        const size_t pixels = reg_image.get_number_of_elements();
+        const float_complext* pcsm = csm->get_data_ptr();
+        const float kappa_value = kappa.value();
+
+        auto precon_weights = boost::make_shared<hoNDArray<float_complext>>(image_dims_);
+        float_complext* pw = precon_weights->get_data_ptr();
+
+#ifdef USE_OMP
+#pragma omp parallel for
+#endif
+        for (long long i = 0; i < (long long)pixels; i++) {
+            float w = R_diag ? kappa_value*(*R_diag)[i] : 0.0f;
+            for (size_t c = 0; c < ncoils; c++)
+                w += norm(pcsm[c*pixels+i]);
+            pw[i] = float_complext(w > 0.0f ? 1.0f/std::sqrt(w) : 0.0f);
+        }
+        D_->set_weights(precon_weights);
+
+        // Weight the data and solve
+        //
+
+        if (plan.dcw_sqrt)
+            data *= *plan.dcw_sqrt;
+
+        boost::shared_ptr< hoNDArray<float_complext> > result;
+
+        if (use_split_bregman_) {
+            Rx_->set_domain_dimensions(image_dims_);
+            Rx_->set_codomain_dimensions(image_dims_);
+            Ry_->set_domain_dimensions(image_dims_);
+            Ry_->set_codomain_dimensions(image_dims_);
+
+            result = sb_.solve(&data);
+        } else {
+            result = cg_.solve(&data);
+        }
+
+        if (!result.get())
+            throw std::runtime_error("CPUNonCartesianSenseGadget: the iterative Sense solver failed");
+
+        return std::move(*result);
+    }
+
+    GADGET_FACTORY_DECLARE(CPUNonCartesianSenseGadget);
+}
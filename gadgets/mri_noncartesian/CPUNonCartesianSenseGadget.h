@@ -0,0 +1,68 @@
+/**
+	\brief CPU iterative non-Cartesian Sense reconstruction gadget
+
+	Reconstructs 2D non-Cartesian data with the coil sensitivities estimated from
+	the gridded coil images, using either conjugate gradient Sense with an image
+	space regularization, or split Bregman Sense with total variation.
+	The NFFT plans come from the plan cache of the gridding recon, and all coils
+	are transformed in one batched, multithreaded NFFT.
+*/
+
+#pragma once
+#include "gadgetron_mri_noncartesian_export.h"
+#include "hoNDArray.h"
+#include "GriddingReconGadgetBase.h"
+#include "hoNonCartesianSenseOperator.h"
+#include "hoCgSolver.h"
+#include "hoSbCgSolver.h"
+#include "hoCgPreconditioner.h"
+#include "hoImageOperator.h"
+#include "hoPartialDerivativeOperator.h"
+
+namespace Gadgetron{
+
+	class EXPORTGADGETSMRINONCARTESIAN CPUNonCartesianSenseGadget : public GriddingReconGadgetBase<hoNDArray> {
+
+	public:
+
+		GADGET_DECLARE(CPUNonCartesianSenseGadget);
+
+		CPUNonCartesianSenseGadget();
+
+		~CPUNonCartesianSenseGadget();
+
+		GADGET_PROPERTY_LIMITS(solver, std::string, "Iterative solver, conjugate gradient or split Bregman", "cg",
+			GadgetPropertyLimitsEnumeration, "cg", "sb");
+		GADGET_PROPERTY(kappa, float, "Regularization factor kappa of the conjugate gradient solver", 0.3);
+		GADGET_PROPERTY(number_of_cg_iterations, int, "Max number of iterations in CG solver", 10);
+		GADGET_PROPERTY(cg_limit, float, "Residual limit for CG convergence", 1e-6);
+		GADGET_PROPERTY(number_of_sb_iterations, int, "Number of split Bregman iterations", 20);
+		GADGET_PROPERTY(mu, float, "Mu regularization parameter of the split Bregman solver", 1.0);
+		GADGET_PROPERTY(lambda, float, "Lambda (total variation) regularization parameter of the split Bregman solver", 2.0);
+		GADGET_PROPERTY(toeplitz, bool, "Use Toeplitz embedding of the normal equations instead of gridding in every iteration", true);
+
+	protected:
+
+		virtual int process_config(ACE_Message_Block* mb) override;
+		virtual int process(Gadgetron::GadgetContainerMessage< IsmrmrdReconData >* m1) override;
+
+		// Sense reconstruction of one frame, with dimensions [samples of the plan, coils]. The data is weighted in place.
+		hoNDArray<float_complext> reconstruct_sense(hoNDArray<float_complext>& data,
+			PlanCache::Entry& plan, size_t ncoils);
+
+		bool use_split_bregman_;
+
+		hoCgSolver<float_complext> cg_;
+		hoSbCgSolver<float_complext> sb_;
+
+		boost::shared_ptr< hoNonCartesianSenseOperator<float,2> > E_;
+		boost::shared_ptr< hoCgPreconditioner<float_complext> > D_;
+
+		// Regularization image operator of the conjugate gradient solver
+		boost::shared_ptr< hoImageOperator<float_complext> > R_;
+
+		// Total variation operators of the split Bregman solver
+		boost::shared_ptr< hoPartialDerivativeOperator<float_complext,2> > Rx_;
+		boost::shared_ptr< hoPartialDerivativeOperator<float_complext,2> > Ry_;
+	};
+}
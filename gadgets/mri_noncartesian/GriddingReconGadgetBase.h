@@ -2,6 +2,7 @@
 
 #include "generic_recon_gadgets/GenericReconGadget.h"
 #include "gadgetron_mri_noncartesian_export.h"
+#include "NFFTPlanCache.h"
 
 namespace Gadgetron {
 
@@ -25,6 +26,8 @@ namespace Gadgetron {
 		GADGET_PROPERTY(image_series,int,"Image Series",1);
 		GADGET_PROPERTY(verbose, bool,"Verbose", false);
 	protected:
+		typedef NFFTPlanCache<ARRAY,float,2> PlanCache;
+
 		float kernel_width_;
 		float oversampling_factor_;
 		int ncoils_;
@@ -34,20 +37,26 @@ namespace Gadgetron {
 		std::vector<size_t> image_dims_;
 		uint64d2 image_dims_os_;
 
+		// Whether the plans get a Toeplitz kernel, which is then counted in the memory of the cache entries
+		bool toeplitz_plans_ = false;
+
 		virtual int process_config(ACE_Message_Block* mb) override;
 		virtual int process(Gadgetron::GadgetContainerMessage< IsmrmrdReconData >* m1) override;
 
 		void pseudo_replica(const hoNDArray<std::complex<float>>& data,
-                             ARRAY<floatd2>& traj,ARRAY<float>& dcw, const ARRAY<float_complext>& csm,
+                             typename PlanCache::Entry& plan, const ARRAY<float_complext>& csm,
                              const IsmrmrdReconBit& recon_bit, size_t encoding, size_t ncoils);
 
 		boost::shared_ptr<ARRAY<float_complext> > reconstruct(
 			ARRAY<float_complext>* data,
-			ARRAY<floatd2>* traj,
-			ARRAY<float>* dcw,
+			typename PlanCache::Entry& plan,
 			size_t ncoils );
 
-		std::tuple<boost::shared_ptr<hoNDArray<floatd2 > >, boost::shared_ptr<hoNDArray<float >>> separate_traj_and_dcw(hoNDArray<float >* traj_dcw);
+		// Preprocessed plan and density compensation weights of the trajectory, from the plan cache.
+		// Iterative reconstructions get a plan for both directions, and the square root of the weights.
+		typename PlanCache::Lease acquire_plan(const hoNDArray<float>& trajectory, size_t trajectory_dimensions, bool iterative);
+
+		std::tuple<boost::shared_ptr<hoNDArray<floatd2 > >, boost::shared_ptr<hoNDArray<float >>> separate_traj_and_dcw(const hoNDArray<float >* traj_dcw);
 
 	};
 }
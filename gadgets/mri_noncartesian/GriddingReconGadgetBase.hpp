@@ -8,6 +8,7 @@
 #include "cgSolver.h"
 #include "hoNDArray_math.h"
 #include "hoNDArray_utils.h"
+#include <algorithm>
 #include <numeric>
 #include <random>
 #include "NonCartesianTools.h"
@@ -88,34 +89,14 @@ template<template<class> class ARRAY> 	int GriddingReconGadgetBase<ARRAY>::proce
 
 			std::vector<size_t> new_order = {0,1,2,4,5,6,3};
 
-			boost::shared_ptr<ARRAY<float>> dcw;
-			boost::shared_ptr<ARRAY<floatd2>> traj;
-
-			auto & trajectory = *buffer->trajectory_;
-			
-			if (buffer->headers_[0].trajectory_dimensions == 3){
-				auto traj_dcw = separate_traj_and_dcw(&trajectory);
-				dcw = boost::make_shared<ARRAY<float>>(*std::get<1>(traj_dcw).get());
-				traj = boost::make_shared<ARRAY<floatd2>>(*std::get<0>(traj_dcw).get());
-			} else if (buffer->headers_[0].trajectory_dimensions == 2){
-				auto old_traj_dims = trajectory.get_dimensions();
-				std::vector<size_t> traj_dims (old_traj_dims.begin()+1,old_traj_dims.end()); //Remove first element
-				hoNDArray<floatd2> tmp_traj(traj_dims,(floatd2*)trajectory.get_data_ptr());
-				traj = boost::make_shared<ARRAY<floatd2>>(tmp_traj);
-			} else {
-				throw std::runtime_error("Unsupported number of trajectory dimensions");
-			}
+			// The plan is ours until the frame, and any pseudo replicas, have been reconstructed
+			auto plan = acquire_plan(*buffer->trajectory_, buffer->headers_[0].trajectory_dimensions, iterate.value());
 
 			auto permuted = permute(*(hoNDArray<float_complext>*)&buffer->data_,new_order);
 			ARRAY<float_complext> data(permuted);
-			
-			if (dcw){
-				float scale_factor = float(prod(image_dims_os_))/asum(dcw.get());
-				*dcw *= scale_factor;
-			}
 
 			//Gridding
-			auto images = reconstruct(&data,traj.get(),dcw.get(),CHA);
+			auto images = reconstruct(&data,*plan,CHA);
 
 			//Calculate coil sensitivity map
 			auto csm = estimate_b1_map<float,2>(*images);
@@ -140,7 +121,7 @@ template<template<class> class ARRAY> 	int GriddingReconGadgetBase<ARRAY>::proce
 
             //Is this where we measure SNR?
 			if (replicas.value() > 0 && snr_frame.value() == process_called_times) {
-				pseudo_replica(buffer->data_,*traj,*dcw,csm,recon_bit_->rbit_[e],e,CHA);
+				pseudo_replica(buffer->data_,*plan,csm,recon_bit_->rbit_[e],e,CHA);
 			}
 		}
 
@@ -148,26 +129,82 @@ template<template<class> class ARRAY> 	int GriddingReconGadgetBase<ARRAY>::proce
 		return GADGET_OK;
 	}
 
+template<template<class> class ARRAY> 	typename GriddingReconGadgetBase<ARRAY>::PlanCache::Lease GriddingReconGadgetBase<ARRAY>::acquire_plan(
+		const hoNDArray<float>& trajectory,
+		size_t trajectory_dimensions,
+		bool iterative) {
+
+		if (trajectory_dimensions != 2 && trajectory_dimensions != 3) {
+			throw std::runtime_error("Unsupported number of trajectory dimensions");
+		}
+
+		// Gridding with density compensation only needs the adjoint convolution
+		const bool use_dcw = trajectory_dimensions == 3;
+		const NFFT_prep_mode mode = (!iterative && use_dcw) ? NFFT_prep_mode::NC2C : NFFT_prep_mode::ALL;
+		const auto matrix_size = from_std_vector<size_t,2>(image_dims_);
+
+		auto build = [&](typename PlanCache::Entry& entry) {
+			GadgetronTimer timer("Preprocess trajectory");
+
+			boost::shared_ptr<ARRAY<floatd2>> traj;
+
+			if (use_dcw){
+				auto traj_dcw = separate_traj_and_dcw(&trajectory);
+				entry.dcw = boost::make_shared<ARRAY<float>>(*std::get<1>(traj_dcw).get());
+				traj = boost::make_shared<ARRAY<floatd2>>(*std::get<0>(traj_dcw).get());
+
+				float scale_factor = float(prod(image_dims_os_))/asum(entry.dcw.get());
+				*entry.dcw *= scale_factor;
+
+				if (iterative) {
+					entry.dcw_sqrt = boost::make_shared<ARRAY<float>>(*entry.dcw);
+					sqrt_inplace(entry.dcw_sqrt.get());
+				}
+			} else {
+				auto old_traj_dims = trajectory.get_dimensions();
+				std::vector<size_t> traj_dims (old_traj_dims.begin()+1,old_traj_dims.end()); //Remove first element
+				hoNDArray<floatd2> tmp_traj(traj_dims,(floatd2*)trajectory.get_data_ptr());
+				traj = boost::make_shared<ARRAY<floatd2>>(tmp_traj);
+			}
+
+			std::vector<size_t> flat_dims = {traj->get_number_of_elements()};
+			ARRAY<floatd2> flat_traj(flat_dims,traj->get_data_ptr());
+
+			entry.plan = NFFT<ARRAY,float,2>::make_plan(matrix_size,image_dims_os_,kernel_width_);
+			entry.plan->preprocess(flat_traj,mode);
+
+			entry.bytes = PlanCache::estimate_plan_bytes(flat_traj.get_number_of_elements(), image_dims_os_, kernel_width_, mode);
+			if (entry.dcw) entry.bytes += entry.dcw->get_number_of_bytes();
+			if (entry.dcw_sqrt) entry.bytes += entry.dcw_sqrt->get_number_of_bytes();
+
+			// The kernel has 2^D complex values per pixel; the trajectory is preprocessed as a single frame
+			if (toeplitz_plans_) entry.bytes += (size_t(1) << 2) * prod(matrix_size) * sizeof(float_complext);
+		};
+
+		auto plan = PlanCache::instance().acquire(trajectory, matrix_size, image_dims_os_, kernel_width_, mode, build);
+
+		if (verbose.value()) {
+			GDEBUG_STREAM("NFFT plan cache: " << PlanCache::instance().get_number_of_hits() << " hits, "
+				<< PlanCache::instance().get_number_of_misses() << " misses, "
+				<< (PlanCache::instance().get_number_of_bytes() >> 20) << " MB");
+		}
+
+		return plan;
+	}
+
 template<template<class> class ARRAY> 	boost::shared_ptr<ARRAY<float_complext> > GriddingReconGadgetBase<ARRAY>::reconstruct(
 		ARRAY<float_complext>* data,
-		ARRAY<floatd2>* traj,
-		ARRAY<float>* dcw,
+		typename PlanCache::Entry& plan,
 		size_t ncoils ) {
 		GadgetronTimer timer("Reconstruct");
 		//We have density compensation and iteration is set to false
-		if (!iterate.value() && dcw) { 
+		if (!iterate.value() && plan.dcw) {
 
-			auto plan = NFFT<ARRAY,float,2>::make_plan(from_std_vector<size_t,2>(image_dims_),image_dims_os_,kernel_width_);
 			std::vector<size_t> recon_dims = image_dims_;
 			recon_dims.push_back(ncoils);
 			auto result = new ARRAY<float_complext>(recon_dims);
 
-			std::vector<size_t> flat_dims = {traj->get_number_of_elements()};
-			ARRAY<floatd2> flat_traj(flat_dims,traj->get_data_ptr());
-
-			
-			plan->preprocess(flat_traj,NFFT_prep_mode::NC2C);
-			plan->compute(*data,*result,dcw,NFFT_comp_mode::BACKWARDS_NC2C);
+			plan.plan->compute(*data,*result,plan.dcw.get(),NFFT_comp_mode::BACKWARDS_NC2C);
 
 			return boost::shared_ptr<ARRAY<float_complext>>(result);
 			
@@ -179,16 +216,12 @@ template<template<class> class ARRAY> 	boost::shared_ptr<ARRAY<float_complext> >
 
                         auto data_cpy = data;
 
-			E->setup(from_std_vector<size_t,2>(image_dims_),image_dims_os_,kernel_width_);
-			if (dcw){
-                              auto dcw_sqrt = boost::make_shared<ARRAY<float>>(*dcw);
-                              sqrt_inplace(dcw_sqrt.get());
-                              E->set_dcw(boost::make_shared<ARRAY<float>>(*dcw_sqrt));
+			E->set_plan(plan.plan);
+			if (plan.dcw_sqrt){
+                              E->set_dcw(plan.dcw_sqrt);
                                 data_cpy = new ARRAY<float_complext>(*data);
-                                *data_cpy *= *dcw_sqrt;
+                                *data_cpy *= *plan.dcw_sqrt;
 			}
-			std::vector<size_t> flat_dims = {traj->get_number_of_elements()};
-			ARRAY<floatd2> flat_traj(flat_dims,traj->get_data_ptr());
 
 			E->set_domain_dimensions(recon_dims);
 			cgSolver<ARRAY<float_complext>> solver;
@@ -197,10 +230,9 @@ template<template<class> class ARRAY> 	boost::shared_ptr<ARRAY<float_complext> >
 			solver.set_tc_tolerance(iteration_tol.value());
 			solver.set_output_mode(decltype(solver)::OUTPUT_SILENT);
 			E->set_codomain_dimensions(data->get_dimensions());
-			E->preprocess(flat_traj);
 			auto res = solver.solve(data_cpy);
 
-                        if (dcw) delete data_cpy;
+                        if (plan.dcw_sqrt) delete data_cpy;
 
 			return res;
 		}
@@ -208,7 +240,7 @@ template<template<class> class ARRAY> 	boost::shared_ptr<ARRAY<float_complext> >
 
 
 template<template<class> class ARRAY> 	std::tuple<boost::shared_ptr<hoNDArray<floatd2 > >, boost::shared_ptr<hoNDArray<float >>> GriddingReconGadgetBase<ARRAY>::separate_traj_and_dcw(
-		hoNDArray<float >* traj_dcw) {
+		const hoNDArray<float >* traj_dcw) {
 		std::vector<size_t> dims = traj_dcw->get_dimensions();
 		std::vector<size_t> reduced_dims(dims.begin()+1,dims.end()); //Copy vector, but leave out first dim
 		auto  dcw = boost::make_shared<hoNDArray<float>>(reduced_dims);
@@ -228,7 +260,7 @@ template<template<class> class ARRAY> 	std::tuple<boost::shared_ptr<hoNDArray<fl
 	}
 
 template<template<class> class ARRAY> 	void GriddingReconGadgetBase<ARRAY>::pseudo_replica(const hoNDArray<std::complex<float>>& data,
-	ARRAY<floatd2>& traj,ARRAY<float>& dcw, const ARRAY<float_complext>& csm,
+	typename PlanCache::Entry& plan, const ARRAY<float_complext>& csm,
 	const IsmrmrdReconBit& recon_bit, size_t encoding, size_t ncoils) {
 		hoNDArray<std::complex<float> > rep_array(image_dims_[0], image_dims_[1], replicas.value());
 
@@ -251,7 +283,7 @@ template<template<class> class ARRAY> 	void GriddingReconGadgetBase<ARRAY>::pseu
 
 			ARRAY<float_complext> data_rep(permuted_rep);
 
-			auto images = reconstruct(&data_rep,&traj,&dcw,ncoils);
+			auto images = reconstruct(&data_rep,plan,ncoils);
 
 			//Coil combine
 			*images *= *conj(&csm);
@@ -4,6 +4,7 @@
 #include "ChannelAlgorithms.h"
 
 #include <gtest/gtest.h>
+#include <functional>
 #include <string>
 
 using testing::Types;
@@ -61,3 +62,60 @@ TEST_F(ChannelAlgortihmsTest, takeUntil) {
 
     ASSERT_EQ(i, 3);
 }
+
+namespace {
+    std::vector<std::vector<std::string>> batches_of(size_t max_size,
+        std::function<bool(const std::string&, const std::string&)> pred) {
+        auto channels = make_channel<MessageChannel>();
+        auto bypassed = make_channel<MessageChannel>();
+        InputChannel<std::string> input(channels.input, bypassed.output);
+
+        for (auto word : { "Penguins", "Are", "Awesome", "Cats", "Are", "Weird" })
+            channels.output.push(std::string(word));
+        { auto closed = std::move(channels.output); }
+
+        std::vector<std::vector<std::string>> batches;
+        for (auto messages : batch(input, max_size, pred))
+            batches.push_back(messages);
+        return batches;
+    }
+}
+
+TEST(ChannelAlgorithms, batch) {
+    auto batches = batches_of(4, [](const std::string&, const std::string&) { return true; });
+
+    ASSERT_EQ(batches.size(), 2);
+    ASSERT_EQ(batches[0].size(), 4);
+    ASSERT_EQ(batches[1].size(), 2);
+}
+
+TEST(ChannelAlgorithms, batchCompatible) {
+    auto batches = batches_of(4, [](const std::string& first, const std::string& message) {
+        return first.size() >= message.size();
+    });
+
+    std::vector<std::vector<std::string>> expected
+        = { { "Penguins"s, "Are"s, "Awesome"s, "Cats"s }, { "Are"s }, { "Weird"s } };
+    ASSERT_EQ(batches, expected);
+}
+
+TEST(ChannelAlgorithms, batchKeepsOrder) {
+    auto channels = make_channel<MessageChannel>();
+    auto bypassed = make_channel<MessageChannel>();
+    InputChannel<std::string> input(channels.input, bypassed.output);
+
+    channels.output.push("Penguins"s);
+    channels.output.push("Are"s);
+    channels.output.push(42);
+    channels.output.push("Awesome"s);
+
+    auto batch_channel = batch(input, 4, [](const std::string&, const std::string&) { return true; });
+
+    auto first = batch_channel.pop();
+    ASSERT_EQ(first, (std::vector<std::string>{ "Penguins"s, "Are"s }));
+    ASSERT_FALSE(bypassed.input.try_pop());
+
+    auto second = batch_channel.pop();
+    ASSERT_EQ(second, (std::vector<std::string>{ "Awesome"s }));
+    ASSERT_TRUE(bypassed.input.try_pop());
+}
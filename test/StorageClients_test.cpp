@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <sstream>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <boost/filesystem.hpp>
+
+#include "StorageClients.h"
+
+using namespace Gadgetron::Storage;
+
+namespace {
+
+// Counts the requests reaching the backend.
+class CountingStorageClient : public FileStorageClient {
+  public:
+    using FileStorageClient::FileStorageClient;
+
+    std::shared_ptr<std::istream> get_latest_item(StorageItemTags const& tags) override {
+        reads++;
+        return FileStorageClient::get_latest_item(tags);
+    }
+
+    StorageItem store_item(StorageItemTags const& tags, std::istream& data,
+                           std::optional<std::chrono::seconds> time_to_live) override {
+        writes++;
+        return FileStorageClient::store_item(tags, data, time_to_live);
+    }
+
+    std::atomic<int> reads{0};
+    std::atomic<int> writes{0};
+};
+
+std::string read_string(std::shared_ptr<std::istream> stream) {
+    std::stringstream ss;
+    ss << stream->rdbuf();
+    return ss.str();
+}
+
+StorageItemTags tags(const std::string& name) {
+    return StorageItemTags::Builder("subject").with_device("device").with_name(name).build();
+}
+
+class StorageClientsTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        directory = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+        backend = std::make_shared<CountingStorageClient>(directory);
+    }
+
+    void TearDown() override { boost::filesystem::remove_all(directory); }
+
+    void store(StorageClient& client, const std::string& name, const std::string& data) {
+        std::stringstream stream(data);
+        client.store_item(tags(name), stream, std::chrono::seconds(60));
+    }
+
+    boost::filesystem::path directory;
+    std::shared_ptr<CountingStorageClient> backend;
+};
+} // namespace
+
+TEST(StorageClientsTagsTest, unspecified_tags_match_anything) {
+    auto item = StorageItemTags::Builder("subject")
+                    .with_device("device")
+                    .with_name("name")
+                    .with_custom_tag("measurement", "a")
+                    .with_custom_tag("measurement", "b")
+                    .build();
+
+    EXPECT_TRUE(tags_match(StorageItemTags::Builder("subject").build(), item));
+    EXPECT_TRUE(tags_match(StorageItemTags::Builder("subject").with_custom_tag("measurement", "b").build(), item));
+    EXPECT_FALSE(tags_match(StorageItemTags::Builder("subject").with_custom_tag("measurement", "c").build(), item));
+    EXPECT_FALSE(tags_match(StorageItemTags::Builder("subject").with_session("session").build(), item));
+    EXPECT_FALSE(tags_match(StorageItemTags::Builder("other").build(), item));
+}
+
+TEST_F(StorageClientsTest, file_client_returns_latest_item) {
+    store(*backend, "noise", "first");
+    store(*backend, "noise", "second");
+    store(*backend, "other", "third");
+
+    EXPECT_EQ(read_string(backend->get_latest_item(tags("noise"))), "second");
+    EXPECT_EQ(backend->list_items(tags("noise")).items.size(), 2);
+    EXPECT_FALSE(backend->get_latest_item(tags("missing")));
+}
+
+TEST_F(StorageClientsTest, writes_are_completed_in_order) {
+    {
+        AsyncStorageClient client(backend);
+        for (int i = 0; i < 10; i++) store(client, "noise", std::to_string(i));
+    }
+
+    EXPECT_EQ(backend->writes, 10);
+    EXPECT_EQ(read_string(backend->get_latest_item(tags("noise"))), "9");
+}
+
+TEST_F(StorageClientsTest, repeated_reads_are_cached) {
+    store(*backend, "noise", "covariance");
+
+    AsyncStorageClient client(backend);
+    EXPECT_EQ(read_string(client.get_latest_item(tags("noise"))), "covariance");
+    EXPECT_EQ(read_string(client.get_latest_item(tags("noise"))), "covariance");
+    EXPECT_EQ(backend->reads, 1);
+}
+
+TEST_F(StorageClientsTest, stored_items_replace_cached_items) {
+    store(*backend, "noise", "old");
+
+    AsyncStorageClient client(backend);
+    auto query = StorageItemTags::Builder("subject").with_name("noise").build();
+    EXPECT_EQ(read_string(client.get_latest_item(query)), "old");
+
+    store(client, "noise", "new");
+    EXPECT_EQ(read_string(client.get_latest_item(query)), "new");
+
+    client.flush();
+    EXPECT_EQ(backend->writes, 2);
+    EXPECT_EQ(read_string(backend->get_latest_item(query)), "new");
+}
+
+TEST_F(StorageClientsTest, forked_processes_read_pending_writes) {
+    AsyncStorageClient client(backend);
+    for (int i = 0; i < 10; i++) store(client, "noise", std::to_string(i));
+
+    auto pid = fork();
+    if (pid == 0) {
+        bool read_latest = read_string(client.get_latest_item(tags("noise"))) == "9" &&
+                           client.list_items(tags("noise"), 20).items.size() == 10;
+        store(client, "child", "stored");
+        bool stored = bool(backend->get_latest_item(tags("child")));
+        _exit(read_latest && stored ? 0 : 1);
+    }
+
+    int status = 0;
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    ASSERT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+
+    store(client, "noise", "10");
+    EXPECT_EQ(read_string(client.get_latest_item(tags("noise"))), "10");
+}
@@ -0,0 +1,135 @@
+#include "non_local_means.h"
+#include "non_local_bayes.h"
+
+#include <gtest/gtest.h>
+#include <random>
+
+#ifdef USE_OMP
+#include <omp.h>
+#endif
+
+using namespace Gadgetron;
+
+namespace {
+
+    // Piecewise constant phantom of nx x ny, repeated over frames
+    hoNDArray<float> make_phantom(size_t nx, size_t ny, size_t frames) {
+        hoNDArray<float> phantom(nx, ny, frames);
+        for (size_t kz = 0; kz < frames; kz++) {
+            for (size_t ky = 0; ky < ny; ky++) {
+                for (size_t kx = 0; kx < nx; kx++) {
+                    float value = 10.0f;
+                    if (kx > nx / 4 && kx < nx / 2) value = 30.0f;
+                    if ((kx - nx / 2.0f) * (kx - nx / 2.0f) + (ky - ny / 2.0f) * (ky - ny / 2.0f) < ny * ny / 16.0f)
+                        value = 20.0f;
+                    phantom(kx, ky, kz) = value;
+                }
+            }
+        }
+        return phantom;
+    }
+
+    hoNDArray<float> add_noise(const hoNDArray<float> &image, float noise_std, unsigned int seed) {
+        std::mt19937 rng(seed);
+        std::normal_distribution<float> noise(0, noise_std);
+
+        hoNDArray<float> noisy(image.dimensions());
+        for (size_t i = 0; i < image.get_number_of_elements(); i++) noisy[i] = image[i] + noise(rng);
+        return noisy;
+    }
+
+    double mean_squared_error(const hoNDArray<float> &image, const hoNDArray<float> &reference) {
+        double error = 0;
+        for (size_t i = 0; i < image.get_number_of_elements(); i++) {
+            double d = image[i] - reference[i];
+            error += d * d;
+        }
+        return error / image.get_number_of_elements();
+    }
+
+    void expect_constant(const hoNDArray<float> &image, float value) {
+        for (size_t i = 0; i < image.get_number_of_elements(); i++) ASSERT_NEAR(image[i], value, 1e-3f) << "at " << i;
+    }
+}
+
+TEST(NonLocalMeans, ConstantImageIsUnchanged) {
+    hoNDArray<float> image(40, 36, 2);
+    image.fill(5.0f);
+
+    expect_constant(Denoise::non_local_means(image, 1.0f, 5), 5.0f);
+}
+
+TEST(NonLocalMeans, ReducesNoise) {
+    const float noise_std = 2.0f;
+    auto phantom = make_phantom(64, 48, 2);
+    auto noisy = add_noise(phantom, noise_std, 3);
+
+    auto denoised = Denoise::non_local_means(noisy, noise_std, 5);
+
+    ASSERT_EQ(denoised.dimensions(), noisy.dimensions());
+    EXPECT_LT(mean_squared_error(denoised, phantom), 0.5 * mean_squared_error(noisy, phantom));
+}
+
+TEST(NonLocalMeans3D, ConstantImageIsUnchanged) {
+    hoNDArray<float> image(40, 36, 10);
+    image.fill(5.0f);
+
+    expect_constant(Denoise::non_local_means_3d(image, 1.0f, 5, 2), 5.0f);
+}
+
+TEST(NonLocalMeans3D, UsesNeighbouringFrames) {
+    const float noise_std = 2.0f;
+    auto phantom = make_phantom(64, 48, 12);
+    auto noisy = add_noise(phantom, noise_std, 5);
+
+    auto denoised_2d = Denoise::non_local_means(noisy, noise_std, 5);
+    auto denoised_3d = Denoise::non_local_means_3d(noisy, noise_std, 5, 2);
+
+    ASSERT_EQ(denoised_3d.dimensions(), noisy.dimensions());
+    EXPECT_LT(mean_squared_error(denoised_3d, phantom), mean_squared_error(denoised_2d, phantom));
+}
+
+TEST(NonLocalBayes, ConstantImageIsUnchanged) {
+    hoNDArray<float> image(40, 36);
+    image.fill(5.0f);
+
+    expect_constant(Denoise::non_local_bayes(image, 1.0f, 10), 5.0f);
+}
+
+TEST(NonLocalBayes, ReducesNoise) {
+    const float noise_std = 2.0f;
+    auto phantom = make_phantom(72, 48, 2);
+    auto noisy = add_noise(phantom, noise_std, 7);
+
+    auto denoised = Denoise::non_local_bayes(noisy, noise_std, 10);
+
+    ASSERT_EQ(denoised.dimensions(), noisy.dimensions());
+    for (auto value : denoised) ASSERT_TRUE(std::isfinite(value));
+    EXPECT_LT(mean_squared_error(denoised, phantom), 0.5 * mean_squared_error(noisy, phantom));
+}
+
+TEST(NonLocalBayes, RunsInsideParallelRegion) {
+    const float noise_std = 2.0f;
+    auto phantom = make_phantom(72, 48, 1);
+    auto noisy = add_noise(phantom, noise_std, 11);
+
+    // Without nested parallelism, the inner regions get a single thread, fewer than they ask for
+#ifdef USE_OMP
+    const int max_active_levels = omp_get_max_active_levels();
+    omp_set_max_active_levels(1);
+#endif
+
+    std::vector<hoNDArray<float>> results(2);
+#pragma omp parallel for num_threads(2)
+    for (int k = 0; k < 2; k++) results[k] = Denoise::non_local_bayes(noisy, noise_std, 10);
+
+#ifdef USE_OMP
+    omp_set_max_active_levels(max_active_levels);
+#endif
+
+    for (auto &denoised : results) {
+        ASSERT_EQ(denoised.dimensions(), noisy.dimensions());
+        for (auto value : denoised) ASSERT_TRUE(std::isfinite(value));
+        EXPECT_LT(mean_squared_error(denoised, phantom), 0.5 * mean_squared_error(noisy, phantom));
+    }
+}
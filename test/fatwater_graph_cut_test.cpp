@@ -0,0 +1,101 @@
+#include "graph_cut.h"
+#include "grid_max_flow.h"
+
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace Gadgetron;
+
+namespace {
+
+    struct GraphCutProblem {
+        hoNDArray<uint16_t> field_map;
+        hoNDArray<uint16_t> proposed_field_map;
+        hoNDArray<float> residuals;
+        hoNDArray<float> lambda_map;
+    };
+
+    GraphCutProblem make_problem(size_t X, size_t Y, size_t Z, size_t fields, unsigned int seed) {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> uniform(0, 1);
+
+        GraphCutProblem problem{hoNDArray<uint16_t>(X, Y, Z), hoNDArray<uint16_t>(X, Y, Z),
+                                hoNDArray<float>(fields, X, Y, Z), hoNDArray<float>(X, Y, Z)};
+
+        for (size_t i = 0; i < problem.field_map.get_number_of_elements(); i++) {
+            problem.field_map[i] = rng() % fields;
+            problem.proposed_field_map[i] = std::min<int>(fields - 1, problem.field_map[i] + 1 + rng() % 3);
+            problem.lambda_map[i] = 3 * uniform(rng);
+        }
+
+        for (auto &r : problem.residuals) r = 100 * uniform(rng);
+
+        return problem;
+    }
+}
+
+TEST(GridMaxFlow, SimpleCut) {
+
+    // source -> 0 -> 1 -> sink, with the middle edge as the bottleneck
+    GridMaxFlow<2> graph(vector_td<int, 2>(2, 1));
+    graph.add_source_capacity(0, 5);
+    graph.add_edge_capacity(0, GridMaxFlow<2>::forward_direction(0), 2);
+    graph.add_sink_capacity(1, 4);
+
+    EXPECT_FLOAT_EQ(graph.solve(), 2);
+    EXPECT_TRUE(graph.in_source_set(0));
+    EXPECT_FALSE(graph.in_source_set(1));
+
+    graph.reset();
+    graph.add_source_capacity(0, 1);
+    graph.add_edge_capacity(0, GridMaxFlow<2>::forward_direction(0), 2);
+    graph.add_sink_capacity(1, 4);
+
+    EXPECT_FLOAT_EQ(graph.solve(true), 1);
+    EXPECT_FALSE(graph.in_source_set(0));
+    EXPECT_FALSE(graph.in_source_set(1));
+}
+
+TEST(FieldMapGraphCut, GridSolversMatchBoykovKolmogorov2D) {
+
+    auto problem = make_problem(48, 40, 1, 32, 11);
+
+    FieldMapGraphCut grid(FatWater::GraphCutSolver::grid);
+    FieldMapGraphCut grid_parallel(FatWater::GraphCutSolver::grid_parallel);
+
+    for (int iteration = 0; iteration < 3; iteration++) {
+        auto reference = update_field_map(problem.field_map, problem.proposed_field_map, problem.residuals,
+                                           problem.lambda_map);
+
+        auto result = grid.update_field_map(problem.field_map, problem.proposed_field_map, problem.residuals,
+                                            problem.lambda_map);
+        auto result_parallel = grid_parallel.update_field_map(problem.field_map, problem.proposed_field_map,
+                                                              problem.residuals, problem.lambda_map);
+
+        EXPECT_TRUE(std::equal(reference.begin(), reference.end(), result.begin()));
+        EXPECT_TRUE(std::equal(reference.begin(), reference.end(), result_parallel.begin()));
+
+        problem.field_map = reference;
+        for (size_t i = 0; i < problem.field_map.get_number_of_elements(); i++)
+            problem.proposed_field_map[i] = std::max<int>(0, problem.field_map[i] - 1 - iteration);
+    }
+}
+
+TEST(FieldMapGraphCut, GridSolversMatchBoykovKolmogorov3D) {
+
+    auto problem = make_problem(32, 24, 12, 32, 42);
+
+    auto reference = update_field_map(problem.field_map, problem.proposed_field_map, problem.residuals,
+                                       problem.lambda_map);
+
+    FieldMapGraphCut grid(FatWater::GraphCutSolver::grid);
+    auto result = grid.update_field_map(problem.field_map, problem.proposed_field_map, problem.residuals,
+                                        problem.lambda_map);
+
+    FieldMapGraphCut grid_parallel(FatWater::GraphCutSolver::grid_parallel);
+    auto result_parallel = grid_parallel.update_field_map(problem.field_map, problem.proposed_field_map,
+                                                          problem.residuals, problem.lambda_map);
+
+    EXPECT_TRUE(std::equal(reference.begin(), reference.end(), result.begin()));
+    EXPECT_TRUE(std::equal(reference.begin(), reference.end(), result_parallel.begin()));
+}
@@ -0,0 +1,97 @@
+#include "projector_table.h"
+
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace Gadgetron;
+using namespace Gadgetron::FatWater;
+
+namespace {
+
+    const std::vector<float> echo_times = {0.0012f, 0.0032f, 0.0052f, 0.0072f, 0.0092f, 0.0112f};
+    const std::vector<float> field_maps = {-200.0f, -100.0f, -25.0f, 0.0f, 25.0f, 100.0f, 200.0f};
+    const std::vector<float> r2stars = {0.0f, 20.0f, 50.0f, 100.0f};
+
+    arma::Mat<std::complex<float>> make_phi() {
+        // Water and a two peak fat model
+        arma::Mat<std::complex<float>> phi(echo_times.size(), 2);
+        for (size_t k = 0; k < echo_times.size(); k++) {
+            auto t = double(echo_times[k]);
+            phi(k, 0) = 1.0f;
+            phi(k, 1) = std::complex<float>(0.7 * std::exp(std::complex<double>(0, -2 * M_PI * 434.0 * t)) +
+                                            0.3 * std::exp(std::complex<double>(0, -2 * M_PI * 332.0 * t)));
+        }
+        return phi;
+    }
+
+    // Residual of the least squares fit of the signal columns to the shifted and decayed model, in double precision
+    double direct_residual(const arma::Mat<std::complex<float>> &phi, const arma::Mat<std::complex<float>> &signal,
+                           float field_map, float r2star) {
+
+        arma::Mat<std::complex<double>> model(phi.n_rows, phi.n_cols);
+        for (size_t k1 = 0; k1 < phi.n_rows; k1++) {
+            auto dt = double(echo_times[k1]) - echo_times[0];
+            auto shift = std::exp(std::complex<double>(-r2star * dt, 2 * M_PI * field_map * dt));
+            for (size_t k2 = 0; k2 < phi.n_cols; k2++)
+                model(k1, k2) = std::complex<double>(phi(k1, k2)) * shift;
+        }
+
+        arma::Mat<std::complex<double>> s = arma::conv_to<arma::Mat<std::complex<double>>>::from(signal);
+        arma::Mat<std::complex<double>> r = s - model * arma::pinv(model) * s;
+        return arma::accu(arma::square(arma::abs(r)));
+    }
+}
+
+TEST(ProjectorTable, MatchesDirectResidual) {
+
+    auto phi = make_phi();
+    ProjectorTable table(echo_times, phi, field_maps, r2stars);
+
+    const size_t echoes = echo_times.size();
+    const size_t columns = 3;
+
+    std::mt19937 rng(17);
+    std::normal_distribution<float> noise(0, 1);
+
+    // Signals close to the model, where the residual is a small difference of large terms
+    std::vector<arma::Mat<std::complex<float>>> signals;
+    for (size_t kf = 0; kf < field_maps.size(); kf++) {
+        for (size_t kr = 0; kr < r2stars.size(); kr++) {
+            arma::Mat<std::complex<float>> signal(echoes, columns);
+            for (size_t c = 0; c < columns; c++) {
+                std::complex<double> water(1000 + 100 * noise(rng), 100 * noise(rng));
+                std::complex<double> fat(300 * noise(rng), 300 * noise(rng));
+                for (size_t k = 0; k < echoes; k++) {
+                    auto dt = double(echo_times[k]) - echo_times[0];
+                    auto shift = std::exp(std::complex<double>(-r2stars[kr] * dt, 2 * M_PI * field_maps[kf] * dt));
+                    auto value = (water * std::complex<double>(phi(k, 0)) + fat * std::complex<double>(phi(k, 1))) * shift;
+                    signal(k, c) = std::complex<float>(value) + 0.01f * std::complex<float>(noise(rng), noise(rng));
+                }
+            }
+            signals.push_back(signal);
+        }
+    }
+
+    hoNDArray<double> covariance(table.packed_size(), signals.size());
+    for (size_t p = 0; p < signals.size(); p++)
+        ProjectorTable::pack_covariance(signals[p].memptr(), echoes, columns, 1, echoes, &covariance(0, p));
+
+    hoNDArray<float> residuals;
+    table.residuals(covariance, residuals);
+
+    ASSERT_EQ(residuals.get_size(0), field_maps.size() * r2stars.size());
+    ASSERT_EQ(residuals.get_size(1), signals.size());
+
+    for (size_t p = 0; p < signals.size(); p++) {
+        double energy = arma::accu(arma::square(arma::abs(arma::conv_to<arma::Mat<std::complex<double>>>::from(signals[p]))));
+        for (size_t kf = 0; kf < field_maps.size(); kf++) {
+            for (size_t kr = 0; kr < r2stars.size(); kr++) {
+                double expected = direct_residual(phi, signals[p], field_maps[kf], r2stars[kr]);
+                float actual = residuals(kr + kf * r2stars.size(), p);
+                EXPECT_GE(actual, 0.0f);
+                EXPECT_NEAR(actual, expected, 1e-5 * expected + 1e-10 * energy)
+                                    << "signal " << p << ", field map " << field_maps[kf] << ", R2* " << r2stars[kr];
+            }
+        }
+    }
+}
@@ -1,11 +1,14 @@
 #include "hoNDArray_elemwise.h"
+#include "hoNDArray_test_helpers.h"
 #include "complext.h"
 
 #include <gtest/gtest.h>
+#include <cmath>
 #include <complex>
 #include <vector>
 
 using namespace Gadgetron;
+using Gadgetron::Test::expect_near_arrays;
 using testing::Types;
 
 template <typename T> class hoNDArray_elemwise_TestReal : public ::testing::Test {
@@ -725,3 +728,131 @@ TYPED_TEST(hoNDArray_operators_TestCplx, nrm2) {
     EXPECT_FLOAT_EQ(1*this->dims[2], real(this->Array2[122]));
     EXPECT_FLOAT_EQ(2*this->dims[2], imag(this->Array2[122]));
 }
+
+template <typename T> class hoNDArray_elemwise_TestKernels : public ::testing::Test {
+protected:
+  virtual void SetUp() {
+    default_isa = Elemwise::instruction_set();
+  }
+  virtual void TearDown() {
+    Elemwise::set_instruction_set(default_isa);
+  }
+
+  // Sizes chosen to exercise the vector tails, the broadcasting and the multithreaded path
+  std::vector<size_t> inner_sizes = {1, 3, 7, 17, 33, 1031, 100003};
+  Elemwise::InstructionSet default_isa;
+};
+
+typedef Types<float, double, std::complex<float>, std::complex<double>> elemwiseKernelImplementations;
+TYPED_TEST_SUITE(hoNDArray_elemwise_TestKernels, elemwiseKernelImplementations);
+
+namespace {
+  template <class T> void fill_deterministic(hoNDArray<T>& x, double seed) {
+    for (size_t i = 0; i < x.size(); i++) {
+      double v = std::sin(seed + 0.37 * i) * 3;
+      if constexpr (std::is_floating_point<T>::value)
+        x[i] = T(v);
+      else
+        x[i] = T(v, std::cos(seed * 1.3 + 0.11 * i) * 2);
+    }
+  }
+}
+
+TYPED_TEST(hoNDArray_elemwise_TestKernels, matchGeneric) {
+  using T = TypeParam;
+  using R = realType_t<T>;
+
+  for (auto isa : {Elemwise::InstructionSet::Avx2, Elemwise::InstructionSet::Avx512}) {
+    if (!Elemwise::supports(isa))
+      continue;
+    SCOPED_TRACE(Elemwise::to_string(isa));
+
+    for (size_t inner : this->inner_sizes) {
+      hoNDArray<T> x(inner, 3);
+      hoNDArray<T> y(inner);
+      hoNDArray<T> y_full(inner, 3);
+      fill_deterministic(x, 0.5);
+      fill_deterministic(y, 1.5);
+      fill_deterministic(y_full, 2.5);
+
+      auto run = [&](Elemwise::InstructionSet run_isa) {
+        Elemwise::set_instruction_set(run_isa);
+        std::vector<hoNDArray<T>> results(6);
+        add(x, y, results[0]);
+        subtract(x, y_full, results[1]);
+        multiply(x, y, results[2]);
+        multiplyConj(x, y_full, results[3]);
+        results[4] = x;
+        results[4] *= T(0.75);
+        hoNDArray<R> magnitude;
+        abs(x, magnitude);
+        results[5] = hoNDArray<T>(magnitude.dimensions());
+        for (size_t i = 0; i < magnitude.size(); i++)
+          results[5][i] = T(magnitude[i]);
+        return results;
+      };
+
+      auto reference = run(Elemwise::InstructionSet::Generic);
+      auto result = run(isa);
+      for (size_t k = 0; k < reference.size(); k++) {
+        SCOPED_TRACE(k);
+        expect_near_arrays(reference[k], result[k]);
+      }
+
+      // The generic kernels against the element-wise definition
+      for (size_t i = 0; i < x.size(); i++) {
+        ASSERT_NEAR(real(reference[2][i]), real(x[i] * y[i % inner]), 1e-5);
+        ASSERT_NEAR(imag(reference[3][i]), imag(x[i] * conj(y_full[i])), 1e-5);
+      }
+    }
+  }
+}
+
+template <typename T> class hoNDArray_elemwise_TestPixelwiseMatvec : public hoNDArray_elemwise_TestKernels<T> {};
+
+typedef Types<std::complex<float>, std::complex<double>> pixelwiseMatvecImplementations;
+TYPED_TEST_SUITE(hoNDArray_elemwise_TestPixelwiseMatvec, pixelwiseMatvecImplementations);
+
+TYPED_TEST(hoNDArray_elemwise_TestPixelwiseMatvec, matchDefinition) {
+  using T = TypeParam;
+
+  // The pixel counts cover partial blocks, and the last one is large enough for the multithreaded path
+  for (size_t P : {1, 7, 513, 64 * 64}) {
+    const size_t S = 5, D = 3;
+    hoNDArray<T> a(P, S, D);
+    hoNDArray<T> x(P, S);
+    fill_deterministic(a, 0.5);
+    fill_deterministic(x, 1.5);
+
+    hoNDArray<T> expected(P, D);
+    for (size_t d = 0; d < D; d++)
+      for (size_t p = 0; p < P; p++) {
+        T sum = 0;
+        for (size_t s = 0; s < S; s++)
+          sum += a(p, s, d) * x(p, s);
+        expected(p, d) = sum;
+      }
+
+    for (auto isa : {Elemwise::InstructionSet::Generic, Elemwise::InstructionSet::Avx2, Elemwise::InstructionSet::Avx512}) {
+      if (!Elemwise::supports(isa))
+        continue;
+      SCOPED_TRACE(Elemwise::to_string(isa));
+      Elemwise::set_instruction_set(isa);
+
+      hoNDArray<T> r(P, D);
+      Elemwise::pixelwise_matvec(P, S, D, a.data(), x.data(), r.data());
+      expect_near_arrays(expected, r);
+    }
+  }
+}
+
+TEST(hoNDArray_elemwise_TestScal, complexByReal) {
+  hoNDArray<std::complex<float>> x(1031);
+  fill_deterministic(x, 0.25);
+  auto expected = x;
+  for (auto& v : expected)
+    v *= 2.5f;
+
+  x *= 2.5f;
+  expect_near_arrays(x, expected);
+}
@@ -0,0 +1,141 @@
+#include "hoNDArray_expressions.h"
+#include "hoNDArray_elemwise.h"
+#include "hoNDArray_test_helpers.h"
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <complex>
+
+using namespace Gadgetron;
+using Gadgetron::Test::expect_near_arrays;
+using testing::Types;
+
+template <typename T> class hoNDArray_expressions_Test : public ::testing::Test {
+protected:
+  virtual void SetUp() {
+    dims = {37, 49, 23};
+    a = hoNDArray<T>(dims);
+    b = hoNDArray<T>(dims);
+    c = hoNDArray<T>(dims);
+    for (size_t i = 0; i < a.size(); i++) {
+      a[i] = value(std::sin(0.1 * i), std::cos(0.3 * i));
+      b[i] = value(std::cos(0.7 * i) + 2, std::sin(0.2 * i));
+      c[i] = value(std::sin(1.3 * i), 0.5);
+    }
+  }
+
+  static T value(double re, double im) {
+    if constexpr (std::is_floating_point<T>::value)
+      return T(re);
+    else
+      return T(re, im);
+  }
+
+  std::vector<size_t> dims;
+  hoNDArray<T> a;
+  hoNDArray<T> b;
+  hoNDArray<T> c;
+};
+
+typedef Types<float, double, std::complex<float>, std::complex<double>> expressionImplementations;
+TYPED_TEST_SUITE(hoNDArray_expressions_Test, expressionImplementations);
+
+TYPED_TEST(hoNDArray_expressions_Test, multiplyConjAddScaled) {
+  using T = TypeParam;
+  const float alpha = 0.75f;
+
+  hoNDArray<T> r = this->a * conj(this->b) + alpha * this->c;
+
+  hoNDArray<T> expected;
+  multiplyConj(this->a, this->b, expected);
+  auto scaled = this->c;
+  scaled *= T(alpha);
+  expected += scaled;
+
+  expect_near_arrays(r, expected);
+}
+
+TYPED_TEST(hoNDArray_expressions_Test, subtractDivide) {
+  using T = TypeParam;
+
+  hoNDArray<T> r = (this->a - this->c) / this->b - 2.0;
+
+  hoNDArray<T> expected;
+  subtract(this->a, this->c, expected);
+  expected /= this->b;
+  expected -= T(2);
+
+  expect_near_arrays(r, expected);
+}
+
+TYPED_TEST(hoNDArray_expressions_Test, resultIsOperand) {
+  using T = TypeParam;
+
+  hoNDArray<T> expected;
+  multiply(this->a, this->b, expected);
+  expected += this->a;
+
+  auto* data = this->a.get_data_ptr();
+  this->a = this->a + this->a * this->b;
+
+  EXPECT_EQ(data, this->a.get_data_ptr());
+  expect_near_arrays(this->a, expected);
+}
+
+TYPED_TEST(hoNDArray_expressions_Test, abs) {
+  using T = TypeParam;
+  using R = realType_t<T>;
+
+  hoNDArray<R> r = abs(as_expression(this->a) * this->b);
+
+  hoNDArray<T> product;
+  multiply(this->a, this->b, product);
+  auto expected = Gadgetron::abs(product);
+
+  expect_near_arrays(r, expected);
+}
+
+TYPED_TEST(hoNDArray_expressions_Test, temporaryOperand) {
+  using T = TypeParam;
+
+  auto expression = this->a * hoNDArray<T>(this->b);
+  hoNDArray<T> r = expression;
+
+  hoNDArray<T> expected;
+  multiply(this->a, this->b, expected);
+  expect_near_arrays(r, expected);
+}
+
+TYPED_TEST(hoNDArray_expressions_Test, incompatibleSizes) {
+  using T = TypeParam;
+  hoNDArray<T> small(10);
+  EXPECT_THROW(this->a + small, std::runtime_error);
+
+  hoNDArray<T> empty;
+  EXPECT_THROW(this->a + empty, std::runtime_error);
+  EXPECT_THROW(empty * (T(2) * this->a), std::runtime_error);
+}
+
+TYPED_TEST(hoNDArray_expressions_Test, scalarWithEmptyArray) {
+  using T = TypeParam;
+  hoNDArray<T> empty;
+  hoNDArray<T> r = T(2) * empty + T(1);
+  EXPECT_EQ(r.get_number_of_elements(), 0);
+}
+
+TEST(hoNDArray_expressions_TestMixed, realTimesComplex) {
+  hoNDArray<float> weights(1000);
+  hoNDArray<std::complex<float>> data(1000);
+  for (size_t i = 0; i < data.size(); i++) {
+    weights[i] = float(i % 7);
+    data[i] = std::complex<float>(float(i), -float(i) / 2);
+  }
+
+  hoNDArray<std::complex<float>> r = weights * data + std::complex<double>(1, 1);
+  for (size_t i = 0; i < data.size(); i++)
+    EXPECT_EQ(r[i], weights[i] * data[i] + std::complex<float>(1, 1));
+
+  hoNDArray<float> magnitude = norm(as_expression(r)) - real(r * conj(r));
+  for (size_t i = 0; i < magnitude.size(); i++)
+    EXPECT_NEAR(magnitude[i], 0, 1e-3 * std::norm(r[i]));
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "hoNDArray.h"
+
+#include <gtest/gtest.h>
+#include <complex>
+
+namespace Gadgetron { namespace Test {
+
+    /// Expects two arrays of the same dimensions to match element by element, in real and imaginary part
+    template <class T>
+    void expect_near_arrays(const hoNDArray<T>& a, const hoNDArray<T>& b, double tolerance = 1e-5) {
+        using std::imag;
+        using std::real;
+        ASSERT_EQ(a.dimensions(), b.dimensions());
+        for (size_t i = 0; i < a.size(); i++) {
+            ASSERT_NEAR(real(a[i]), real(b[i]), tolerance) << "at " << i;
+            ASSERT_NEAR(imag(a[i]), imag(b[i]), tolerance) << "at " << i;
+        }
+    }
+}}
@@ -3,10 +3,14 @@
 #include "hoNDArray_reductions.h"
 #include "hoNDArray_elemwise.h"
 #include "hoNFFT.h"
+#include "NFFTPlanCache.h"
+#include "hoNonCartesianSenseOperator.h"
 #include "vector_td_utilities.h"
 #include "ImageIOAnalyze.h"
 #include "GadgetronTimer.h"
 
+#include <random>
+
 using namespace Gadgetron;
 using testing::Types;
 
@@ -151,3 +155,175 @@ TYPED_TEST(hoNFFT_2D_NC2C_BACKWARDS, randomTestOne)
 
     EXPECT_LE(v/norm_ref, 0.00001);
 }
+
+TEST(NFFTPlanCache, reuseAndEvict)
+{
+    typedef NFFTPlanCache<hoNDArray, float, 2> Cache;
+
+    const vector_td<size_t, 2> matrix_size(64, 64);
+    const vector_td<size_t, 2> matrix_size_os(96, 96);
+    const float W = 5.5f;
+
+    hoNDArray<float> traj_a(2, 128);
+    hoNDArray<float> traj_b(2, 128);
+    for (size_t i = 0; i < traj_a.get_number_of_elements(); i++) {
+        traj_a[i] = 0.5f * std::sin(float(i));
+        traj_b[i] = 0.5f * std::cos(float(i));
+    }
+
+    size_t builds = 0;
+    auto build = [&](Cache::Entry& entry) {
+        builds++;
+        entry.plan = NFFT<hoNDArray, float, 2>::make_plan(matrix_size, matrix_size_os, W);
+        entry.bytes = 1000;
+    };
+
+    Cache cache(8000);
+
+    boost::shared_ptr<NFFT_plan<hoNDArray, float, 2>> plan;
+    {
+        auto first = cache.acquire(traj_a, matrix_size, matrix_size_os, W, NFFT_prep_mode::NC2C, build);
+        plan = first->plan;
+    }
+
+    {
+        auto second = cache.acquire(traj_a, matrix_size, matrix_size_os, W, NFFT_prep_mode::NC2C, build);
+        EXPECT_EQ(builds, 1);
+        EXPECT_EQ(second->plan, plan);
+        EXPECT_EQ(cache.get_number_of_hits(), 1);
+
+        // A concurrent lease of the same trajectory gets a plan of its own instead of waiting
+        auto concurrent = cache.acquire(traj_a, matrix_size, matrix_size_os, W, NFFT_prep_mode::NC2C, build);
+        EXPECT_EQ(builds, 2);
+        EXPECT_NE(concurrent->plan, second->plan);
+        EXPECT_EQ(cache.get_number_of_entries(), 1);
+    }
+
+    // Both plans went back to the entry
+    {
+        auto first = cache.acquire(traj_a, matrix_size, matrix_size_os, W, NFFT_prep_mode::NC2C, build);
+        auto second = cache.acquire(traj_a, matrix_size, matrix_size_os, W, NFFT_prep_mode::NC2C, build);
+        EXPECT_EQ(builds, 2);
+    }
+
+    // Other trajectories and preprocessing modes get their own plans
+    cache.acquire(traj_b, matrix_size, matrix_size_os, W, NFFT_prep_mode::NC2C, build);
+    cache.acquire(traj_a, matrix_size, matrix_size_os, W, NFFT_prep_mode::ALL, build);
+    EXPECT_EQ(builds, 4);
+    EXPECT_EQ(cache.get_number_of_entries(), 3);
+
+    // Each entry is at least 1000 bytes plus its trajectory, so only the most recently used fits in 3000 bytes
+    cache.set_capacity(3000);
+    EXPECT_EQ(cache.get_number_of_entries(), 1);
+    EXPECT_LE(cache.get_number_of_bytes(), 3000);
+
+    cache.acquire(traj_a, matrix_size, matrix_size_os, W, NFFT_prep_mode::ALL, build);
+    EXPECT_EQ(builds, 4);
+
+    cache.set_capacity(0);
+    EXPECT_EQ(cache.get_number_of_entries(), 0);
+    cache.acquire(traj_a, matrix_size, matrix_size_os, W, NFFT_prep_mode::ALL, build);
+    EXPECT_EQ(builds, 5);
+    EXPECT_EQ(cache.get_number_of_entries(), 0);
+}
+
+TEST(hoNonCartesianSenseOperator, adjoint)
+{
+    const size_t matrix = 32;
+    const size_t coils = 4;
+    const size_t samples = 500;
+
+    std::mt19937 engine(17);
+    std::uniform_real_distribution<float> position(-0.5f, 0.5f);
+    std::normal_distribution<float> value;
+
+    hoNDArray<floatd2> traj(samples);
+    for (size_t i = 0; i < samples; i++)
+        traj[i] = floatd2(position(engine), position(engine));
+
+    auto csm = boost::make_shared<hoNDArray<float_complext>>(matrix, matrix, coils);
+    for (auto& c : *csm)
+        c = float_complext(value(engine), value(engine));
+
+    hoNDArray<float_complext> x(matrix, matrix);
+    for (auto& v : x)
+        v = float_complext(value(engine), value(engine));
+
+    hoNDArray<float_complext> y(samples, coils);
+    for (auto& v : y)
+        v = float_complext(value(engine), value(engine));
+
+    hoNonCartesianSenseOperator<float, 2> E;
+    E.set_domain_dimensions(x.get_dimensions());
+    E.set_codomain_dimensions(y.get_dimensions());
+    E.set_csm(csm);
+    E.setup(uint64d2(matrix, matrix), uint64d2(2 * matrix, 2 * matrix), 5.5f);
+    E.preprocess(traj);
+
+    hoNDArray<float_complext> Ex(y.get_dimensions());
+    hoNDArray<float_complext> EHy(x.get_dimensions());
+    E.mult_M(&x, &Ex);
+    E.mult_MH(&y, &EHy);
+
+    // <Ex, y> == <x, E^H y>
+    auto lhs = dot(&Ex, &y);
+    auto rhs = dot(&x, &EHy);
+    EXPECT_LE(abs(lhs - rhs), 1e-3f * abs(lhs));
+
+    // Accumulation adds to the output
+    hoNDArray<float_complext> EHy2(EHy);
+    E.mult_MH(&y, &EHy2, true);
+    EHy *= float_complext(2.0f);
+    EHy2 -= EHy;
+    EXPECT_LE(nrm2(&EHy2), 1e-5f * nrm2(&EHy));
+}
+
+TEST(hoNFFT_plan, toeplitz)
+{
+    const size_t matrix = 32;
+    const size_t samples = 2000;
+    const size_t batches = 3;
+
+    std::mt19937 engine(23);
+    std::uniform_real_distribution<float> position(-0.5f, 0.5f);
+    std::uniform_real_distribution<float> weight(0.5f, 1.5f);
+    std::normal_distribution<float> value;
+
+    hoNDArray<floatd2> traj(samples);
+    for (size_t i = 0; i < samples; i++)
+        traj[i] = floatd2(position(engine), position(engine));
+
+    hoNDArray<float> dcw(samples);
+    for (auto& w : dcw)
+        w = weight(engine);
+
+    hoNDArray<float_complext> x(matrix, matrix, batches);
+    for (auto& v : x)
+        v = float_complext(value(engine), value(engine));
+
+    hoNFFT_plan<float, 2> plan(uint64d2(matrix, matrix), uint64d2(2 * matrix, 2 * matrix), 5.5f);
+    plan.preprocess(traj, NFFT_prep_mode::ALL);
+
+    hoNDArray<float_complext> gridded(x.get_dimensions());
+    plan.mult_MH_M(x, gridded, &dcw);
+
+    plan.preprocess_toeplitz(&dcw);
+    EXPECT_TRUE(plan.is_toeplitz_preprocessed(&dcw));
+    EXPECT_FALSE(plan.is_toeplitz_preprocessed(nullptr));
+
+    // The weights are recognised by value, not by address
+    hoNDArray<float> same_dcw(dcw);
+    EXPECT_TRUE(plan.is_toeplitz_preprocessed(&same_dcw));
+    same_dcw[7] *= 2;
+    EXPECT_FALSE(plan.is_toeplitz_preprocessed(&same_dcw));
+
+    hoNDArray<float_complext> embedded(x.get_dimensions());
+    plan.mult_MH_M(x, embedded, &dcw);
+
+    embedded -= gridded;
+    EXPECT_LE(nrm2(&embedded), 1e-3f * nrm2(&gridded));
+
+    // Preprocessing a new trajectory discards the kernel
+    plan.preprocess(traj, NFFT_prep_mode::ALL);
+    EXPECT_FALSE(plan.is_toeplitz_preprocessed(&dcw));
+}
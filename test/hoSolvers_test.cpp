@@ -0,0 +1,215 @@
+#include "hoCgSolver.h"
+#include "hoCgPreconditioner.h"
+#include "hoLsqrSolver.h"
+#include "hoNDArray_math.h"
+#include "linearOperator.h"
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <random>
+
+using namespace Gadgetron;
+
+namespace {
+
+    // Dense matrix of rows x cols, stored row major
+    struct Matrix {
+        size_t rows, cols;
+        std::vector<double> values;
+
+        Matrix(size_t rows, size_t cols) : rows(rows), cols(cols), values(rows * cols, 0.0) {}
+
+        double &operator()(size_t i, size_t j) { return values[i * cols + j]; }
+        double operator()(size_t i, size_t j) const { return values[i * cols + j]; }
+    };
+
+    Matrix random_matrix(size_t rows, size_t cols, unsigned int seed) {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+
+        Matrix A(rows, cols);
+        for (auto &value : A.values) value = uniform(rng);
+        return A;
+    }
+
+    hoNDArray<double> random_vector(size_t length, unsigned int seed) {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+
+        hoNDArray<double> x(length);
+        for (size_t i = 0; i < length; i++) x[i] = uniform(rng);
+        return x;
+    }
+
+    class MatrixOperator : public linearOperator<hoNDArray<double>> {
+    public:
+        explicit MatrixOperator(Matrix A) : A(std::move(A)) {
+            this->set_domain_dimensions(std::vector<size_t>{this->A.cols});
+            this->set_codomain_dimensions(std::vector<size_t>{this->A.rows});
+        }
+
+        void mult_M(hoNDArray<double> *in, hoNDArray<double> *out, bool accumulate = false) override {
+            for (size_t i = 0; i < A.rows; i++) {
+                double sum = accumulate ? (*out)[i] : 0.0;
+                for (size_t j = 0; j < A.cols; j++) sum += A(i, j) * (*in)[j];
+                (*out)[i] = sum;
+            }
+        }
+
+        void mult_MH(hoNDArray<double> *in, hoNDArray<double> *out, bool accumulate = false) override {
+            for (size_t j = 0; j < A.cols; j++) {
+                double sum = accumulate ? (*out)[j] : 0.0;
+                for (size_t i = 0; i < A.rows; i++) sum += A(i, j) * (*in)[i];
+                (*out)[j] = sum;
+            }
+        }
+
+        const Matrix A;
+    };
+
+    // Weighted sum of the normal matrices of the operators
+    Matrix normal_matrix(const std::vector<std::pair<Matrix, double>> &terms) {
+        const size_t n = terms.front().first.cols;
+        Matrix N(n, n);
+        for (auto &term : terms) {
+            for (size_t i = 0; i < n; i++)
+                for (size_t j = 0; j < n; j++)
+                    for (size_t k = 0; k < term.first.rows; k++)
+                        N(i, j) += term.second * term.first(k, i) * term.first(k, j);
+        }
+        return N;
+    }
+
+    // Gaussian elimination with partial pivoting
+    hoNDArray<double> direct_solve(Matrix A, hoNDArray<double> b) {
+        const size_t n = A.rows;
+        for (size_t k = 0; k < n; k++) {
+            size_t pivot = k;
+            for (size_t i = k + 1; i < n; i++)
+                if (std::abs(A(i, k)) > std::abs(A(pivot, k))) pivot = i;
+
+            for (size_t j = 0; j < n; j++) std::swap(A(k, j), A(pivot, j));
+            std::swap(b[k], b[pivot]);
+
+            for (size_t i = k + 1; i < n; i++) {
+                double factor = A(i, k) / A(k, k);
+                for (size_t j = k; j < n; j++) A(i, j) -= factor * A(k, j);
+                b[i] -= factor * b[k];
+            }
+        }
+
+        hoNDArray<double> x(n);
+        for (size_t k = n; k-- > 0;) {
+            double sum = b[k];
+            for (size_t j = k + 1; j < n; j++) sum -= A(k, j) * x[j];
+            x[k] = sum / A(k, k);
+        }
+        return x;
+    }
+
+    void expect_near(const hoNDArray<double> &x, const hoNDArray<double> &expected, double tolerance) {
+        ASSERT_EQ(x.get_number_of_elements(), expected.get_number_of_elements());
+        for (size_t i = 0; i < x.get_number_of_elements(); i++) EXPECT_NEAR(x[i], expected[i], tolerance) << "at " << i;
+    }
+
+    // Least squares problem min |A x - d|^2 of 12 equations in 8 unknowns
+    class hoCgSolverTest : public ::testing::Test {
+    protected:
+        void SetUp() override {
+            encoding = boost::make_shared<MatrixOperator>(random_matrix(12, 8, 1));
+            data = random_vector(12, 2);
+
+            solver.set_encoding_operator(encoding);
+            solver.set_max_iterations(100);
+            solver.set_tc_tolerance(1e-20);
+        }
+
+        hoNDArray<double> expected(const std::vector<std::pair<Matrix, double>> &terms) {
+            hoNDArray<double> rhs(8);
+            encoding->mult_MH(&data, &rhs);
+            rhs *= terms.front().second;
+            return direct_solve(normal_matrix(terms), rhs);
+        }
+
+        // Jacobi preconditioner; the preconditioner is applied twice, so its weights are the inverse square roots
+        void set_jacobi_preconditioner(const Matrix &N) {
+            auto weights = boost::make_shared<hoNDArray<double>>(8);
+            for (size_t i = 0; i < 8; i++) (*weights)[i] = 1.0 / std::sqrt(N(i, i));
+
+            auto preconditioner = boost::make_shared<hoCgPreconditioner<double>>();
+            preconditioner->set_weights(weights);
+            solver.set_preconditioner(preconditioner);
+        }
+
+        boost::shared_ptr<MatrixOperator> encoding;
+        hoNDArray<double> data;
+        hoCgSolver<double> solver;
+    };
+}
+
+TEST_F(hoCgSolverTest, SolvesNormalEquations) {
+    auto x = solver.solve(&data);
+    expect_near(*x, expected({{encoding->A, 1.0}}), 1e-8);
+}
+
+TEST_F(hoCgSolverTest, StartsFromInitialGuess) {
+    auto x0 = boost::make_shared<hoNDArray<double>>(random_vector(8, 3));
+    solver.set_x0(x0);
+
+    auto x = solver.solve(&data);
+    expect_near(*x, expected({{encoding->A, 1.0}}), 1e-8);
+}
+
+TEST_F(hoCgSolverTest, SolvesPreconditioned) {
+    set_jacobi_preconditioner(normal_matrix({{encoding->A, 1.0}}));
+
+    auto x = solver.solve(&data);
+    expect_near(*x, expected({{encoding->A, 1.0}}), 1e-8);
+}
+
+TEST_F(hoCgSolverTest, SolvesPreconditionedFromInitialGuess) {
+    set_jacobi_preconditioner(normal_matrix({{encoding->A, 1.0}}));
+    solver.set_x0(boost::make_shared<hoNDArray<double>>(random_vector(8, 4)));
+
+    auto x = solver.solve(&data);
+    expect_near(*x, expected({{encoding->A, 1.0}}), 1e-8);
+}
+
+TEST_F(hoCgSolverTest, SolvesWeightedRegularizedProblem) {
+    // Operators with unit and other weights are accumulated differently
+    encoding->set_weight(2.0);
+    auto unit_weight = boost::make_shared<MatrixOperator>(random_matrix(5, 8, 5));
+    auto weighted = boost::make_shared<MatrixOperator>(random_matrix(8, 8, 6));
+    weighted->set_weight(0.3);
+
+    solver.add_regularization_operator(unit_weight);
+    solver.add_regularization_operator(weighted);
+
+    const std::vector<std::pair<Matrix, double>> terms{
+            {encoding->A, 2.0}, {unit_weight->A, 1.0}, {weighted->A, 0.3}
+    };
+    set_jacobi_preconditioner(normal_matrix(terms));
+
+    auto x = solver.solve(&data);
+    expect_near(*x, expected(terms), 1e-8);
+
+    // The iteration vectors are reused by a second solve
+    expect_near(*solver.solve(&data), expected(terms), 1e-8);
+}
+
+TEST(hoLsqrSolver, SolvesSquareSystem) {
+    Matrix A = random_matrix(10, 10, 7);
+    for (size_t i = 0; i < 10; i++) A(i, i) += 4.0;
+    auto b = random_vector(10, 8);
+
+    hoLsqrSolver<double> solver;
+    solver.set_encoding_operator(boost::make_shared<MatrixOperator>(A));
+    solver.set_max_iterations(100);
+    solver.set_tc_tolerance(1e-12);
+
+    auto expected = direct_solve(A, b);
+    expect_near(*solver.solve(&b), expected, 1e-8);
+
+    solver.set_x0(boost::make_shared<hoNDArray<double>>(random_vector(10, 9)));
+    expect_near(*solver.solve(&b), expected, 1e-8);
+}
@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../apps/clients/gadgetron_ismrmrd_client/dataset_sending.h"
+
+namespace {
+
+    // Serves acquisitions and waveforms with the given time stamps; each is numbered by its scan counter.
+    struct FakeDataset {
+        std::vector<uint32_t> acquisition_time_stamps;
+        std::vector<uint32_t> waveform_time_stamps;
+
+        uint32_t getNumberOfAcquisitions() { return acquisition_time_stamps.size(); }
+        uint32_t getNumberOfWaveforms() { return waveform_time_stamps.size(); }
+
+        void readAcquisition(uint32_t index, ISMRMRD::Acquisition& acq) {
+            ISMRMRD::AcquisitionHeader head;
+            head.scan_counter = index;
+            head.acquisition_time_stamp = acquisition_time_stamps[index];
+            acq.setHead(head);
+        }
+
+        void readWaveform(uint32_t index, ISMRMRD::Waveform& wav) {
+            wav.head.scan_counter = index;
+            wav.head.time_stamp = waveform_time_stamps[index];
+        }
+    };
+
+    std::string describe(DatasetItem& item) {
+        if (auto acq = std::get_if<ISMRMRD::Acquisition>(&item)) {
+            return "acq " + std::to_string(acq->getHead().scan_counter);
+        }
+        return "wav " + std::to_string(std::get<ISMRMRD::Waveform>(item).head.scan_counter);
+    }
+
+    struct FakeConnector {
+        std::vector<std::string> frames;
+        size_t fail_at = std::numeric_limits<size_t>::max();
+
+        void send_frame(std::string frame) {
+            if (frames.size() == fail_at) throw std::runtime_error("Connection lost.");
+            frames.push_back(std::move(frame));
+        }
+    };
+
+    std::vector<std::string> interleaved(FakeDataset& dataset, uint32_t chunk_size) {
+        std::mutex mutex;
+        std::vector<std::string> items;
+        for_each_dataset_item(dataset, mutex, dataset.getNumberOfAcquisitions(), dataset.getNumberOfWaveforms(),
+            chunk_size, false, [&](DatasetItem item) { items.push_back(describe(item)); });
+        return items;
+    }
+}
+
+TEST(IsmrmrdClientDatasetTest, items_are_sent_in_time_stamp_order_acquisitions_first_on_ties) {
+    FakeDataset dataset{{10, 20, 30}, {5, 20, 25, 40}};
+
+    std::vector<std::string> expected{"wav 0", "acq 0", "acq 1", "wav 1", "wav 2", "acq 2", "wav 3"};
+
+    EXPECT_EQ(interleaved(dataset, 1), expected);
+    EXPECT_EQ(interleaved(dataset, 2), expected);
+    EXPECT_EQ(interleaved(dataset, 64), expected);
+}
+
+TEST(IsmrmrdClientDatasetTest, frames_are_sent_in_order_when_encoded_concurrently) {
+    FakeDataset dataset;
+    for (uint32_t k = 0; k < 200; k++) dataset.acquisition_time_stamps.push_back(2 * k);
+    for (uint32_t k = 0; k < 100; k++) dataset.waveform_time_stamps.push_back(4 * k + 1);
+
+    // Items take varying times to encode, so they are finished out of order.
+    auto encode = [](DatasetItem& item) {
+        auto description = describe(item);
+        std::this_thread::sleep_for(std::chrono::microseconds(7 * (std::hash<std::string>()(description) % 100)));
+        return description;
+    };
+
+    std::mutex mutex;
+    FakeConnector connector;
+    send_dataset(connector, dataset, mutex, encode, 4, 16, false);
+
+    EXPECT_EQ(connector.frames, interleaved(dataset, 1));
+}
+
+TEST(IsmrmrdClientDatasetTest, send_failures_are_rethrown) {
+    FakeDataset dataset;
+    for (uint32_t k = 0; k < 100; k++) dataset.acquisition_time_stamps.push_back(k);
+
+    std::mutex mutex;
+    FakeConnector connector;
+    connector.fail_at = 5;
+
+    EXPECT_THROW(send_dataset(connector, dataset, mutex, describe, 4, 8, false), std::runtime_error);
+    EXPECT_EQ(connector.frames.size(), 5);
+}
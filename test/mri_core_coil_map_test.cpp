@@ -0,0 +1,70 @@
+#include "mri_core_coil_map_estimation.h"
+
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace Gadgetron;
+
+namespace {
+
+    // circular object with smooth coil sensitivities and additive noise, [RO E1 CHA]
+    hoNDArray<std::complex<float>> make_coil_images(size_t RO, size_t E1, size_t CHA, unsigned int seed) {
+        std::mt19937 rng(seed);
+        std::normal_distribution<float> noise(0, 0.5f);
+
+        hoNDArray<std::complex<float>> data(RO, E1, CHA);
+        for (size_t cha = 0; cha < CHA; cha++) {
+            for (size_t e1 = 0; e1 < E1; e1++) {
+                for (size_t ro = 0; ro < RO; ro++) {
+                    float dx = float(ro) - RO / 2.0f;
+                    float dy = float(e1) - E1 / 2.0f;
+                    float object = (dx * dx + dy * dy < 0.15f * RO * E1) ? 10.0f : 0.0f;
+                    auto sensitivity = std::polar(1.0f + 0.3f * std::cos(0.03f * ro * (cha + 1)),
+                                                  0.01f * (float(ro * cha) - e1) + cha);
+                    data(ro, e1, cha) = object * sensitivity * std::polar(1.0f, 0.1f * ro) +
+                                        std::complex<float>(noise(rng), noise(rng));
+                }
+            }
+        }
+        return data;
+    }
+}
+
+TEST(CoilMapInati, FastMatchesReference) {
+
+    auto data = make_coil_images(70, 53, 8, 3);
+
+    hoNDArray<std::complex<float>> reference, fast;
+    coil_map_2d_Inati(data, reference, 7, 3);
+    coil_map_2d_Inati_fast(data, fast, 7, 3);
+
+    ASSERT_EQ(reference.dimensions(), fast.dimensions());
+    for (size_t i = 0; i < reference.get_number_of_elements(); i++) {
+        EXPECT_NEAR(std::abs(reference[i] - fast[i]), 0, 2e-3);
+    }
+}
+
+TEST(CoilMapInati, LowResolutionInsideObject) {
+
+    const size_t RO = 96, E1 = 80, CHA = 8;
+    auto data = make_coil_images(RO, E1, CHA, 5);
+
+    hoNDArray<std::complex<float>> reference, low_res;
+    coil_map_2d_Inati(data, reference, 7, 3);
+    coil_map_2d_Inati_fast(data, low_res, 7, 3, 4);
+
+    double error = 0, norm = 0;
+    for (size_t cha = 0; cha < CHA; cha++) {
+        for (size_t e1 = 0; e1 < E1; e1++) {
+            for (size_t ro = 0; ro < RO; ro++) {
+                float dx = float(ro) - RO / 2.0f;
+                float dy = float(e1) - E1 / 2.0f;
+                if (dx * dx + dy * dy >= 0.1f * RO * E1) continue;
+                error += std::norm(reference(ro, e1, cha) - low_res(ro, e1, cha));
+                norm += std::norm(reference(ro, e1, cha));
+            }
+        }
+    }
+
+    EXPECT_LT(std::sqrt(error / norm), 0.05);
+}
@@ -7,6 +7,7 @@
 #include "ImageIOAnalyze.h"
 #include "GadgetronTimer.h"
 #include "pr_kmeans.h"
+#include "pr_kmeans_fast.h"
 #include <gtest/gtest.h>
 #include <random>
 
@@ -185,3 +186,73 @@ TYPED_TEST(pattern_recognition_test, kmeans_test)
 
     EXPECT_LE( std::sqrt(sumD) / N, 2.0);
 }
+
+TYPED_TEST(pattern_recognition_test, kmeans_fast_test)
+{
+    std::default_random_engine generator;
+    std::normal_distribution<float> distribution(0.0f, 1.0f);
+
+    size_t P = 3;
+    size_t N = 20000;
+    size_t K = 6;
+
+    hoNDArray<float> X;
+    X.create(P, N);
+
+    size_t n, p;
+    for (n = 0; n < N; n++)
+    {
+        for (p = 0; p < P; p++)
+        {
+            X(p, n) = distribution(generator) + ((n%K == p || n%K == p + 3) ? 6.0f : 0.0f);
+        }
+    }
+
+    Gadgetron::kmeans_fast<float> km;
+    km.max_iter_ = 300;
+    km.replicates_ = 1;
+    km.seed_ = 7;
+
+    hoNDArray<float> C_for_initial;
+    km.get_initial_guess_kmeansplusplus(X, K, C_for_initial);
+
+    std::vector<size_t> IDX_lloyd, IDX_hamerly, IDX_elkan, IDX_mini_batch;
+    hoNDArray<float> C_lloyd, C_hamerly, C_elkan, C_mini_batch;
+    float sumD_lloyd, sumD_hamerly, sumD_elkan, sumD_mini_batch;
+
+    km.bound_type_ = PR_KMEANS_BOUND_NONE;
+    km.run(X, K, C_for_initial, IDX_lloyd, C_lloyd, sumD_lloyd);
+
+    km.bound_type_ = PR_KMEANS_BOUND_HAMERLY;
+    km.run(X, K, C_for_initial, IDX_hamerly, C_hamerly, sumD_hamerly);
+
+    km.bound_type_ = PR_KMEANS_BOUND_ELKAN;
+    km.run(X, K, C_for_initial, IDX_elkan, C_elkan, sumD_elkan);
+
+    // pruning must not change the clustering
+    EXPECT_EQ(IDX_lloyd, IDX_hamerly);
+    EXPECT_EQ(IDX_lloyd, IDX_elkan);
+    EXPECT_NEAR(sumD_lloyd, sumD_hamerly, 1e-3 * sumD_lloyd);
+    EXPECT_NEAR(sumD_lloyd, sumD_elkan, 1e-3 * sumD_lloyd);
+
+    // the un-accelerated kmeans from the same start
+    Gadgetron::kmeans<float> km_ref;
+    km_ref.max_iter_ = 300;
+    km_ref.perform_online_update_ = false;
+
+    std::vector<size_t> IDX_ref;
+    hoNDArray<float> C_ref;
+    float sumD_ref;
+    km_ref.run(X, K, C_for_initial, IDX_ref, C_ref, sumD_ref);
+
+    EXPECT_NEAR(sumD_lloyd, sumD_ref, 1e-3 * sumD_ref);
+
+    km.mini_batch_threshold_ = 1000;
+    km.mini_batch_size_ = 1024;
+    km.run(X, K, C_for_initial, IDX_mini_batch, C_mini_batch, sumD_mini_batch);
+
+    EXPECT_LE(sumD_mini_batch, 1.05 * sumD_lloyd);
+
+    EXPECT_EQ(get_kmeans_bound_type("Elkan"), PR_KMEANS_BOUND_ELKAN);
+    EXPECT_EQ(get_kmeans_bound_name(PR_KMEANS_BOUND_HAMERLY), "Hamerly");
+}
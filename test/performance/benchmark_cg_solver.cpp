@@ -0,0 +1,129 @@
+//
+// Compares the conjugate gradient solver against a reference loop allocating its temporaries every iteration
+// and computing each BLAS-1 operation in a separate pass.
+//
+#include "hoCgSolver.h"
+#include "linearOperator.h"
+#include "hoNDArray_elemwise.h"
+#include "hoNDArray_math.h"
+#include "log.h"
+
+#include <chrono>
+#include <complex>
+#include <boost/make_shared.hpp>
+
+using namespace Gadgetron;
+
+typedef std::complex<float> T;
+
+#define ITERATIONS 20
+#define REPETITIONS 5
+
+// Multiplication with a fixed real diagonal
+class benchmarkDiagonalOperator : public linearOperator<hoNDArray<T> >
+{
+public:
+    benchmarkDiagonalOperator(const hoNDArray<T>& diag) : diag_(diag) {}
+
+    virtual void mult_M(hoNDArray<T>* in, hoNDArray<T>* out, bool accumulate = false)
+    {
+        if (accumulate) {
+            hoNDArray<T> tmp(in->get_dimensions());
+            multiply(diag_, *in, tmp);
+            add(*out, tmp, *out);
+        }
+        else
+            multiply(diag_, *in, *out);
+    }
+
+    virtual void mult_MH(hoNDArray<T>* in, hoNDArray<T>* out, bool accumulate = false)
+    {
+        mult_M(in, out, accumulate);
+    }
+
+protected:
+    hoNDArray<T> diag_;
+};
+
+static hoNDArray<T> make_diagonal(const std::vector<size_t>& dims)
+{
+    hoNDArray<T> diag(dims);
+    for (size_t i = 0; i < diag.get_number_of_elements(); i++)
+        diag[i] = T(1.0f + float(i % 97) / 10.0f, 0.0f);
+    return diag;
+}
+
+static hoNDArray<T> make_rhs(const std::vector<size_t>& dims)
+{
+    hoNDArray<T> b(dims);
+    for (size_t i = 0; i < b.get_number_of_elements(); i++)
+        b[i] = T(std::cos(float(i)), std::sin(float(i) * 0.5f));
+    return b;
+}
+
+// The solver loop before the workspaces were introduced
+static boost::shared_ptr<hoNDArray<T> > legacy_cg(hoNDArray<T>& diag, hoNDArray<T>& b, size_t iterations)
+{
+    auto x = boost::make_shared<hoNDArray<T> >(b.get_dimensions());
+    clear(x.get());
+
+    hoNDArray<T> r(b);
+    multiply(diag, r, r); // rhs = A^H b
+    hoNDArray<T> p(r);
+    float rq = real(dot(&r, &r));
+
+    for (size_t it = 0; it < iterations; it++) {
+        hoNDArray<T> q(p.get_dimensions());
+        multiply(diag, p, q);
+        multiply(diag, q, q);
+
+        T alpha = rq / dot(&p, &q);
+        axpy(alpha, &p, x.get());
+        axpy(-alpha, &q, &r);
+
+        float rr = real(dot(&r, &r));
+        hoNDArray<T> tmp(p);
+        scal(T(rr / rq), tmp);
+        add(r, tmp, p);
+        rq = rr;
+    }
+    return x;
+}
+
+int main()
+{
+    std::vector<size_t> dims = { 192, 192, 96 };
+
+    hoNDArray<T> diag = make_diagonal(dims);
+    hoNDArray<T> b = make_rhs(dims);
+
+    auto op = boost::make_shared<benchmarkDiagonalOperator>(diag);
+    op->set_domain_dimensions(dims);
+    op->set_codomain_dimensions(dims);
+
+    hoCgSolver<T> solver;
+    solver.set_encoding_operator(op);
+    solver.set_max_iterations(ITERATIONS);
+    solver.set_tc_tolerance(0);
+    solver.set_output_mode(hoCgSolver<T>::OUTPUT_SILENT);
+
+    boost::shared_ptr<hoNDArray<T> > x_solver, x_legacy;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < REPETITIONS; i++)
+        x_legacy = legacy_cg(diag, b, ITERATIONS);
+    auto end = std::chrono::high_resolution_clock::now();
+    GINFO_STREAM("Legacy CG took " << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() / REPETITIONS << " ms per solve" << std::endl);
+
+    start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < REPETITIONS; i++)
+        x_solver = solver.solve(&b);
+    end = std::chrono::high_resolution_clock::now();
+    GINFO_STREAM("hoCgSolver took " << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() / REPETITIONS << " ms per solve" << std::endl);
+
+    GINFO_STREAM("Workspace allocations " << solver.get_workspace().get_number_of_allocations() << std::endl);
+
+    hoNDArray<T> diff(*x_solver);
+    subtract(diff, *x_legacy, diff);
+    GINFO_STREAM("Relative difference " << nrm2(&diff) / nrm2(x_legacy.get()) << std::endl);
+}
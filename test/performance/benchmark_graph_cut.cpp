@@ -0,0 +1,82 @@
+//
+// Benchmark of the field map graph-cut solvers on synthetic 3D data
+//
+#include "graph_cut.h"
+#include "log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+using namespace Gadgetron;
+
+namespace {
+
+    double time_solver(FatWater::GraphCutSolver solver, const hoNDArray<uint16_t> &field_map,
+                       const hoNDArray<float> &residuals, const hoNDArray<float> &lambda_map, size_t fields,
+                       int iterations, hoNDArray<uint16_t> &result) {
+
+        std::mt19937 rng(4242);
+        FieldMapGraphCut graph_cut(solver);
+
+        result = field_map;
+        hoNDArray<uint16_t> proposal(field_map.dimensions());
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < iterations; i++) {
+            int step = (i % 2 ? -1 : 1) * int(1 + rng() % 3);
+            std::transform(result.begin(), result.end(), proposal.begin(), [&](uint16_t f) {
+                return uint16_t(std::min(std::max(int(f) + step, 0), int(fields - 1)));
+            });
+            result = graph_cut.update_field_map(result, proposal, residuals, lambda_map);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+
+        return std::chrono::duration<double>(end - start).count();
+    }
+}
+
+int main(int argc, char **argv) {
+
+    const size_t X = argc > 1 ? std::stoul(argv[1]) : 128;
+    const size_t Y = argc > 2 ? std::stoul(argv[2]) : 128;
+    const size_t Z = argc > 3 ? std::stoul(argv[3]) : 32;
+    const size_t fields = 100;
+    const int iterations = 20;
+
+    std::mt19937 rng(42);
+    std::normal_distribution<float> noise(0, 5);
+
+    // Smooth synthetic field map, with residuals having a minimum at the true field value
+    hoNDArray<float> residuals(fields, X, Y, Z);
+    hoNDArray<float> lambda_map(X, Y, Z);
+    for (size_t kz = 0; kz < Z; kz++) {
+        for (size_t ky = 0; ky < Y; ky++) {
+            for (size_t kx = 0; kx < X; kx++) {
+                float true_field = fields / 2 + fields / 4 * std::sin(kx * 0.05f) * std::cos(ky * 0.04f + kz * 0.1f);
+                for (size_t f = 0; f < fields; f++)
+                    residuals(f, kx, ky, kz) = std::abs(float(f) - true_field) * 10 + std::abs(noise(rng));
+                lambda_map(kx, ky, kz) = 2;
+            }
+        }
+    }
+
+    hoNDArray<uint16_t> field_map(X, Y, Z);
+    field_map.fill(fields / 2);
+
+    hoNDArray<uint16_t> reference, result;
+    double time_bk = time_solver(FatWater::GraphCutSolver::boykov_kolmogorov, field_map, residuals, lambda_map,
+                                 fields, iterations, reference);
+    std::cout << "boykov_kolmogorov: " << time_bk << " s" << std::endl;
+
+    for (auto solver : {FatWater::GraphCutSolver::grid, FatWater::GraphCutSolver::grid_parallel}) {
+        double t = time_solver(solver, field_map, residuals, lambda_map, fields, iterations, result);
+        bool identical = std::equal(reference.begin(), reference.end(), result.begin());
+        std::cout << (solver == FatWater::GraphCutSolver::grid ? "grid: " : "grid_parallel: ") << t << " s, speedup "
+                  << time_bk / t << (identical ? ", identical labelling" : ", LABELLING DIFFERS") << std::endl;
+    }
+
+    return 0;
+}
@@ -166,6 +166,35 @@ TEST_F(python_converter_test, numpy_hoNDArray_three_outputs)
     EXPECT_FLOAT_EQ(c[20], 255);
 }
 
+TEST_F(python_converter_test, numpy_hoNDArray_moved)
+{
+    GDEBUG_STREAM(" --------------------------------------------------------------------------------------------------");
+    GDEBUG_STREAM("Test passing an hoNDArray to numpy and back without copying");
+    {
+        GILLock gl;     // this is needed
+        boost::python::object main(boost::python::import("__main__"));
+        boost::python::object global(main.attr("__dict__"));
+        boost::python::exec("import numpy as np\n"
+            "def scale_in_place(a): \n"
+            "   a *= 2\n"
+            "   return a.reshape((a.size,), order='F')\n",
+            global, global);
+    }
+
+    hoNDArray<float> a;
+    a.create(32, 64);
+    Gadgetron::fill(a, float(45));
+    const float* storage = a.get_data_ptr();
+
+    PythonFunction< hoNDArray<float> > scale_in_place("__main__", "scale_in_place");
+    hoNDArray<float> b = scale_in_place(std::move(a));
+
+    EXPECT_EQ(b.get_data_ptr(), storage);
+    EXPECT_EQ(b.get_number_of_dimensions(), 1);
+    EXPECT_EQ(b.get_number_of_elements(), 32*64);
+    EXPECT_FLOAT_EQ(b[12], 90);
+}
+
 TEST_F(python_converter_test, ismrmrd_acquisitionheader)
 {
     {
@@ -0,0 +1,40 @@
+#include <gtest/gtest.h>
+#include "ThreadBudget.h"
+
+#include <thread>
+
+using namespace Gadgetron::Core;
+
+TEST(ThreadBudgetTest, limitsParallelRegions){
+    EXPECT_EQ(ThreadBudget::current(), 0);
+    const size_t unlimited = ThreadBudget::measure();
+    {
+        ThreadBudget budget{1};
+        EXPECT_EQ(ThreadBudget::current(), 1);
+        EXPECT_EQ(ThreadBudget::measure(), 1);
+    }
+    EXPECT_EQ(ThreadBudget::current(), 0);
+    EXPECT_EQ(ThreadBudget::measure(), unlimited);
+}
+
+TEST(ThreadBudgetTest, nestedBudgets){
+    ThreadBudget outer{2};
+    {
+        ThreadBudget inner{1};
+        EXPECT_EQ(ThreadBudget::current(), 1);
+        EXPECT_EQ(ThreadBudget::measure(), 1);
+    }
+    EXPECT_EQ(ThreadBudget::current(), 2);
+    EXPECT_LE(ThreadBudget::measure(), 2);
+}
+
+TEST(ThreadBudgetTest, budgetIsPerThread){
+    ThreadBudget budget{1};
+
+    size_t other_budget = 1;
+    std::thread other([&]() { other_budget = ThreadBudget::current(); });
+    other.join();
+
+    EXPECT_EQ(other_budget, 0);
+    EXPECT_EQ(ThreadBudget::current(), 1);
+}
@@ -5,6 +5,9 @@
 #include <gtest/gtest.h>
 #include "ThreadPool.h"
 
+#include <atomic>
+#include <thread>
+
 using namespace Gadgetron::Core;
 TEST(ThreadPoolTest,VoidTest){
     ThreadPool pool{4};
@@ -24,3 +27,34 @@ TEST(ThreadPoolTest,moveTest){
     pool.join();
 
 }
+
+TEST(MPMCChannelTest,boundedPushWaitsForSpace){
+    MPMCChannel<int> channel{2};
+    channel.push(1);
+    channel.push(2);
+
+    std::atomic<bool> pushed{false};
+    std::thread producer([&](){ channel.push(3); pushed = true; });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(pushed);
+
+    EXPECT_EQ(channel.pop(),1);
+    producer.join();
+    EXPECT_TRUE(pushed);
+
+    channel.close();
+    EXPECT_EQ(channel.pop(),2);
+    EXPECT_EQ(channel.pop(),3);
+    EXPECT_THROW(channel.pop(),ChannelClosed);
+}
+
+TEST(MPMCChannelTest,closeReleasesBlockedPush){
+    MPMCChannel<int> channel{1};
+    channel.push(1);
+
+    std::thread producer([&](){ EXPECT_THROW(channel.push(2),ChannelClosed); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    channel.close();
+    producer.join();
+}
@@ -1,3 +1,4 @@
+#include <stdlib.h>
 #include <string.h>
 
 #ifdef _MSC_VER
@@ -221,4 +222,28 @@ bool CPU_supports_RDTSCP() { return CPU_Rep.isIntel_ && CPU_Rep.f_81_EDX_[27]; }
 bool CPU_supports_3DNOWEXT() { return CPU_Rep.isAMD_ && CPU_Rep.f_81_EDX_[30]; }
 bool CPU_supports_3DNOW() { return CPU_Rep.isAMD_ && CPU_Rep.f_81_EDX_[31]; }
 
+namespace {
+	// XCR0, the register state enabled by the operating system
+	unsigned long long xgetbv0()
+	{
+#ifdef _MSC_VER
+		return _xgetbv(0);
+#else
+		unsigned int eax, edx;
+		__asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+		return (static_cast<unsigned long long>(edx) << 32) | eax;
+#endif
+	}
+}
+
+bool CPU_OS_supports_AVX2()
+{
+	// XMM and YMM state
+	return CPU_supports_AVX2() && CPU_supports_FMA() && CPU_supports_OSXSAVE() && (xgetbv0() & 0x6) == 0x6;
+}
 
+bool CPU_OS_supports_AVX512F()
+{
+	// XMM, YMM, opmask and ZMM state
+	return CPU_supports_AVX512F() && CPU_supports_OSXSAVE() && (xgetbv0() & 0xE6) == 0xE6;
+}
@@ -18,6 +18,11 @@ namespace Gadgetron{
         class Slice {};
         constexpr auto slice = Slice{};
     }
+
+    namespace Expressions {
+        template <class E> struct Expression;
+    }
+
    template<class... ARGS>
    struct ValidIndex : std::integral_constant<bool, Core::all_of_v<Core::is_convertible_v<ARGS,size_t>...>> {};
 
@@ -153,6 +158,13 @@ namespace Gadgetron{
     template<unsigned int D, bool C>
     hoNDArray& operator=(const hoNDArrayView<T,D,C>& view);
 
+    // Evaluation of element-wise expressions, defined in hoNDArray_expressions.h
+    template<class E>
+    hoNDArray(const Expressions::Expression<E>& expression);
+
+    template<class E>
+    hoNDArray& operator=(const Expressions::Expression<E>& expression);
+
     bool operator==(const hoNDArray& rhs) const;
 
     virtual void create(const std::vector<size_t>& dimensions);
@@ -0,0 +1,345 @@
+#include "cpp_elemwise.h"
+#include "cpp_elemwise_kernels.h"
+#include "cpuisa.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+#ifdef USE_OMP
+#include <omp.h>
+#endif // USE_OMP
+
+namespace Gadgetron {
+    namespace Elemwise {
+
+        namespace {
+
+            // Chunks are large enough to amortise the dispatch, and small enough to balance the threads
+            constexpr size_t chunk_size = 16 * 1024;
+
+            // Positions per block of pixelwise_matvec; a block of one channel stays in L1, and of all channels in L2
+            constexpr size_t pixel_block_size = 512;
+
+            InstructionSet best_instruction_set() {
+                if (CPU_OS_supports_AVX512F()) return InstructionSet::Avx512;
+                if (CPU_OS_supports_AVX2()) return InstructionSet::Avx2;
+                return InstructionSet::Generic;
+            }
+
+            std::atomic<InstructionSet>& active_instruction_set() {
+                static std::atomic<InstructionSet> isa(best_instruction_set());
+                return isa;
+            }
+
+            namespace Generic {
+
+                template <class T> void add(size_t n, const T* x, const T* y, T* r) {
+                    for (size_t i = 0; i < n; i++) r[i] = x[i] + y[i];
+                }
+
+                template <class T> void subtract(size_t n, const T* x, const T* y, T* r) {
+                    for (size_t i = 0; i < n; i++) r[i] = x[i] - y[i];
+                }
+
+                template <class T> void multiply(size_t n, const T* x, const T* y, T* r) {
+                    for (size_t i = 0; i < n; i++) r[i] = x[i] * y[i];
+                }
+
+                template <class T> void complex_multiply(size_t n, const T* x, const T* y, T* r) {
+                    for (size_t i = 0; i < 2 * n; i += 2) {
+                        const T ar = x[i], ai = x[i + 1], br = y[i], bi = y[i + 1];
+                        r[i] = ar * br - ai * bi;
+                        r[i + 1] = ar * bi + ai * br;
+                    }
+                }
+
+                template <class T> void complex_multiply_conj(size_t n, const T* x, const T* y, T* r) {
+                    for (size_t i = 0; i < 2 * n; i += 2) {
+                        const T ar = x[i], ai = x[i + 1], br = y[i], bi = y[i + 1];
+                        r[i] = ar * br + ai * bi;
+                        r[i + 1] = ai * br - ar * bi;
+                    }
+                }
+
+                template <class T> void complex_multiply_add(size_t n, const T* x, const T* y, T* r) {
+                    for (size_t i = 0; i < 2 * n; i += 2) {
+                        const T ar = x[i], ai = x[i + 1], br = y[i], bi = y[i + 1];
+                        r[i] += ar * br - ai * bi;
+                        r[i + 1] += ar * bi + ai * br;
+                    }
+                }
+
+                template <class T> void abs(size_t n, const T* x, T* r) {
+                    for (size_t i = 0; i < n; i++) r[i] = std::abs(x[i]);
+                }
+
+                template <class T> void complex_abs(size_t n, const T* x, T* r) {
+                    for (size_t i = 0; i < n; i++) r[i] = std::sqrt(x[2 * i] * x[2 * i] + x[2 * i + 1] * x[2 * i + 1]);
+                }
+
+                template <class T> void scal(size_t n, T a, T* x) {
+                    for (size_t i = 0; i < n; i++) x[i] *= a;
+                }
+
+                template <class T> void complex_scal(size_t n, T a_re, T a_im, T* x) {
+                    for (size_t i = 0; i < 2 * n; i += 2) {
+                        const T re = x[i], im = x[i + 1];
+                        x[i] = re * a_re - im * a_im;
+                        x[i + 1] = re * a_im + im * a_re;
+                    }
+                }
+            }
+
+#define GADGETRON_ELEMWISE_DISPATCH(isa, kernel, ...)                                                              \
+    switch (isa) {                                                                                                  \
+    case InstructionSet::Avx512: Avx512::kernel(__VA_ARGS__); break;                                                \
+    case InstructionSet::Avx2: Avx2::kernel(__VA_ARGS__); break;                                                    \
+    default: Generic::kernel(__VA_ARGS__); break;                                                                   \
+    }
+
+            /**
+             * Calls f(begin, end) for consecutive chunks of [0, N), in parallel for large N.
+             */
+            template <class F> void parallel_chunks(size_t N, F&& f) {
+                const long long num_chunks = (long long)((N + chunk_size - 1) / chunk_size);
+
+#pragma omp parallel for schedule(static) if (N > parallel_threshold)
+                for (long long c = 0; c < num_chunks; c++) {
+                    const size_t begin = size_t(c) * chunk_size;
+                    f(begin, std::min(begin + chunk_size, N));
+                }
+            }
+
+            /**
+             * Applies kernel(n, x, y, r) over x of outer*inner elements, with y repeated for every outer index.
+             * Sizes are in scalars; stride is the number of scalars per element (2 for complex).
+             */
+            template <class T, class Kernel>
+            void broadcast_apply(size_t outer, size_t inner, size_t stride, const T* x, const T* y, T* r,
+                                 Kernel&& kernel) {
+                const size_t N = outer * inner;
+                parallel_chunks(N, [&](size_t begin, size_t end) {
+                    size_t pos = begin;
+                    while (pos < end) {
+                        const size_t i = pos % inner;
+                        const size_t len = std::min(end - pos, inner - i);
+                        kernel(len, x + pos * stride, y + i * stride, r + pos * stride);
+                        pos += len;
+                    }
+                });
+            }
+
+            template <class T> void add_T(size_t outer, size_t inner, size_t stride, const T* x, const T* y, T* r) {
+                const auto isa = instruction_set();
+                broadcast_apply(outer, inner, stride, x, y, r, [isa, stride](size_t n, const T* a, const T* b, T* c) {
+                    GADGETRON_ELEMWISE_DISPATCH(isa, add, n * stride, a, b, c)
+                });
+            }
+
+            template <class T>
+            void subtract_T(size_t outer, size_t inner, size_t stride, const T* x, const T* y, T* r) {
+                const auto isa = instruction_set();
+                broadcast_apply(outer, inner, stride, x, y, r, [isa, stride](size_t n, const T* a, const T* b, T* c) {
+                    GADGETRON_ELEMWISE_DISPATCH(isa, subtract, n * stride, a, b, c)
+                });
+            }
+
+            template <class T> void multiply_T(size_t outer, size_t inner, const T* x, const T* y, T* r) {
+                const auto isa = instruction_set();
+                broadcast_apply(outer, inner, 1, x, y, r, [isa](size_t n, const T* a, const T* b, T* c) {
+                    GADGETRON_ELEMWISE_DISPATCH(isa, multiply, n, a, b, c)
+                });
+            }
+
+            template <class T> void complex_multiply_T(size_t outer, size_t inner, const T* x, const T* y, T* r) {
+                const auto isa = instruction_set();
+                broadcast_apply(outer, inner, 2, x, y, r, [isa](size_t n, const T* a, const T* b, T* c) {
+                    GADGETRON_ELEMWISE_DISPATCH(isa, complex_multiply, n, a, b, c)
+                });
+            }
+
+            template <class T>
+            void complex_multiply_conj_T(size_t outer, size_t inner, const T* x, const T* y, T* r) {
+                const auto isa = instruction_set();
+                broadcast_apply(outer, inner, 2, x, y, r, [isa](size_t n, const T* a, const T* b, T* c) {
+                    GADGETRON_ELEMWISE_DISPATCH(isa, complex_multiply_conj, n, a, b, c)
+                });
+            }
+
+            template <class T> void abs_T(size_t N, const T* x, T* r) {
+                const auto isa = instruction_set();
+                parallel_chunks(N, [&](size_t begin, size_t end) {
+                    GADGETRON_ELEMWISE_DISPATCH(isa, abs, end - begin, x + begin, r + begin)
+                });
+            }
+
+            template <class T> void complex_abs_T(size_t N, const T* x, T* r) {
+                const auto isa = instruction_set();
+                parallel_chunks(N, [&](size_t begin, size_t end) {
+                    GADGETRON_ELEMWISE_DISPATCH(isa, complex_abs, end - begin, x + 2 * begin, r + begin)
+                });
+            }
+
+            template <class T> void scal_T(size_t N, T a, T* x) {
+                const auto isa = instruction_set();
+                parallel_chunks(N, [&](size_t begin, size_t end) {
+                    GADGETRON_ELEMWISE_DISPATCH(isa, scal, end - begin, a, x + begin)
+                });
+            }
+
+            template <class T> void complex_scal_T(size_t N, T a_re, T a_im, T* x) {
+                const auto isa = instruction_set();
+                parallel_chunks(N, [&](size_t begin, size_t end) {
+                    GADGETRON_ELEMWISE_DISPATCH(isa, complex_scal, end - begin, a_re, a_im, x + 2 * begin)
+                });
+            }
+
+            template <class T>
+            void pixelwise_matvec_T(size_t P, size_t S, size_t D, const T* a, const T* x, T* r) {
+                const auto isa = instruction_set();
+                const long long num_blocks = (long long)((P + pixel_block_size - 1) / pixel_block_size);
+
+#pragma omp parallel for schedule(static) if (P * S * D > parallel_threshold)
+                for (long long b = 0; b < num_blocks; b++) {
+                    const size_t begin = size_t(b) * pixel_block_size;
+                    const size_t n = std::min(pixel_block_size, P - begin);
+
+                    for (size_t d = 0; d < D; d++) {
+                        T* rd = r + 2 * (d * P + begin);
+                        const T* ad = a + 2 * (d * S * P + begin);
+                        if (S == 0) {
+                            std::fill(rd, rd + 2 * n, T(0));
+                            continue;
+                        }
+
+                        GADGETRON_ELEMWISE_DISPATCH(isa, complex_multiply, n, ad, x + 2 * begin, rd)
+                        for (size_t s = 1; s < S; s++) {
+                            GADGETRON_ELEMWISE_DISPATCH(isa, complex_multiply_add, n, ad + 2 * s * P,
+                                                        x + 2 * (s * P + begin), rd)
+                        }
+                    }
+                }
+            }
+
+#undef GADGETRON_ELEMWISE_DISPATCH
+
+            template <class T> const T* scalars(const std::complex<T>* x) {
+                return reinterpret_cast<const T*>(x);
+            }
+
+            template <class T> T* scalars(std::complex<T>* x) { return reinterpret_cast<T*>(x); }
+        }
+
+        InstructionSet instruction_set() { return active_instruction_set().load(std::memory_order_relaxed); }
+
+        bool supports(InstructionSet isa) {
+            switch (isa) {
+            case InstructionSet::Avx512: return CPU_OS_supports_AVX512F();
+            case InstructionSet::Avx2: return CPU_OS_supports_AVX2();
+            default: return true;
+            }
+        }
+
+        void set_instruction_set(InstructionSet isa) {
+            if (!supports(isa))
+                throw std::runtime_error(std::string("Instruction set not supported by this CPU: ") + to_string(isa));
+            active_instruction_set().store(isa);
+        }
+
+        const char* to_string(InstructionSet isa) {
+            switch (isa) {
+            case InstructionSet::Avx512: return "AVX-512";
+            case InstructionSet::Avx2: return "AVX2";
+            default: return "Generic";
+            }
+        }
+
+        void add(size_t outer, size_t inner, const float* x, const float* y, float* r) {
+            add_T(outer, inner, 1, x, y, r);
+        }
+        void add(size_t outer, size_t inner, const double* x, const double* y, double* r) {
+            add_T(outer, inner, 1, x, y, r);
+        }
+        void add(size_t outer, size_t inner, const std::complex<float>* x, const std::complex<float>* y,
+                 std::complex<float>* r) {
+            add_T(outer, inner, 2, scalars(x), scalars(y), scalars(r));
+        }
+        void add(size_t outer, size_t inner, const std::complex<double>* x, const std::complex<double>* y,
+                 std::complex<double>* r) {
+            add_T(outer, inner, 2, scalars(x), scalars(y), scalars(r));
+        }
+
+        void subtract(size_t outer, size_t inner, const float* x, const float* y, float* r) {
+            subtract_T(outer, inner, 1, x, y, r);
+        }
+        void subtract(size_t outer, size_t inner, const double* x, const double* y, double* r) {
+            subtract_T(outer, inner, 1, x, y, r);
+        }
+        void subtract(size_t outer, size_t inner, const std::complex<float>* x, const std::complex<float>* y,
+                      std::complex<float>* r) {
+            subtract_T(outer, inner, 2, scalars(x), scalars(y), scalars(r));
+        }
+        void subtract(size_t outer, size_t inner, const std::complex<double>* x, const std::complex<double>* y,
+                      std::complex<double>* r) {
+            subtract_T(outer, inner, 2, scalars(x), scalars(y), scalars(r));
+        }
+
+        void multiply(size_t outer, size_t inner, const float* x, const float* y, float* r) {
+            multiply_T(outer, inner, x, y, r);
+        }
+        void multiply(size_t outer, size_t inner, const double* x, const double* y, double* r) {
+            multiply_T(outer, inner, x, y, r);
+        }
+        void multiply(size_t outer, size_t inner, const std::complex<float>* x, const std::complex<float>* y,
+                      std::complex<float>* r) {
+            complex_multiply_T(outer, inner, scalars(x), scalars(y), scalars(r));
+        }
+        void multiply(size_t outer, size_t inner, const std::complex<double>* x, const std::complex<double>* y,
+                      std::complex<double>* r) {
+            complex_multiply_T(outer, inner, scalars(x), scalars(y), scalars(r));
+        }
+
+        void multiply_conj(size_t outer, size_t inner, const float* x, const float* y, float* r) {
+            multiply_T(outer, inner, x, y, r);
+        }
+        void multiply_conj(size_t outer, size_t inner, const double* x, const double* y, double* r) {
+            multiply_T(outer, inner, x, y, r);
+        }
+        void multiply_conj(size_t outer, size_t inner, const std::complex<float>* x, const std::complex<float>* y,
+                           std::complex<float>* r) {
+            complex_multiply_conj_T(outer, inner, scalars(x), scalars(y), scalars(r));
+        }
+        void multiply_conj(size_t outer, size_t inner, const std::complex<double>* x, const std::complex<double>* y,
+                           std::complex<double>* r) {
+            complex_multiply_conj_T(outer, inner, scalars(x), scalars(y), scalars(r));
+        }
+
+        void pixelwise_matvec(size_t P, size_t S, size_t D, const std::complex<float>* a,
+                              const std::complex<float>* x, std::complex<float>* r) {
+            pixelwise_matvec_T(P, S, D, scalars(a), scalars(x), scalars(r));
+        }
+        void pixelwise_matvec(size_t P, size_t S, size_t D, const std::complex<double>* a,
+                              const std::complex<double>* x, std::complex<double>* r) {
+            pixelwise_matvec_T(P, S, D, scalars(a), scalars(x), scalars(r));
+        }
+
+        void abs(size_t N, const float* x, float* r) { abs_T(N, x, r); }
+        void abs(size_t N, const double* x, double* r) { abs_T(N, x, r); }
+        void abs(size_t N, const std::complex<float>* x, float* r) { complex_abs_T(N, scalars(x), r); }
+        void abs(size_t N, const std::complex<double>* x, double* r) { complex_abs_T(N, scalars(x), r); }
+
+        void scal(size_t N, float a, float* x) { scal_T(N, a, x); }
+        void scal(size_t N, double a, double* x) { scal_T(N, a, x); }
+        void scal(size_t N, float a, std::complex<float>* x) { scal_T(2 * N, a, scalars(x)); }
+        void scal(size_t N, double a, std::complex<double>* x) { scal_T(2 * N, a, scalars(x)); }
+        void scal(size_t N, std::complex<float> a, std::complex<float>* x) {
+            complex_scal_T(N, a.real(), a.imag(), scalars(x));
+        }
+        void scal(size_t N, std::complex<double> a, std::complex<double>* x) {
+            complex_scal_T(N, a.real(), a.imag(), scalars(x));
+        }
+    }
+}
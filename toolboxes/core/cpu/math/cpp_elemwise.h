@@ -0,0 +1,80 @@
+/** \file   cpp_elemwise.h
+    \brief  Element-wise kernels for contiguous arrays, used by hoNDArray_elemwise.
+
+    Kernels are available as generic C++, AVX2 and AVX-512 implementations. The instruction set is
+    selected at runtime from the capabilities of the CPU (see cpuisa.h), and can be overridden with
+    set_instruction_set, e.g. for testing.
+
+    Arrays with more than parallel_threshold elements are processed in chunks by multiple threads.
+*/
+
+#pragma once
+
+#include <complex>
+#include <cstddef>
+
+namespace Gadgetron {
+    namespace Elemwise {
+
+        enum class InstructionSet { Generic, Avx2, Avx512 };
+
+        /// Instruction set currently used by the kernels
+        InstructionSet instruction_set();
+
+        /// True if the CPU and operating system support the instruction set
+        bool supports(InstructionSet isa);
+
+        /// Selects the instruction set used by the kernels; throws if it is not supported
+        void set_instruction_set(InstructionSet isa);
+
+        const char* to_string(InstructionSet isa);
+
+        /// Number of elements above which the kernels run multithreaded
+        constexpr size_t parallel_threshold = 64 * 1024;
+
+        // Binary operations with broadcasting of y along the outer dimension:
+        // r[o*inner + i] = x[o*inner + i] op y[i], for o < outer and i < inner.
+        // Without broadcasting, outer is 1. r may be the same array as x.
+
+        void add(size_t outer, size_t inner, const float* x, const float* y, float* r);
+        void add(size_t outer, size_t inner, const double* x, const double* y, double* r);
+        void add(size_t outer, size_t inner, const std::complex<float>* x, const std::complex<float>* y, std::complex<float>* r);
+        void add(size_t outer, size_t inner, const std::complex<double>* x, const std::complex<double>* y, std::complex<double>* r);
+
+        void subtract(size_t outer, size_t inner, const float* x, const float* y, float* r);
+        void subtract(size_t outer, size_t inner, const double* x, const double* y, double* r);
+        void subtract(size_t outer, size_t inner, const std::complex<float>* x, const std::complex<float>* y, std::complex<float>* r);
+        void subtract(size_t outer, size_t inner, const std::complex<double>* x, const std::complex<double>* y, std::complex<double>* r);
+
+        void multiply(size_t outer, size_t inner, const float* x, const float* y, float* r);
+        void multiply(size_t outer, size_t inner, const double* x, const double* y, double* r);
+        void multiply(size_t outer, size_t inner, const std::complex<float>* x, const std::complex<float>* y, std::complex<float>* r);
+        void multiply(size_t outer, size_t inner, const std::complex<double>* x, const std::complex<double>* y, std::complex<double>* r);
+
+        /// r = x * conj(y)
+        void multiply_conj(size_t outer, size_t inner, const float* x, const float* y, float* r);
+        void multiply_conj(size_t outer, size_t inner, const double* x, const double* y, double* r);
+        void multiply_conj(size_t outer, size_t inner, const std::complex<float>* x, const std::complex<float>* y, std::complex<float>* r);
+        void multiply_conj(size_t outer, size_t inner, const std::complex<double>* x, const std::complex<double>* y, std::complex<double>* r);
+
+        /// Multiplies the vector at each of P positions, e.g. the pixels of a multi-channel image, by the matrix
+        /// at that position: r[d*P + p] = sum_s a[(d*S + s)*P + p] * x[s*P + p], for d < D.
+        /// The positions are processed in blocks, so no P*S*D intermediate is needed. r must not overlap a or x.
+        void pixelwise_matvec(size_t P, size_t S, size_t D, const std::complex<float>* a, const std::complex<float>* x, std::complex<float>* r);
+        void pixelwise_matvec(size_t P, size_t S, size_t D, const std::complex<double>* a, const std::complex<double>* x, std::complex<double>* r);
+
+        /// r = |x|; for complex x, computed as sqrt(re^2 + im^2)
+        void abs(size_t N, const float* x, float* r);
+        void abs(size_t N, const double* x, double* r);
+        void abs(size_t N, const std::complex<float>* x, float* r);
+        void abs(size_t N, const std::complex<double>* x, double* r);
+
+        /// x = a * x
+        void scal(size_t N, float a, float* x);
+        void scal(size_t N, double a, double* x);
+        void scal(size_t N, float a, std::complex<float>* x);
+        void scal(size_t N, double a, std::complex<double>* x);
+        void scal(size_t N, std::complex<float> a, std::complex<float>* x);
+        void scal(size_t N, std::complex<double> a, std::complex<double>* x);
+    }
+}
@@ -0,0 +1,94 @@
+/** \file   cpp_elemwise_avx2.cpp
+    \brief  AVX2 + FMA element-wise kernels; compiled with -mavx2 -mfma (/arch:AVX2).
+*/
+
+#include "cpp_elemwise_kernels.h"
+
+#include <immintrin.h>
+
+namespace Gadgetron {
+    namespace Elemwise {
+        namespace Avx2 {
+
+            namespace {
+
+                struct FloatVec {
+                    typedef float T;
+                    typedef __m256 V;
+                    static constexpr size_t width = 8;
+
+                    static V load(const T* p) { return _mm256_loadu_ps(p); }
+                    static void store(T* p, V v) { _mm256_storeu_ps(p, v); }
+                    static V set1(T a) { return _mm256_set1_ps(a); }
+                    static V add(V a, V b) { return _mm256_add_ps(a, b); }
+                    static V sub(V a, V b) { return _mm256_sub_ps(a, b); }
+                    static V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+                    static V abs(V a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+                    static V sqrt(V a) { return _mm256_sqrt_ps(a); }
+                    static T sqrt_scalar(T a) { return _mm_cvtss_f32(_mm_sqrt_ss(_mm_set_ss(a))); }
+
+                    // [ar*br - ai*bi, ai*br + ar*bi]
+                    static V cmul(V a, V b) {
+                        V b_re = _mm256_moveldup_ps(b);
+                        V b_im = _mm256_movehdup_ps(b);
+                        V a_swap = _mm256_permute_ps(a, 0xB1);
+                        return _mm256_fmaddsub_ps(a, b_re, _mm256_mul_ps(a_swap, b_im));
+                    }
+
+                    // [ar*br + ai*bi, ai*br - ar*bi]
+                    static V cmulconj(V a, V b) {
+                        V b_re = _mm256_moveldup_ps(b);
+                        V b_im = _mm256_movehdup_ps(b);
+                        V a_swap = _mm256_permute_ps(a, 0xB1);
+                        return _mm256_fmsubadd_ps(a, b_re, _mm256_mul_ps(a_swap, b_im));
+                    }
+
+                    static V cnorm2(V a, V b) {
+                        // hadd gives |z|^2 in the order 0 1 4 5 | 2 3 6 7
+                        V h = _mm256_hadd_ps(_mm256_mul_ps(a, a), _mm256_mul_ps(b, b));
+                        return _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(h), _MM_SHUFFLE(3, 1, 2, 0)));
+                    }
+                };
+
+                struct DoubleVec {
+                    typedef double T;
+                    typedef __m256d V;
+                    static constexpr size_t width = 4;
+
+                    static V load(const T* p) { return _mm256_loadu_pd(p); }
+                    static void store(T* p, V v) { _mm256_storeu_pd(p, v); }
+                    static V set1(T a) { return _mm256_set1_pd(a); }
+                    static V add(V a, V b) { return _mm256_add_pd(a, b); }
+                    static V sub(V a, V b) { return _mm256_sub_pd(a, b); }
+                    static V mul(V a, V b) { return _mm256_mul_pd(a, b); }
+                    static V abs(V a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+                    static V sqrt(V a) { return _mm256_sqrt_pd(a); }
+                    static T sqrt_scalar(T a) { return _mm_cvtsd_f64(_mm_sqrt_sd(_mm_setzero_pd(), _mm_set_sd(a))); }
+
+                    static V cmul(V a, V b) {
+                        V b_re = _mm256_movedup_pd(b);
+                        V b_im = _mm256_permute_pd(b, 0xF);
+                        V a_swap = _mm256_permute_pd(a, 0x5);
+                        return _mm256_fmaddsub_pd(a, b_re, _mm256_mul_pd(a_swap, b_im));
+                    }
+
+                    static V cmulconj(V a, V b) {
+                        V b_re = _mm256_movedup_pd(b);
+                        V b_im = _mm256_permute_pd(b, 0xF);
+                        V a_swap = _mm256_permute_pd(a, 0x5);
+                        return _mm256_fmsubadd_pd(a, b_re, _mm256_mul_pd(a_swap, b_im));
+                    }
+
+                    static V cnorm2(V a, V b) {
+                        // hadd gives |z|^2 in the order 0 2 1 3
+                        V h = _mm256_hadd_pd(_mm256_mul_pd(a, a), _mm256_mul_pd(b, b));
+                        return _mm256_permute4x64_pd(h, _MM_SHUFFLE(3, 1, 2, 0));
+                    }
+                };
+            }
+
+#include "cpp_elemwise_simd.hxx"
+
+        }
+    }
+}
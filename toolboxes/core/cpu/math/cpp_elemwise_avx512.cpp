@@ -0,0 +1,96 @@
+/** \file   cpp_elemwise_avx512.cpp
+    \brief  AVX-512F element-wise kernels; compiled with -mavx512f (/arch:AVX512).
+*/
+
+#include "cpp_elemwise_kernels.h"
+
+#include <immintrin.h>
+
+namespace Gadgetron {
+    namespace Elemwise {
+        namespace Avx512 {
+
+            namespace {
+
+                struct FloatVec {
+                    typedef float T;
+                    typedef __m512 V;
+                    static constexpr size_t width = 16;
+
+                    static V load(const T* p) { return _mm512_loadu_ps(p); }
+                    static void store(T* p, V v) { _mm512_storeu_ps(p, v); }
+                    static V set1(T a) { return _mm512_set1_ps(a); }
+                    static V add(V a, V b) { return _mm512_add_ps(a, b); }
+                    static V sub(V a, V b) { return _mm512_sub_ps(a, b); }
+                    static V mul(V a, V b) { return _mm512_mul_ps(a, b); }
+                    static V abs(V a) { return _mm512_abs_ps(a); }
+                    static V sqrt(V a) { return _mm512_sqrt_ps(a); }
+                    static T sqrt_scalar(T a) { return _mm_cvtss_f32(_mm_sqrt_ss(_mm_set_ss(a))); }
+
+                    static V cmul(V a, V b) {
+                        V b_re = _mm512_moveldup_ps(b);
+                        V b_im = _mm512_movehdup_ps(b);
+                        V a_swap = _mm512_permute_ps(a, 0xB1);
+                        return _mm512_fmaddsub_ps(a, b_re, _mm512_mul_ps(a_swap, b_im));
+                    }
+
+                    static V cmulconj(V a, V b) {
+                        V b_re = _mm512_moveldup_ps(b);
+                        V b_im = _mm512_movehdup_ps(b);
+                        V a_swap = _mm512_permute_ps(a, 0xB1);
+                        return _mm512_fmsubadd_ps(a, b_re, _mm512_mul_ps(a_swap, b_im));
+                    }
+
+                    static V cnorm2(V a, V b) {
+                        const __m512i even = _mm512_set_epi32(30, 28, 26, 24, 22, 20, 18, 16, 14, 12, 10, 8, 6, 4, 2, 0);
+                        const __m512i odd = _mm512_set_epi32(31, 29, 27, 25, 23, 21, 19, 17, 15, 13, 11, 9, 7, 5, 3, 1);
+                        V a2 = _mm512_mul_ps(a, a);
+                        V b2 = _mm512_mul_ps(b, b);
+                        return _mm512_add_ps(_mm512_permutex2var_ps(a2, even, b2), _mm512_permutex2var_ps(a2, odd, b2));
+                    }
+                };
+
+                struct DoubleVec {
+                    typedef double T;
+                    typedef __m512d V;
+                    static constexpr size_t width = 8;
+
+                    static V load(const T* p) { return _mm512_loadu_pd(p); }
+                    static void store(T* p, V v) { _mm512_storeu_pd(p, v); }
+                    static V set1(T a) { return _mm512_set1_pd(a); }
+                    static V add(V a, V b) { return _mm512_add_pd(a, b); }
+                    static V sub(V a, V b) { return _mm512_sub_pd(a, b); }
+                    static V mul(V a, V b) { return _mm512_mul_pd(a, b); }
+                    static V abs(V a) { return _mm512_abs_pd(a); }
+                    static V sqrt(V a) { return _mm512_sqrt_pd(a); }
+                    static T sqrt_scalar(T a) { return _mm_cvtsd_f64(_mm_sqrt_sd(_mm_setzero_pd(), _mm_set_sd(a))); }
+
+                    static V cmul(V a, V b) {
+                        V b_re = _mm512_movedup_pd(b);
+                        V b_im = _mm512_permute_pd(b, 0xFF);
+                        V a_swap = _mm512_permute_pd(a, 0x55);
+                        return _mm512_fmaddsub_pd(a, b_re, _mm512_mul_pd(a_swap, b_im));
+                    }
+
+                    static V cmulconj(V a, V b) {
+                        V b_re = _mm512_movedup_pd(b);
+                        V b_im = _mm512_permute_pd(b, 0xFF);
+                        V a_swap = _mm512_permute_pd(a, 0x55);
+                        return _mm512_fmsubadd_pd(a, b_re, _mm512_mul_pd(a_swap, b_im));
+                    }
+
+                    static V cnorm2(V a, V b) {
+                        const __m512i even = _mm512_set_epi64(14, 12, 10, 8, 6, 4, 2, 0);
+                        const __m512i odd = _mm512_set_epi64(15, 13, 11, 9, 7, 5, 3, 1);
+                        V a2 = _mm512_mul_pd(a, a);
+                        V b2 = _mm512_mul_pd(b, b);
+                        return _mm512_add_pd(_mm512_permutex2var_pd(a2, even, b2), _mm512_permutex2var_pd(a2, odd, b2));
+                    }
+                };
+            }
+
+#include "cpp_elemwise_simd.hxx"
+
+        }
+    }
+}
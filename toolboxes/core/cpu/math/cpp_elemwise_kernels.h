@@ -0,0 +1,51 @@
+/** \file   cpp_elemwise_kernels.h
+    \brief  Instruction set specific kernels behind cpp_elemwise.h.
+
+    Each instruction set is compiled in its own translation unit with the matching compiler flags,
+    and is only called after the runtime check in cpp_elemwise.cpp. These translation units must not
+    include standard library headers, so that no inline library code compiled for a newer instruction
+    set can be picked by the linker for the rest of the library.
+
+    Complex arrays are passed as interleaved real/imaginary pairs; n is the number of complex elements.
+*/
+
+#pragma once
+
+#include <cstddef>
+
+namespace Gadgetron {
+    namespace Elemwise {
+
+#define GADGETRON_ELEMWISE_DECLARE_KERNELS                                                                  \
+        void add(size_t n, const float* x, const float* y, float* r);                                      \
+        void add(size_t n, const double* x, const double* y, double* r);                                   \
+        void subtract(size_t n, const float* x, const float* y, float* r);                                 \
+        void subtract(size_t n, const double* x, const double* y, double* r);                              \
+        void multiply(size_t n, const float* x, const float* y, float* r);                                 \
+        void multiply(size_t n, const double* x, const double* y, double* r);                              \
+        void complex_multiply(size_t n, const float* x, const float* y, float* r);                         \
+        void complex_multiply(size_t n, const double* x, const double* y, double* r);                      \
+        void complex_multiply_conj(size_t n, const float* x, const float* y, float* r);                    \
+        void complex_multiply_conj(size_t n, const double* x, const double* y, double* r);                 \
+        void complex_multiply_add(size_t n, const float* x, const float* y, float* r);                     \
+        void complex_multiply_add(size_t n, const double* x, const double* y, double* r);                  \
+        void abs(size_t n, const float* x, float* r);                                                      \
+        void abs(size_t n, const double* x, double* r);                                                    \
+        void complex_abs(size_t n, const float* x, float* r);                                              \
+        void complex_abs(size_t n, const double* x, double* r);                                            \
+        void scal(size_t n, float a, float* x);                                                            \
+        void scal(size_t n, double a, double* x);                                                          \
+        void complex_scal(size_t n, float a_re, float a_im, float* x);                                     \
+        void complex_scal(size_t n, double a_re, double a_im, double* x);
+
+        namespace Avx2 {
+            GADGETRON_ELEMWISE_DECLARE_KERNELS
+        }
+
+        namespace Avx512 {
+            GADGETRON_ELEMWISE_DECLARE_KERNELS
+        }
+
+#undef GADGETRON_ELEMWISE_DECLARE_KERNELS
+    }
+}
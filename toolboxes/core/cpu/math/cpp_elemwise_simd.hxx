@@ -0,0 +1,151 @@
+/** \file   cpp_elemwise_simd.hxx
+    \brief  Kernels of cpp_elemwise_kernels.h, written against a vector traits class.
+
+    Included by the instruction set specific translation units, inside their namespace, after defining
+    FloatVec and DoubleVec with:
+        T, V, width, load, store, set1, add, sub, mul, abs, sqrt, sqrt_scalar,
+        cmul(a, b) = a*b and cmulconj(a, b) = a*conj(b) on interleaved complex values,
+        cnorm2(a, b) = |z|^2 of the 2*width/2 complex values in a and b, in order.
+*/
+
+namespace {
+
+    struct AddOp {
+        template <class VT> static typename VT::V vec(typename VT::V a, typename VT::V b) { return VT::add(a, b); }
+        template <class T> static T scalar(T a, T b) { return a + b; }
+    };
+
+    struct SubtractOp {
+        template <class VT> static typename VT::V vec(typename VT::V a, typename VT::V b) { return VT::sub(a, b); }
+        template <class T> static T scalar(T a, T b) { return a - b; }
+    };
+
+    struct MultiplyOp {
+        template <class VT> static typename VT::V vec(typename VT::V a, typename VT::V b) { return VT::mul(a, b); }
+        template <class T> static T scalar(T a, T b) { return a * b; }
+    };
+
+    template <class VT, class Op>
+    inline void binary_kernel(size_t n, const typename VT::T* x, const typename VT::T* y, typename VT::T* r) {
+        size_t i = 0;
+        for (; i + VT::width <= n; i += VT::width)
+            VT::store(r + i, Op::template vec<VT>(VT::load(x + i), VT::load(y + i)));
+        for (; i < n; i++)
+            r[i] = Op::scalar(x[i], y[i]);
+    }
+
+    template <class VT, bool Conj>
+    inline void complex_multiply_kernel(size_t n, const typename VT::T* x, const typename VT::T* y, typename VT::T* r) {
+        typedef typename VT::T T;
+        const size_t N = 2 * n;
+        size_t i = 0;
+        for (; i + VT::width <= N; i += VT::width) {
+            auto a = VT::load(x + i);
+            auto b = VT::load(y + i);
+            VT::store(r + i, Conj ? VT::cmulconj(a, b) : VT::cmul(a, b));
+        }
+        for (; i < N; i += 2) {
+            const T ar = x[i], ai = x[i + 1];
+            const T br = y[i], bi = Conj ? -y[i + 1] : y[i + 1];
+            r[i] = ar * br - ai * bi;
+            r[i + 1] = ar * bi + ai * br;
+        }
+    }
+
+    // r += x*y
+    template <class VT>
+    inline void complex_multiply_add_kernel(size_t n, const typename VT::T* x, const typename VT::T* y, typename VT::T* r) {
+        typedef typename VT::T T;
+        const size_t N = 2 * n;
+        size_t i = 0;
+        for (; i + VT::width <= N; i += VT::width)
+            VT::store(r + i, VT::add(VT::load(r + i), VT::cmul(VT::load(x + i), VT::load(y + i))));
+        for (; i < N; i += 2) {
+            const T ar = x[i], ai = x[i + 1], br = y[i], bi = y[i + 1];
+            r[i] += ar * br - ai * bi;
+            r[i + 1] += ar * bi + ai * br;
+        }
+    }
+
+    template <class VT>
+    inline void abs_kernel(size_t n, const typename VT::T* x, typename VT::T* r) {
+        size_t i = 0;
+        for (; i + VT::width <= n; i += VT::width)
+            VT::store(r + i, VT::abs(VT::load(x + i)));
+        for (; i < n; i++)
+            r[i] = x[i] < 0 ? -x[i] : x[i];
+    }
+
+    template <class VT>
+    inline void complex_abs_kernel(size_t n, const typename VT::T* x, typename VT::T* r) {
+        size_t i = 0;
+        for (; i + VT::width <= n; i += VT::width) {
+            auto a = VT::load(x + 2 * i);
+            auto b = VT::load(x + 2 * i + VT::width);
+            VT::store(r + i, VT::sqrt(VT::cnorm2(a, b)));
+        }
+        for (; i < n; i++)
+            r[i] = VT::sqrt_scalar(x[2 * i] * x[2 * i] + x[2 * i + 1] * x[2 * i + 1]);
+    }
+
+    template <class VT>
+    inline void scal_kernel(size_t n, typename VT::T a, typename VT::T* x) {
+        const auto va = VT::set1(a);
+        size_t i = 0;
+        for (; i + VT::width <= n; i += VT::width)
+            VT::store(x + i, VT::mul(va, VT::load(x + i)));
+        for (; i < n; i++)
+            x[i] *= a;
+    }
+
+    template <class VT>
+    inline void complex_scal_kernel(size_t n, typename VT::T a_re, typename VT::T a_im, typename VT::T* x) {
+        typedef typename VT::T T;
+        T pattern[VT::width];
+        for (size_t k = 0; k < VT::width; k += 2) {
+            pattern[k] = a_re;
+            pattern[k + 1] = a_im;
+        }
+        const auto va = VT::load(pattern);
+
+        const size_t N = 2 * n;
+        size_t i = 0;
+        for (; i + VT::width <= N; i += VT::width)
+            VT::store(x + i, VT::cmul(VT::load(x + i), va));
+        for (; i < N; i += 2) {
+            const T re = x[i], im = x[i + 1];
+            x[i] = re * a_re - im * a_im;
+            x[i + 1] = re * a_im + im * a_re;
+        }
+    }
+}
+
+void add(size_t n, const float* x, const float* y, float* r) { binary_kernel<FloatVec, AddOp>(n, x, y, r); }
+void add(size_t n, const double* x, const double* y, double* r) { binary_kernel<DoubleVec, AddOp>(n, x, y, r); }
+
+void subtract(size_t n, const float* x, const float* y, float* r) { binary_kernel<FloatVec, SubtractOp>(n, x, y, r); }
+void subtract(size_t n, const double* x, const double* y, double* r) { binary_kernel<DoubleVec, SubtractOp>(n, x, y, r); }
+
+void multiply(size_t n, const float* x, const float* y, float* r) { binary_kernel<FloatVec, MultiplyOp>(n, x, y, r); }
+void multiply(size_t n, const double* x, const double* y, double* r) { binary_kernel<DoubleVec, MultiplyOp>(n, x, y, r); }
+
+void complex_multiply(size_t n, const float* x, const float* y, float* r) { complex_multiply_kernel<FloatVec, false>(n, x, y, r); }
+void complex_multiply(size_t n, const double* x, const double* y, double* r) { complex_multiply_kernel<DoubleVec, false>(n, x, y, r); }
+
+void complex_multiply_conj(size_t n, const float* x, const float* y, float* r) { complex_multiply_kernel<FloatVec, true>(n, x, y, r); }
+void complex_multiply_conj(size_t n, const double* x, const double* y, double* r) { complex_multiply_kernel<DoubleVec, true>(n, x, y, r); }
+
+void complex_multiply_add(size_t n, const float* x, const float* y, float* r) { complex_multiply_add_kernel<FloatVec>(n, x, y, r); }
+void complex_multiply_add(size_t n, const double* x, const double* y, double* r) { complex_multiply_add_kernel<DoubleVec>(n, x, y, r); }
+
+void abs(size_t n, const float* x, float* r) { abs_kernel<FloatVec>(n, x, r); }
+void abs(size_t n, const double* x, double* r) { abs_kernel<DoubleVec>(n, x, r); }
+
+void complex_abs(size_t n, const float* x, float* r) { complex_abs_kernel<FloatVec>(n, x, r); }
+void complex_abs(size_t n, const double* x, double* r) { complex_abs_kernel<DoubleVec>(n, x, r); }
+
+void scal(size_t n, float a, float* x) { scal_kernel<FloatVec>(n, a, x); }
+void scal(size_t n, double a, double* x) { scal_kernel<DoubleVec>(n, a, x); }
+
+void complex_scal(size_t n, float a_re, float a_im, float* x) { complex_scal_kernel<FloatVec>(n, a_re, a_im, x); }
+void complex_scal(size_t n, double a_re, double a_im, double* x) { complex_scal_kernel<DoubleVec>(n, a_re, a_im, x); }
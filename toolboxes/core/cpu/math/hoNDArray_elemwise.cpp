@@ -102,6 +102,13 @@ namespace Gadgetron {
         if (r.get_number_of_elements() != x.get_number_of_elements()) {
             r.create(x.dimensions());
         }
+
+        using E = typename ::gadgetron_detail::elemwiseType<T>::type;
+        if constexpr (::gadgetron_detail::has_elemwise_kernel<E> && std::is_same<R, realType_t<T>>::value) {
+            Elemwise::abs(x.get_number_of_elements(), reinterpret_cast<const E*>(x.data()), r.data());
+            return;
+        }
+
         transform(x,r,[](auto val){return abs(val);});
     }
 
@@ -117,8 +124,9 @@ namespace Gadgetron {
     template  void abs(const hoNDArray<complext<double>>& x, hoNDArray<complext<double>>& r);
 
     template <class T> hoNDArray<realType_t<T>> abs(const hoNDArray<T>& x) {
-        using std::abs;
-        return transform(x,[](auto val){return abs(val);}) ;
+        hoNDArray<realType_t<T>> r(x.dimensions());
+        abs(x, r);
+        return r;
     }
 
     template  hoNDArray<float> abs(const hoNDArray<float>& x);
@@ -13,6 +13,76 @@ namespace {
         template <class T> struct mathInternalType { typedef T type; };
         template <class T> struct mathInternalType<std::complex<T>> { typedef Gadgetron::complext<T> type; };
 
+        //
+        // Element types of the Elemwise kernels (cpp_elemwise.h)
+        // this replaces complext<T> with std::complex<T>
+        //
+        template <class T> struct elemwiseType { typedef T type; };
+        template <class T> struct elemwiseType<Gadgetron::complext<T>> { typedef std::complex<T> type; };
+
+        template <class T>
+        constexpr bool has_elemwise_kernel = std::is_same<T, float>::value || std::is_same<T, double>::value
+            || std::is_same<T, std::complex<float>>::value || std::is_same<T, std::complex<double>>::value;
+
+        // Scaling is supported for a real or complex array by a scalar of the same precision, but a real
+        // array cannot be scaled by a complex scalar
+        template <class T, class S>
+        constexpr bool has_elemwise_scal = has_elemwise_kernel<T> && has_elemwise_kernel<S>
+            && std::is_same<realType_t<T>, realType_t<S>>::value
+            && !(std::is_floating_point<T>::value && !std::is_floating_point<S>::value);
+
+        struct multiply_conj {
+            template <class A, class B> auto operator()(const A& a, const B& b) const { return a * conj(b); }
+        };
+
+        // Maps the binary operators onto the Elemwise kernels
+        template <class Op> struct elemwise_kernel { static constexpr bool available = false; };
+
+        template <> struct elemwise_kernel<std::plus<>> {
+            static constexpr bool available = true;
+            template <class T> static void apply(size_t outer, size_t inner, const T* x, const T* y, T* r) {
+                Elemwise::add(outer, inner, x, y, r);
+            }
+        };
+
+        template <> struct elemwise_kernel<std::minus<>> {
+            static constexpr bool available = true;
+            template <class T> static void apply(size_t outer, size_t inner, const T* x, const T* y, T* r) {
+                Elemwise::subtract(outer, inner, x, y, r);
+            }
+        };
+
+        template <> struct elemwise_kernel<std::multiplies<>> {
+            static constexpr bool available = true;
+            template <class T> static void apply(size_t outer, size_t inner, const T* x, const T* y, T* r) {
+                Elemwise::multiply(outer, inner, x, y, r);
+            }
+        };
+
+        template <> struct elemwise_kernel<multiply_conj> {
+            static constexpr bool available = true;
+            template <class T> static void apply(size_t outer, size_t inner, const T* x, const T* y, T* r) {
+                Elemwise::multiply_conj(outer, inner, x, y, r);
+            }
+        };
+
+        // Runs the operation with the Elemwise kernels if they support the types, operator and broadcasting.
+        // Returns false if the generic implementation has to be used.
+        template <class T, class S, class R, class BinaryOperator>
+        inline bool try_elemwise_kernel(size_t sizeX, size_t sizeY, const T* x, const S* y, R* r, const BinaryOperator&) {
+            using kernel = elemwise_kernel<std::decay_t<BinaryOperator>>;
+            using E = typename elemwiseType<T>::type;
+            if constexpr (kernel::available && std::is_same<T, S>::value && std::is_same<T, R>::value
+                          && has_elemwise_kernel<E>) {
+                if (sizeY == 0 || sizeX < sizeY || sizeX % sizeY != 0)
+                    return false;
+                kernel::apply(sizeX / sizeY, sizeY, reinterpret_cast<const E*>(x), reinterpret_cast<const E*>(y),
+                    reinterpret_cast<E*>(r));
+                return true;
+            }
+            return false;
+        }
+
         // --------------------------------------------------------------------------------
 
         // internal low level function for element-wise addition of two arrays
@@ -28,11 +98,14 @@ namespace {
             typename mathInternalType<typename mathReturnType<T, S>::type>::type *c
                     = reinterpret_cast<typename mathInternalType<typename mathReturnType<T, S>::type>::type *>(r);
 
+            if (try_elemwise_kernel(sizeX, sizeY, x, y, r, op))
+                return;
+
             if (sizeX == sizeY) {
                 // No Broadcasting
                 long long loopsize = sizeX;
-                long long n;
 
+#pragma omp parallel for if (sizeX > Elemwise::parallel_threshold)
                 for ( long long n = 0; n < loopsize; n++) {
                     c[n] = op(a[n], b[n]);
                 }
@@ -40,7 +113,7 @@ namespace {
                 // Broadcasting
                 long long outerloopsize = sizeX / sizeY;
                 long long innerloopsize = sizeX / outerloopsize;
-                // No OMP at All
+#pragma omp parallel for if (sizeX > Elemwise::parallel_threshold)
                 for (long long outer = 0; outer < outerloopsize; outer++) {
                     size_t offset = outer * innerloopsize;
                     const typename mathInternalType<T>::type *ai = &a[offset];
@@ -117,7 +190,7 @@ void Gadgetron::divide(
 template <class T, class S>
 void Gadgetron::multiplyConj(
     const hoNDArray<T>& x, const hoNDArray<S>& y, hoNDArray<typename mathReturnType<T, S>::type>& r) {
-    ::gadgetron_detail::transform_arrays(x, y, r, [](auto& a, auto& b) { return a * conj(b); });
+    ::gadgetron_detail::transform_arrays(x, y, r, ::gadgetron_detail::multiply_conj());
 }
 
 template <class T, class S> Gadgetron::hoNDArray<T>& Gadgetron::operator+=(hoNDArray<T>& x, const hoNDArray<S>& y) {
@@ -141,6 +214,7 @@ template <class T, class S> Gadgetron::hoNDArray<T>& Gadgetron::operator+=(hoNDA
     long long n;
     size_t N = x.get_number_of_elements();
 
+#pragma omp parallel for if (N > Elemwise::parallel_threshold)
     for (n = 0; n < (long long)N; ++n) {
         x[n] += y;
     }
@@ -155,6 +229,7 @@ template <class T, class S> Gadgetron::hoNDArray<T>& Gadgetron::operator-=(hoNDA
 
     size_t N = x.get_number_of_elements();
 
+#pragma omp parallel for if (N > Elemwise::parallel_threshold)
     for (n = 0; n < (long long)N; ++n) {
         x[n] -= y;
     }
@@ -164,10 +239,18 @@ template <class T, class S> Gadgetron::hoNDArray<T>& Gadgetron::operator-=(hoNDA
 
 template <class T, class S> Gadgetron::hoNDArray<T>& Gadgetron::operator*=(hoNDArray<T>& x, const S& y) {
 
+    using E = typename ::gadgetron_detail::elemwiseType<T>::type;
+    using ES = typename ::gadgetron_detail::elemwiseType<S>::type;
+    if constexpr (::gadgetron_detail::has_elemwise_scal<E, ES>) {
+        Elemwise::scal(x.get_number_of_elements(), reinterpret_cast<const ES&>(y), reinterpret_cast<E*>(x.data()));
+        return x;
+    }
+
     long long n;
 
     size_t N = x.get_number_of_elements();
 
+#pragma omp parallel for if (N > Elemwise::parallel_threshold)
     for (n = 0; n < (long long)N; ++n) {
         x[n] *= y;
     }
@@ -184,6 +267,7 @@ template <class T, class S> Gadgetron::hoNDArray<T>& Gadgetron::operator/=(hoNDA
     size_t N = x.get_number_of_elements();
 
 
+#pragma omp parallel for if (N > Elemwise::parallel_threshold)
     for (n = 0; n < (long long)N; ++n) {
         x[n] /= y;
     }
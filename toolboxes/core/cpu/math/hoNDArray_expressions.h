@@ -0,0 +1,396 @@
+/** \file   hoNDArray_expressions.h
+    \brief  Lazy element-wise expressions over hoNDArray.
+
+    Arithmetic on arrays builds an expression tree instead of computing intermediate arrays. The tree is
+    evaluated when it is assigned to a hoNDArray, in a single pass over memory, vectorised and in parallel:
+
+        hoNDArray<std::complex<float>> r = a * conj(b) + alpha * c;
+        r = r - 0.5f * abs(as_expression(a));
+
+    Operands are arrays, expressions or scalars. Array operands must have the same number of elements; scalars
+    are broadcast. Scalars are converted to the precision of the array they are combined with, so
+    2.0 * hoNDArray<std::complex<float>> is evaluated in single precision.
+
+    The result may be one of the operands (e.g. r = r + x), as every element only depends on the same element
+    of the operands. Arrays passed as temporaries are moved into the expression, so expressions can outlive
+    the statement they are created in; arrays passed as lvalues are referenced and must outlive the expression.
+
+    Since abs, real and imag of a hoNDArray already return arrays (hoNDArray_elemwise.h), use as_expression to
+    apply them lazily to an array.
+*/
+
+#pragma once
+
+#include "hoNDArray.h"
+#include "cpp_elemwise.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifdef USE_OMP
+#include <omp.h>
+#endif // USE_OMP
+
+namespace Gadgetron {
+    namespace Expressions {
+
+        template <class E> struct Expression {
+            const E& derived() const { return static_cast<const E&>(*this); }
+        };
+
+        template <class E> struct is_expression : std::is_base_of<Expression<E>, E> {};
+
+        template <class T> struct is_array : std::false_type {};
+        template <class T> struct is_array<hoNDArray<T>> : std::true_type {};
+
+        template <class T> struct is_scalar : std::is_arithmetic<T> {};
+        template <class T> struct is_scalar<std::complex<T>> : std::true_type {};
+        template <class T> struct is_scalar<complext<T>> : std::true_type {};
+
+        // --------------------------------------------------------------------------------
+        // Element-wise operations
+        // --------------------------------------------------------------------------------
+
+        namespace Ops {
+
+            // std::complex multiplication checks for NaN and infinity, which prevents vectorisation
+            template <class T> inline std::complex<T> mul(const std::complex<T>& a, const std::complex<T>& b) {
+                return std::complex<T>(a.real() * b.real() - a.imag() * b.imag(),
+                                       a.real() * b.imag() + a.imag() * b.real());
+            }
+            template <class A, class B> inline auto mul(const A& a, const B& b) { return a * b; }
+
+            template <class T> inline T conj_value(const T& a) { return a; }
+            template <class T> inline std::complex<T> conj_value(const std::complex<T>& a) { return std::conj(a); }
+            template <class T> inline complext<T> conj_value(const complext<T>& a) { return conj(a); }
+
+            template <class T> inline T real_value(const T& a) { return a; }
+            template <class T> inline T real_value(const std::complex<T>& a) { return a.real(); }
+            template <class T> inline T real_value(const complext<T>& a) { return a.real(); }
+
+            template <class T> inline T imag_value(const T&) { return T(0); }
+            template <class T> inline T imag_value(const std::complex<T>& a) { return a.imag(); }
+            template <class T> inline T imag_value(const complext<T>& a) { return a.imag(); }
+
+            template <class T> inline T norm_value(const T& a) { return a * a; }
+            template <class T> inline T norm_value(const std::complex<T>& a) {
+                return a.real() * a.real() + a.imag() * a.imag();
+            }
+            template <class T> inline T norm_value(const complext<T>& a) {
+                return a.real() * a.real() + a.imag() * a.imag();
+            }
+
+            template <class T> inline T abs_value(const T& a) { return std::abs(a); }
+            template <class T> inline T abs_value(const std::complex<T>& a) { return std::sqrt(norm_value(a)); }
+            template <class T> inline T abs_value(const complext<T>& a) { return std::sqrt(norm_value(a)); }
+
+            struct Plus {
+                template <class A, class B> auto operator()(const A& a, const B& b) const { return a + b; }
+            };
+            struct Minus {
+                template <class A, class B> auto operator()(const A& a, const B& b) const { return a - b; }
+            };
+            struct Multiplies {
+                template <class A, class B> auto operator()(const A& a, const B& b) const { return mul(a, b); }
+            };
+            struct Divides {
+                template <class A, class B> auto operator()(const A& a, const B& b) const { return a / b; }
+            };
+
+            struct Negate {
+                template <class A> auto operator()(const A& a) const { return -a; }
+            };
+            struct Conj {
+                template <class A> auto operator()(const A& a) const { return conj_value(a); }
+            };
+            struct Real {
+                template <class A> auto operator()(const A& a) const { return real_value(a); }
+            };
+            struct Imag {
+                template <class A> auto operator()(const A& a) const { return imag_value(a); }
+            };
+            struct Abs {
+                template <class A> auto operator()(const A& a) const { return abs_value(a); }
+            };
+            struct Norm {
+                template <class A> auto operator()(const A& a) const { return norm_value(a); }
+            };
+            struct Sqrt {
+                template <class A> auto operator()(const A& a) const { using std::sqrt; return sqrt(a); }
+            };
+            struct Exp {
+                template <class A> auto operator()(const A& a) const { using std::exp; return exp(a); }
+            };
+        }
+
+        // --------------------------------------------------------------------------------
+        // Expression nodes
+        // --------------------------------------------------------------------------------
+
+        /// Array operand held by reference
+        template <class T> class ArrayRef : public Expression<ArrayRef<T>> {
+        public:
+            using value_type = T;
+
+            explicit ArrayRef(const hoNDArray<T>& array) : array_(&array), data_(array.get_data_ptr()) {}
+
+            T operator[](size_t i) const { return data_[i]; }
+            size_t size() const { return array_->get_number_of_elements(); }
+            const std::vector<size_t>* dimensions() const { return &array_->dimensions(); }
+
+        private:
+            const hoNDArray<T>* array_;
+            const T* data_;
+        };
+
+        /// Array operand owned by the expression, for arrays passed as temporaries
+        template <class T> class ArrayValue : public Expression<ArrayValue<T>> {
+        public:
+            using value_type = T;
+
+            explicit ArrayValue(hoNDArray<T>&& array) : array_(std::move(array)) {}
+
+            T operator[](size_t i) const { return array_.get_data_ptr()[i]; }
+            size_t size() const { return array_.get_number_of_elements(); }
+            const std::vector<size_t>* dimensions() const { return &array_.dimensions(); }
+
+        private:
+            hoNDArray<T> array_;
+        };
+
+        /// Scalar operand, broadcast over the array operands. It has no elements of its own; its size is 0.
+        template <class T> class Scalar : public Expression<Scalar<T>> {
+        public:
+            using value_type = T;
+
+            explicit Scalar(const T& value) : value_(value) {}
+
+            T operator[](size_t) const { return value_; }
+            size_t size() const { return 0; }
+            const std::vector<size_t>* dimensions() const { return nullptr; }
+
+        private:
+            T value_;
+        };
+
+        template <class Op, class E> class Unary;
+        template <class Op, class L, class R> class Binary;
+
+        /// Expressions without array operands, which are broadcast like scalars
+        template <class E> struct is_scalar_expression : std::false_type {};
+        template <class T> struct is_scalar_expression<Scalar<T>> : std::true_type {};
+        template <class Op, class E> struct is_scalar_expression<Unary<Op, E>> : is_scalar_expression<E> {};
+        template <class Op, class L, class R>
+        struct is_scalar_expression<Binary<Op, L, R>>
+            : std::integral_constant<bool, is_scalar_expression<L>::value && is_scalar_expression<R>::value> {};
+
+        template <class Op, class E> class Unary : public Expression<Unary<Op, E>> {
+        public:
+            using value_type = std::decay_t<decltype(Op()(std::declval<typename E::value_type>()))>;
+
+            explicit Unary(E e) : e_(std::move(e)) {}
+
+            value_type operator[](size_t i) const { return Op()(e_[i]); }
+            size_t size() const { return e_.size(); }
+            const std::vector<size_t>* dimensions() const { return e_.dimensions(); }
+
+        private:
+            E e_;
+        };
+
+        template <class Op, class L, class R> class Binary : public Expression<Binary<Op, L, R>> {
+        public:
+            using value_type = std::decay_t<decltype(
+                Op()(std::declval<typename L::value_type>(), std::declval<typename R::value_type>()))>;
+
+            Binary(L l, R r) : l_(std::move(l)), r_(std::move(r)) {
+                if (!is_scalar_expression<L>::value && !is_scalar_expression<R>::value && l_.size() != r_.size())
+                    throw std::runtime_error("Expressions: operands have different number of elements");
+            }
+
+            value_type operator[](size_t i) const { return Op()(l_[i], r_[i]); }
+            size_t size() const { return is_scalar_expression<L>::value ? r_.size() : l_.size(); }
+            const std::vector<size_t>* dimensions() const {
+                return is_scalar_expression<L>::value ? r_.dimensions() : l_.dimensions();
+            }
+
+        private:
+            L l_;
+            R r_;
+        };
+
+        // --------------------------------------------------------------------------------
+        // Operand wrapping
+        // --------------------------------------------------------------------------------
+
+        namespace detail {
+
+            template <class E, std::enable_if_t<is_expression<std::decay_t<E>>::value, int> = 0>
+            std::decay_t<E> wrap(E&& e) {
+                return std::forward<E>(e);
+            }
+
+            template <class T> ArrayRef<T> wrap(const hoNDArray<T>& array) { return ArrayRef<T>(array); }
+            template <class T> ArrayRef<T> wrap(hoNDArray<T>& array) { return ArrayRef<T>(array); }
+            template <class T> ArrayValue<T> wrap(hoNDArray<T>&& array) { return ArrayValue<T>(std::move(array)); }
+
+            template <class X> struct value_type_of { using type = typename X::value_type; };
+            template <class T> struct value_type_of<hoNDArray<T>> { using type = T; };
+
+            // Scalars take the precision of the array operand they are combined with
+            template <class S, class V> struct scalar_type {
+                using type = std::conditional_t<std::is_arithmetic<S>::value, realType_t<V>, S>;
+            };
+            template <class T, class V> struct scalar_type<std::complex<T>, V> {
+                using type = std::complex<realType_t<V>>;
+            };
+            template <class T, class V> struct scalar_type<complext<T>, V> {
+                using type = complext<realType_t<V>>;
+            };
+
+            template <class V, class S> auto wrap_scalar(const S& s) {
+                using T = typename scalar_type<S, V>::type;
+                return Scalar<T>(T(s));
+            }
+
+            template <class X>
+            constexpr bool is_operand = is_expression<std::decay_t<X>>::value || is_array<std::decay_t<X>>::value;
+
+            template <class X> constexpr bool is_scalar_operand = is_scalar<std::decay_t<X>>::value;
+
+            template <class L, class R>
+            constexpr bool is_binary_operands = (is_operand<L> && is_operand<R>)
+                || (is_operand<L> && is_scalar_operand<R>) || (is_scalar_operand<L> && is_operand<R>);
+
+            template <class Op, class L, class R> auto make_binary(L&& l, R&& r) {
+                if constexpr (is_scalar_operand<L>) {
+                    auto rw = wrap(std::forward<R>(r));
+                    auto lw = wrap_scalar<typename decltype(rw)::value_type>(l);
+                    return Binary<Op, decltype(lw), decltype(rw)>(std::move(lw), std::move(rw));
+                } else if constexpr (is_scalar_operand<R>) {
+                    auto lw = wrap(std::forward<L>(l));
+                    auto rw = wrap_scalar<typename decltype(lw)::value_type>(r);
+                    return Binary<Op, decltype(lw), decltype(rw)>(std::move(lw), std::move(rw));
+                } else {
+                    auto lw = wrap(std::forward<L>(l));
+                    auto rw = wrap(std::forward<R>(r));
+                    return Binary<Op, decltype(lw), decltype(rw)>(std::move(lw), std::move(rw));
+                }
+            }
+
+            template <class Op, class X> auto make_unary(X&& x) {
+                auto w = wrap(std::forward<X>(x));
+                return Unary<Op, decltype(w)>(std::move(w));
+            }
+        }
+
+        // --------------------------------------------------------------------------------
+        // Operators and functions
+        // --------------------------------------------------------------------------------
+
+        /// Turns an array into an expression, e.g. to apply abs lazily
+        template <class T> ArrayRef<T> as_expression(const hoNDArray<T>& array) { return ArrayRef<T>(array); }
+        template <class T> ArrayValue<T> as_expression(hoNDArray<T>&& array) { return ArrayValue<T>(std::move(array)); }
+
+        template <class L, class R, std::enable_if_t<detail::is_binary_operands<L, R>, int> = 0>
+        auto operator+(L&& l, R&& r) {
+            return detail::make_binary<Ops::Plus>(std::forward<L>(l), std::forward<R>(r));
+        }
+
+        template <class L, class R, std::enable_if_t<detail::is_binary_operands<L, R>, int> = 0>
+        auto operator-(L&& l, R&& r) {
+            return detail::make_binary<Ops::Minus>(std::forward<L>(l), std::forward<R>(r));
+        }
+
+        template <class L, class R, std::enable_if_t<detail::is_binary_operands<L, R>, int> = 0>
+        auto operator*(L&& l, R&& r) {
+            return detail::make_binary<Ops::Multiplies>(std::forward<L>(l), std::forward<R>(r));
+        }
+
+        template <class L, class R, std::enable_if_t<detail::is_binary_operands<L, R>, int> = 0>
+        auto operator/(L&& l, R&& r) {
+            return detail::make_binary<Ops::Divides>(std::forward<L>(l), std::forward<R>(r));
+        }
+
+        template <class X, std::enable_if_t<detail::is_operand<X>, int> = 0> auto operator-(X&& x) {
+            return detail::make_unary<Ops::Negate>(std::forward<X>(x));
+        }
+
+        /// Lazy complex conjugate of an array or expression
+        template <class X, std::enable_if_t<detail::is_operand<X>, int> = 0> auto conj(X&& x) {
+            return detail::make_unary<Ops::Conj>(std::forward<X>(x));
+        }
+
+        /// Lazy functions of expressions
+        template <class E> auto abs(const Expression<E>& e) { return detail::make_unary<Ops::Abs>(e.derived()); }
+        template <class E> auto norm(const Expression<E>& e) { return detail::make_unary<Ops::Norm>(e.derived()); }
+        template <class E> auto real(const Expression<E>& e) { return detail::make_unary<Ops::Real>(e.derived()); }
+        template <class E> auto imag(const Expression<E>& e) { return detail::make_unary<Ops::Imag>(e.derived()); }
+        template <class E> auto sqrt(const Expression<E>& e) { return detail::make_unary<Ops::Sqrt>(e.derived()); }
+        template <class E> auto exp(const Expression<E>& e) { return detail::make_unary<Ops::Exp>(e.derived()); }
+
+        // --------------------------------------------------------------------------------
+        // Evaluation
+        // --------------------------------------------------------------------------------
+
+        /// Evaluates the expression into r, which must hold e.size() elements
+        template <class E, class T> void evaluate(const Expression<E>& expression, T* r) {
+            const E& e = expression.derived();
+            const long long N = (long long)e.size();
+
+            // Blocks keep the inner loop simple enough to be vectorised
+            constexpr long long block_size = 4096;
+            const long long num_blocks = (N + block_size - 1) / block_size;
+
+#pragma omp parallel for schedule(static) if (N > (long long)Elemwise::parallel_threshold)
+            for (long long b = 0; b < num_blocks; b++) {
+                const long long end = std::min(N, (b + 1) * block_size);
+#pragma omp simd
+                for (long long i = b * block_size; i < end; i++)
+                    r[i] = static_cast<T>(e[i]);
+            }
+        }
+
+        /// Evaluates the expression into a new array
+        template <class E> hoNDArray<typename E::value_type> eval(const Expression<E>& expression) {
+            return hoNDArray<typename E::value_type>(expression);
+        }
+    }
+
+    using Expressions::as_expression;
+    using Expressions::conj;
+    using Expressions::operator+;
+    using Expressions::operator-;
+    using Expressions::operator*;
+    using Expressions::operator/;
+
+    template <class T>
+    template <class E>
+    hoNDArray<T>::hoNDArray(const Expressions::Expression<E>& expression) : NDArray<T>::NDArray() {
+        *this = expression;
+    }
+
+    template <class T>
+    template <class E>
+    hoNDArray<T>& hoNDArray<T>::operator=(const Expressions::Expression<E>& expression) {
+        const E& e = expression.derived();
+        if (e.dimensions() == nullptr)
+            throw std::runtime_error("hoNDArray: cannot assign an expression without array operands");
+
+        if (this->get_number_of_elements() == e.size()) {
+            // Keep the memory, as the array may be an operand of the expression
+            if (!this->dimensions_equal(*e.dimensions()))
+                this->reshape(*e.dimensions());
+        } else {
+            this->create(*e.dimensions());
+        }
+
+        Expressions::evaluate(e, this->get_data_ptr());
+        return *this;
+    }
+}
@@ -3,8 +3,14 @@
 #include "vector_td_utilities.h"
 #include <GadgetronTimer.h>
 #include "hoArmadillo.h"
+#include <algorithm>
+#include <atomic>
 #include <numeric>
 
+#ifdef USE_OMP
+#include <omp.h>
+#endif // USE_OMP
+
 namespace Gadgetron {
     namespace Denoise {
 
@@ -175,51 +181,107 @@ namespace Gadgetron {
 
             }
 
-            template<class T>
-            hoNDArray<T> non_local_bayes_single_image(const hoNDArray<T> &image, float noise_std, int search_window) {
-
+            // Reference pixels are visited tile by tile; every tile is denoised by a single thread
+            constexpr int tile_size = 32;
 
-                if (image.get_number_of_dimensions() != 2)
-                    throw std::invalid_argument("non_local_bayes: image must be 2 dimensional");
+            /**
+             * As before tiling, a pixel which has been denoised as part of any group in the image is not used as a
+             * reference pixel again. The mask is shared between the tiles, so only the order in which reference
+             * pixels are visited depends on the tiling and the number of threads.
+             */
+            template<class T>
+            void non_local_bayes_tile(const hoNDArray<T> &image, int tile_x, int tile_y, float noise_std,
+                                      int search_window, const vector_td<int, 2> &image_dims,
+                                      hoNDArray<T> &result, hoNDArray<int> &count,
+                                      std::vector<std::atomic<uint8_t>> &denoised) {
 
                 constexpr int patch_size = 5;
                 constexpr int n_patches = 50;
 
-                hoNDArray<T> result(image.dimensions());
-                result.fill(0);
+                const int end_x = std::min(tile_x + tile_size, image_dims[0]);
+                const int end_y = std::min(tile_y + tile_size, image_dims[1]);
 
-                hoNDArray<bool> mask(image.dimensions());
-                mask.fill(true);
+                for (int ky = tile_y; ky < end_y; ky++) {
+                    for (int kx = tile_x; kx < end_x; kx++) {
 
-                hoNDArray<int> count(image.dimensions());
-                count.fill(0);
+                        if (denoised[kx + ky * image_dims[0]].load(std::memory_order_relaxed)) continue;
 
-                const vector_td<int, 2> image_dims = vector_td<int, 2>(
-                        from_std_vector<size_t, 2>(image.dimensions())
-                );
+                        auto reference_patch = get_patch(image, kx, ky, patch_size, image_dims);
+                        auto patches = create_patches(image, kx, ky, patch_size, search_window, image_dims);
+
+                        filter_patches(patches, n_patches, reference_patch);
+                        denoise_patches(patches, noise_std);
+
+                        for (auto &patch : patches) {
+                            add_patch(patch, result, count, patch_size, image_dims);
+                            denoised[patch.center_x + patch.center_y * image_dims[0]].store(1, std::memory_order_relaxed);
+                        }
+                    }
+                }
+            }
 
-#pragma omp parallel for num_threads(4)
-                for (int ky = 0; ky < image.get_size(1); ky++) {
-                    for (int kx = 0; kx < image.get_size(0); kx++) {
+            template<class T>
+            hoNDArray<T> non_local_bayes_single_image(const hoNDArray<T> &image, float noise_std, int search_window) {
 
-                        if (mask(kx, ky)) {
-                            auto reference_patch = get_patch(image, kx, ky, patch_size, image_dims);
-                            auto patches = create_patches(image, kx, ky, patch_size, search_window, image_dims);
 
-                            filter_patches(patches, n_patches, reference_patch);
-                            denoise_patches(patches, noise_std);
+                if (image.get_number_of_dimensions() != 2)
+                    throw std::invalid_argument("non_local_bayes: image must be 2 dimensional");
 
-                            for (auto &patch : patches) {
-                                #pragma omp critical
-                                add_patch(patch, result, count, patch_size, image_dims);
-                                mask(patch.center_x, patch.center_y) = false;
-                            }
-                        }
+                const vector_td<int, 2> image_dims = vector_td<int, 2>(
+                        from_std_vector<size_t, 2>(image.dimensions())
+                );
+
+                std::vector<vector_td<int, 2>> tiles;
+                for (int ty = 0; ty < image_dims[1]; ty += tile_size)
+                    for (int tx = 0; tx < image_dims[0]; tx += tile_size)
+                        tiles.push_back(vector_td<int, 2>(tx, ty));
+
+                // Patch estimates are accumulated into per-thread buffers, which are merged at the end
+                int num_threads = 1;
+#ifdef USE_OMP
+                num_threads = std::max(1, std::min<int>(omp_get_max_threads(), tiles.size()));
+#endif // USE_OMP
+
+                // OpenMP may run a smaller team than requested, e.g. inside another parallel region, so every
+                // buffer is allocated up front; those of threads that never run are merged as zeros
+                std::vector<hoNDArray<T>> thread_results(num_threads);
+                std::vector<hoNDArray<int>> thread_counts(num_threads);
+                for (int t = 0; t < num_threads; t++) {
+                    thread_results[t].create(image.dimensions());
+                    thread_results[t].fill(0);
+                    thread_counts[t].create(image.dimensions());
+                    thread_counts[t].fill(0);
+                }
+                std::vector<std::atomic<uint8_t>> denoised(image.get_number_of_elements());
+
+#pragma omp parallel num_threads(num_threads)
+                {
+                    int thread_id = 0;
+#ifdef USE_OMP
+                    thread_id = omp_get_thread_num();
+#endif // USE_OMP
+                    auto &local_result = thread_results[thread_id];
+                    auto &local_count = thread_counts[thread_id];
+
+#pragma omp for schedule(dynamic)
+                    for (int i = 0; i < (int) tiles.size(); i++) {
+                        non_local_bayes_tile(image, tiles[i][0], tiles[i][1], noise_std, search_window, image_dims,
+                                             local_result, local_count, denoised);
                     }
                 }
 
-                for (size_t i = 0; i < result.get_number_of_elements(); i++) {
-                    result[i] /= count[i];
+                hoNDArray<T> result(image.dimensions());
+                const long long N = result.get_number_of_elements();
+
+#pragma omp parallel for num_threads(num_threads)
+                for (long long i = 0; i < N; i++) {
+                    T sum = 0;
+                    int total = 0;
+                    for (int t = 0; t < num_threads; t++) {
+                        sum += thread_results[t][i];
+                        total += thread_counts[t][i];
+                    }
+                    result[i] = sum / float(total);
                 }
 
                 return result;
@@ -230,6 +292,8 @@ namespace Gadgetron {
             template<class T>
             hoNDArray<T> non_local_bayes_T(const hoNDArray<T> &image, float noise_std, unsigned int search_window) {
 
+                GadgetronTimer timer("Non local Bayes");
+
                 size_t n_images = image.get_number_of_elements() / (image.get_size(0) * image.get_size(1));
 
                 std::vector<size_t> image_dims = {image.get_size(0), image.get_size(1)};
@@ -237,13 +301,11 @@ namespace Gadgetron {
 
                 auto result = hoNDArray<T>(image.dimensions());
 
-                hoNDArray<T> result_view;
-                result_view.create(image_dims);
-                #pragma omp parallel for
-                for (int i = 0; i < n_images; i++) {
+                // Images are processed in turn, each one using all threads over its tiles
+                for (size_t i = 0; i < n_images; i++) {
 
                     auto image_view = hoNDArray<T>(image_dims, const_cast<T*>(image.get_data_ptr() + i * image_elements));
-                    result_view = non_local_bayes_single_image(image_view, noise_std, search_window);
+                    auto result_view = non_local_bayes_single_image(image_view, noise_std, search_window);
 
                     memcpy(result.begin() + i * image_elements, result_view.begin(), result_view.get_number_of_bytes());
                 }
@@ -6,104 +6,236 @@
 #include <GadgetronTimer.h>
 #include "non_local_means.h"
 
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
 
 namespace Gadgetron {
     namespace Denoise {
 
         namespace {
 
+            using Coord = vector_td<int, 3>;
 
-            template<class T, int D>
-            vector_td<T, D * D> get_patch(const hoNDArray<T> &image, int x, int y,
-                                          const vector_td<int, 2> &image_dims) {
+            // Tiles are processed independently, so the work scales with the number of cores rather than images
+            constexpr int tile_size_xy = 32;
+            constexpr int tile_size_z = 8;
 
-                constexpr int N = D * D;
-                vector_td<T, N> window;
-                for (int ky = 0; ky < D; ky++) {
-                    for (int kx = 0; kx < D; kx++) {
-                        window[kx + ky * D] = image(((kx - D / 2) + x + image_dims[0]) % image_dims[0],
-                                                    ((ky - D / 2) + y + image_dims[1]) % image_dims[1]);
+            struct Tile {
+                size_t volume;
+                Coord begin;
+                Coord end;
+            };
 
-                    }
-                }
-                return window;
+            template<class T>
+            struct TileWorkspace {
+                std::vector<double> integral;
+                std::vector<float> sum_weight;
+                std::vector<T> sum_value;
+                std::vector<int> reference_index[3];
+                std::vector<int> shifted_index[3];
             };
 
+            inline int wrap(int i, int n) {
+                return ((i % n) + n) % n;
+            }
 
+            /**
+             * Denoises one tile, looping over the search offsets. For every offset, the squared difference between the
+             * image and its shifted copy is computed once over the tile (plus the patch margin) and summed into an
+             * integral image, from which every patch distance follows in constant time.
+             */
             template<class T>
-            hoNDArray<T> non_local_means_single_image(const hoNDArray<T> &image, float noise_std, int search_radius) {
-
-                constexpr int D = 5;
+            void non_local_means_tile(const T *volume, T *result, const Coord &dims, const Tile &tile, float noise_std,
+                                      const Coord &search_radius, const Coord &patch_radius,
+                                      TileWorkspace<T> &workspace) {
+
+                Coord tile_dims, region_dims;
+                for (int d = 0; d < 3; d++) {
+                    tile_dims[d] = tile.end[d] - tile.begin[d];
+                    region_dims[d] = tile_dims[d] + 2 * patch_radius[d];
+                }
 
-                hoNDArray<T> result(image.dimensions());
-                const float noise_std2 = noise_std * noise_std;
-                const vector_td<int, 2> image_dims = vector_td<int, 2>(
-                        from_std_vector<size_t, 2>(image.dimensions()));
+                const size_t tile_elements = size_t(tile_dims[0]) * tile_dims[1] * tile_dims[2];
+                const size_t IX = region_dims[0] + 1;
+                const size_t IXY = IX * (region_dims[1] + 1);
 
-#pragma omp parallel for
-                for (int ky = 0; ky < image.get_size(1); ky++) {
-                    for (int kx = 0; kx < image.get_size(0); kx++) {
-                        float sum_weight = 0;
-                        T sum_value = 0;
-                        auto window = get_patch<T, D>(image, kx, ky, image_dims);
+                // The integral image has a zero border at index 0 along every dimension, which is never overwritten
+                workspace.integral.assign(IXY * (region_dims[2] + 1), 0.0);
+                workspace.sum_weight.assign(tile_elements, 0.0f);
+                workspace.sum_value.assign(tile_elements, T(0));
 
-                        for (int dy = -int(search_radius); dy < search_radius; dy++) {
-                            for (int dx = -int(search_radius); dx < search_radius; dx++) {
+                for (int d = 0; d < 3; d++) {
+                    workspace.reference_index[d].resize(region_dims[d]);
+                    workspace.shifted_index[d].resize(region_dims[d]);
+                    for (int r = 0; r < region_dims[d]; r++)
+                        workspace.reference_index[d][r] = wrap(tile.begin[d] - patch_radius[d] + r, dims[d]);
+                }
 
-                                auto window2 = get_patch<T, D>(image, kx + dx, ky + dy, image_dims);
-                                auto diff = window - window2;
-                                auto weight = std::exp(-norm_squared(diff) / (noise_std2 * D * D));
+                const auto &ref_x = workspace.reference_index[0];
+                const auto &ref_y = workspace.reference_index[1];
+                const auto &ref_z = workspace.reference_index[2];
+                const auto &shift_x = workspace.shifted_index[0];
+                const auto &shift_y = workspace.shifted_index[1];
+                const auto &shift_z = workspace.shifted_index[2];
+
+                const float patch_elements =
+                        float(2 * patch_radius[0] + 1) * (2 * patch_radius[1] + 1) * (2 * patch_radius[2] + 1);
+                const float inv_h2 = 1.0f / (noise_std * noise_std * patch_elements);
+
+                const size_t dimXY = size_t(dims[0]) * dims[1];
+                double *S = workspace.integral.data();
+
+                for (int oz = -search_radius[2]; oz <= search_radius[2]; oz++) {
+                    for (int oy = -search_radius[1]; oy <= search_radius[1]; oy++) {
+                        for (int ox = -search_radius[0]; ox <= search_radius[0]; ox++) {
+
+                            const Coord offset(ox, oy, oz);
+                            for (int d = 0; d < 3; d++) {
+                                for (int r = 0; r < region_dims[d]; r++)
+                                    workspace.shifted_index[d][r] = wrap(
+                                            tile.begin[d] - patch_radius[d] + r + offset[d], dims[d]);
+                            }
 
-                                sum_weight += weight;
-                                sum_value += weight * window2[D / 2 + D * (D / 2)];
+                            // Integral image of the squared differences
+                            for (int z = 0; z < region_dims[2]; z++) {
+                                for (int y = 0; y < region_dims[1]; y++) {
+                                    const T *ref_row = volume + ref_y[y] * dims[0] + ref_z[z] * dimXY;
+                                    const T *shift_row = volume + shift_y[y] * dims[0] + shift_z[z] * dimXY;
+
+                                    double *row = S + (z + 1) * IXY + (y + 1) * IX + 1;
+                                    const double *row_y = row - IX;
+                                    const double *row_z = row - IXY;
+                                    const double *row_yz = row - IX - IXY;
+
+                                    double running = 0;
+                                    for (int x = 0; x < region_dims[0]; x++) {
+                                        running += std::norm(ref_row[ref_x[x]] - shift_row[shift_x[x]]);
+                                        row[x] = running + row_y[x] + row_z[x] - row_yz[x];
+                                    }
+                                }
+                            }
 
+                            // Patch distances and weighted accumulation
+                            const int PX = 2 * patch_radius[0] + 1;
+                            const size_t PY = (2 * patch_radius[1] + 1) * IX;
+                            const size_t PZ = (2 * patch_radius[2] + 1) * IXY;
+
+                            size_t t = 0;
+                            for (int z = 0; z < tile_dims[2]; z++) {
+                                for (int y = 0; y < tile_dims[1]; y++) {
+                                    const double *low = S + z * IXY + y * IX;
+                                    const T *value_row = volume + shift_y[y + patch_radius[1]] * dims[0] +
+                                                         shift_z[z + patch_radius[2]] * dimXY;
+
+                                    for (int x = 0; x < tile_dims[0]; x++, t++) {
+                                        const double *l = low + x;
+                                        double dist = l[PX + PY + PZ] - l[PY + PZ] - l[PX + PZ] - l[PX + PY]
+                                                      + l[PZ] + l[PY] + l[PX] - l[0];
+
+                                        float weight = std::exp(-float(dist) * inv_h2);
+                                        workspace.sum_weight[t] += weight;
+                                        workspace.sum_value[t] += weight * value_row[shift_x[x + patch_radius[0]]];
+                                    }
+                                }
                             }
                         }
+                    }
+                }
 
-                        result(kx, ky) = sum_value / sum_weight;
-
+                size_t t = 0;
+                for (int z = tile.begin[2]; z < tile.end[2]; z++) {
+                    for (int y = tile.begin[1]; y < tile.end[1]; y++) {
+                        for (int x = tile.begin[0]; x < tile.end[0]; x++, t++) {
+                            result[x + y * dims[0] + z * dimXY] = workspace.sum_value[t] / workspace.sum_weight[t];
+                        }
                     }
                 }
+            }
 
-                return result;
 
+            std::vector<Tile> make_tiles(size_t n_volumes, const Coord &dims, const Coord &tile_size) {
+                std::vector<Tile> tiles;
+                for (size_t v = 0; v < n_volumes; v++) {
+                    for (int z = 0; z < dims[2]; z += tile_size[2]) {
+                        for (int y = 0; y < dims[1]; y += tile_size[1]) {
+                            for (int x = 0; x < dims[0]; x += tile_size[0]) {
+                                tiles.push_back(Tile{v, Coord(x, y, z),
+                                                     Coord(std::min(x + tile_size[0], dims[0]),
+                                                           std::min(y + tile_size[1], dims[1]),
+                                                           std::min(z + tile_size[2], dims[2]))});
+                            }
+                        }
+                    }
+                }
+                return tiles;
             }
 
-            template<class T>
-            hoNDArray<T> non_local_means_T(const hoNDArray<T> &image, float noise_std, unsigned int search_radius) {
 
+            template<class T>
+            hoNDArray<T> non_local_means_T(const hoNDArray<T> &image, float noise_std, const Coord &search_radius,
+                                           const Coord &patch_radius, bool volumetric) {
 
                 GadgetronTimer timer("Non local means");
-                             size_t n_images = image.get_number_of_elements() / (image.get_size(0) * image.get_size(1));
 
-                std::vector<size_t> image_dims = {image.get_size(0), image.get_size(1)};
-                size_t image_elements = image_dims[0] * image_dims[1];
+                const Coord dims(image.get_size(0), image.get_size(1), volumetric ? image.get_size(2) : 1);
+                const size_t volume_elements = size_t(dims[0]) * dims[1] * dims[2];
+                const size_t n_volumes = image.get_number_of_elements() / volume_elements;
+
+                const auto tiles = make_tiles(n_volumes, dims,
+                                              Coord(tile_size_xy, tile_size_xy, volumetric ? tile_size_z : 1));
 
                 auto result = hoNDArray<T>(image.dimensions());
 
-                #pragma omp parallel for
-                for (int i = 0; i < n_images; i++) {
+                const T *input_ptr = image.get_data_ptr();
+                T *result_ptr = result.get_data_ptr();
 
-                    auto image_view = hoNDArray<T>(image_dims, const_cast<T*>(image.get_data_ptr() + i * image_elements));
-                    auto result_view = non_local_means_single_image(image_view, noise_std,search_radius) ;
+#pragma omp parallel
+                {
+                    TileWorkspace<T> workspace;
 
-                    memcpy(result.begin() + i * image_elements, result_view.begin(), result_view.get_number_of_bytes());
-                    GDEBUG_STREAM("I finished one");
+#pragma omp for schedule(dynamic)
+                    for (int i = 0; i < (int) tiles.size(); i++) {
+                        const auto &tile = tiles[i];
+                        non_local_means_tile(input_ptr + tile.volume * volume_elements,
+                                             result_ptr + tile.volume * volume_elements, dims, tile, noise_std,
+                                             search_radius, patch_radius, workspace);
+                    }
                 }
-                return result;
 
+                return result;
             }
+
+            Coord patch_radius_2d() { return Coord(2, 2, 0); }
+
+            Coord patch_radius_3d() { return Coord(2, 2, 1); }
         }
 
 
 
         hoNDArray<float> non_local_means(const hoNDArray<float> &image, float noise_std, unsigned int search_radius) {
-            return non_local_means_T(image, noise_std, search_radius);
+            return non_local_means_T(image, noise_std, Coord(search_radius, search_radius, 0), patch_radius_2d(),
+                                     false);
         }
 
         hoNDArray<std::complex<float>>
         non_local_means(const hoNDArray<std::complex<float>> &image, float noise_std, unsigned int search_radius) {
-            return non_local_means_T(image, noise_std, search_radius);
+            return non_local_means_T(image, noise_std, Coord(search_radius, search_radius, 0), patch_radius_2d(),
+                                     false);
+        }
+
+        hoNDArray<float> non_local_means_3d(const hoNDArray<float> &image, float noise_std, unsigned int search_radius,
+                                            unsigned int temporal_search_radius) {
+            return non_local_means_T(image, noise_std, Coord(search_radius, search_radius, temporal_search_radius),
+                                     patch_radius_3d(), true);
+        }
+
+        hoNDArray<std::complex<float>>
+        non_local_means_3d(const hoNDArray<std::complex<float>> &image, float noise_std, unsigned int search_radius,
+                           unsigned int temporal_search_radius) {
+            return non_local_means_T(image, noise_std, Coord(search_radius, search_radius, temporal_search_radius),
+                                     patch_radius_3d(), true);
         }
 
 
@@ -6,7 +6,18 @@
 
 namespace Gadgetron {
     namespace Denoise {
+        /**
+         * Non local means over every 2D image (dimensions 0 and 1) of the array, with 5x5 patches and a
+         * (2*search_radius+1)^2 search window. Boundaries are periodic.
+         */
         EXPORTDENOISE hoNDArray<float> non_local_means(const hoNDArray<float>& image, float noise_std, unsigned int search_radius);
         EXPORTDENOISE hoNDArray<std::complex<float>> non_local_means(const hoNDArray<std::complex<float>>& image, float noise_std, unsigned int search_radius);
+
+        /**
+         * Non local means over every 3D volume (dimensions 0, 1 and 2) of the array, e.g. a cine series or a 3D image.
+         * Patches are 5x5x3 and the search window extends temporal_search_radius along dimension 2.
+         */
+        EXPORTDENOISE hoNDArray<float> non_local_means_3d(const hoNDArray<float>& image, float noise_std, unsigned int search_radius, unsigned int temporal_search_radius);
+        EXPORTDENOISE hoNDArray<std::complex<float>> non_local_means_3d(const hoNDArray<std::complex<float>>& image, float noise_std, unsigned int search_radius, unsigned int temporal_search_radius);
     }
 }
@@ -16,6 +16,7 @@
 #include <boost/iterator/function_input_iterator.hpp>
 #include <iterator>
 #include "graph_cut.h"
+#include "projector_table.h"
 
 #include "hoNDArray_math.h"
 
@@ -209,6 +210,9 @@ namespace Gadgetron {
             std::uniform_int_distribution<int> coinflip(0, 2);
             fmIndex.fill(field_map_strengths.size() / 2);
 
+            // The graph is allocated once and reused for every iteration
+            FieldMapGraphCut graph_cut(config.graph_cut_solver);
+
             hoNDArray<uint16_t> fmIndex_update;
             for (int i = 0; i < config.number_of_iterations; i++) {
                 if (coinflip(rng_state) == 0 || i < 15) {
@@ -224,7 +228,7 @@ namespace Gadgetron {
                                                                         field_map_strengths.size() - 1);
                 }
 
-                fmIndex = update_field_map(fmIndex, fmIndex_update, residual, second_deriv);
+                fmIndex = graph_cut.update_field_map(fmIndex, fmIndex_update, residual, second_deriv);
             }
 
             return fmIndex;
@@ -246,134 +250,54 @@ namespace Gadgetron {
         }
 
 
-        hoNDArray<arma::Mat<std::complex<float>>>
-        calculate_projection_matrices(const std::vector<float> &echo_times,
-                                      const arma::Mat<std::complex<float>> &phiMatrix,
-                                      const std::vector<float> &field_map_strengths,
-                                      const std::vector<float> &r2stars) {
-
-            auto num_fm = field_map_strengths.size();
-            auto num_r2star = r2stars.size();
-            hoNDArray<arma::Mat<std::complex<float>>> Ps(num_fm, num_r2star);
-            size_t nte = echo_times.size();
-
-#ifdef WIN32
-#pragma omp parallel for
-#else
-#pragma omp parallel for
-#endif
-            for (int k3 = 0; k3 < num_fm; k3++) {
-
-                float fm = field_map_strengths[k3];
-                arma::Col<std::complex<float>> b_shifts(nte);
-                for (int kt = 0; kt < nte; kt++)
-                    b_shifts[kt] = std::exp(2if * PI * (echo_times[kt] - echo_times[0]) * fm);
-                for (int k4 = 0; k4 < num_r2star; k4++) {
-                    float r2star = r2stars[k4];
-
-                    arma::Mat<std::complex<float>> psiMatrix = calculate_psi_matrix(echo_times, phiMatrix,
-                                                                                    r2star);
-                    Ps(k3, k4) = arma::diagmat(b_shifts) * (arma::eye<arma::Mat<std::complex<float>>>(nte, nte) -
-                                                            psiMatrix * arma::pinv(psiMatrix)) *
-                                 arma::diagmat(arma::conj(b_shifts));
-
-                }
-            }
-            return Ps;
-        }
-
-
-
-
         hoNDArray<float>
         calculate_r2star_map(const hoNDArray<std::complex<float> > &data, const hoNDArray<float> &field_map,
                              const std::vector<float> &r2star_values,
                              const arma::Mat<std::complex<float>> &phiMatrix, const std::vector<float> &echoTimes) {
-            using cMat = arma::Mat<std::complex<float>>;
             uint16_t X = data.get_size(0);
             uint16_t Y = data.get_size(1);
             uint16_t Z = data.get_size(2);
             uint16_t CHA = data.get_size(3);
             uint16_t N = data.get_size(4);
             uint16_t S = data.get_size(5);
-            uint16_t LOC = data.get_size(6);
-            auto nte = phiMatrix.n_rows;
 
+            // Projectors without field map shift; the signal is demodulated with the field map instead
+            auto projectors = get_projector_table(echoTimes, phiMatrix, {0.0f}, r2star_values);
+            const size_t packed_size = projectors->packed_size();
+            const size_t num_r2star = r2star_values.size();
 
-            auto data_corrected = data;
+            const size_t echo_stride = size_t(X) * Y * Z * CHA * N;
+            const size_t columns = size_t(CHA) * N;
 
-            for (int kS = 0; kS < S; kS++) {
-                for (int kN = 0; kN < N; kN++) {
-                    for (int kcha = 0; kcha < CHA; kcha++) {
-                        for (int ky = 0; ky < Y; ky++) {
-                            for (int kx = 0; kx < X; kx++) {
-                                data_corrected(kx, ky, 0, kcha, kN, kS) *= std::exp(
-                                        -2if * PI * field_map(kx, ky) * echoTimes[kS]);
-                            }
-                        }
-                    }
-                }
-            }
-
-
-            std::vector<arma::Mat<std::complex<float>>> Ps;
-            for (auto r2star : r2star_values) {
-
-                auto psiMatrix = calculate_psi_matrix(echoTimes, phiMatrix,
-                                                      r2star);
-                Ps.emplace_back(
-                        arma::eye<arma::Mat<std::complex<float>>>(nte, nte) - psiMatrix * arma::pinv(psiMatrix)
-                );
-
-            }
+            hoNDArray<float> r2star_map(field_map.dimensions());
 
+            for (int k2 = 0; k2 < Y; k2++) {
+                hoNDArray<double> covariance(packed_size, X);
 
-            hoNDArray<float> r2star_map(field_map.dimensions());
-#ifdef WIN32
 #pragma omp parallel for
-#else
-#pragma omp parallel for collapse(2)
-#endif
-            for (int k2 = 0; k2 < Y; k2++) {
                 for (int k1 = 0; k1 < X; k1++) {
-                    // Get current signal
-                    std::vector<cMat> signals(CHA, cMat(S, N));
-                    for (int cha = 0; cha < CHA; cha++) {
-                        auto &tempSignal = signals[cha];
-                        for (int k4 = 0; k4 < N; k4++) {
-                            for (int k5 = 0; k5 < S; k5++) {
-                                tempSignal(k5, k4) = data_corrected(k1, k2, 0, cha, k4, k5, 0);
-
-                            }
+                    std::vector<std::complex<float>> signal(S * columns);
+                    const std::complex<float> *pixel = &data(k1, k2, 0, 0, 0, 0, 0);
+                    for (size_t c = 0; c < columns; c++) {
+                        for (int ks = 0; ks < S; ks++) {
+                            signal[ks + c * S] = pixel[c * X * Y * Z + ks * echo_stride] *
+                                                 std::exp(-2if * PI * field_map(k1, k2) * echoTimes[ks]);
                         }
                     }
+                    ProjectorTable::pack_covariance(signal.data(), S, columns, 1, S, &covariance(0, k1));
+                }
 
+                hoNDArray<float> residuals;
+                projectors->residuals(covariance, residuals);
 
+                for (int k1 = 0; k1 < X; k1++) {
                     float minResidual = std::numeric_limits<float>::max();
-                    std::vector<float> field_map_strengths = {field_map(k1, k2)};
-
-
-                    for (int kr2 = 0; kr2 < r2star_values.size(); kr2++) {
-
-                        float curResidual = 0;
-
-                        for (int cha = 0; cha < CHA; cha++) {
-                            // Apply projector
-                            arma::Mat<std::complex<float>> projected = Ps[kr2] * signals[cha];
-                            curResidual += std::accumulate(projected.begin(), projected.end(), 0.0f,
-                                                           [](auto v1, auto v2) {
-                                                               return v1 +
-                                                                      std::norm(v2);
-                                                           });
-                        }
-                        if (curResidual < minResidual) {
-                            minResidual = curResidual;
+                    for (size_t kr2 = 0; kr2 < num_r2star; kr2++) {
+                        if (residuals(kr2, k1) < minResidual) {
+                            minResidual = residuals(kr2, k1);
                             r2star_map(k1, k2) = r2star_values[kr2];
                         }
-
                     }
-
-
                 }
             }
 
@@ -386,18 +310,18 @@ namespace Gadgetron {
                                       const arma::Mat<std::complex<float>> &phi,
                                       const std::vector<float> &field_strengths,
                                       const std::vector<float> &r2star_values) {
-            using cMat = arma::Mat<std::complex<float>>;
             uint16_t X = data.get_size(0);
             uint16_t Y = data.get_size(1);
             uint16_t Z = data.get_size(2);
             uint16_t CHA = data.get_size(3);
             uint16_t N = data.get_size(4);
             uint16_t S = data.get_size(5);
-            uint16_t LOC = data.get_size(6);
-
 
-            auto projection_matrices = calculate_projection_matrices(parameters.echo_times_s, phi, field_strengths,
-                                                                     r2star_values);
+            // Shared between slices and repetitions with the same echo times and species
+            auto projectors = get_projector_table(parameters.echo_times_s, phi, field_strengths, r2star_values);
+            const size_t packed_size = projectors->packed_size();
+            const size_t num_fm = field_strengths.size();
+            const size_t num_r2star = r2star_values.size();
 
             auto result = std::make_tuple(hoNDArray<float>(field_strengths.size(), X, Y, Z),
                                           hoNDArray<uint16_t>(X, Y, Z, field_strengths.size()));
@@ -405,49 +329,40 @@ namespace Gadgetron {
             auto &residual = std::get<0>(result);
             auto &r2starIndex = std::get<1>(result);
 
-#ifdef WIN32
-#pragma omp parallel for 
-#else
-#pragma omp parallel for collapse(3)
-#endif
-            for (int kz = 0; kz < Z; kz++) {
-                for (int ky = 0; ky < Y; ky++) {
-                    for (int kx = 0; kx < X; kx++) {
+            const size_t pixels = size_t(X) * Y * Z;
+            const size_t columns = size_t(CHA) * N;
+            const size_t echo_stride = pixels * columns;
+            const size_t block_size = 1024;
 
-                        std::vector<cMat> signals(CHA, cMat(S, N));
-                        for (int cha = 0; cha < CHA; cha++) {
-                            auto &tempSignal = signals[cha];
-                            for (int kn = 0; kn < N; kn++) {
-                                for (int ks = 0; ks < S; ks++) {
-                                    tempSignal(ks, kn) = data(kx, ky, kz, cha, kn, ks, 0);
-                                }
-                            }
-                        }
+            hoNDArray<double> covariance;
+            hoNDArray<float> block_residuals;
 
-                        for (int kf = 0; kf < field_strengths.size(); kf++) {
-
-                            float minResidual = std::numeric_limits<float>::max();
-
-                            for (int kr = 0; kr < r2star_values.size(); kr++) {
-                                // Apply projector
-                                float curResidual = 0;
-                                for (int cha = 0; cha < CHA; cha++) {
-                                    arma::Mat<std::complex<float>> projected =
-                                            projection_matrices(kf, kr) * signals[cha];
-                                    curResidual += std::accumulate(projected.begin(), projected.end(), 0.0f,
-                                                                   [](auto v1, auto v2) {
-                                                                       return v1 +
-                                                                              std::norm(v2);
-                                                                   });
-                                }
-                                if (curResidual < minResidual) {
-                                    minResidual = curResidual;
-                                    r2starIndex(kx, ky, kz, kf) = kr;
-                                }
-                            }
-                            residual(kf, kx, ky, kz) = minResidual;
+            for (size_t start = 0; start < pixels; start += block_size) {
+                const size_t count = std::min(block_size, pixels - start);
+                covariance.create(packed_size, count);
 
+#pragma omp parallel for
+                for (int p = 0; p < (int)count; p++) {
+                    ProjectorTable::pack_covariance(data.data() + start + p, S, columns, echo_stride, pixels,
+                                                    &covariance(0, p));
+                }
+
+                projectors->residuals(covariance, block_residuals);
+
+#pragma omp parallel for
+                for (int p = 0; p < (int)count; p++) {
+                    const size_t pixel = start + p;
+                    const float *pixel_residuals = &block_residuals(0, p);
+                    for (size_t kf = 0; kf < num_fm; kf++) {
+                        float minResidual = std::numeric_limits<float>::max();
+                        for (size_t kr = 0; kr < num_r2star; kr++) {
+                            float curResidual = pixel_residuals[kr + kf * num_r2star];
+                            if (curResidual < minResidual) {
+                                minResidual = curResidual;
+                                r2starIndex[pixel + kf * pixels] = kr;
+                            }
                         }
+                        residual[kf + pixel * num_fm] = minResidual;
                     }
                 }
             }
@@ -11,6 +11,15 @@ namespace Gadgetron
 {
     namespace FatWater {
 
+        /**
+           Max-flow solver used for the field map graph-cut
+         */
+        enum class GraphCutSolver {
+            boykov_kolmogorov, // boost::boykov_kolmogorov_max_flow on an ImageGraph rebuilt every iteration
+            grid,              // GridMaxFlow, graph allocated once and reused across iterations
+            grid_parallel      // GridMaxFlow, slabs solved concurrently before the global pass
+        };
+
         struct EXPORTFATWATER Config {
             std::pair<float, float> frequency_range = {-500, 500};
             size_t number_of_frequency_samples = 200;
@@ -25,6 +34,7 @@ namespace Gadgetron
             float lambda_extra = 0.01;
             bool do_gradient_descent = true;
             unsigned int downsamples = 0;
+            GraphCutSolver graph_cut_solver = GraphCutSolver::grid_parallel;
 
 
         };
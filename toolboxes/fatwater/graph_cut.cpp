@@ -6,6 +6,8 @@
 #include "ImageGraph.h"
 #include <boost/graph/boykov_kolmogorov_max_flow.hpp>
 #include "graph_cut.h"
+#include "grid_max_flow.h"
+#include "vector_td_operators.h"
 
 
 namespace {
@@ -13,68 +15,60 @@ namespace {
     static std::mt19937 rng_state(4242);
 
 
-    template<unsigned int D>
-    void update_regularization_edge(ImageGraph<D> &graph, const hoNDArray<uint16_t> &field_map,
-                                    const hoNDArray<uint16_t> &proposed_field_map,
-                                    const hoNDArray<float> &second_deriv, const size_t idx, const size_t idx2,
-                                    const size_t edge_idx, float scaling) {
+    /**
+     * Walks the voxels in a fixed order and reports every capacity of the graph-cut problem.
+     * Both ImageGraph and GridMaxFlow are filled through this, so their capacities are bitwise identical.
+     * add_edge(idx, dimension, capacity) is the edge from idx to its +1 neighbour along dimension.
+     */
+    template<class EdgeFunction, class SourceFunction, class SinkFunction>
+    void add_graph_capacities(const hoNDArray<uint16_t> &field_map, const hoNDArray<uint16_t> &proposed_field_map,
+                              const hoNDArray<float> &residual_diff_map, const hoNDArray<float> &second_deriv,
+                              EdgeFunction &&add_edge, SourceFunction &&add_source, SinkFunction &&add_sink) {
 
-        int f_value1 = field_map[idx];
-        int pf_value1 = proposed_field_map[idx];
-        int f_value2 = field_map[idx2];
-        int pf_value2 = proposed_field_map[idx2];
-        int a = std::norm(f_value1 - f_value2);
-        int b = std::norm(f_value1 - pf_value2);
-        int c = std::norm(pf_value1 - f_value2);
-        int d = std::norm(pf_value1 - pf_value2);
+        const auto dims = vector_td<int,3>(field_map.get_size(0),field_map.get_size(1),field_map.get_size(2));
 
-        float weight = b + c - a - d;
+        auto update_regularization_edge = [&](const size_t idx, const size_t idx2, unsigned int dimension,
+                                              float scaling) {
+            int f_value1 = field_map[idx];
+            int pf_value1 = proposed_field_map[idx];
+            int f_value2 = field_map[idx2];
+            int pf_value2 = proposed_field_map[idx2];
+            int a = std::norm(f_value1 - f_value2);
+            int b = std::norm(f_value1 - pf_value2);
+            int c = std::norm(pf_value1 - f_value2);
+            int d = std::norm(pf_value1 - pf_value2);
 
-        assert(weight >= 0);
-        float lambda = std::max(std::min(second_deriv[idx], second_deriv[idx2]), 0.0f) * scaling;
-        weight *= lambda;
+            float weight = b + c - a - d;
 
-        assert(lambda >= 0);
+            assert(weight >= 0);
+            float lambda = std::max(std::min(second_deriv[idx], second_deriv[idx2]), 0.0f) * scaling;
+            weight *= lambda;
 
-        auto &capacity_map = graph.edge_capacity_map;
+            assert(lambda >= 0);
 
-        capacity_map[edge_idx] += weight;
-        {
-            float aq = lambda * (c - a);
+            add_edge(idx, dimension, weight);
+            {
+                float aq = lambda * (c - a);
 
-            if (aq > 0) {
-                capacity_map[graph.edge_from_source(idx)] += aq;
+                if (aq > 0) {
+                    add_source(idx, aq);
 
-            } else {
-                capacity_map[graph.edge_to_sink(idx)] -= aq;
+                } else {
+                    add_sink(idx, -aq);
+                }
             }
-        }
 
-        {
-            float aj = lambda * (d - c);
-            if (aj > 0) {
-                capacity_map[graph.edge_from_source(idx2)] += aj;
+            {
+                float aj = lambda * (d - c);
+                if (aj > 0) {
+                    add_source(idx2, aj);
 
-            } else {
-                capacity_map[graph.edge_to_sink(idx2)] -= aj;
+                } else {
+                    add_sink(idx2, -aj);
+                }
             }
-        }
-
-
-    }
-
-    template<unsigned int D>
-    ImageGraph<D> make_graph(const hoNDArray<uint16_t> &field_map, const hoNDArray<uint16_t> &proposed_field_map,
-                             const hoNDArray<float> &residual_diff_map, const hoNDArray<float> &second_deriv) {
-
-        const auto dims = vector_td<int,3>(field_map.get_size(0),field_map.get_size(1),field_map.get_size(2));
-
-        vector_td<int,D> graph_dims;
-        for (int i = 0; i < D; i++) graph_dims[i] = dims[i];
+        };
 
-        ImageGraph<D> graph = ImageGraph<D>(graph_dims);
-
-        auto &capacity_map = graph.edge_capacity_map;
         //Add regularization edges
 
         for (size_t kz = 0; kz < dims[2]; kz++) {
@@ -85,40 +79,110 @@ namespace {
 
                     if (kx < (dims[0] - 1)) {
                         size_t idx2 = idx + 1;
-
-                        update_regularization_edge(graph, field_map, proposed_field_map, second_deriv, idx, idx2,
-                                                   graph.edge(idx, idx2).first, 1);
+                        update_regularization_edge(idx, idx2, 0, 1);
                     }
 
 
                     if (ky < (dims[1] - 1)) {
                         size_t idx2 = idx + dims[0];
-                        update_regularization_edge(graph, field_map, proposed_field_map, second_deriv, idx, idx2,
-                                                   graph.edge(idx, idx2).first, 1);
+                        update_regularization_edge(idx, idx2, 1, 1);
                     }
 
                     if (kz < (dims[2] - 1)) {
                         size_t idx2 = idx + dims[0]*dims[1];
-                        update_regularization_edge(graph, field_map, proposed_field_map, second_deriv, idx, idx2,
-                                                   graph.edge(idx, idx2).first, 1);
+                        update_regularization_edge(idx, idx2, 2, 1);
                     }
 
                     float residual_diff = residual_diff_map[idx];
 
                     if (residual_diff > 0) {
-                        capacity_map[graph.edge_to_sink(idx)] += int(residual_diff);
+                        add_sink(idx, int(residual_diff));
 
                     } else {
-                        capacity_map[graph.edge_from_source(idx)] -= int(residual_diff);
+                        add_source(idx, -int(residual_diff));
                     }
 
                 }
             }
         }
+    }
+
+    template<unsigned int D>
+    ImageGraph<D> make_graph(const hoNDArray<uint16_t> &field_map, const hoNDArray<uint16_t> &proposed_field_map,
+                             const hoNDArray<float> &residual_diff_map, const hoNDArray<float> &second_deriv) {
+
+        vector_td<int,D> graph_dims;
+        for (int i = 0; i < D; i++) graph_dims[i] = field_map.get_size(i);
+
+        ImageGraph<D> graph = ImageGraph<D>(graph_dims);
+
+        auto &capacity_map = graph.edge_capacity_map;
+
+        add_graph_capacities(field_map, proposed_field_map, residual_diff_map, second_deriv,
+                             [&](size_t idx, unsigned int dimension, float capacity) {
+                                 size_t stride = 1;
+                                 for (unsigned int i = 0; i < dimension; i++) stride *= graph_dims[i];
+                                 capacity_map[graph.edge(idx, idx + stride).first] += capacity;
+                             },
+                             [&](size_t idx, float capacity) { capacity_map[graph.edge_from_source(idx)] += capacity; },
+                             [&](size_t idx, float capacity) { capacity_map[graph.edge_to_sink(idx)] += capacity; });
 
         return graph;
     }
 
+    template<unsigned int D>
+    void fill_grid_graph(GridMaxFlow<D> &graph, const hoNDArray<uint16_t> &field_map,
+                         const hoNDArray<uint16_t> &proposed_field_map, const hoNDArray<float> &residual_diff_map,
+                         const hoNDArray<float> &second_deriv) {
+        graph.reset();
+        add_graph_capacities(field_map, proposed_field_map, residual_diff_map, second_deriv,
+                             [&](size_t idx, unsigned int dimension, float capacity) {
+                                 graph.add_edge_capacity(idx, GridMaxFlow<D>::forward_direction(dimension), capacity);
+                             },
+                             [&](size_t idx, float capacity) { graph.add_source_capacity(idx, capacity); },
+                             [&](size_t idx, float capacity) { graph.add_sink_capacity(idx, capacity); });
+    }
+
+    template<unsigned int D>
+    std::vector<uint8_t>
+    grid_graph_cut(std::unique_ptr<GridMaxFlow<D>> &graph, const hoNDArray<uint16_t> &field_map_index,
+                   const hoNDArray<uint16_t> &proposed_field_map_index, const hoNDArray<float> &lambda_map,
+                   const hoNDArray<float> &residual_diff_map, bool parallel) {
+
+        vector_td<int,D> graph_dims;
+        for (int i = 0; i < D; i++) graph_dims[i] = field_map_index.get_size(i);
+
+        if (!graph || graph->dimensions() != graph_dims)
+            graph = std::make_unique<GridMaxFlow<D>>(graph_dims);
+
+        fill_grid_graph(*graph, field_map_index, proposed_field_map_index, residual_diff_map, lambda_map);
+        graph->solve(parallel);
+
+        return graph->source_set();
+    }
+
+    hoNDArray<float> calculate_residual_diff(const hoNDArray<uint16_t> &field_map_index,
+                                             const hoNDArray<uint16_t> &proposed_field_map_index,
+                                             const hoNDArray<float> &residuals_map) {
+
+        hoNDArray<float> residual_diff_map(field_map_index.dimensions());
+        const auto X = field_map_index.get_size(0);
+        const auto Y = field_map_index.get_size(1);
+        const auto Z = field_map_index.get_size(2);
+
+        for (size_t kz = 0; kz < Z; kz++) {
+            for (size_t ky = 0; ky < Y; ky++) {
+                for (size_t kx = 0; kx < X; kx++) {
+                    residual_diff_map(kx, ky,kz) = residuals_map(field_map_index(kx, ky,kz), kx, ky,kz) -
+                                                residuals_map(proposed_field_map_index(kx, ky,kz), kx, ky,kz);
+
+
+                }
+            }
+        }
+        return residual_diff_map;
+    }
+
     template<unsigned int DIMS>
     std::vector<boost::default_color_type>
     graph_cut(const hoNDArray<uint16_t> &field_map_index, const hoNDArray<uint16_t> &proposed_field_map_index,
@@ -141,22 +205,10 @@ namespace Gadgetron {
                      const hoNDArray<float> &residuals_map, const hoNDArray<float> &lambda_map) {
 
 
-        hoNDArray<float> residual_diff_map(field_map_index.dimensions());
-        const auto X = field_map_index.get_size(0);
-        const auto Y = field_map_index.get_size(1);
+        hoNDArray<float> residual_diff_map = calculate_residual_diff(field_map_index, proposed_field_map_index,
+                                                                     residuals_map);
         const auto Z = field_map_index.get_size(2);
 
-        for (size_t kz = 0; kz < Z; kz++) {
-            for (size_t ky = 0; ky < Y; ky++) {
-                for (size_t kx = 0; kx < X; kx++) {
-                    residual_diff_map(kx, ky,kz) = residuals_map(field_map_index(kx, ky,kz), kx, ky,kz) -
-                                                residuals_map(proposed_field_map_index(kx, ky,kz), kx, ky,kz);
-
-
-                }
-            }
-        }
-
 
         std::vector<boost::default_color_type> color_map;
         if (Z == 1) {
@@ -181,4 +233,38 @@ namespace Gadgetron {
 
     }
 
-}
\ No newline at end of file
+    FieldMapGraphCut::FieldMapGraphCut(FatWater::GraphCutSolver solver) : solver_(solver) {}
+
+    FieldMapGraphCut::~FieldMapGraphCut() = default;
+
+    hoNDArray<uint16_t>
+    FieldMapGraphCut::update_field_map(const hoNDArray<uint16_t> &field_map_index,
+                                       const hoNDArray<uint16_t> &proposed_field_map_index,
+                                       const hoNDArray<float> &residuals_map, const hoNDArray<float> &lambda_map) {
+
+        if (solver_ == FatWater::GraphCutSolver::boykov_kolmogorov)
+            return Gadgetron::update_field_map(field_map_index, proposed_field_map_index, residuals_map, lambda_map);
+
+        hoNDArray<float> residual_diff_map = calculate_residual_diff(field_map_index, proposed_field_map_index,
+                                                                     residuals_map);
+        const auto Z = field_map_index.get_size(2);
+        const bool parallel = solver_ == FatWater::GraphCutSolver::grid_parallel;
+
+        std::vector<uint8_t> source_set;
+        if (Z == 1) {
+            source_set = grid_graph_cut<2>(graph2D_, field_map_index, proposed_field_map_index, lambda_map,
+                                           residual_diff_map, parallel);
+        } else {
+            source_set = grid_graph_cut<3>(graph3D_, field_map_index, proposed_field_map_index, lambda_map,
+                                           residual_diff_map, parallel);
+        }
+
+        auto result = field_map_index;
+        for (size_t i = 0; i < field_map_index.get_number_of_elements(); i++) {
+            if (!source_set[i]) result[i] = proposed_field_map_index[i];
+        }
+
+        return result;
+    }
+
+}
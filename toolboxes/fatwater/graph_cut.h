@@ -3,11 +3,36 @@
 
 
 #include "hoNDArray.h"
+#include "fatwater.h"
+
+#include <memory>
+
 namespace  Gadgetron {
 
+    template<unsigned int D> class GridMaxFlow;
 
     hoNDArray <uint16_t>
     update_field_map(const hoNDArray <uint16_t> &field_map_index, const hoNDArray <uint16_t> &proposed_field_map_index,
                      const hoNDArray<float> &residuals_map, const hoNDArray<float> &lambda_map);
 
-}
\ No newline at end of file
+    /**
+     * Graph-cut field map update which keeps its graph between calls.
+     * Use one instance for all iterations of the field map estimation to avoid rebuilding the graph.
+     * All solvers give the same labelling.
+     */
+    class FieldMapGraphCut {
+    public:
+        explicit FieldMapGraphCut(FatWater::GraphCutSolver solver = FatWater::GraphCutSolver::grid_parallel);
+        ~FieldMapGraphCut();
+
+        hoNDArray <uint16_t>
+        update_field_map(const hoNDArray <uint16_t> &field_map_index, const hoNDArray <uint16_t> &proposed_field_map_index,
+                         const hoNDArray<float> &residuals_map, const hoNDArray<float> &lambda_map);
+
+    private:
+        FatWater::GraphCutSolver solver_;
+        std::unique_ptr<GridMaxFlow<2>> graph2D_;
+        std::unique_ptr<GridMaxFlow<3>> graph3D_;
+    };
+
+}
@@ -0,0 +1,405 @@
+#include "grid_max_flow.h"
+
+#include <algorithm>
+#include <deque>
+#include <limits>
+
+#ifdef USE_OMP
+#include <omp.h>
+#endif
+
+namespace Gadgetron {
+
+    namespace {
+        constexpr uint8_t FREE = 0;
+        constexpr uint8_t SOURCE_TREE = 1;
+        constexpr uint8_t SINK_TREE = 2;
+
+        // Parent values 0..2D-1 are neighbour directions
+        constexpr uint8_t TERMINAL = 254;
+        constexpr uint8_t ORPHAN = 253;
+        constexpr uint8_t NO_PARENT = 255;
+
+        constexpr int INFINITE_DISTANCE = std::numeric_limits<int>::max();
+    }
+
+    template<unsigned int D>
+    GridMaxFlow<D>::GridMaxFlow(const vector_td<int, D> &dims) : dims_(dims) {
+
+        num_voxels_ = 1;
+        for (unsigned int d = 0; d < D; d++) {
+            strides_[d] = num_voxels_;
+            num_voxels_ *= dims_[d];
+        }
+
+        boundary_mask_ = std::vector<uint8_t>(num_voxels_, 0);
+        for (size_t idx = 0; idx < num_voxels_; idx++) {
+            uint8_t mask = 0;
+            for (unsigned int d = 0; d < D; d++) {
+                size_t co = (idx / strides_[d]) % dims_[d];
+                if (co > 0) mask |= 1u << (2 * d);
+                if (co < size_t(dims_[d] - 1)) mask |= 1u << (2 * d + 1);
+            }
+            boundary_mask_[idx] = mask;
+        }
+
+        capacity_ = std::vector<float>(num_voxels_ * neighbours, 0);
+        source_capacity_ = std::vector<float>(num_voxels_, 0);
+        sink_capacity_ = std::vector<float>(num_voxels_, 0);
+
+        terminal_capacity_ = std::vector<float>(num_voxels_, 0);
+        tree_ = std::vector<uint8_t>(num_voxels_, FREE);
+        parent_ = std::vector<uint8_t>(num_voxels_, NO_PARENT);
+        active_ = std::vector<uint8_t>(num_voxels_, 0);
+        timestamp_ = std::vector<int>(num_voxels_, 0);
+        distance_ = std::vector<int>(num_voxels_, 0);
+        source_set_ = std::vector<uint8_t>(num_voxels_, 0);
+    }
+
+    template<unsigned int D>
+    void GridMaxFlow<D>::reset() {
+        std::fill(capacity_.begin(), capacity_.end(), 0.0f);
+        std::fill(source_capacity_.begin(), source_capacity_.end(), 0.0f);
+        std::fill(sink_capacity_.begin(), sink_capacity_.end(), 0.0f);
+    }
+
+    template<unsigned int D>
+    float GridMaxFlow<D>::solve(bool parallel) {
+
+        // Flow pushed directly from source to sink through a voxel does not change the cut
+        float flow = 0;
+        for (size_t idx = 0; idx < num_voxels_; idx++) {
+            float direct = std::min(source_capacity_[idx], sink_capacity_[idx]);
+            flow += direct;
+            terminal_capacity_[idx] = source_capacity_[idx] - sink_capacity_[idx];
+        }
+
+        const size_t slab_size = strides_[D - 1];
+        const size_t slabs = dims_[D - 1];
+
+        int num_regions = 1;
+#ifdef USE_OMP
+        if (parallel) num_regions = std::min<int>(omp_get_max_threads(), slabs);
+#endif
+
+        if (num_regions > 1) {
+            std::vector<float> region_flow(num_regions, 0);
+
+#pragma omp parallel for num_threads(num_regions)
+            for (int region = 0; region < num_regions; region++) {
+                Range range{slab_size * ((slabs * region) / num_regions),
+                            slab_size * ((slabs * (region + 1)) / num_regions)};
+                region_flow[region] = run_boykov_kolmogorov(range);
+            }
+
+            for (auto f : region_flow) flow += f;
+        }
+
+        flow += run_boykov_kolmogorov(Range{0, num_voxels_});
+
+        compute_source_set();
+
+        return flow;
+    }
+
+    template<unsigned int D>
+    float GridMaxFlow<D>::run_boykov_kolmogorov(Range range) {
+
+        std::deque<size_t> active_nodes;
+        std::deque<size_t> orphans;
+
+        auto set_active = [&](size_t idx) {
+            if (!active_[idx]) {
+                active_[idx] = 1;
+                active_nodes.push_back(idx);
+            }
+        };
+
+        for (size_t idx = range.begin; idx < range.end; idx++) {
+            timestamp_[idx] = 0;
+            active_[idx] = 0;
+            if (terminal_capacity_[idx] > 0) {
+                tree_[idx] = SOURCE_TREE;
+                parent_[idx] = TERMINAL;
+                distance_[idx] = 1;
+                set_active(idx);
+            } else if (terminal_capacity_[idx] < 0) {
+                tree_[idx] = SINK_TREE;
+                parent_[idx] = TERMINAL;
+                distance_[idx] = 1;
+                set_active(idx);
+            } else {
+                tree_[idx] = FREE;
+                parent_[idx] = NO_PARENT;
+            }
+        }
+
+        float flow = 0;
+        int time = 0;
+
+        // Distance from idx to its terminal, following parents. Marks the visited path with the current time.
+        auto distance_to_terminal = [&](size_t start) -> int {
+            int dist = 0;
+            size_t k = start;
+            while (true) {
+                if (timestamp_[k] == time) {
+                    dist += distance_[k];
+                    break;
+                }
+                uint8_t p = parent_[k];
+                dist++;
+                if (p == TERMINAL) {
+                    timestamp_[k] = time;
+                    distance_[k] = 1;
+                    break;
+                }
+                if (p == ORPHAN || p == NO_PARENT) return INFINITE_DISTANCE;
+                k = neighbour(k, p);
+            }
+
+            int d = dist;
+            for (k = start; timestamp_[k] != time; k = neighbour(k, parent_[k])) {
+                timestamp_[k] = time;
+                distance_[k] = d;
+                d--;
+            }
+            return dist;
+        };
+
+        auto set_orphan_front = [&](size_t idx) {
+            parent_[idx] = ORPHAN;
+            orphans.push_front(idx);
+        };
+
+        auto set_orphan_rear = [&](size_t idx) {
+            parent_[idx] = ORPHAN;
+            orphans.push_back(idx);
+        };
+
+        auto augment = [&](size_t a, unsigned int dir) {
+            size_t b = neighbour(a, dir);
+
+            // Bottleneck on the source side
+            float bottleneck = capacity_[a * neighbours + dir];
+            size_t k = a;
+            while (parent_[k] != TERMINAL) {
+                unsigned int p = parent_[k];
+                size_t w = neighbour(k, p);
+                bottleneck = std::min(bottleneck, capacity_[w * neighbours + opposite(p)]);
+                k = w;
+            }
+            bottleneck = std::min(bottleneck, terminal_capacity_[k]);
+
+            // Bottleneck on the sink side
+            k = b;
+            while (parent_[k] != TERMINAL) {
+                unsigned int p = parent_[k];
+                bottleneck = std::min(bottleneck, capacity_[k * neighbours + p]);
+                k = neighbour(k, p);
+            }
+            bottleneck = std::min(bottleneck, -terminal_capacity_[k]);
+
+            capacity_[a * neighbours + dir] -= bottleneck;
+            capacity_[b * neighbours + opposite(dir)] += bottleneck;
+
+            k = a;
+            while (parent_[k] != TERMINAL) {
+                unsigned int p = parent_[k];
+                size_t w = neighbour(k, p);
+                capacity_[k * neighbours + p] += bottleneck;
+                capacity_[w * neighbours + opposite(p)] -= bottleneck;
+                if (capacity_[w * neighbours + opposite(p)] == 0) set_orphan_front(k);
+                k = w;
+            }
+            terminal_capacity_[k] -= bottleneck;
+            if (terminal_capacity_[k] == 0) set_orphan_front(k);
+
+            k = b;
+            while (parent_[k] != TERMINAL) {
+                unsigned int p = parent_[k];
+                size_t w = neighbour(k, p);
+                capacity_[w * neighbours + opposite(p)] += bottleneck;
+                capacity_[k * neighbours + p] -= bottleneck;
+                if (capacity_[k * neighbours + p] == 0) set_orphan_front(k);
+                k = w;
+            }
+            terminal_capacity_[k] += bottleneck;
+            if (terminal_capacity_[k] == 0) set_orphan_front(k);
+
+            flow += bottleneck;
+        };
+
+        auto process_orphan = [&](size_t idx) {
+            const uint8_t tree = tree_[idx];
+            int best_distance = INFINITE_DISTANCE;
+            uint8_t best_parent = NO_PARENT;
+
+            for (unsigned int dir = 0; dir < neighbours; dir++) {
+                if (!has_neighbour(idx, dir, range)) continue;
+                size_t j = neighbour(idx, dir);
+                if (tree_[j] != tree || parent_[j] == NO_PARENT) continue;
+
+                // Residual capacity from the parent candidate towards the tree root
+                float cap = (tree == SOURCE_TREE) ? capacity_[j * neighbours + opposite(dir)]
+                                                  : capacity_[idx * neighbours + dir];
+                if (cap <= 0) continue;
+
+                int dist = distance_to_terminal(j);
+                if (dist < best_distance) {
+                    best_distance = dist;
+                    best_parent = dir;
+                }
+            }
+
+            if (best_parent != NO_PARENT) {
+                parent_[idx] = best_parent;
+                timestamp_[idx] = time;
+                distance_[idx] = best_distance + 1;
+                return;
+            }
+
+            // No valid parent: the voxel becomes free
+            parent_[idx] = NO_PARENT;
+            tree_[idx] = FREE;
+            for (unsigned int dir = 0; dir < neighbours; dir++) {
+                if (!has_neighbour(idx, dir, range)) continue;
+                size_t j = neighbour(idx, dir);
+                if (tree_[j] != tree || parent_[j] == NO_PARENT) continue;
+
+                float cap = (tree == SOURCE_TREE) ? capacity_[j * neighbours + opposite(dir)]
+                                                  : capacity_[idx * neighbours + dir];
+                if (cap > 0) set_active(j);
+
+                uint8_t p = parent_[j];
+                if (p != TERMINAL && p != ORPHAN && p == opposite(dir)) set_orphan_rear(j);
+            }
+        };
+
+        bool has_current = false;
+        size_t current = 0;
+
+        while (true) {
+            size_t i;
+            if (has_current && parent_[current] != NO_PARENT) {
+                i = current;
+            } else {
+                has_current = false;
+                bool found_active = false;
+                while (!active_nodes.empty()) {
+                    i = active_nodes.front();
+                    active_nodes.pop_front();
+                    active_[i] = 0;
+                    if (parent_[i] != NO_PARENT) {
+                        found_active = true;
+                        break;
+                    }
+                }
+                if (!found_active) break;
+            }
+
+            // Growth
+            bool found_path = false;
+            size_t path_start = 0;
+            unsigned int path_dir = 0;
+
+            if (tree_[i] == SOURCE_TREE) {
+                for (unsigned int dir = 0; dir < neighbours; dir++) {
+                    if (!has_neighbour(i, dir, range)) continue;
+                    if (capacity_[i * neighbours + dir] <= 0) continue;
+                    size_t j = neighbour(i, dir);
+                    if (tree_[j] == FREE) {
+                        tree_[j] = SOURCE_TREE;
+                        parent_[j] = opposite(dir);
+                        timestamp_[j] = timestamp_[i];
+                        distance_[j] = distance_[i] + 1;
+                        set_active(j);
+                    } else if (tree_[j] == SINK_TREE) {
+                        found_path = true;
+                        path_start = i;
+                        path_dir = dir;
+                        break;
+                    } else if (timestamp_[j] <= timestamp_[i] && distance_[j] > distance_[i]) {
+                        parent_[j] = opposite(dir);
+                        timestamp_[j] = timestamp_[i];
+                        distance_[j] = distance_[i] + 1;
+                    }
+                }
+            } else {
+                for (unsigned int dir = 0; dir < neighbours; dir++) {
+                    if (!has_neighbour(i, dir, range)) continue;
+                    size_t j = neighbour(i, dir);
+                    if (capacity_[j * neighbours + opposite(dir)] <= 0) continue;
+                    if (tree_[j] == FREE) {
+                        tree_[j] = SINK_TREE;
+                        parent_[j] = opposite(dir);
+                        timestamp_[j] = timestamp_[i];
+                        distance_[j] = distance_[i] + 1;
+                        set_active(j);
+                    } else if (tree_[j] == SOURCE_TREE) {
+                        found_path = true;
+                        path_start = j;
+                        path_dir = opposite(dir);
+                        break;
+                    } else if (timestamp_[j] <= timestamp_[i] && distance_[j] > distance_[i]) {
+                        parent_[j] = opposite(dir);
+                        timestamp_[j] = timestamp_[i];
+                        distance_[j] = distance_[i] + 1;
+                    }
+                }
+            }
+
+            time++;
+
+            if (found_path) {
+                // Keep processing this voxel, it may still have other paths
+                has_current = true;
+                current = i;
+
+                augment(path_start, path_dir);
+
+                // Adoption
+                while (!orphans.empty()) {
+                    size_t orphan = orphans.front();
+                    orphans.pop_front();
+                    process_orphan(orphan);
+                }
+            } else {
+                has_current = false;
+            }
+        }
+
+        return flow;
+    }
+
+    template<unsigned int D>
+    void GridMaxFlow<D>::compute_source_set() {
+
+        std::fill(source_set_.begin(), source_set_.end(), 0);
+
+        std::vector<size_t> stack;
+        for (size_t idx = 0; idx < num_voxels_; idx++) {
+            if (terminal_capacity_[idx] > 0) {
+                source_set_[idx] = 1;
+                stack.push_back(idx);
+            }
+        }
+
+        const Range full{0, num_voxels_};
+        while (!stack.empty()) {
+            size_t idx = stack.back();
+            stack.pop_back();
+            for (unsigned int dir = 0; dir < neighbours; dir++) {
+                if (!has_neighbour(idx, dir, full)) continue;
+                if (capacity_[idx * neighbours + dir] <= 0) continue;
+                size_t j = neighbour(idx, dir);
+                if (!source_set_[j]) {
+                    source_set_[j] = 1;
+                    stack.push_back(j);
+                }
+            }
+        }
+    }
+
+    template class GridMaxFlow<2>;
+    template class GridMaxFlow<3>;
+}
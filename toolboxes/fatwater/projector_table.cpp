@@ -0,0 +1,169 @@
+#include "projector_table.h"
+
+#include "hoNDArray_linalg.h"
+
+#include <boost/math/constants/constants.hpp>
+
+#include <algorithm>
+#include <list>
+#include <mutex>
+
+namespace Gadgetron {
+    namespace FatWater {
+
+        namespace {
+            using namespace std::complex_literals;
+            constexpr double PI = boost::math::constants::pi<double>();
+
+            void pack_projector(const arma::Mat<std::complex<double>> &Q, double *packed) {
+                const size_t nte = Q.n_rows;
+                for (size_t i = 0; i < nte; i++)
+                    packed[i] = std::real(Q(i, i));
+
+                size_t offset = nte;
+                for (size_t i = 0; i < nte; i++) {
+                    for (size_t j = i + 1; j < nte; j++) {
+                        packed[offset++] = 2 * std::real(Q(i, j));
+                        packed[offset++] = -2 * std::imag(Q(i, j));
+                    }
+                }
+            }
+        }
+
+        ProjectorTable::ProjectorTable(const std::vector<float> &echo_times, const arma::Mat<std::complex<float>> &phi,
+                                       const std::vector<float> &field_map_strengths,
+                                       const std::vector<float> &r2stars)
+            : echoes_(echo_times.size()), field_maps_(field_map_strengths.size()), r2stars_(r2stars.size()),
+              table_(echo_times.size() * echo_times.size(), r2stars.size(), field_map_strengths.size()) {
+
+            const size_t nte = echoes_;
+
+            // The unshifted projectors only depend on R2*
+            const arma::Mat<std::complex<double>> phi_d = arma::conv_to<arma::Mat<std::complex<double>>>::from(phi);
+            std::vector<arma::Mat<std::complex<double>>> projectors(r2stars_);
+            for (size_t kr = 0; kr < r2stars_; kr++) {
+                arma::Mat<std::complex<double>> psi(phi.n_rows, phi.n_cols);
+                for (size_t k1 = 0; k1 < phi.n_rows; k1++) {
+                    auto modulation = std::exp(-double(r2stars[kr]) * (double(echo_times[k1]) - echo_times[0]));
+                    for (size_t k2 = 0; k2 < phi.n_cols; k2++)
+                        psi(k1, k2) = phi_d(k1, k2) * modulation;
+                }
+                projectors[kr] = arma::eye<arma::Mat<std::complex<double>>>(nte, nte) - psi * arma::pinv(psi);
+            }
+
+#pragma omp parallel for
+            for (int kf = 0; kf < (int)field_maps_; kf++) {
+                arma::Col<std::complex<double>> b_shifts(nte);
+                for (size_t kt = 0; kt < nte; kt++)
+                    b_shifts[kt] = std::exp(2i * PI * (double(echo_times[kt]) - echo_times[0]) *
+                                            double(field_map_strengths[kf]));
+
+                for (size_t kr = 0; kr < r2stars_; kr++) {
+                    arma::Mat<std::complex<double>> P =
+                            arma::diagmat(b_shifts) * projectors[kr] * arma::diagmat(arma::conj(b_shifts));
+                    arma::Mat<std::complex<double>> Q = P.t() * P;
+                    pack_projector(Q, &table_(0, kr, kf));
+                }
+            }
+        }
+
+        void ProjectorTable::residuals(const hoNDArray<double> &packed_covariance, hoNDArray<float> &residuals) const {
+            hoNDArray<double> table(packed_size(), r2stars_ * field_maps_, const_cast<double *>(table_.data()));
+            hoNDArray<double> precise;
+            Gadgetron::gemm(precise, table, true, packed_covariance, false);
+
+            residuals.create(precise.dimensions());
+            // A residual is a squared norm; rounding may still leave it slightly negative
+            std::transform(precise.begin(), precise.end(), residuals.begin(),
+                           [](double r) { return float(std::max(r, 0.0)); });
+        }
+
+        void ProjectorTable::pack_covariance(const std::complex<float> *signal, size_t echoes, size_t columns,
+                                             size_t echo_stride, size_t column_stride, double *packed) {
+
+            std::fill(packed, packed + echoes * echoes, 0.0);
+
+            for (size_t c = 0; c < columns; c++) {
+                const std::complex<float> *s = signal + c * column_stride;
+                for (size_t i = 0; i < echoes; i++)
+                    packed[i] += std::norm(std::complex<double>(s[i * echo_stride]));
+
+                size_t offset = echoes;
+                for (size_t i = 0; i < echoes; i++) {
+                    const std::complex<double> si = std::conj(std::complex<double>(s[i * echo_stride]));
+                    for (size_t j = i + 1; j < echoes; j++) {
+                        const std::complex<double> m = si * std::complex<double>(s[j * echo_stride]);
+                        packed[offset++] += std::real(m);
+                        packed[offset++] += std::imag(m);
+                    }
+                }
+            }
+        }
+
+        namespace {
+            struct ProjectorTableCache {
+                struct Entry {
+                    std::vector<float> key;
+                    std::shared_ptr<const ProjectorTable> table;
+                };
+
+                static constexpr size_t max_entries = 8;
+
+                std::mutex mutex;
+                std::list<Entry> entries; // Most recently used first
+            };
+
+            ProjectorTableCache &projector_table_cache() {
+                static ProjectorTableCache cache;
+                return cache;
+            }
+
+            std::vector<float> make_key(const std::vector<float> &echo_times, const arma::Mat<std::complex<float>> &phi,
+                                        const std::vector<float> &field_map_strengths,
+                                        const std::vector<float> &r2stars) {
+                std::vector<float> key;
+                key.reserve(4 + echo_times.size() + 2 * phi.n_elem + field_map_strengths.size() + r2stars.size());
+
+                key.push_back(echo_times.size());
+                key.insert(key.end(), echo_times.begin(), echo_times.end());
+                key.push_back(phi.n_cols);
+                for (auto p : phi) {
+                    key.push_back(std::real(p));
+                    key.push_back(std::imag(p));
+                }
+                key.push_back(field_map_strengths.size());
+                key.insert(key.end(), field_map_strengths.begin(), field_map_strengths.end());
+                key.push_back(r2stars.size());
+                key.insert(key.end(), r2stars.begin(), r2stars.end());
+                return key;
+            }
+        }
+
+        std::shared_ptr<const ProjectorTable>
+        get_projector_table(const std::vector<float> &echo_times, const arma::Mat<std::complex<float>> &phi,
+                            const std::vector<float> &field_map_strengths, const std::vector<float> &r2stars) {
+
+            auto key = make_key(echo_times, phi, field_map_strengths, r2stars);
+            auto &cache = projector_table_cache();
+
+            {
+                std::lock_guard<std::mutex> guard(cache.mutex);
+                auto it = std::find_if(cache.entries.begin(), cache.entries.end(),
+                                       [&](const auto &entry) { return entry.key == key; });
+                if (it != cache.entries.end()) {
+                    cache.entries.splice(cache.entries.begin(), cache.entries, it);
+                    return it->table;
+                }
+            }
+
+            // Built outside the lock; concurrent builds of the same table are harmless
+            auto table = std::make_shared<const ProjectorTable>(echo_times, phi, field_map_strengths, r2stars);
+
+            std::lock_guard<std::mutex> guard(cache.mutex);
+            cache.entries.push_front(ProjectorTableCache::Entry{std::move(key), table});
+            if (cache.entries.size() > ProjectorTableCache::max_entries) cache.entries.pop_back();
+
+            return table;
+        }
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "fatwater.h"
+
+#include <armadillo>
+#include <complex>
+#include <memory>
+#include <vector>
+
+namespace Gadgetron {
+    namespace FatWater {
+
+        /**
+           Residual projectors for every field map x R2* grid point, stored in one contiguous array.
+
+           For a projector P and signal columns s_c, the residual sum_c |P s_c|^2 equals sum_ij Q_ij M_ij with
+           Q = P^H P and M_ij = sum_c conj(s_ci) s_cj. Both are Hermitian, so they are packed into nte^2 real values
+           (diagonal, then real and imaginary part of the upper triangle) such that the residual is a dot product.
+           The residuals of a block of pixels for all grid points are then a single real GEMM.
+
+           The residual is a small difference of large terms when the signal is well explained by the model, so the
+           projectors, covariances and the GEMM are kept in double precision, and the result is clamped at zero.
+         */
+        class ProjectorTable {
+        public:
+            ProjectorTable(const std::vector<float> &echo_times, const arma::Mat<std::complex<float>> &phi,
+                           const std::vector<float> &field_map_strengths, const std::vector<float> &r2stars);
+
+            size_t number_of_echoes() const { return echoes_; }
+            size_t number_of_field_maps() const { return field_maps_; }
+            size_t number_of_r2stars() const { return r2stars_; }
+
+            /// Length of one packed projector or covariance, equal to number_of_echoes()^2
+            size_t packed_size() const { return echoes_ * echoes_; }
+
+            /// Packed projectors, [packed_size, R2*, field map]
+            const hoNDArray<double> &packed_projectors() const { return table_; }
+
+            /// Residuals [R2* x field map, pixels] for packed covariances [packed_size, pixels]; R2* runs fastest
+            void residuals(const hoNDArray<double> &packed_covariance, hoNDArray<float> &residuals) const;
+
+            /// Packs the covariance of the signal columns. Echo e of column c is at signal[c*column_stride + e*echo_stride]
+            static void pack_covariance(const std::complex<float> *signal, size_t echoes, size_t columns,
+                                        size_t echo_stride, size_t column_stride, double *packed);
+
+        private:
+            size_t echoes_;
+            size_t field_maps_;
+            size_t r2stars_;
+            hoNDArray<double> table_;
+        };
+
+        /**
+           Returns the projector table for these parameters from a process wide cache, creating it if needed.
+           The table only depends on the echo times, the species model (phi) and the grids, so it is shared
+           between slices, repetitions and connections.
+         */
+        std::shared_ptr<const ProjectorTable>
+        get_projector_table(const std::vector<float> &echo_times, const arma::Mat<std::complex<float>> &phi,
+                            const std::vector<float> &field_map_strengths, const std::vector<float> &r2stars);
+    }
+}
@@ -11,6 +11,10 @@
 #include "hoNDArray_reductions.h"
 #include "complext.h"
 #include "GadgetronTimer.h"
+
+#include <algorithm>
+#include <vector>
+
 #ifdef USE_OMP
     #include <omp.h>
 #endif // USE_OMP
@@ -228,6 +232,546 @@ template void coil_map_2d_Inati(const hoNDArray< complext<float> >& data, hoNDAr
 template void coil_map_2d_Inati(const hoNDArray< complext<double> >& data, hoNDArray< complext<double> >& coilMap, size_t ks, size_t power);
 // ------------------------------------------------------------------------
 
+namespace
+{
+    // Box filtered local statistics used by coil_map_2d_Inati_fast
+    // for every pixel, the features are conj(x_i)*x_j for i <= j (the packed upper triangle of D'*D),
+    // followed by x_c (the local channel sum); features are stored as separate real and imaginary planes [feature RO]
+    template<typename T>
+    class InatiRowFilter
+    {
+    public:
+        typedef typename realType<T>::Type value_type;
+
+        InatiRowFilter(const T* pData, long long RO, long long E1, long long CHA, long long ks, bool with_covariance)
+            : pData_(pData), RO_(RO), E1_(E1), CHA_(CHA), halfKs_(ks / 2)
+        {
+            num_pairs_ = with_covariance ? CHA*(CHA + 1) / 2 : 0;
+            num_features_ = num_pairs_ + CHA;
+
+            x_re_.resize(CHA*RO);
+            x_im_.resize(CHA*RO);
+            line_re_.resize(RO);
+            line_im_.resize(RO);
+        }
+
+        size_t num_pairs() const { return num_pairs_; }
+        size_t num_features() const { return num_features_; }
+
+        /// horizontally box filtered features of row e1, periodic boundary
+        /// re, im : [num_features RO]
+        void filter_row(long long e1, value_type* re, value_type* im)
+        {
+            e1 = wrap(e1, E1_);
+
+            long long cha, ro;
+            for (cha = 0; cha < CHA_; cha++)
+            {
+                const T* pRow = pData_ + cha*RO_*E1_ + e1*RO_;
+                value_type* pRe = &x_re_[cha*RO_];
+                value_type* pIm = &x_im_[cha*RO_];
+                for (ro = 0; ro < RO_; ro++)
+                {
+                    pRe[ro] = pRow[ro].real();
+                    pIm[ro] = pRow[ro].imag();
+                }
+            }
+
+            size_t f = 0;
+            for (long long i = 0; num_pairs_ > 0 && i < CHA_; i++)
+            {
+                const value_type* ar = &x_re_[i*RO_];
+                const value_type* ai = &x_im_[i*RO_];
+                for (long long j = i; j < CHA_; j++)
+                {
+                    const value_type* br = &x_re_[j*RO_];
+                    const value_type* bi = &x_im_[j*RO_];
+                    for (ro = 0; ro < RO_; ro++)
+                    {
+                        line_re_[ro] = ar[ro] * br[ro] + ai[ro] * bi[ro];
+                        line_im_[ro] = ar[ro] * bi[ro] - ai[ro] * br[ro];
+                    }
+                    box_filter(line_re_.data(), re + f*RO_);
+                    box_filter(line_im_.data(), im + f*RO_);
+                    f++;
+                }
+            }
+
+            for (cha = 0; cha < CHA_; cha++)
+            {
+                box_filter(&x_re_[cha*RO_], re + (num_pairs_ + cha)*RO_);
+                box_filter(&x_im_[cha*RO_], im + (num_pairs_ + cha)*RO_);
+            }
+        }
+
+        static long long wrap(long long i, long long n)
+        {
+            return ((i % n) + n) % n;
+        }
+
+    private:
+
+        // running sum over [ro-halfKs, ro+halfKs], restarted for every row
+        void box_filter(const value_type* in, value_type* out) const
+        {
+            value_type sum = 0;
+            for (long long k = -halfKs_; k <= halfKs_; k++)
+            {
+                sum += in[wrap(k, RO_)];
+            }
+            out[0] = sum;
+
+            long long add = wrap(halfKs_ + 1, RO_);
+            long long sub = wrap(-halfKs_, RO_);
+            for (long long ro = 1; ro < RO_; ro++)
+            {
+                sum += in[add] - in[sub];
+                out[ro] = sum;
+                if (++add == RO_) add = 0;
+                if (++sub == RO_) sub = 0;
+            }
+        }
+
+        const T* pData_;
+        long long RO_, E1_, CHA_, halfKs_;
+        size_t num_pairs_, num_features_;
+
+        std::vector<value_type> x_re_, x_im_;
+        std::vector<value_type> line_re_, line_im_;
+    };
+
+    // batched power iteration for N pixels
+    // A_re, A_im : [num_features N] local statistics, as produced by InatiRowFilter
+    // v_re, v_im : [CHA N] dominant eigenvector of every local covariance, initialized from the local channel sum
+    // the loops over pixels are innermost and contiguous, so they are vectorized by the compiler
+    template<typename T>
+    void inati_power_iteration(const T* A_re, const T* A_im, size_t N, size_t CHA, size_t power, T* v_re, T* v_im, T* w_re, T* w_im, T* norm)
+    {
+        size_t num_pairs = CHA*(CHA + 1) / 2;
+        size_t n, i, j;
+
+        auto normalize = [&](T* re, T* im)
+        {
+            std::fill(norm, norm + N, T(0));
+            for (i = 0; i < CHA; i++)
+            {
+                for (n = 0; n < N; n++)
+                {
+                    norm[n] += re[i*N + n] * re[i*N + n] + im[i*N + n] * im[i*N + n];
+                }
+            }
+
+            for (n = 0; n < N; n++)
+            {
+                norm[n] = (norm[n] > 0) ? T(1) / std::sqrt(norm[n]) : T(0);
+            }
+
+            for (i = 0; i < CHA; i++)
+            {
+                for (n = 0; n < N; n++)
+                {
+                    re[i*N + n] *= norm[n];
+                    im[i*N + n] *= norm[n];
+                }
+            }
+        };
+
+        memcpy(v_re, A_re + num_pairs*N, sizeof(T)*CHA*N);
+        memcpy(v_im, A_im + num_pairs*N, sizeof(T)*CHA*N);
+        normalize(v_re, v_im);
+
+        for (size_t po = 0; po < power; po++)
+        {
+            std::fill(w_re, w_re + CHA*N, T(0));
+            std::fill(w_im, w_im + CHA*N, T(0));
+
+            // w = R*v, with R_ij = A_(ij) for i <= j and R_ji = conj(R_ij)
+            size_t f = 0;
+            for (i = 0; i < CHA; i++)
+            {
+                for (j = i; j < CHA; j++, f++)
+                {
+                    const T* rr = A_re + f*N;
+                    const T* ri = A_im + f*N;
+
+                    T* wi_re = w_re + i*N;
+                    T* wi_im = w_im + i*N;
+                    const T* vj_re = v_re + j*N;
+                    const T* vj_im = v_im + j*N;
+
+                    for (n = 0; n < N; n++)
+                    {
+                        wi_re[n] += rr[n] * vj_re[n] - ri[n] * vj_im[n];
+                        wi_im[n] += rr[n] * vj_im[n] + ri[n] * vj_re[n];
+                    }
+
+                    if (j != i)
+                    {
+                        T* wj_re = w_re + j*N;
+                        T* wj_im = w_im + j*N;
+                        const T* vi_re = v_re + i*N;
+                        const T* vi_im = v_im + i*N;
+
+                        for (n = 0; n < N; n++)
+                        {
+                            wj_re[n] += rr[n] * vi_re[n] + ri[n] * vi_im[n];
+                            wj_im[n] += rr[n] * vi_im[n] - ri[n] * vi_re[n];
+                        }
+                    }
+                }
+            }
+
+            memcpy(v_re, w_re, sizeof(T)*CHA*N);
+            memcpy(v_im, w_im, sizeof(T)*CHA*N);
+            normalize(v_re, v_im);
+        }
+    }
+
+    // phase of s.'*v, i.e. the sum of U1 = D*v over the neighbourhood
+    template<typename T>
+    void inati_phase(const T* s_re, const T* s_im, const T* v_re, const T* v_im, size_t N, size_t CHA, T* phase_re, T* phase_im)
+    {
+        std::fill(phase_re, phase_re + N, T(0));
+        std::fill(phase_im, phase_im + N, T(0));
+
+        for (size_t c = 0; c < CHA; c++)
+        {
+            for (size_t n = 0; n < N; n++)
+            {
+                phase_re[n] += s_re[c*N + n] * v_re[c*N + n] - s_im[c*N + n] * v_im[c*N + n];
+                phase_im[n] += s_re[c*N + n] * v_im[c*N + n] + s_im[c*N + n] * v_re[c*N + n];
+            }
+        }
+
+        for (size_t n = 0; n < N; n++)
+        {
+            T mag = std::sqrt(phase_re[n] * phase_re[n] + phase_im[n] * phase_im[n]);
+            T inv = (mag > 0) ? T(1) / mag : T(0);
+            phase_re[n] *= inv;
+            phase_im[n] *= inv;
+        }
+    }
+
+    // interpolation positions of the low resolution grid along one dimension
+    struct InatiGrid
+    {
+        InatiGrid(long long len, long long stride)
+        {
+            for (long long p = 0; p < len - 1; p += stride) pos.push_back(p);
+            pos.push_back(len - 1);
+        }
+
+        // index of the node before x and the weight of the next node
+        void locate(long long x, size_t& k, double& t) const
+        {
+            k = std::upper_bound(pos.begin(), pos.end(), x) - pos.begin();
+            k = (k == 0) ? 0 : k - 1;
+            if (k + 1 >= pos.size())
+            {
+                k = pos.size() - 1;
+                t = 0;
+                return;
+            }
+            t = double(x - pos[k]) / double(pos[k + 1] - pos[k]);
+        }
+
+        std::vector<long long> pos;
+    };
+}
+
+template<typename T>
+void coil_map_2d_Inati_fast(const hoNDArray<T>& data, hoNDArray<T>& coilMap, size_t ks, size_t power, size_t stride)
+{
+    try
+    {
+        typedef typename realType<T>::Type value_type;
+
+        long long RO = data.get_size(0);
+        long long E1 = data.get_size(1);
+        long long CHA = data.get_size(2);
+
+        long long N = data.get_number_of_elements() / (RO*E1*CHA);
+        GADGET_CHECK_THROW(N == 1);
+
+        const T* pData = data.begin();
+
+        if (!data.dimensions_equal(coilMap))
+        {
+            coilMap = data;
+        }
+        T* pSen = coilMap.begin();
+
+        if (ks % 2 != 1)
+        {
+            ks++;
+        }
+
+        if (stride < 1) stride = 1;
+
+        const long long halfKs = (long long)ks / 2;
+        const size_t num_pairs = CHA*(CHA + 1) / 2;
+        const size_t num_features = num_pairs + CHA;
+
+        // writes conj(v)*phase for N pixels starting at pixel offset
+        auto store = [&](const value_type* v_re, const value_type* v_im, const value_type* ph_re, const value_type* ph_im, size_t N, size_t offset)
+        {
+            for (long long cha = 0; cha < CHA; cha++)
+            {
+                T* pOut = pSen + cha*RO*E1 + offset;
+                for (size_t n = 0; n < N; n++)
+                {
+                    const value_type a = v_re[cha*N + n];
+                    const value_type b = v_im[cha*N + n];
+                    const value_type c = ph_re[n];
+                    const value_type d = ph_im[n];
+                    pOut[n] = T(a*c + b*d, a*d - b*c);
+                }
+            }
+        };
+
+        if (stride == 1)
+        {
+            // rows are processed in strips; within a strip, the vertical box sum slides over a ring of filtered rows
+            const long long strip_size = 16;
+            const long long num_strips = (E1 + strip_size - 1) / strip_size;
+
+            long long strip;
+
+#pragma omp parallel private(strip) shared(pData, RO, E1, CHA, ks, halfKs, power, num_pairs, num_features)
+            {
+                InatiRowFilter<T> filter(pData, RO, E1, CHA, ks, true);
+
+                const size_t plane = num_features*RO;
+                std::vector<value_type> ring(2 * plane*ks);
+                std::vector<value_type> A(2 * plane);
+                std::vector<value_type> v(2 * CHA*RO), w(2 * CHA*RO), norm(RO), phase(2 * RO);
+
+                value_type* A_re = A.data();
+                value_type* A_im = A.data() + plane;
+
+                #pragma omp for schedule(dynamic)
+                for (strip = 0; strip < num_strips; strip++)
+                {
+                    const long long e1_start = strip*strip_size;
+                    const long long e1_end = std::min(E1, e1_start + strip_size);
+
+                    std::fill(A.begin(), A.end(), value_type(0));
+                    for (long long k = 0; k < (long long)ks; k++)
+                    {
+                        value_type* slot = &ring[2 * plane*k];
+                        filter.filter_row(e1_start - halfKs + k, slot, slot + plane);
+                        for (size_t p = 0; p < 2 * plane; p++) A[p] += slot[p];
+                    }
+
+                    // slot holding the oldest row of the window
+                    long long oldest = 0;
+
+                    for (long long e1 = e1_start; e1 < e1_end; e1++)
+                    {
+                        if (e1 > e1_start)
+                        {
+                            value_type* slot = &ring[2 * plane*oldest];
+                            for (size_t p = 0; p < 2 * plane; p++) A[p] -= slot[p];
+                            filter.filter_row(e1 + halfKs, slot, slot + plane);
+                            for (size_t p = 0; p < 2 * plane; p++) A[p] += slot[p];
+                            oldest = (oldest + 1) % (long long)ks;
+                        }
+
+                        inati_power_iteration(A_re, A_im, RO, CHA, power, v.data(), v.data() + CHA*RO, w.data(), w.data() + CHA*RO, norm.data());
+                        inati_phase(A_re + num_pairs*RO, A_im + num_pairs*RO, v.data(), v.data() + CHA*RO, RO, CHA, phase.data(), phase.data() + RO);
+                        store(v.data(), v.data() + CHA*RO, phase.data(), phase.data() + RO, RO, e1*RO);
+                    }
+                }
+            }
+        }
+        else
+        {
+            // eigenvectors are computed on a grid with spacing stride and bilinearly interpolated
+            // the phase is computed from the local channel sum at every pixel
+            InatiGrid grid_ro(RO, stride), grid_e1(E1, stride);
+            const long long NRO = grid_ro.pos.size();
+            const long long NE1 = grid_e1.pos.size();
+
+            // phase normalized eigenvectors on the grid, [NRO CHA NE1]
+            std::vector<value_type> nodes_re(NRO*CHA*NE1), nodes_im(NRO*CHA*NE1);
+
+            long long ke1;
+
+#pragma omp parallel private(ke1) shared(pData, RO, E1, CHA, halfKs, power, num_pairs, num_features, grid_ro, grid_e1, nodes_re, nodes_im)
+            {
+                std::vector<value_type> x(2 * CHA*NRO);
+                std::vector<value_type> G(2 * num_features*NRO);
+                std::vector<value_type> v(2 * CHA*NRO), w(2 * CHA*NRO), norm(NRO), phase(2 * NRO);
+
+                value_type* x_re = x.data();
+                value_type* x_im = x.data() + CHA*NRO;
+
+                #pragma omp for schedule(dynamic)
+                for (ke1 = 0; ke1 < NE1; ke1++)
+                {
+                    // local statistics at the grid columns, accumulated over the ks*ks neighbourhood
+                    std::fill(G.begin(), G.end(), value_type(0));
+                    value_type* pG_re = G.data();
+                    value_type* pG_im = G.data() + num_features*NRO;
+
+                    for (long long ke = -halfKs; ke <= halfKs; ke++)
+                    {
+                        const long long de1 = InatiRowFilter<T>::wrap(grid_e1.pos[ke1] + ke, E1);
+
+                        for (long long kr = -halfKs; kr <= halfKs; kr++)
+                        {
+                            for (long long cha = 0; cha < CHA; cha++)
+                            {
+                                const T* pRow = pData + cha*RO*E1 + de1*RO;
+                                for (long long kro = 0; kro < NRO; kro++)
+                                {
+                                    const T& val = pRow[InatiRowFilter<T>::wrap(grid_ro.pos[kro] + kr, RO)];
+                                    x_re[cha*NRO + kro] = val.real();
+                                    x_im[cha*NRO + kro] = val.imag();
+                                }
+                            }
+
+                            size_t f = 0;
+                            for (long long i = 0; i < CHA; i++)
+                            {
+                                const value_type* ar = x_re + i*NRO;
+                                const value_type* ai = x_im + i*NRO;
+                                for (long long j = i; j < CHA; j++, f++)
+                                {
+                                    const value_type* br = x_re + j*NRO;
+                                    const value_type* bi = x_im + j*NRO;
+                                    for (long long kro = 0; kro < NRO; kro++)
+                                    {
+                                        pG_re[f*NRO + kro] += ar[kro] * br[kro] + ai[kro] * bi[kro];
+                                        pG_im[f*NRO + kro] += ar[kro] * bi[kro] - ai[kro] * br[kro];
+                                    }
+                                }
+                            }
+
+                            for (long long p = 0; p < CHA*NRO; p++)
+                            {
+                                pG_re[num_pairs*NRO + p] += x_re[p];
+                                pG_im[num_pairs*NRO + p] += x_im[p];
+                            }
+                        }
+                    }
+
+                    const value_type* G_re = G.data();
+                    const value_type* G_im = G.data() + num_features*NRO;
+                    value_type* v_re = v.data();
+                    value_type* v_im = v.data() + CHA*NRO;
+
+                    inati_power_iteration(G_re, G_im, NRO, CHA, power, v_re, v_im, w.data(), w.data() + CHA*NRO, norm.data());
+                    inati_phase(G_re + num_pairs*NRO, G_im + num_pairs*NRO, v_re, v_im, NRO, CHA, phase.data(), phase.data() + NRO);
+
+                    // remove the phase, so that neighbouring eigenvectors can be interpolated
+                    for (long long cha = 0; cha < CHA; cha++)
+                    {
+                        for (long long kro = 0; kro < NRO; kro++)
+                        {
+                            const value_type a = v_re[cha*NRO + kro];
+                            const value_type b = v_im[cha*NRO + kro];
+                            const value_type c = phase[kro];
+                            const value_type d = phase[NRO + kro];
+                            nodes_re[kro + cha*NRO + ke1*NRO*CHA] = a*c + b*d;
+                            nodes_im[kro + cha*NRO + ke1*NRO*CHA] = b*c - a*d;
+                        }
+                    }
+                }
+            }
+
+            long long e1;
+
+#pragma omp parallel private(e1) shared(pData, RO, E1, CHA, ks, halfKs, grid_ro, grid_e1, nodes_re, nodes_im)
+            {
+                InatiRowFilter<T> filter(pData, RO, E1, CHA, ks, false);
+
+                const size_t plane = CHA*RO;
+                std::vector<value_type> row(2 * plane), s(2 * plane);
+                std::vector<value_type> v(2 * CHA*RO), norm(RO), phase(2 * RO);
+
+                #pragma omp for
+                for (e1 = 0; e1 < E1; e1++)
+                {
+                    std::fill(s.begin(), s.end(), value_type(0));
+                    for (long long k = -halfKs; k <= halfKs; k++)
+                    {
+                        filter.filter_row(e1 + k, row.data(), row.data() + plane);
+                        for (size_t p = 0; p < 2 * plane; p++) s[p] += row[p];
+                    }
+
+                    size_t k0;
+                    double t0;
+                    grid_e1.locate(e1, k0, t0);
+                    const size_t k1 = std::min<size_t>(k0 + 1, NE1 - 1);
+
+                    value_type* v_re = v.data();
+                    value_type* v_im = v.data() + CHA*RO;
+
+                    for (long long ro = 0; ro < RO; ro++)
+                    {
+                        size_t j0;
+                        double u0;
+                        grid_ro.locate(ro, j0, u0);
+                        const size_t j1 = std::min<size_t>(j0 + 1, NRO - 1);
+
+                        const value_type w00 = value_type((1 - u0)*(1 - t0));
+                        const value_type w10 = value_type(u0*(1 - t0));
+                        const value_type w01 = value_type((1 - u0)*t0);
+                        const value_type w11 = value_type(u0*t0);
+
+                        for (long long cha = 0; cha < CHA; cha++)
+                        {
+                            const size_t o0 = cha*NRO + k0*NRO*CHA;
+                            const size_t o1 = cha*NRO + k1*NRO*CHA;
+                            v_re[cha*RO + ro] = w00*nodes_re[o0 + j0] + w10*nodes_re[o0 + j1] + w01*nodes_re[o1 + j0] + w11*nodes_re[o1 + j1];
+                            v_im[cha*RO + ro] = w00*nodes_im[o0 + j0] + w10*nodes_im[o0 + j1] + w01*nodes_im[o1 + j0] + w11*nodes_im[o1 + j1];
+                        }
+                    }
+
+                    // normalize the interpolated eigenvectors
+                    std::fill(norm.begin(), norm.end(), value_type(0));
+                    for (long long cha = 0; cha < CHA; cha++)
+                    {
+                        for (long long ro = 0; ro < RO; ro++)
+                        {
+                            norm[ro] += v_re[cha*RO + ro] * v_re[cha*RO + ro] + v_im[cha*RO + ro] * v_im[cha*RO + ro];
+                        }
+                    }
+                    for (long long ro = 0; ro < RO; ro++)
+                    {
+                        norm[ro] = (norm[ro] > 0) ? value_type(1) / std::sqrt(norm[ro]) : value_type(0);
+                    }
+                    for (long long cha = 0; cha < CHA; cha++)
+                    {
+                        for (long long ro = 0; ro < RO; ro++)
+                        {
+                            v_re[cha*RO + ro] *= norm[ro];
+                            v_im[cha*RO + ro] *= norm[ro];
+                        }
+                    }
+
+                    inati_phase(s.data(), s.data() + plane, v_re, v_im, RO, CHA, phase.data(), phase.data() + RO);
+                    store(v_re, v_im, phase.data(), phase.data() + RO, RO, e1*RO);
+                }
+            }
+        }
+    }
+    catch (...)
+    {
+        GERROR_STREAM("Errors in coil_map_2d_Inati_fast(...) ... ");
+        throw;
+    }
+}
+
+template void coil_map_2d_Inati_fast(const hoNDArray< std::complex<float> >& data, hoNDArray< std::complex<float> >& coilMap, size_t ks, size_t power, size_t stride);
+template void coil_map_2d_Inati_fast(const hoNDArray< std::complex<double> >& data, hoNDArray< std::complex<double> >& coilMap, size_t ks, size_t power, size_t stride);
+
+template void coil_map_2d_Inati_fast(const hoNDArray< complext<float> >& data, hoNDArray< complext<float> >& coilMap, size_t ks, size_t power, size_t stride);
+template void coil_map_2d_Inati_fast(const hoNDArray< complext<double> >& data, hoNDArray< complext<double> >& coilMap, size_t ks, size_t power, size_t stride);
+
+// ------------------------------------------------------------------------
+
 template<typename T> 
 void coil_map_3d_Inati(const hoNDArray<T>& data, hoNDArray<T>& coilMap, size_t ks, size_t kz, size_t power)
 {
@@ -664,7 +1208,7 @@ template<typename T> void coil_map_Inati(const hoNDArray<T>& data, hoNDArray<T>&
                 hoNDArray<T> im(RO, E1, CHA, const_cast<T*>(data.begin()) + n*RO*E1*CHA);
                 hoNDArray<T> cmap(RO, E1, CHA, coilMap.begin() + n*RO*E1*CHA);
 
-                Gadgetron::coil_map_2d_Inati(im, cmap, ks, power);
+                Gadgetron::coil_map_2d_Inati_fast(im, cmap, ks, power);
             }
         }
     }
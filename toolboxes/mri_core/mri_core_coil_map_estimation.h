@@ -35,6 +35,12 @@ namespace Gadgetron
     // power: number of iterations to apply power method
     template<typename T>  void coil_map_2d_Inati(const hoNDArray<T>& data, hoNDArray<T>& coilMap, size_t ks = 7, size_t power = 3);
 
+    // same estimate as coil_map_2d_Inati, up to round-off
+    // the local covariances are built with separable box filters over rows, and the power iterations are batched over all pixels of a row
+    // stride: if > 1, eigenvectors are only computed on a grid with this spacing and bilinearly interpolated; the phase is still computed at every pixel
+    // the low resolution estimate is intended for large matrices, where the coil sensitivity is smooth on the scale of stride
+    template<typename T>  void coil_map_2d_Inati_fast(const hoNDArray<T>& data, hoNDArray<T>& coilMap, size_t ks = 7, size_t power = 3, size_t stride = 1);
+
     // data: [RO E1 E2 CHA], this functions uses true 3D data correlation matrix
     template<typename T>  void coil_map_3d_Inati(const hoNDArray<T>& data, hoNDArray<T>& coilMap, size_t ks = 7, size_t kz = 5, size_t power = 3);
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <stdexcept>
 #include <vector>
 
 #include "complext.h"
@@ -89,6 +90,15 @@ namespace Gadgetron {
         const ARRAY<REAL> *dcw
         );
 
+        /**
+           Precompute the Toeplitz embedding of mult_MH_M for the preprocessed trajectory, after which mult_MH_M
+           with the same density compensation weights needs no gridding. Not supported by all plans.
+           \param[in] dcw the density compensation weights later passed to mult_MH_M, or 0x0.
+        */
+        virtual void preprocess_toeplitz(const ARRAY<REAL> *dcw) {
+            throw std::runtime_error("NFFT_plan::preprocess_toeplitz : Toeplitz embedding not supported by this plan");
+        }
+
     public: // Utilities
 
 
@@ -21,10 +21,17 @@ namespace Gadgetron{
     inline boost::shared_ptr< ARRAY<REAL> > get_dcw() { return dcw_; }
 
     inline boost::shared_ptr<NFFT_plan<ARRAY,REAL,D>> get_plan() { return plan_; }
+
+    // Use an already preprocessed plan, instead of calling setup and preprocess
+    virtual void set_plan( boost::shared_ptr<NFFT_plan<ARRAY,REAL,D>> plan ) { plan_ = plan; }
   
     virtual void setup( typename uint64d<D>::Type matrix_size, typename uint64d<D>::Type matrix_size_os, REAL W );
     virtual void preprocess(const ARRAY<typename reald<REAL,D>::Type>& trajectory );
 
+    // Precompute the Toeplitz kernel of mult_MH_M for the current plan and density compensation weights,
+    // so that mult_MH_M is computed with two FFTs instead of two NFFTs. Call again after set_dcw.
+    virtual void preprocess_toeplitz();
+
     virtual void mult_M( ARRAY< complext<REAL> > *in, ARRAY< complext<REAL> > *out, bool accumulate = false );
     virtual void mult_MH( ARRAY< complext<REAL> > *in, ARRAY< complext<REAL> > *out, bool accumulate = false );
     virtual void mult_MH_M( ARRAY< complext<REAL> > *in, ARRAY< complext<REAL> > *out, bool accumulate = false );
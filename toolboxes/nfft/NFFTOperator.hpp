@@ -97,4 +97,13 @@ NFFTOperator<ARRAY, REAL, D>::preprocess(const ARRAY<typename reald<REAL, D>::Ty
     plan_->preprocess(trajectory, NFFT_prep_mode::ALL);
 }
 
+template<template<class> class ARRAY, class REAL, unsigned int D>
+void
+NFFTOperator<ARRAY, REAL, D>::preprocess_toeplitz() {
+    if (!plan_) {
+        throw std::runtime_error("NFFTOperator::preprocess_toeplitz : setup has not been called");
+    }
+    plan_->preprocess_toeplitz(dcw_.get());
+}
+
 }
@@ -0,0 +1,328 @@
+/** \file NFFTPlanCache.h
+    \brief Process wide cache of preprocessed NFFT plans and density compensation weights.
+
+    Preprocessing a plan builds the gridding convolution matrices of a trajectory, which dominates the
+    reconstruction time of radial and spiral real-time imaging, where the trajectory repeats every frame.
+    The cache keys the plans on the content of the host side trajectory, the matrix sizes, the kernel width
+    and the preprocessing mode, and shares them between frames and connections. Entries are evicted in least
+    recently used order when the estimated memory of all entries exceeds the capacity. Connections reconstructing
+    the same trajectory at the same time each get a plan of their own, so that no frame waits on another.
+*/
+
+#pragma once
+
+#include "NFFT.h"
+#include "hoNDArray.h"
+#include "vector_td.h"
+
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <list>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+namespace Gadgetron {
+
+    template<template<class> class ARRAY, class REAL, unsigned int D>
+    class NFFTPlanCache {
+    public:
+
+        struct Entry {
+            boost::shared_ptr<NFFT_plan<ARRAY, REAL, D>> plan;
+
+            // Density compensation weights as used by the reconstruction, and their square root for
+            // iterative reconstructions. Either may be empty.
+            boost::shared_ptr<ARRAY<REAL>> dcw;
+            boost::shared_ptr<ARRAY<REAL>> dcw_sqrt;
+
+            // Estimated memory of the entry in bytes, set by whoever builds the entry
+            size_t bytes = 0;
+        };
+
+    protected:
+        struct Shared;
+
+    public:
+
+        /**
+           An entry with a plan for the exclusive use of the holder, as plans hold internal buffers and cannot be
+           computed from several threads at once. The plan is handed back to the cache entry when the lease is
+           destroyed. The weights are shared between all leases of the entry, and must not be modified.
+        */
+        class Lease {
+        public:
+            Lease() = default;
+            Lease(Lease&& other) noexcept : entry(std::move(other.entry)), shared(std::move(other.shared)) {}
+            Lease& operator=(Lease&& other) noexcept {
+                release();
+                entry = std::move(other.entry);
+                shared = std::move(other.shared);
+                return *this;
+            }
+            ~Lease() { release(); }
+
+            Entry* operator->() { return &entry; }
+            Entry& operator*() { return entry; }
+
+        private:
+            friend class NFFTPlanCache;
+
+            void release() {
+                if (!shared || !entry.plan) return;
+                auto owner = std::move(shared);
+                std::lock_guard<std::mutex> guard(owner->mutex);
+                owner->idle.push_back(std::move(entry.plan));
+            }
+
+            Entry entry;
+            boost::shared_ptr<Shared> shared;
+        };
+
+        /**
+           The cache shared by the process. Its capacity in MB is read once from the environment variable
+           GADGETRON_NFFT_PLAN_CACHE_MB, and defaults to 1024 MB. A capacity of 0 disables caching.
+        */
+        static NFFTPlanCache& instance() {
+            static NFFTPlanCache cache(capacity_from_environment());
+            return cache;
+        }
+
+        NFFTPlanCache(size_t capacity = size_t(1024) << 20) : capacity_(capacity), bytes_(0), hits_(0), misses_(0) {}
+
+        /**
+           Set the memory budget in bytes. A capacity of 0 disables caching.
+        */
+        void set_capacity(size_t capacity) {
+            std::lock_guard<std::mutex> guard(mutex_);
+            capacity_ = capacity;
+            evict(nullptr);
+        }
+
+        size_t get_capacity() const {
+            std::lock_guard<std::mutex> guard(mutex_);
+            return capacity_;
+        }
+
+        /**
+           Returns a lease on the entry for the trajectory, calling build(Entry&) to preprocess it if it is not cached.
+           If every plan of the entry is leased, build is called again for a plan of the new lease, rather than
+           waiting for one to be handed back; the plan joins the entry when the lease is destroyed.
+           \param trajectory the host side trajectory as received, including any density compensation weights.
+           \param matrix_size the matrix size of the plan.
+           \param matrix_size_os the oversampled matrix size of the plan.
+           \param W the kernel width.
+           \param mode the preprocessing mode.
+           \param build callable filling plan, dcw and bytes of the entry.
+        */
+        template<class F>
+        Lease acquire(const hoNDArray<REAL>& trajectory, const vector_td<size_t, D>& matrix_size,
+                      const vector_td<size_t, D>& matrix_size_os, REAL W, NFFT_prep_mode mode, F&& build) {
+
+            Key key = make_key(trajectory, matrix_size, matrix_size_os, W, mode);
+
+            Lease lease;
+            {
+                std::lock_guard<std::mutex> guard(mutex_);
+
+                auto it = entries_.find(key);
+                if (it != entries_.end() && same_trajectory(it->second.entry->trajectory, trajectory)) {
+                    lru_.splice(lru_.begin(), lru_, it->second.position);
+                    lease.shared = it->second.entry;
+                    hits_++;
+                } else {
+                    if (it != entries_.end())
+                        remove(it);
+
+                    lease.shared = boost::make_shared<Shared>();
+                    misses_++;
+
+                    if (capacity_ > 0) {
+                        lease.shared->trajectory = trajectory;
+                        lru_.push_front(key);
+                        entries_[key] = Slot{lease.shared, lru_.begin(), 0};
+                    }
+                }
+            }
+
+            auto& shared = *lease.shared;
+            size_t added_bytes = 0;
+            {
+                // Entries are built outside of the cache lock, so that connections with other trajectories are not
+                // held up. Concurrent users of the same trajectory wait for the first one to finish building.
+                std::unique_lock<std::mutex> lock(shared.mutex);
+
+                if (!shared.ready) {
+                    build(lease.entry);
+                    lease.entry.bytes += trajectory.get_number_of_bytes();
+                    added_bytes = lease.entry.bytes;
+
+                    shared.weights = lease.entry;
+                    shared.weights.plan.reset();
+                    shared.ready = true;
+                } else if (!shared.idle.empty()) {
+                    lease.entry = shared.weights;
+                    lease.entry.plan = std::move(shared.idle.back());
+                    shared.idle.pop_back();
+                } else {
+                    lock.unlock();
+
+                    Entry extra;
+                    build(extra);
+                    added_bytes = extra.bytes;
+
+                    lease.entry = shared.weights;
+                    lease.entry.plan = std::move(extra.plan);
+                }
+            }
+
+            if (added_bytes) {
+                std::lock_guard<std::mutex> guard(mutex_);
+                auto it = entries_.find(key);
+                if (it != entries_.end() && it->second.entry == lease.shared) {
+                    it->second.bytes += added_bytes;
+                    bytes_ += added_bytes;
+                    evict(lease.shared.get());
+                }
+            }
+
+            return lease;
+        }
+
+        /**
+           Estimated memory of a preprocessed plan: the sparse convolution matrix, stored twice for both
+           directions, and the deapodization filters on the oversampled grid.
+        */
+        static size_t estimate_plan_bytes(size_t number_of_samples, const vector_td<size_t, D>& matrix_size_os,
+                                          REAL W, NFFT_prep_mode mode) {
+            size_t footprint = 1;
+            size_t grid = 1;
+            for (unsigned int d = 0; d < D; d++) {
+                footprint *= size_t(std::ceil(W)) + 1;
+                grid *= matrix_size_os[d];
+            }
+            const size_t directions = mode == NFFT_prep_mode::ALL ? 2 : 1;
+            return directions * number_of_samples * footprint * (sizeof(REAL) + sizeof(size_t))
+                   + 2 * grid * sizeof(complext<REAL>);
+        }
+
+        void clear() {
+            std::lock_guard<std::mutex> guard(mutex_);
+            entries_.clear();
+            lru_.clear();
+            bytes_ = 0;
+        }
+
+        size_t get_number_of_entries() const {
+            std::lock_guard<std::mutex> guard(mutex_);
+            return entries_.size();
+        }
+
+        size_t get_number_of_bytes() const {
+            std::lock_guard<std::mutex> guard(mutex_);
+            return bytes_;
+        }
+
+        size_t get_number_of_hits() const {
+            std::lock_guard<std::mutex> guard(mutex_);
+            return hits_;
+        }
+
+        size_t get_number_of_misses() const {
+            std::lock_guard<std::mutex> guard(mutex_);
+            return misses_;
+        }
+
+    protected:
+
+        // A cached trajectory: its weights, and the plans not currently leased
+        struct Shared {
+            std::mutex mutex;
+            bool ready = false;
+            Entry weights;
+            std::vector<boost::shared_ptr<NFFT_plan<ARRAY, REAL, D>>> idle;
+            hoNDArray<REAL> trajectory;
+        };
+
+        typedef std::tuple<uint64_t, std::vector<size_t>, std::vector<size_t>, std::vector<size_t>, REAL, int> Key;
+
+        struct Slot {
+            boost::shared_ptr<Shared> entry;
+            typename std::list<Key>::iterator position;
+            size_t bytes;
+        };
+
+        static Key make_key(const hoNDArray<REAL>& trajectory, const vector_td<size_t, D>& matrix_size,
+                            const vector_td<size_t, D>& matrix_size_os, REAL W, NFFT_prep_mode mode) {
+            return Key(hash(trajectory), trajectory.get_dimensions(),
+                       std::vector<size_t>(matrix_size.vec, matrix_size.vec + D),
+                       std::vector<size_t>(matrix_size_os.vec, matrix_size_os.vec + D), W, int(mode));
+        }
+
+        // 64 bit FNV-1a over the words of the trajectory, with the remaining bytes folded in last
+        static uint64_t hash(const hoNDArray<REAL>& trajectory) {
+            const uint64_t prime = 1099511628211ull;
+            uint64_t h = 14695981039346656037ull;
+
+            const char* data = reinterpret_cast<const char*>(trajectory.get_data_ptr());
+            const size_t bytes = trajectory.get_number_of_bytes();
+
+            size_t i = 0;
+            for (; i + sizeof(uint64_t) <= bytes; i += sizeof(uint64_t)) {
+                uint64_t word;
+                std::memcpy(&word, data + i, sizeof(uint64_t));
+                h = (h ^ word) * prime;
+            }
+            for (; i < bytes; i++)
+                h = (h ^ uint64_t(static_cast<unsigned char>(data[i]))) * prime;
+
+            return h;
+        }
+
+        static size_t capacity_from_environment() {
+            const char* megabytes = std::getenv("GADGETRON_NFFT_PLAN_CACHE_MB");
+            if (!megabytes) return size_t(1024) << 20;
+            return size_t(std::strtoull(megabytes, nullptr, 10)) << 20;
+        }
+
+        static bool same_trajectory(const hoNDArray<REAL>& a, const hoNDArray<REAL>& b) {
+            return a.dimensions_equal(b.get_dimensions())
+                   && std::memcmp(a.get_data_ptr(), b.get_data_ptr(), a.get_number_of_bytes()) == 0;
+        }
+
+        void remove(typename std::map<Key, Slot>::iterator it) {
+            bytes_ -= it->second.bytes;
+            lru_.erase(it->second.position);
+            entries_.erase(it);
+        }
+
+        // Evicts least recently used entries until the cache fits its capacity. The entry being returned is kept.
+        void evict(const Shared* keep) {
+            auto position = lru_.end();
+            while (bytes_ > capacity_ && position != lru_.begin()) {
+                --position;
+                auto it = entries_.find(*position);
+                if (it->second.entry.get() == keep)
+                    continue;
+
+                auto next = position;
+                ++next;
+                remove(it);
+                position = next;
+            }
+        }
+
+        mutable std::mutex mutex_;
+        std::map<Key, Slot> entries_;
+        std::list<Key> lru_;
+        size_t capacity_;
+        size_t bytes_;
+        size_t hits_;
+        size_t misses_;
+    };
+}
@@ -25,6 +25,10 @@
 
 #include "hoGriddingConvolution.h"
 
+#ifdef USE_OMP
+#include <omp.h>
+#endif
+
 using namespace std;
 
 namespace Gadgetron {
@@ -240,13 +244,160 @@ namespace Gadgetron {
             hoNDArray<ComplexType> &out,
             const hoNDArray<REAL>* dcw
     ) {
-        std::vector<size_t> dims = {this->number_of_samples,this->number_of_frames};
-        auto batches = in.get_number_of_elements()/(prod(this->matrix_size_)*this->number_of_frames);
-        dims.push_back(batches);
+        const auto *pin = reinterpret_cast<const hoNDArray<complext<REAL>> *>(&in);
+        auto *pout = reinterpret_cast<hoNDArray<complext<REAL>> *>(&out);
+
+        if (is_toeplitz_preprocessed(dcw)) {
+            mult_MH_M_toeplitz(*pin, *pout);
+        } else {
+            NFFT_plan<hoNDArray, REAL, D>::mult_MH_M(*pin, *pout, dcw);
+        }
+    }
+
+
+    template<class REAL, unsigned int D>
+    void hoNFFT_plan<REAL, D>::preprocess(
+            const hoNDArray<vector_td<REAL, D>>& k,
+            NFFT_prep_mode prep_mode
+    ) {
+        toeplitz_kernel.clear();
+        toeplitz_dcw.clear();
+        toeplitz_weighted = false;
+        toeplitz_preprocessed = false;
+
+        NFFT_plan<hoNDArray, REAL, D>::preprocess(k, prep_mode);
+        preprocessed_all = prep_mode == NFFT_prep_mode::ALL;
+    }
+
+
+    template<class REAL, unsigned int D>
+    void hoNFFT_plan<REAL, D>::preprocess_toeplitz(const hoNDArray<REAL>* dcw)
+    {
+        if (is_toeplitz_preprocessed(dcw))
+            return;
+
+        if (!preprocessed_all) {
+            throw std::runtime_error("hoNFFT_plan::preprocess_toeplitz : the plan must be preprocessed with NFFT_prep_mode::ALL");
+        }
+
+        const size_t frames = this->conv_->get_num_frames();
+        const size_t corners = size_t(1) << D;
+        const size_t pixels = prod(this->matrix_size_);
+
+        const vector_td<size_t, D> kernel_size = this->matrix_size_ * size_t(2);
+        const size_t kernel_pixels = prod(kernel_size);
+
+        // MH_M is a convolution with the point spread function of the trajectory. The columns of MH_M
+        // belonging to the corner pixels of the matrix hold the point spread function for all shifts
+        // between two pixels, one quadrant per corner, and are computed in a single batched call.
+
+        std::vector<size_t> dims = to_std_vector(this->matrix_size_);
+        dims.push_back(frames);
+        dims.push_back(corners);
+
+        hoNDArray<complext<REAL>> columns(dims);
+        columns.fill(complext<REAL>(0));
+
+        for (size_t q = 0; q < corners; q++) {
+            size_t corner = 0;
+            size_t stride = 1;
+            for (unsigned int d = 0; d < D; d++) {
+                if ((q >> d) & 1)
+                    corner += (this->matrix_size_[d] - 1) * stride;
+                stride *= this->matrix_size_[d];
+            }
+            for (size_t f = 0; f < frames; f++)
+                columns[(q * frames + f) * pixels + corner] = complext<REAL>(1);
+        }
+
+        NFFT_plan<hoNDArray, REAL, D>::mult_MH_M(columns, columns, dcw);
+
+        // Circulant embedding of the point spread function, with the zero shift at the center of the grid
+
+        std::vector<size_t> kernel_dims = to_std_vector(kernel_size);
+        kernel_dims.push_back(frames);
+
+        toeplitz_kernel.create(kernel_dims);
+        toeplitz_kernel.fill(complext<REAL>(0));
+
+        for (size_t q = 0; q < corners; q++) {
+            for (size_t f = 0; f < frames; f++) {
+                const complext<REAL>* column = columns.get_data_ptr() + (q * frames + f) * pixels;
+                complext<REAL>* kernel = toeplitz_kernel.get_data_ptr() + f * kernel_pixels;
+
+                for (size_t i = 0; i < pixels; i++) {
+                    size_t remainder = i;
+                    size_t index = 0;
+                    size_t stride = 1;
+                    for (unsigned int d = 0; d < D; d++) {
+                        const size_t r = remainder % this->matrix_size_[d];
+                        remainder /= this->matrix_size_[d];
+                        const size_t corner = ((q >> d) & 1) ? this->matrix_size_[d] - 1 : 0;
+                        index += (this->matrix_size_[d] + r - corner) * stride;
+                        stride *= kernel_size[d];
+                    }
+                    kernel[index] = column[i];
+                }
+            }
+        }
+
+        // Unscaled, so that the unitary FFTs of mult_MH_M_toeplitz compute the convolution
+        fft(toeplitz_kernel, NFFT_fft_mode::FORWARDS, false);
+
+        toeplitz_weighted = dcw != nullptr;
+        if (dcw) toeplitz_dcw = *dcw;
+        else toeplitz_dcw.clear();
+        toeplitz_preprocessed = true;
+    }
+
+
+    template<class REAL, unsigned int D>
+    bool hoNFFT_plan<REAL, D>::is_toeplitz_preprocessed(const hoNDArray<REAL>* dcw) const
+    {
+        if (!toeplitz_preprocessed || toeplitz_weighted != (dcw != nullptr))
+            return false;
+        if (!dcw)
+            return true;
+        return toeplitz_dcw.dimensions_equal(dcw->get_dimensions())
+               && std::equal(dcw->begin(), dcw->end(), toeplitz_dcw.begin());
+    }
+
+
+    template<class REAL, unsigned int D>
+    void hoNFFT_plan<REAL, D>::mult_MH_M_toeplitz(
+            const hoNDArray<complext<REAL>> &in,
+            hoNDArray<complext<REAL>> &out
+    ) {
+        const vector_td<size_t, D> kernel_size = this->matrix_size_ * size_t(2);
+
+        std::vector<size_t> dims = to_std_vector(kernel_size);
+        for (unsigned int d = D; d < in.get_number_of_dimensions(); d++)
+            dims.push_back(in.get_size(d));
+
+        hoNDArray<complext<REAL>> work(dims);
+
+        const size_t kernel_elements = toeplitz_kernel.get_number_of_elements();
+        if (work.get_number_of_elements() % kernel_elements) {
+            throw std::runtime_error("hoNFFT_plan::mult_MH_M : input dimensions do not match the number of frames of the trajectory");
+        }
+
+        pad<complext<REAL>, D>(in, work);
+        fft(work, NFFT_fft_mode::FORWARDS);
+
+        complext<REAL>* pw = work.get_data_ptr();
+        const complext<REAL>* pk = toeplitz_kernel.get_data_ptr();
+        const long long N = (long long)work.get_number_of_elements();
+
+#ifdef USE_OMP
+#pragma omp parallel for
+#endif
+        for (long long n = 0; n < N; n++)
+            pw[n] *= pk[size_t(n) % kernel_elements];
+
+        fft(work, NFFT_fft_mode::BACKWARDS);
 
-        hoNDArray<ComplexType> tmp(dims);
-        compute(in, tmp, dcw, NFFT_comp_mode::FORWARDS_C2NC);
-        compute(tmp, out,dcw, NFFT_comp_mode::BACKWARDS_NC2C);
+        // Same offset as pad, which keeps the center pixel at N/2
+        crop<complext<REAL>, D>((kernel_size >> 1) - (this->matrix_size_ >> 1), this->matrix_size_, work, out);
     }
 
     template<class REAL, unsigned int D>
@@ -62,9 +62,28 @@ namespace Gadgetron{
                 \param mode: enum specifying the preprocessing mode
             */
 
-            // virtual void preprocess(
-            //     const hoNDArray<vector_td<REAL, D>>& k, NFFT_prep_mode prep_mode = NFFT_prep_mode::ALL
-            // ) override;
+            virtual void preprocess(
+                const hoNDArray<vector_td<REAL, D>>& k, NFFT_prep_mode prep_mode = NFFT_prep_mode::ALL
+            ) override;
+
+            /**
+                Precompute the Toeplitz embedding of mult_MH_M
+
+                The point spread function of the trajectory, weighted with the squared density
+                compensation weights, is computed once on a grid of twice the matrix size. Afterwards
+                mult_MH_M with the same weights is a pointwise multiplication between two FFTs on that
+                grid, without any gridding. The kernel is discarded when the plan is preprocessed again,
+                and should be recomputed when the values of the weights change.
+
+                \param dcw: the density compensation weights later passed to mult_MH_M, or 0x0
+            */
+            virtual void preprocess_toeplitz(const hoNDArray<REAL>* dcw) override;
+
+            /**
+                Is mult_MH_M with the given density compensation weights computed by Toeplitz embedding.
+                The weights are compared by value, so an array reused for other weights is not mistaken for them.
+            */
+            bool is_toeplitz_preprocessed(const hoNDArray<REAL>* dcw) const;
 
 
             void compute(
@@ -145,9 +164,22 @@ namespace Gadgetron{
 
         private:
 
+            void mult_MH_M_toeplitz(
+                const hoNDArray<complext<REAL>> &in,
+                hoNDArray<complext<REAL>> &out
+            );
+
             hoNDArray<ComplexType> deapodization_filter_IFFT;
             hoNDArray<ComplexType> deapodization_filter_FFT;
 
+            // Fourier transform of the point spread function on the grid of twice the matrix size, per frame
+            hoNDArray<complext<REAL>> toeplitz_kernel;
+            // Copy of the weights the kernel was computed with, if any
+            hoNDArray<REAL> toeplitz_dcw;
+            bool toeplitz_weighted = false;
+            bool toeplitz_preprocessed = false;
+            bool preprocessed_all = false;
+
     };
 
 
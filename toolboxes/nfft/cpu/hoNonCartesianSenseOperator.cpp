@@ -0,0 +1,206 @@
+#include "hoNonCartesianSenseOperator.h"
+#include "hoNDArray_elemwise.h"
+#include "vector_td_utilities.h"
+
+#ifdef USE_OMP
+#include <omp.h>
+#endif
+
+namespace Gadgetron{
+
+  template<class REAL, unsigned int D>
+  hoNonCartesianSenseOperator<REAL,D>::hoNonCartesianSenseOperator()
+    : linearOperator< hoNDArray< complext<REAL> > >(), ncoils_(0), is_preprocessed_(false)
+  {
+  }
+
+  template<class REAL, unsigned int D> void
+  hoNonCartesianSenseOperator<REAL,D>::set_csm( boost::shared_ptr< hoNDArray< complext<REAL> > > csm )
+  {
+    if( csm.get() && csm->get_number_of_dimensions() == D+1 ) {
+      csm_ = csm;
+      ncoils_ = csm_->get_size(D);
+    }
+    else{
+      throw std::runtime_error("hoNonCartesianSenseOperator::set_csm : unexpected csm dimensionality");
+    }
+  }
+
+  template<class REAL, unsigned int D> hoNDArray< complext<REAL> >&
+  hoNonCartesianSenseOperator<REAL,D>::coil_images()
+  {
+    std::vector<size_t> dims = this->get_domain_dimensions();
+    dims.push_back(ncoils_);
+    if( !coil_images_.dimensions_equal(dims) )
+      coil_images_.create(dims);
+    return coil_images_;
+  }
+
+  template<class REAL, unsigned int D> void
+  hoNonCartesianSenseOperator<REAL,D>::mult_csm( const hoNDArray< complext<REAL> >* in, hoNDArray< complext<REAL> >* out )
+  {
+    const size_t pixels = csm_->get_number_of_elements() / ncoils_;
+    const size_t frames = in->get_number_of_elements() / pixels;
+
+    if( in->get_number_of_elements() != pixels*frames || out->get_number_of_elements() != pixels*frames*ncoils_ ){
+      throw std::runtime_error("hoNonCartesianSenseOperator::mult_csm : array dimensions do not match the coil sensitivities");
+    }
+
+    const complext<REAL>* pin = in->get_data_ptr();
+    const complext<REAL>* pcsm = csm_->get_data_ptr();
+    complext<REAL>* pout = out->get_data_ptr();
+
+    const long long N = (long long)(ncoils_*frames);
+
+#ifdef USE_OMP
+#pragma omp parallel for
+#endif
+    for( long long n=0; n<N; n++ ){
+      const size_t c = size_t(n) / frames;
+      const size_t f = size_t(n) % frames;
+
+      const complext<REAL>* s = pcsm + c*pixels;
+      const complext<REAL>* x = pin + f*pixels;
+      complext<REAL>* r = pout + size_t(n)*pixels;
+
+      for( size_t i=0; i<pixels; i++ )
+        r[i] = s[i]*x[i];
+    }
+  }
+
+  template<class REAL, unsigned int D> void
+  hoNonCartesianSenseOperator<REAL,D>::mult_csm_conj_sum( const hoNDArray< complext<REAL> >* in, hoNDArray< complext<REAL> >* out, bool accumulate )
+  {
+    const size_t pixels = csm_->get_number_of_elements() / ncoils_;
+    const size_t frames = out->get_number_of_elements() / pixels;
+
+    if( out->get_number_of_elements() != pixels*frames || in->get_number_of_elements() != pixels*frames*ncoils_ ){
+      throw std::runtime_error("hoNonCartesianSenseOperator::mult_csm_conj_sum : array dimensions do not match the coil sensitivities");
+    }
+
+    const complext<REAL>* pin = in->get_data_ptr();
+    const complext<REAL>* pcsm = csm_->get_data_ptr();
+    complext<REAL>* pout = out->get_data_ptr();
+
+    const size_t coil_stride = pixels*frames;
+    const long long N = (long long)(pixels*frames);
+
+    // Every output pixel is summed over the coils by one thread
+#ifdef USE_OMP
+#pragma omp parallel for
+#endif
+    for( long long n=0; n<N; n++ ){
+      const size_t i = size_t(n) % pixels;
+
+      complext<REAL> sum = accumulate ? pout[n] : complext<REAL>(0);
+      for( unsigned int c=0; c<ncoils_; c++ )
+        sum += conj(pcsm[c*pixels+i]) * pin[c*coil_stride+n];
+
+      pout[n] = sum;
+    }
+  }
+
+  template<class REAL, unsigned int D> void
+  hoNonCartesianSenseOperator<REAL,D>::mult_M( hoNDArray< complext<REAL> >* in, hoNDArray< complext<REAL> >* out, bool accumulate )
+  {
+    if( !in || !out ){
+      throw std::runtime_error("hoNonCartesianSenseOperator::mult_M : 0x0 input/output not accepted");
+    }
+    if( !is_preprocessed_ ){
+      throw std::runtime_error("hoNonCartesianSenseOperator::mult_M : the operator has not been preprocessed");
+    }
+
+    hoNDArray< complext<REAL> >& tmp = coil_images();
+    mult_csm( in, &tmp );
+
+    // Forwards NFFT of all coils
+
+    if( accumulate ){
+      if( !samples_.dimensions_equal(out->get_dimensions()) )
+        samples_.create(out->get_dimensions());
+      plan_->compute( tmp, samples_, dcw_.get(), NFFT_comp_mode::FORWARDS_C2NC );
+      *out += samples_;
+    }
+    else
+      plan_->compute( tmp, *out, dcw_.get(), NFFT_comp_mode::FORWARDS_C2NC );
+  }
+
+  template<class REAL, unsigned int D> void
+  hoNonCartesianSenseOperator<REAL,D>::mult_MH( hoNDArray< complext<REAL> >* in, hoNDArray< complext<REAL> >* out, bool accumulate )
+  {
+    if( !in || !out ){
+      throw std::runtime_error("hoNonCartesianSenseOperator::mult_MH : 0x0 input/output not accepted");
+    }
+    if( !is_preprocessed_ ){
+      throw std::runtime_error("hoNonCartesianSenseOperator::mult_MH : the operator has not been preprocessed");
+    }
+
+    // Adjoint NFFT of all coils
+
+    hoNDArray< complext<REAL> >& tmp = coil_images();
+    plan_->compute( *in, tmp, dcw_.get(), NFFT_comp_mode::BACKWARDS_NC2C );
+
+    mult_csm_conj_sum( &tmp, out, accumulate );
+  }
+
+  template<class REAL, unsigned int D> void
+  hoNonCartesianSenseOperator<REAL,D>::mult_MH_M( hoNDArray< complext<REAL> >* in, hoNDArray< complext<REAL> >* out, bool accumulate )
+  {
+    if( !in || !out ){
+      throw std::runtime_error("hoNonCartesianSenseOperator::mult_MH_M : 0x0 input/output not accepted");
+    }
+    if( !is_preprocessed_ ){
+      throw std::runtime_error("hoNonCartesianSenseOperator::mult_MH_M : the operator has not been preprocessed");
+    }
+
+    // All coils in one call, in place on the coil images
+
+    hoNDArray< complext<REAL> >& tmp = coil_images();
+    mult_csm( in, &tmp );
+    plan_->mult_MH_M( tmp, tmp, dcw_.get() );
+    mult_csm_conj_sum( &tmp, out, accumulate );
+  }
+
+  template<class REAL, unsigned int D> void
+  hoNonCartesianSenseOperator<REAL,D>::preprocess_toeplitz()
+  {
+    if( !is_preprocessed_ ){
+      throw std::runtime_error("hoNonCartesianSenseOperator::preprocess_toeplitz : the operator has not been preprocessed");
+    }
+    plan_->preprocess_toeplitz( dcw_.get() );
+  }
+
+  template<class REAL, unsigned int D> void
+  hoNonCartesianSenseOperator<REAL,D>::setup( _uint64d matrix_size, _uint64d matrix_size_os, REAL W )
+  {
+    plan_ = NFFT<hoNDArray,REAL,D>::make_plan( matrix_size, matrix_size_os, W );
+    is_preprocessed_ = false;
+  }
+
+  template<class REAL, unsigned int D> void
+  hoNonCartesianSenseOperator<REAL,D>::preprocess( const hoNDArray<_reald>& trajectory )
+  {
+    if( !plan_.get() ){
+      throw std::runtime_error("hoNonCartesianSenseOperator::preprocess : setup has not been called");
+    }
+    plan_->preprocess( trajectory, NFFT_prep_mode::ALL );
+    is_preprocessed_ = true;
+  }
+
+  template<class REAL, unsigned int D> void
+  hoNonCartesianSenseOperator<REAL,D>::set_plan( boost::shared_ptr< NFFT_plan<hoNDArray,REAL,D> > plan )
+  {
+    plan_ = plan;
+    is_preprocessed_ = plan_.get() != 0x0;
+  }
+
+  //
+  // Instantiations
+  //
+
+  template class EXPORTNFFT hoNonCartesianSenseOperator<float,2>;
+  template class EXPORTNFFT hoNonCartesianSenseOperator<float,3>;
+
+  template class EXPORTNFFT hoNonCartesianSenseOperator<double,2>;
+  template class EXPORTNFFT hoNonCartesianSenseOperator<double,3>;
+}
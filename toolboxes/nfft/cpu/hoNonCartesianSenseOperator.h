@@ -0,0 +1,81 @@
+/** \file hoNonCartesianSenseOperator.h
+    \brief Non-Cartesian Sense operator, CPU based.
+
+    The encoding operator of iterative non-Cartesian Sense: multiplication with the coil sensitivities followed by
+    a forwards NFFT. The coils are transformed in a single batched NFFT call, which grids and transforms the coils in
+    parallel, and the coil sensitivity multiplications are parallelized over coils (mult_csm) and pixels
+    (mult_csm_conj_sum). With Toeplitz embedding, mult_MH_M runs without gridding.
+*/
+
+#pragma once
+
+#include "nfft_export.h"
+#include "linearOperator.h"
+#include "hoNFFT.h"
+#include "hoNDArray.h"
+#include "complext.h"
+#include "vector_td.h"
+
+#include <boost/shared_ptr.hpp>
+
+namespace Gadgetron{
+
+  template<class REAL, unsigned int D> class EXPORTNFFT hoNonCartesianSenseOperator : public linearOperator< hoNDArray< complext<REAL> > >
+  {
+
+  public:
+
+    typedef typename uint64d<D>::Type _uint64d;
+    typedef typename reald<REAL,D>::Type _reald;
+
+    hoNonCartesianSenseOperator();
+    virtual ~hoNonCartesianSenseOperator() {}
+
+    inline unsigned int get_number_of_coils() { return ncoils_; }
+    inline boost::shared_ptr< hoNDArray< complext<REAL> > > get_csm() { return csm_; }
+    inline boost::shared_ptr< NFFT_plan<hoNDArray,REAL,D> > get_plan() { return plan_; }
+    inline boost::shared_ptr< hoNDArray<REAL> > get_dcw() { return dcw_; }
+    inline bool is_preprocessed() { return is_preprocessed_; }
+
+    // Coil sensitivities of dimensions [matrix_size, coils]
+    virtual void set_csm( boost::shared_ptr< hoNDArray< complext<REAL> > > csm );
+
+    // The density compensation weights are applied in both directions, so these are usually the square root of the weights
+    virtual void set_dcw( boost::shared_ptr< hoNDArray<REAL> > dcw ) { dcw_ = dcw; }
+
+    virtual void setup( _uint64d matrix_size, _uint64d matrix_size_os, REAL W );
+    virtual void preprocess( const hoNDArray<_reald>& trajectory );
+
+    // Use an already preprocessed plan (with NFFT_prep_mode::ALL), instead of calling setup and preprocess
+    virtual void set_plan( boost::shared_ptr< NFFT_plan<hoNDArray,REAL,D> > plan );
+
+    virtual void mult_M( hoNDArray< complext<REAL> >* in, hoNDArray< complext<REAL> >* out, bool accumulate = false );
+    virtual void mult_MH( hoNDArray< complext<REAL> >* in, hoNDArray< complext<REAL> >* out, bool accumulate = false );
+
+    // Uses the Toeplitz embedding of the plan, if preprocess_toeplitz has been called for the current weights
+    virtual void mult_MH_M( hoNDArray< complext<REAL> >* in, hoNDArray< complext<REAL> >* out, bool accumulate = false );
+
+    // Precompute the Toeplitz kernel of the plan for the current density compensation weights
+    virtual void preprocess_toeplitz();
+
+    // out[..., c] = csm[c] * in
+    virtual void mult_csm( const hoNDArray< complext<REAL> >* in, hoNDArray< complext<REAL> >* out );
+
+    // out (+)= sum_c conj(csm[c]) * in[..., c]
+    virtual void mult_csm_conj_sum( const hoNDArray< complext<REAL> >* in, hoNDArray< complext<REAL> >* out, bool accumulate = false );
+
+  protected:
+
+    // The coil images, reused between calls
+    hoNDArray< complext<REAL> >& coil_images();
+
+    boost::shared_ptr< NFFT_plan<hoNDArray,REAL,D> > plan_;
+    boost::shared_ptr< hoNDArray<REAL> > dcw_;
+    boost::shared_ptr< hoNDArray< complext<REAL> > > csm_;
+    unsigned int ncoils_;
+    bool is_preprocessed_;
+
+    hoNDArray< complext<REAL> > coil_images_;
+    hoNDArray< complext<REAL> > samples_;
+  };
+}
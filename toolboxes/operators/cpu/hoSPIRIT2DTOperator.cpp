@@ -54,9 +54,6 @@ void hoSPIRIT2DTOperator<T>::set_forward_kernel(ARRAY_TYPE& forward_kernel, bool
         }
 
         // allocate the helper memory
-        res_after_apply_kernel_.create(RO, E1, srcCHA, dstCHA);
-        res_after_apply_kernel_dst_.create(RO, E1, dstCHA, srcCHA);
-
         if(kspace_.get_size(4)>N)
         {
             res_after_apply_kernel_sum_over_.create(RO, E1, dstCHA, kspace_.get_size(4));
@@ -109,10 +106,8 @@ void hoSPIRIT2DTOperator<T>::apply_forward_kernel(ARRAY_TYPE& x)
                 curr_forward_kernel.create(RO, E1, srcCHA, dstCHA, this->forward_kernel_.begin() + (kernelN - 1)*RO*E1*srcCHA*dstCHA);
             }
 
-            Gadgetron::multiply(curr_forward_kernel, currComplexIm, res_after_apply_kernel_);
-
-            hoNDArray<T> sumResCurr(RO, E1, 1, dstCHA, this->res_after_apply_kernel_sum_over_.begin() + n*RO*E1*dstCHA);
-            Gadgetron::sum_over_dimension(this->res_after_apply_kernel_, sumResCurr, 2);
+            hoNDArray<T> sumResCurr(RO, E1, dstCHA, this->res_after_apply_kernel_sum_over_.begin() + n*RO*E1*dstCHA);
+            this->apply_kernel(curr_forward_kernel, currComplexIm, sumResCurr);
         }
     }
     catch(...)
@@ -192,10 +187,8 @@ void hoSPIRIT2DTOperator<T>::apply_adjoint_kernel(ARRAY_TYPE& x)
                 curr_adjoint_kernel.create(RO, E1, dstCHA, srcCHA, this->adjoint_kernel_.begin() + (kernelN - 1)*RO*E1*dstCHA*srcCHA);
             }
 
-            Gadgetron::multiply(curr_adjoint_kernel, currComplexIm, res_after_apply_kernel_dst_);
-
-            hoNDArray<T> sumResCurr(RO, E1, 1, srcCHA, this->res_after_apply_kernel_sum_over_dst_.begin() + n*RO*E1*srcCHA);
-            Gadgetron::sum_over_dimension(this->res_after_apply_kernel_dst_, sumResCurr, 2);
+            hoNDArray<T> sumResCurr(RO, E1, srcCHA, this->res_after_apply_kernel_sum_over_dst_.begin() + n*RO*E1*srcCHA);
+            this->apply_kernel(curr_adjoint_kernel, currComplexIm, sumResCurr);
         }
     }
     catch (...)
@@ -290,10 +283,12 @@ void hoSPIRIT2DTOperator<T>::apply_adjoint_forward_kernel(ARRAY_TYPE& x)
         GADGET_CHECK_THROW(this->adjoint_forward_kernel_.get_size(3)==srcCHA);
         size_t kernelN = this->adjoint_forward_kernel_.get_size(4);
 
+        this->res_after_apply_kernel_sum_over_dst_.create(RO, E1, srcCHA, N);
+
         long long n;
-        for (n = 0; n < (long long)N; N++)
+        for (n = 0; n < (long long)N; n++)
         {
-            hoNDArray<T> currComplexIm(RO, E1, srcCHA, this->complexIm_.begin() + n*RO*E1*srcCHA);
+            hoNDArray<T> currComplexIm(RO, E1, srcCHA, x.begin() + n*RO*E1*srcCHA);
 
             hoNDArray<T> curr_adjoint_forward_kernel;
 
@@ -306,10 +301,8 @@ void hoSPIRIT2DTOperator<T>::apply_adjoint_forward_kernel(ARRAY_TYPE& x)
                 curr_adjoint_forward_kernel.create(RO, E1, srcCHA, srcCHA, this->adjoint_forward_kernel_.begin() + (kernelN - 1)*RO*E1*srcCHA*srcCHA);
             }
 
-            Gadgetron::multiply(curr_adjoint_forward_kernel, currComplexIm, res_after_apply_kernel_dst_);
-
-            hoNDArray<T> sumResCurr(RO, E1, 1, srcCHA, this->res_after_apply_kernel_sum_over_dst_.begin() + n*RO*E1*srcCHA);
-            Gadgetron::sum_over_dimension(this->res_after_apply_kernel_dst_, sumResCurr, 2);
+            hoNDArray<T> sumResCurr(RO, E1, srcCHA, this->res_after_apply_kernel_sum_over_dst_.begin() + n*RO*E1*srcCHA);
+            this->apply_kernel(curr_adjoint_forward_kernel, currComplexIm, sumResCurr);
         }
     }
     catch (...)
@@ -67,8 +67,6 @@ protected:
     using BaseClass::kspace_dst_;
     using BaseClass::complexIm_;
     ARRAY_TYPE complexIm_dst_;
-    using BaseClass::res_after_apply_kernel_;
-    ARRAY_TYPE res_after_apply_kernel_dst_;
     using BaseClass::res_after_apply_kernel_sum_over_;
     ARRAY_TYPE res_after_apply_kernel_sum_over_dst_;
 
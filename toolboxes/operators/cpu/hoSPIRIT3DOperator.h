@@ -45,7 +45,6 @@ protected:
     using BaseClass::kspace_;
     using BaseClass::complexIm_;
     using BaseClass::kspace_dst_;
-    using BaseClass::res_after_apply_kernel_;
     using BaseClass::res_after_apply_kernel_sum_over_;
 
     using BaseClass::fft_im_buffer_;
@@ -1,5 +1,6 @@
 
 #include "hoSPIRITOperator.h"
+#include "cpp_elemwise.h"
 #include "mri_core_spirit.h"
 
 namespace Gadgetron 
@@ -128,7 +129,6 @@ void hoSPIRITOperator<T>::set_forward_kernel(ARRAY_TYPE& forward_kernel, bool co
         dimSrc[NDim - 2] = dims[NDim - 2];
         dimDst[NDim - 2] = dims[NDim - 1];
 
-        res_after_apply_kernel_.create(dims);
         res_after_apply_kernel_sum_over_.create(dimDst);
         kspace_dst_.create(dimDst);
     }
@@ -180,6 +180,41 @@ void hoSPIRITOperator<T>::sum_over_src_channel(const ARRAY_TYPE& x, ARRAY_TYPE&
     }
 }
 
+template<typename T>
+void hoSPIRITOperator<T>::apply_kernel(const ARRAY_TYPE& kernel, const ARRAY_TYPE& x, ARRAY_TYPE& r)
+{
+    try
+    {
+        size_t NDim = kernel.get_number_of_dimensions();
+        GADGET_CHECK_THROW(NDim >= 3 && kernel.get_number_of_elements() > 0);
+
+        size_t S = kernel.get_size(NDim - 2);
+        size_t D = kernel.get_size(NDim - 1);
+        size_t P = kernel.get_number_of_elements() / (S*D);
+
+        std::vector<size_t> dimR = x.dimensions();
+        GADGET_CHECK_THROW(dimR.size() >= NDim - 1 && dimR[NDim - 2] == S);
+        GADGET_CHECK_THROW(x.get_number_of_elements() % (P*S) == 0);
+        size_t M = x.get_number_of_elements() / (P*S);
+
+        dimR[NDim - 2] = D;
+        if (!r.dimensions_equal(dimR))
+        {
+            r.create(dimR);
+        }
+
+        size_t m;
+        for (m = 0; m < M; m++)
+        {
+            Gadgetron::Elemwise::pixelwise_matvec(P, S, D, kernel.begin(), x.begin() + m*P*S, r.begin() + m*P*D);
+        }
+    }
+    catch (...)
+    {
+        GADGET_THROW("Errors in hoSPIRITOperator<T>::apply_kernel(const ARRAY_TYPE& kernel, const ARRAY_TYPE& x, ARRAY_TYPE& r) ... ");
+    }
+}
+
 template <typename T>
 void hoSPIRITOperator<T>::mult_M(ARRAY_TYPE* x, ARRAY_TYPE* y, bool accumulate)
 {
@@ -205,9 +240,7 @@ void hoSPIRITOperator<T>::mult_M(ARRAY_TYPE* x, ARRAY_TYPE* y, bool accumulate)
         }
 
         // apply kernel and sum
-        Gadgetron::multiply(forward_kernel_, complexIm_, res_after_apply_kernel_);
-
-        this->sum_over_src_channel(res_after_apply_kernel_, res_after_apply_kernel_sum_over_);
+        this->apply_kernel(forward_kernel_, complexIm_, res_after_apply_kernel_sum_over_);
 
         // go back to kspace 
         this->convert_to_kspace(res_after_apply_kernel_sum_over_, *y);
@@ -239,8 +272,7 @@ void hoSPIRITOperator<T>::mult_MH(ARRAY_TYPE* x, ARRAY_TYPE* y, bool accumulate)
         this->convert_to_image(*x, complexIm_);
 
         // apply kernel and sum
-        Gadgetron::multiply(adjoint_kernel_, complexIm_, res_after_apply_kernel_);
-        this->sum_over_src_channel(res_after_apply_kernel_, res_after_apply_kernel_sum_over_);
+        this->apply_kernel(adjoint_kernel_, complexIm_, res_after_apply_kernel_sum_over_);
 
         // go back to kspace 
         this->convert_to_kspace(res_after_apply_kernel_sum_over_, *y);
@@ -282,9 +314,7 @@ void hoSPIRITOperator<T>::compute_righ_hand_side(const ARRAY_TYPE& x, ARRAY_TYPE
             this->convert_to_image(x, complexIm_);
 
             // apply kernel and sum
-            GADGET_CATCH_THROW(Gadgetron::multiply(forward_kernel_, complexIm_, res_after_apply_kernel_));
-
-            GADGET_CATCH_THROW(this->sum_over_src_channel(res_after_apply_kernel_, res_after_apply_kernel_sum_over_));
+            GADGET_CATCH_THROW(this->apply_kernel(forward_kernel_, complexIm_, res_after_apply_kernel_sum_over_));
 
             // go back to kspace 
             this->convert_to_kspace(res_after_apply_kernel_sum_over_, b);
@@ -325,8 +355,7 @@ void hoSPIRITOperator<T>::gradient(ARRAY_TYPE* x, ARRAY_TYPE* g, bool accumulate
         }
 
         // apply kernel and sum
-        Gadgetron::multiply(adjoint_forward_kernel_, complexIm_, res_after_apply_kernel_);
-        this->sum_over_src_channel(res_after_apply_kernel_, res_after_apply_kernel_sum_over_);
+        this->apply_kernel(adjoint_forward_kernel_, complexIm_, res_after_apply_kernel_sum_over_);
 
         // go back to kspace 
         this->convert_to_kspace(res_after_apply_kernel_sum_over_, *g);
@@ -370,8 +399,7 @@ typename hoSPIRITOperator<T>::REAL hoSPIRITOperator<T>::magnitude(ARRAY_TYPE* x)
         }
 
         // apply kernel and sum
-        Gadgetron::multiply(forward_kernel_, complexIm_, res_after_apply_kernel_);
-        this->sum_over_src_channel(res_after_apply_kernel_, res_after_apply_kernel_sum_over_);
+        this->apply_kernel(forward_kernel_, complexIm_, res_after_apply_kernel_sum_over_);
 
         // L2 norm
         T obj = Gadgetron::dot(res_after_apply_kernel_sum_over_, res_after_apply_kernel_sum_over_, true);
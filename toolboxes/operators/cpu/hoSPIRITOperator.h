@@ -106,11 +106,14 @@ protected:
     // utility functions
     void sum_over_src_channel(const ARRAY_TYPE& x, ARRAY_TYPE& r);
 
+    /// apply the kernel at every pixel and sum over its source channels, without forming the product of kernel and image
+    /// kernel: [... S D], x: [... S M], r: [... D M]; the same kernel is applied to every one of M images
+    void apply_kernel(const ARRAY_TYPE& kernel, const ARRAY_TYPE& x, ARRAY_TYPE& r);
+
     // helper memory
     ARRAY_TYPE kspace_;
     ARRAY_TYPE complexIm_;
     ARRAY_TYPE kspace_dst_;
-    ARRAY_TYPE res_after_apply_kernel_;
     ARRAY_TYPE res_after_apply_kernel_sum_over_;
 
     ARRAY_TYPE fft_im_buffer_;
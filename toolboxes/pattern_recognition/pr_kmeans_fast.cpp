@@ -0,0 +1,895 @@
+/** \file   pr_kmeans_fast.cpp
+    \brief  Implement accelerated kmeans with triangle-inequality pruning, blocked distance kernel and mini-batch mode
+*/
+
+#include "pr_kmeans_fast.h"
+#include "log.h"
+
+#include "hoNDArray_elemwise.h"
+#include "hoNDArray_linalg.h"
+
+#include <boost/algorithm/string.hpp>
+
+#include <algorithm>
+#include <cfloat>
+#include <cstring>
+#include <limits>
+#include <random>
+
+#ifdef USE_OMP
+#include <omp.h>
+#endif // USE_OMP
+
+namespace Gadgetron {
+
+PRKMEANSBOUND get_kmeans_bound_type(const std::string& name)
+{
+    std::string name_lower(name);
+    boost::algorithm::to_lower(name_lower);
+
+    if (name_lower == "none")
+    {
+        return PR_KMEANS_BOUND_NONE;
+    }
+    else if (name_lower == "hamerly")
+    {
+        return PR_KMEANS_BOUND_HAMERLY;
+    }
+    else if (name_lower == "elkan")
+    {
+        return PR_KMEANS_BOUND_ELKAN;
+    }
+
+    GERROR_STREAM("Unrecognized kmeans bound name : " << name);
+
+    return PR_KMEANS_BOUND_HAMERLY;
+}
+
+std::string get_kmeans_bound_name(PRKMEANSBOUND v)
+{
+    std::string name;
+
+    switch (v)
+    {
+    case PR_KMEANS_BOUND_NONE:
+        name = "None";
+        break;
+
+    case PR_KMEANS_BOUND_HAMERLY:
+        name = "Hamerly";
+        break;
+
+    case PR_KMEANS_BOUND_ELKAN:
+        name = "Elkan";
+        break;
+
+    default:
+        GERROR_STREAM("Unrecognized kmeans bound type : " << v);
+    }
+
+    return name;
+}
+
+// squared distance between two P-dimensional points
+template <typename T>
+inline T kmeans_sq_dist(const T* x, const T* c, size_t P)
+{
+    T v = 0;
+    for (size_t p = 0; p < P; p++)
+    {
+        T t = x[p] - c[p];
+        v += t*t;
+    }
+    return v;
+}
+
+inline int kmeans_num_threads()
+{
+#ifdef USE_OMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif // USE_OMP
+}
+
+inline int kmeans_thread_id()
+{
+#ifdef USE_OMP
+    return omp_get_thread_num();
+#else
+    return 0;
+#endif // USE_OMP
+}
+
+template <typename T>
+kmeans_fast<T>::kmeans_fast() : BaseClass()
+{
+    bound_type_ = PR_KMEANS_BOUND_HAMERLY;
+    block_size_ = 4096;
+
+    mini_batch_threshold_ = 0;
+    mini_batch_size_ = 1024;
+    mini_batch_max_iter_ = 200;
+    mini_batch_tolerance_ = (T)1e-4;
+
+    seed_ = 0;
+
+    // the online update is a serial O(N*K*P) pass per moved point; it is not used by default here
+    this->perform_online_update_ = false;
+}
+
+template <typename T>
+kmeans_fast<T>::~kmeans_fast()
+{
+}
+
+template <typename T>
+unsigned int kmeans_fast<T>::get_seed()
+{
+    if (seed_ > 0) return seed_;
+
+    std::random_device rd;
+    return rd();
+}
+
+template <typename T>
+void kmeans_fast<T>::get_initial_guess_kmeansplusplus(const ArrayType& X, size_t K, ArrayType& C_for_initial)
+{
+    try
+    {
+        if (this->perform_timing_) this->gt_timer_.start("kmeans_fast, get_initial_guess_kmeansplusplus");
+
+        size_t P = X.get_size(0);
+        size_t N = X.get_size(1);
+
+        GADGET_CHECK_THROW(N>K);
+
+        std::mt19937 gen(this->get_seed());
+        std::uniform_real_distribution<> dis(0, 1);
+
+        C_for_initial.create(P, K, this->replicates_);
+        Gadgetron::clear(C_for_initial);
+
+        const T* pX = X.begin();
+
+        // squared distance from every sample to its closest centroid
+        VectorType D2(N, 0);
+        std::vector<double> cumsum_D2(N, 0);
+
+        size_t r, i, s;
+        long long n;
+
+        for (r = 0; r < this->replicates_; r++)
+        {
+            T* pC = &C_for_initial(0, 0, r);
+
+            size_t ind = (size_t)(dis(gen)*N);
+            if (ind >= N) ind = N - 1;
+            memcpy(pC, pX + ind*P, sizeof(T)*P);
+
+#pragma omp parallel for private(n) shared(N, P, pX, pC, D2) if(N>1024)
+            for (n = 0; n < (long long)N; n++)
+            {
+                D2[n] = kmeans_sq_dist(pX + n*P, pC, P);
+            }
+
+            for (i = 1; i < K; i++)
+            {
+                cumsum_D2[0] = D2[0];
+                for (n = 1; n < (long long)N; n++)
+                {
+                    cumsum_D2[n] = cumsum_D2[n - 1] + D2[n];
+                }
+
+                if (cumsum_D2[N - 1] < FLT_EPSILON)
+                {
+                    GWARN_STREAM("kmeans_fast, all samples coincide with the selected centroids, fill the remaining centroids randomly ... ");
+
+                    for (s = i; s < K; s++)
+                    {
+                        ind = (size_t)(dis(gen)*N);
+                        if (ind >= N) ind = N - 1;
+                        memcpy(pC + s*P, pX + ind*P, sizeof(T)*P);
+                    }
+                    break;
+                }
+
+                // D^2 weighted sampling
+                double v = dis(gen) * cumsum_D2[N - 1];
+                ind = (size_t)(std::lower_bound(cumsum_D2.begin(), cumsum_D2.end(), v) - cumsum_D2.begin());
+                if (ind >= N) ind = N - 1;
+
+                T* pCi = pC + i*P;
+                memcpy(pCi, pX + ind*P, sizeof(T)*P);
+
+#pragma omp parallel for private(n) shared(N, P, pX, pCi, D2) if(N>1024)
+                for (n = 0; n < (long long)N; n++)
+                {
+                    T d = kmeans_sq_dist(pX + n*P, pCi, P);
+                    if (d < D2[n]) D2[n] = d;
+                }
+            }
+        }
+
+        if (this->perform_timing_) this->gt_timer_.stop();
+    }
+    catch (...)
+    {
+        GERROR_STREAM("Exceptions happened in kmeans_fast<T>::get_initial_guess_kmeansplusplus(...) ... ");
+    }
+}
+
+template <typename T>
+void kmeans_fast<T>::run(const ArrayType& X, size_t K, const ArrayType& C_for_initial, ClusterType& IDX, ArrayType& C, T& sumD)
+{
+    try
+    {
+        size_t P = X.get_size(0);
+        size_t N = X.get_size(1);
+
+        GADGET_CHECK_THROW(N>K);
+        GADGET_CHECK_THROW(C_for_initial.get_size(0) == P);
+        GADGET_CHECK_THROW(C_for_initial.get_size(1) == K);
+
+        // only the first set of centroids is used
+        C.create(P, K);
+        memcpy(C.begin(), C_for_initial.begin(), sizeof(T)*P*K);
+
+        IDX.resize(N, 0);
+
+        if ((mini_batch_threshold_ > 0) && (N > mini_batch_threshold_))
+        {
+            this->run_mini_batch(X, K, IDX, C);
+        }
+        else if (bound_type_ == PR_KMEANS_BOUND_ELKAN)
+        {
+            this->run_elkan(X, K, IDX, C);
+        }
+        else if (bound_type_ == PR_KMEANS_BOUND_HAMERLY)
+        {
+            this->run_hamerly(X, K, IDX, C);
+        }
+        else
+        {
+            this->run_lloyd(X, K, IDX, C);
+        }
+
+        sumD = this->compute_sum_dist(X, IDX, C);
+
+        if (this->verbose_)
+        {
+            GDEBUG_STREAM("Kmeans_fast, " << get_kmeans_bound_name(bound_type_) << " - " << sumD);
+        }
+
+        if (this->perform_online_update_)
+        {
+            this->perform_online_update(X, IDX, C, sumD);
+            if (this->verbose_)
+            {
+                GDEBUG_STREAM("Kmeans_fast online update : " << sumD);
+            }
+        }
+    }
+    catch (...)
+    {
+        GERROR_STREAM("Exceptions happened in kmeans_fast<T>::run(...) ... ");
+    }
+}
+
+template <typename T>
+void kmeans_fast<T>::compute_column_norm(const ArrayType& A, VectorType& norm_A)
+{
+    size_t P = A.get_size(0);
+    size_t N = A.get_size(1);
+
+    norm_A.resize(N);
+
+    const T* pA = A.begin();
+
+    long long n;
+#pragma omp parallel for private(n) shared(N, P, pA, norm_A) if(N>1024)
+    for (n = 0; n < (long long)N; n++)
+    {
+        const T* pa = pA + n*P;
+        T v = 0;
+        for (size_t p = 0; p < P; p++)
+        {
+            v += pa[p] * pa[p];
+        }
+        norm_A[n] = v;
+    }
+}
+
+template <typename T>
+void kmeans_fast<T>::assign_blocked(const ArrayType& X, const VectorType& norm_X, const ArrayType& C, const VectorType& norm_C, ClusterType& IDX, VectorType& dist_best, VectorType* dist_second)
+{
+    try
+    {
+        size_t P = X.get_size(0);
+        size_t N = X.get_size(1);
+        size_t K = C.get_size(1);
+
+        GADGET_CHECK_THROW(norm_X.size() == N);
+        GADGET_CHECK_THROW(norm_C.size() == K);
+
+        IDX.resize(N);
+        dist_best.resize(N);
+        if (dist_second) dist_second->resize(N);
+
+        size_t B = (block_size_ > 0) ? std::min(block_size_, N) : N;
+
+        const T* pX = X.begin();
+        const T* pC = C.begin();
+
+        ArrayType CX;
+
+        for (size_t n0 = 0; n0 < N; n0 += B)
+        {
+            size_t nb = std::min(B, N - n0);
+
+            // CX = C'*X for this block, [K nb]
+            ArrayType Xb(P, nb, const_cast<T*>(pX + n0*P));
+            Gadgetron::gemm(CX, C, true, Xb, false);
+
+            const T* pCX = CX.begin();
+
+            long long n;
+#pragma omp parallel for private(n) shared(n0, nb, K, P, pX, pC, pCX, norm_X, norm_C, IDX, dist_best, dist_second) if(nb>256)
+            for (n = 0; n < (long long)nb; n++)
+            {
+                const T* cx = pCX + n*K;
+                T nx = norm_X[n0 + n];
+
+                T best = std::numeric_limits<T>::max();
+                T second = std::numeric_limits<T>::max();
+                size_t ind = 0, ind_second = K;
+
+                for (size_t k = 0; k < K; k++)
+                {
+                    T d2 = nx + norm_C[k] - 2 * cx[k];
+                    if (d2 < best)
+                    {
+                        second = best;
+                        ind_second = ind;
+                        best = d2;
+                        ind = k;
+                    }
+                    else if (d2 < second)
+                    {
+                        second = d2;
+                        ind_second = k;
+                    }
+                }
+
+                IDX[n0 + n] = ind;
+
+                // the expansion |x|^2 + |c|^2 - 2x'c loses precision for close points, the bounds need the exact distances
+                const T* px = pX + (n0 + n)*P;
+                dist_best[n0 + n] = std::sqrt(kmeans_sq_dist(px, pC + ind*P, P));
+
+                if (dist_second)
+                {
+                    (*dist_second)[n0 + n] = (ind_second < K && ind_second != ind) ? std::sqrt(kmeans_sq_dist(px, pC + ind_second*P, P)) : std::numeric_limits<T>::max();
+                }
+            }
+        }
+    }
+    catch (...)
+    {
+        GADGET_THROW("Exceptions happened in kmeans_fast<T>::assign_blocked(...) ... ");
+    }
+}
+
+template <typename T>
+void kmeans_fast<T>::compute_centroid_dist(const ArrayType& C, VectorType& dist_CC, VectorType& half_min_dist)
+{
+    size_t P = C.get_size(0);
+    size_t K = C.get_size(1);
+
+    dist_CC.resize(K*K);
+    half_min_dist.resize(K);
+
+    const T* pC = C.begin();
+
+    long long k;
+#pragma omp parallel for private(k) shared(K, P, pC, dist_CC, half_min_dist) if(K>16)
+    for (k = 0; k < (long long)K; k++)
+    {
+        T min_d = std::numeric_limits<T>::max();
+        for (size_t j = 0; j < K; j++)
+        {
+            T d = 0;
+            if (j != (size_t)k)
+            {
+                d = std::sqrt(kmeans_sq_dist(pC + k*P, pC + j*P, P));
+                if (d < min_d) min_d = d;
+            }
+            dist_CC[k*K + j] = d;
+        }
+
+        half_min_dist[k] = (K > 1) ? (T)0.5 * min_d : 0;
+    }
+}
+
+template <typename T>
+void kmeans_fast<T>::update_centroid_parallel(const ArrayType& X, ClusterType& IDX, ArrayType& C, VectorType& drift, std::vector<size_t>& reseeded)
+{
+    try
+    {
+        size_t P = X.get_size(0);
+        size_t N = X.get_size(1);
+        size_t K = C.get_size(1);
+
+        const T* pX = X.begin();
+        T* pC = C.begin();
+
+        ArrayType C_old(C);
+
+        int num_threads = kmeans_num_threads();
+        if (N < 1024) num_threads = 1;
+
+        // per-thread accumulation, merged after the parallel pass
+        std::vector<T> sum_buf(num_threads*K*P, 0);
+        std::vector<size_t> count_buf(num_threads*K, 0);
+
+#pragma omp parallel num_threads(num_threads) shared(N, K, P, pX, IDX, sum_buf, count_buf)
+        {
+            int tid = kmeans_thread_id();
+            T* psum = &sum_buf[tid*K*P];
+            size_t* pcount = &count_buf[tid*K];
+
+            long long n;
+#pragma omp for private(n)
+            for (n = 0; n < (long long)N; n++)
+            {
+                size_t k = IDX[n];
+                if (k >= K) continue;
+
+                const T* px = pX + n*P;
+                T* ps = psum + k*P;
+                for (size_t p = 0; p < P; p++)
+                {
+                    ps[p] += px[p];
+                }
+                pcount[k]++;
+            }
+        }
+
+        std::vector<size_t> cluster_size(K, 0);
+
+        size_t k, p;
+        int t;
+        for (k = 0; k < K; k++)
+        {
+            for (t = 0; t < num_threads; t++)
+            {
+                cluster_size[k] += count_buf[t*K + k];
+            }
+
+            if (cluster_size[k] == 0) continue;
+
+            T* pc = pC + k*P;
+            for (p = 0; p < P; p++)
+            {
+                T v = 0;
+                for (t = 0; t < num_threads; t++)
+                {
+                    v += sum_buf[(t*K + k)*P + p];
+                }
+                pc[p] = v / (T)cluster_size[k];
+            }
+        }
+
+        // an empty cluster takes the sample furthest away from its own centroid, from a cluster with more than one member
+        reseeded.clear();
+        for (k = 0; k < K; k++)
+        {
+            if (cluster_size[k] > 0) continue;
+
+            T max_d = -1;
+            size_t lonely = N;
+            for (size_t n = 0; n < N; n++)
+            {
+                size_t c = IDX[n];
+                if (c >= K || cluster_size[c] < 2) continue;
+
+                T d = kmeans_sq_dist(pX + n*P, pC + c*P, P);
+                if (d > max_d)
+                {
+                    max_d = d;
+                    lonely = n;
+                }
+            }
+
+            if (lonely == N)
+            {
+                GWARN_STREAM("kmeans_fast, cannot find a sample for empty cluster " << k);
+                continue;
+            }
+
+            size_t c = IDX[lonely];
+            const T* px = pX + lonely*P;
+            T* pc = pC + c*P;
+            for (p = 0; p < P; p++)
+            {
+                pc[p] = (pc[p] * cluster_size[c] - px[p]) / (T)(cluster_size[c] - 1);
+            }
+            cluster_size[c]--;
+
+            memcpy(pC + k*P, px, sizeof(T)*P);
+            cluster_size[k] = 1;
+
+            IDX[lonely] = k;
+            reseeded.push_back(lonely);
+        }
+
+        drift.resize(K);
+        for (k = 0; k < K; k++)
+        {
+            drift[k] = std::sqrt(kmeans_sq_dist(pC + k*P, C_old.begin() + k*P, P));
+        }
+    }
+    catch (...)
+    {
+        GADGET_THROW("Exceptions happened in kmeans_fast<T>::update_centroid_parallel(...) ... ");
+    }
+}
+
+template <typename T>
+T kmeans_fast<T>::compute_sum_dist(const ArrayType& X, const ClusterType& IDX, const ArrayType& C)
+{
+    size_t P = X.get_size(0);
+    size_t N = X.get_size(1);
+    size_t K = C.get_size(1);
+
+    const T* pX = X.begin();
+    const T* pC = C.begin();
+
+    double sumD = 0;
+
+    long long n;
+#pragma omp parallel for private(n) shared(N, K, P, pX, pC, IDX) reduction(+:sumD) if(N>1024)
+    for (n = 0; n < (long long)N; n++)
+    {
+        if (IDX[n] < K) sumD += kmeans_sq_dist(pX + n*P, pC + IDX[n] * P, P);
+    }
+
+    return (T)sumD;
+}
+
+template <typename T>
+void kmeans_fast<T>::run_lloyd(const ArrayType& X, size_t K, ClusterType& IDX, ArrayType& C)
+{
+    size_t N = X.get_size(1);
+
+    VectorType norm_X, norm_C, dist_best, drift;
+    this->compute_column_norm(X, norm_X);
+    this->compute_column_norm(C, norm_C);
+
+    this->assign_blocked(X, norm_X, C, norm_C, IDX, dist_best, nullptr);
+
+    ClusterType prev_IDX;
+    std::vector<size_t> reseeded;
+
+    size_t num_iter;
+    for (num_iter = 0; num_iter < this->max_iter_; num_iter++)
+    {
+        this->update_centroid_parallel(X, IDX, C, drift, reseeded);
+        this->compute_column_norm(C, norm_C);
+
+        prev_IDX = IDX;
+        this->assign_blocked(X, norm_X, C, norm_C, IDX, dist_best, nullptr);
+
+        if (reseeded.empty() && !this->is_clustering_changed(prev_IDX, IDX)) break;
+    }
+
+    if (this->verbose_)
+    {
+        GDEBUG_STREAM("Kmeans_fast lloyd iteration stopped : iter " << num_iter << " for " << N << " samples");
+    }
+}
+
+template <typename T>
+void kmeans_fast<T>::run_hamerly(const ArrayType& X, size_t K, ClusterType& IDX, ArrayType& C)
+{
+    size_t P = X.get_size(0);
+    size_t N = X.get_size(1);
+
+    const T* pX = X.begin();
+    const T* pC = C.begin();
+
+    // upper bound to the assigned centroid and lower bound to the second closest centroid
+    VectorType upper, lower;
+
+    VectorType norm_X, norm_C;
+    this->compute_column_norm(X, norm_X);
+    this->compute_column_norm(C, norm_C);
+    this->assign_blocked(X, norm_X, C, norm_C, IDX, upper, &lower);
+
+    VectorType drift, dist_CC, half_min_dist;
+    std::vector<size_t> reseeded;
+
+    size_t num_iter, num_dist = 0;
+    for (num_iter = 0; num_iter < this->max_iter_; num_iter++)
+    {
+        this->update_centroid_parallel(X, IDX, C, drift, reseeded);
+
+        // the lower bound moves with the largest drift of all other centroids
+        size_t k_max = 0;
+        T max_drift = 0, second_drift = 0;
+        for (size_t k = 0; k < K; k++)
+        {
+            if (drift[k] > max_drift)
+            {
+                second_drift = max_drift;
+                max_drift = drift[k];
+                k_max = k;
+            }
+            else if (drift[k] > second_drift)
+            {
+                second_drift = drift[k];
+            }
+        }
+
+        long long n;
+#pragma omp parallel for private(n) shared(N, IDX, upper, lower, drift, k_max, max_drift, second_drift) if(N>1024)
+        for (n = 0; n < (long long)N; n++)
+        {
+            upper[n] += drift[IDX[n]];
+            lower[n] -= (IDX[n] == k_max) ? second_drift : max_drift;
+        }
+
+        for (size_t r = 0; r < reseeded.size(); r++)
+        {
+            upper[reseeded[r]] = 0;
+            lower[reseeded[r]] = 0;
+        }
+
+        this->compute_centroid_dist(C, dist_CC, half_min_dist);
+
+        size_t num_changed = 0;
+
+#pragma omp parallel for private(n) shared(N, K, P, pX, pC, IDX, upper, lower, half_min_dist) reduction(+:num_changed, num_dist) if(N>1024)
+        for (n = 0; n < (long long)N; n++)
+        {
+            size_t a = IDX[n];
+            T m = std::max(half_min_dist[a], lower[n]);
+            if (upper[n] <= m) continue;
+
+            // tighten the upper bound
+            const T* px = pX + n*P;
+            upper[n] = std::sqrt(kmeans_sq_dist(px, pC + a*P, P));
+            num_dist++;
+            if (upper[n] <= m) continue;
+
+            T best = std::numeric_limits<T>::max();
+            T second = std::numeric_limits<T>::max();
+            size_t ind = a;
+            for (size_t k = 0; k < K; k++)
+            {
+                T d = (k == a) ? upper[n] * upper[n] : kmeans_sq_dist(px, pC + k*P, P);
+                if (d < best)
+                {
+                    second = best;
+                    best = d;
+                    ind = k;
+                }
+                else if (d < second)
+                {
+                    second = d;
+                }
+            }
+            num_dist += K - 1;
+
+            if (ind != a) num_changed++;
+
+            IDX[n] = ind;
+            upper[n] = std::sqrt(best);
+            lower[n] = std::sqrt(second);
+        }
+
+        if (num_changed == 0 && reseeded.empty()) break;
+    }
+
+    if (this->verbose_)
+    {
+        GDEBUG_STREAM("Kmeans_fast hamerly iteration stopped : iter " << num_iter << ", distance computed " << num_dist << " out of " << num_iter*N*K);
+    }
+}
+
+template <typename T>
+void kmeans_fast<T>::run_elkan(const ArrayType& X, size_t K, ClusterType& IDX, ArrayType& C)
+{
+    size_t P = X.get_size(0);
+    size_t N = X.get_size(1);
+
+    const T* pX = X.begin();
+    const T* pC = C.begin();
+
+    // upper bound to the assigned centroid and lower bounds [K N] to every centroid
+    VectorType upper(N), lower(N*K);
+
+    long long n;
+#pragma omp parallel for private(n) shared(N, K, P, pX, pC, IDX, upper, lower) if(N>256)
+    for (n = 0; n < (long long)N; n++)
+    {
+        const T* px = pX + n*P;
+        T* pl = &lower[n*K];
+
+        T best = std::numeric_limits<T>::max();
+        size_t ind = 0;
+        for (size_t k = 0; k < K; k++)
+        {
+            pl[k] = std::sqrt(kmeans_sq_dist(px, pC + k*P, P));
+            if (pl[k] < best)
+            {
+                best = pl[k];
+                ind = k;
+            }
+        }
+
+        IDX[n] = ind;
+        upper[n] = best;
+    }
+
+    VectorType drift, dist_CC, half_min_dist;
+    std::vector<size_t> reseeded;
+
+    size_t num_iter, num_dist = 0;
+    for (num_iter = 0; num_iter < this->max_iter_; num_iter++)
+    {
+        this->update_centroid_parallel(X, IDX, C, drift, reseeded);
+
+#pragma omp parallel for private(n) shared(N, K, IDX, upper, lower, drift) if(N>1024)
+        for (n = 0; n < (long long)N; n++)
+        {
+            T* pl = &lower[n*K];
+            for (size_t k = 0; k < K; k++)
+            {
+                pl[k] = std::max(pl[k] - drift[k], (T)0);
+            }
+            upper[n] += drift[IDX[n]];
+        }
+
+        for (size_t r = 0; r < reseeded.size(); r++)
+        {
+            upper[reseeded[r]] = 0;
+            std::fill(lower.begin() + reseeded[r] * K, lower.begin() + (reseeded[r] + 1)*K, (T)0);
+        }
+
+        this->compute_centroid_dist(C, dist_CC, half_min_dist);
+
+        size_t num_changed = 0;
+
+#pragma omp parallel for private(n) shared(N, K, P, pX, pC, IDX, upper, lower, dist_CC, half_min_dist) reduction(+:num_changed, num_dist) if(N>1024)
+        for (n = 0; n < (long long)N; n++)
+        {
+            size_t a = IDX[n];
+            if (upper[n] <= half_min_dist[a]) continue;
+
+            const T* px = pX + n*P;
+            T* pl = &lower[n*K];
+            bool tight = false;
+
+            for (size_t k = 0; k < K; k++)
+            {
+                if (k == a) continue;
+                if (upper[n] <= pl[k] || upper[n] <= (T)0.5 * dist_CC[a*K + k]) continue;
+
+                if (!tight)
+                {
+                    upper[n] = std::sqrt(kmeans_sq_dist(px, pC + a*P, P));
+                    pl[a] = upper[n];
+                    tight = true;
+                    num_dist++;
+
+                    if (upper[n] <= pl[k] || upper[n] <= (T)0.5 * dist_CC[a*K + k]) continue;
+                }
+
+                T d = std::sqrt(kmeans_sq_dist(px, pC + k*P, P));
+                pl[k] = d;
+                num_dist++;
+
+                if (d < upper[n])
+                {
+                    a = k;
+                    upper[n] = d;
+                }
+            }
+
+            if (a != IDX[n])
+            {
+                IDX[n] = a;
+                num_changed++;
+            }
+        }
+
+        if (num_changed == 0 && reseeded.empty()) break;
+    }
+
+    if (this->verbose_)
+    {
+        GDEBUG_STREAM("Kmeans_fast elkan iteration stopped : iter " << num_iter << ", distance computed " << num_dist << " out of " << num_iter*N*K);
+    }
+}
+
+template <typename T>
+void kmeans_fast<T>::run_mini_batch(const ArrayType& X, size_t K, ClusterType& IDX, ArrayType& C)
+{
+    size_t P = X.get_size(0);
+    size_t N = X.get_size(1);
+
+    const T* pX = X.begin();
+    T* pC = C.begin();
+
+    std::mt19937 gen(this->get_seed());
+    std::uniform_int_distribution<size_t> dis(0, N - 1);
+
+    size_t B = std::min(std::max(mini_batch_size_, K), N);
+
+    ArrayType Xb(P, B);
+    ArrayType C_prev(P, K);
+
+    VectorType norm_Xb, norm_C, dist_b;
+    ClusterType IDX_b;
+
+    // number of samples assigned to every centroid so far, giving the per-centroid learning rate
+    std::vector<size_t> counts(K, 0);
+
+    size_t num_iter;
+    for (num_iter = 0; num_iter < mini_batch_max_iter_; num_iter++)
+    {
+        for (size_t b = 0; b < B; b++)
+        {
+            memcpy(&Xb(0, b), pX + dis(gen)*P, sizeof(T)*P);
+        }
+
+        this->compute_column_norm(Xb, norm_Xb);
+        this->compute_column_norm(C, norm_C);
+        this->assign_blocked(Xb, norm_Xb, C, norm_C, IDX_b, dist_b, nullptr);
+
+        memcpy(C_prev.begin(), pC, sizeof(T)*P*K);
+
+        for (size_t b = 0; b < B; b++)
+        {
+            size_t k = IDX_b[b];
+            counts[k]++;
+
+            T eta = (T)1 / (T)counts[k];
+            T* pc = pC + k*P;
+            const T* px = &Xb(0, b);
+            for (size_t p = 0; p < P; p++)
+            {
+                pc[p] += eta * (px[p] - pc[p]);
+            }
+        }
+
+        T max_shift = 0;
+        for (size_t k = 0; k < K; k++)
+        {
+            T d = std::sqrt(kmeans_sq_dist(pC + k*P, C_prev.begin() + k*P, P));
+            if (d > max_shift) max_shift = d;
+        }
+
+        if (max_shift < mini_batch_tolerance_) break;
+    }
+
+    VectorType norm_X, dist_best;
+    this->compute_column_norm(X, norm_X);
+    this->compute_column_norm(C, norm_C);
+    this->assign_blocked(X, norm_X, C, norm_C, IDX, dist_best, nullptr);
+
+    if (this->verbose_)
+    {
+        GDEBUG_STREAM("Kmeans_fast mini-batch iteration stopped : iter " << num_iter << ", batch size " << B);
+    }
+}
+
+// ------------------------------------------------------------
+// Instantiation
+// ------------------------------------------------------------
+
+template class EXPORTPR kmeans_fast< float >;
+template class EXPORTPR kmeans_fast< double >;
+
+}
@@ -0,0 +1,124 @@
+/** \file   pr_kmeans_fast.h
+    \brief  Accelerated kmeans engine with triangle-inequality pruning, blocked distance kernel and mini-batch mode
+*/
+
+#pragma once
+
+#include "pr_kmeans.h"
+
+namespace Gadgetron {
+
+// ======================================================================================
+// bound pruning used by kmeans_fast
+// ======================================================================================
+enum PRKMEANSBOUND
+{
+    PR_KMEANS_BOUND_NONE = 0,
+    PR_KMEANS_BOUND_HAMERLY,
+    PR_KMEANS_BOUND_ELKAN
+};
+
+// get the bound type from name : "none", "hamerly" or "elkan"
+EXPORTPR PRKMEANSBOUND get_kmeans_bound_type(const std::string& name);
+EXPORTPR std::string get_kmeans_bound_name(PRKMEANSBOUND v);
+
+// ======================================================================================
+// kmeans_fast class
+// drop-in replacement of kmeans, with the same input/output convention
+// X [P N], C [P K], IDX [N], sumD is the sum of squared point-to-centroid distances
+//
+// bound_type_ :
+// 'hamerly' : one upper and one lower bound per sample, http://dx.doi.org/10.1137/1.9781611972801.12
+// 'elkan' : one upper bound and K lower bounds per sample, needs N*K extra storage, http://www.aaai.org/Papers/ICML/2003/ICML03-022.pdf
+// 'none' : every iteration computes all N*K distances with the blocked kernel
+// The pruned Lloyd iterations give the same clustering as the un-pruned iterations, up to round-off.
+//
+// block_size_ : number of samples processed per GEMM call when all distances are needed;
+// the squared distance is computed as |x|^2 + |c|^2 - 2 C'X
+//
+// mini-batch mode : if N > mini_batch_threshold_, centroids are estimated with mini-batch kmeans
+// http://dx.doi.org/10.1145/1772690.1772862, followed by one full assignment of all samples
+//
+// all assignment and centroid update steps are thread-parallel over samples, centroid sums are
+// accumulated in per-thread buffers and merged at the end of every iteration
+// ======================================================================================
+
+template <typename T>
+class EXPORTPR kmeans_fast : public kmeans<T>
+{
+public:
+
+    typedef kmeans<T> BaseClass;
+    typedef kmeans_fast<T> Self;
+
+    typedef typename BaseClass::ArrayType ArrayType;
+    typedef typename BaseClass::VectorType VectorType;
+    typedef typename BaseClass::ClusterType ClusterType;
+
+    kmeans_fast();
+    virtual ~kmeans_fast();
+
+    // ======================================================================================
+    /// parameter for kmeans_fast
+    // ======================================================================================
+
+    // bound pruning method
+    PRKMEANSBOUND bound_type_;
+
+    // number of samples per block for the distance kernel
+    size_t block_size_;
+
+    // if N is larger than this threshold, run mini-batch kmeans; 0 means never
+    size_t mini_batch_threshold_;
+    // number of samples per mini-batch
+    size_t mini_batch_size_;
+    // maximal number of mini-batch iterations
+    size_t mini_batch_max_iter_;
+    // mini-batch iteration stops if the maximal centroid shift is below this value
+    T mini_batch_tolerance_;
+
+    // seed for the random number generator; 0 means seeding from std::random_device
+    unsigned int seed_;
+
+    // ======================================================================================
+    // perform every steps
+    // ======================================================================================
+
+    /// kmeans++ seeding, with the distance to the closest centroid updated incrementally
+    virtual void get_initial_guess_kmeansplusplus(const ArrayType& X, size_t K, ArrayType& C_for_initial);
+
+    /// compute kmeans, dispatch to the mini-batch or the bounded lloyd iterations
+    virtual void run(const ArrayType& X, size_t K, const ArrayType& C_for_initial, ClusterType& IDX, ArrayType& C, T& sumD);
+
+    /// assign every sample to its closest centroid with the blocked distance kernel
+    /// norm_X: [N], squared norm of every sample
+    /// dist_best: [N], distance to the closest centroid
+    /// dist_second: [N], distance to the second closest centroid; if nullptr, not computed
+    void assign_blocked(const ArrayType& X, const VectorType& norm_X, const ArrayType& C, const VectorType& norm_C, ClusterType& IDX, VectorType& dist_best, VectorType* dist_second);
+
+    /// compute the squared norm of every column of A
+    void compute_column_norm(const ArrayType& A, VectorType& norm_A);
+
+    /// compute the [K K] centroid-to-centroid distance matrix and half of the distance from every centroid to its closest neighbour
+    void compute_centroid_dist(const ArrayType& C, VectorType& dist_CC, VectorType& half_min_dist);
+
+    /// update centroids given the IDX, with per-thread accumulation
+    /// empty clusters are replaced by the sample furthest away from its own centroid; IDX is updated for these samples
+    /// drift: [K], distance every centroid moved
+    /// reseeded: samples which were moved into empty clusters
+    void update_centroid_parallel(const ArrayType& X, ClusterType& IDX, ArrayType& C, VectorType& drift, std::vector<size_t>& reseeded);
+
+    /// sum of squared distances from every sample to its centroid
+    T compute_sum_dist(const ArrayType& X, const ClusterType& IDX, const ArrayType& C);
+
+protected:
+
+    void run_lloyd(const ArrayType& X, size_t K, ClusterType& IDX, ArrayType& C);
+    void run_hamerly(const ArrayType& X, size_t K, ClusterType& IDX, ArrayType& C);
+    void run_elkan(const ArrayType& X, size_t K, ClusterType& IDX, ArrayType& C);
+    void run_mini_batch(const ArrayType& X, size_t K, ClusterType& IDX, ArrayType& C);
+
+    unsigned int get_seed();
+};
+
+}
@@ -23,9 +23,23 @@ namespace Gadgetron {
         static PyObject* convert(const IsmrmrdImageArray & arrayData)
         {
             GILLock lock;
+            return make_image_array(arrayData, bp::object(arrayData.data_));
+        }
+
+        /// As convert, but the image data is handed over to NumPy without copying
+        static PyObject* adopt(IsmrmrdImageArray && arrayData)
+        {
+            GILLock lock;
+            auto data = to_numpy(std::move(arrayData.data_));
+            return make_image_array(arrayData, data);
+        }
+
+    private:
+        // The IsmrmrdImageArray object holds its own references to the converted members
+        static PyObject* make_image_array(const IsmrmrdImageArray & arrayData, bp::object data)
+        {
             bp::object pygadgetron = bp::import("gadgetron");
 
-            auto data = bp::object(arrayData.data_);
             /*auto pyHeaders = bp::list();
 
             size_t n;
@@ -47,11 +61,6 @@ namespace Gadgetron {
             auto pyWav = arrayData.waveform_ ? boost::python::object(*arrayData.waveform_) : boost::python::object();
             auto pyAcqHeaders = arrayData.acq_headers_ ? boost::python::object(*arrayData.acq_headers_) : boost::python::object();
 
-            bp::incref(data.ptr());
-            bp::incref(pyHeaders.ptr());
-            bp::incref(pyMeta.ptr());
-            bp::incref(pyWav.ptr());
-            bp::incref(pyAcqHeaders.ptr());
             auto buffer = pygadgetron.attr("IsmrmrdImageArray")(data, pyHeaders, pyMeta, pyWav, pyAcqHeaders);
 
             // increment the reference count so it exists after `return`
@@ -108,6 +117,12 @@ namespace Gadgetron {
         }
     };
 
+    /// Passes an image array given as an rvalue to Python without copying the image data
+    inline bp::object python_argument(IsmrmrdImageArray&& arrayData)
+    {
+        return bp::object(bp::handle<>(IsmrmrdImageArray_to_python_object::adopt(std::move(arrayData))));
+    }
+
     // ------------------------------------------------------------------------
     template<> struct python_converter<IsmrmrdImageArray>
     {
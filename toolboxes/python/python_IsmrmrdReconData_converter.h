@@ -31,21 +31,42 @@ public:
     return bp::incref(pyReconData.ptr());
   }
 
+  /// As convert, but the data and trajectories are handed over to NumPy without copying
+  static PyObject* adopt(IsmrmrdReconData && reconData) {
+      GILLock lock;
+    bp::object pygadgetron = bp::import("gadgetron");
+
+    auto pyReconData = bp::list();
+    for (auto & reconBit : reconData.rbit_ ){
+      auto data = DataBufferedToPython(std::move(reconBit.data_));
+      auto ref = 	reconBit.ref_ ? DataBufferedToPython(std::move(*reconBit.ref_)) : bp::object();
+
+      auto pyReconBit = pygadgetron.attr("IsmrmrdReconBit")(data,ref);
+      pyReconData.append(pyReconBit);
+
+    }
+    return bp::incref(pyReconData.ptr());
+  }
+
 private:
   static bp::object DataBufferedToPython( const IsmrmrdDataBuffered & dataBuffer){
-    bp::object pygadgetron = bp::import("gadgetron");
     auto data = bp::object(dataBuffer.data_);
-    auto headers = boost::python::object(dataBuffer.headers_);
     auto trajectory = dataBuffer.trajectory_ ? bp::object(*dataBuffer.trajectory_) : bp::object();
-    auto sampling = SamplingDescriptionToPython(dataBuffer.sampling_);
-    auto buffer = pygadgetron.attr("IsmrmrdDataBuffered")(data,headers,sampling,trajectory);
+    return DataBufferedToPython(dataBuffer, data, trajectory);
+  }
 
-    bp::incref(data.ptr());
-    bp::incref(headers.ptr());
-    bp::incref(trajectory.ptr());
-    bp::incref(sampling.ptr());
+  static bp::object DataBufferedToPython( IsmrmrdDataBuffered && dataBuffer){
+    auto data = to_numpy(std::move(dataBuffer.data_));
+    auto trajectory = dataBuffer.trajectory_ ? to_numpy(std::move(*dataBuffer.trajectory_)) : bp::object();
+    return DataBufferedToPython(dataBuffer, data, trajectory);
+  }
 
-    return buffer;
+  // The IsmrmrdDataBuffered object holds its own references to the converted members
+  static bp::object DataBufferedToPython( const IsmrmrdDataBuffered & dataBuffer, bp::object data, bp::object trajectory){
+    bp::object pygadgetron = bp::import("gadgetron");
+    auto headers = boost::python::object(dataBuffer.headers_);
+    auto sampling = SamplingDescriptionToPython(dataBuffer.sampling_);
+    return pygadgetron.attr("IsmrmrdDataBuffered")(data,headers,sampling,trajectory);
   }
 
   static bp::object SamplingDescriptionToPython(const SamplingDescription & sD){
@@ -153,6 +174,11 @@ struct IsmrmrdReconData_from_python_object {
 };
 
 
+/// Passes recon data given as an rvalue to Python without copying the data and trajectories
+inline bp::object python_argument(IsmrmrdReconData&& reconData) {
+  return bp::object(bp::handle<>(IsmrmrdReconData_to_python_object::adopt(std::move(reconData))));
+}
+
 /// Partial specialization of `python_converter` for hoNDArray
 template<> struct python_converter<IsmrmrdReconData> {
   static void create()
@@ -2,6 +2,7 @@
 #define GADGETRON_PYTHON_MATH_CONVERSIONS_H
 
 #include "ismrmrd/ismrmrd.h"
+#include <boost/python.hpp>
 
 namespace Gadgetron {
 
@@ -23,6 +24,25 @@ void register_converter(void) {
     (void) expander {0, (python_converter<TS>::create(), 0)...};
 }
 
+/// Arguments of a PythonFunction are converted by the registered converters, which copy
+/// array data. Overloads for rvalues hand the data over to NumPy instead.
+template <typename T>
+const T& python_argument(const T& arg) {
+    return arg;
+}
+
+/// Converts the result of a Python function. Values constructed by an rvalue converter are moved out
+/// of the converter storage, rather than copied as `bp::extract<T>` does.
+template <typename T>
+T python_result(const boost::python::object& res) {
+    namespace cv = boost::python::converter;
+    cv::rvalue_from_python_data<T> data(cv::rvalue_from_python_stage1(res.ptr(), cv::registered<T>::converters));
+    void* converted = cv::rvalue_from_python_stage2(res.ptr(), data.stage1, cv::registered<T>::converters);
+    if (converted == data.storage.bytes)
+        return std::move(*static_cast<T*>(converted));
+    return *static_cast<T*>(converted);
+}
+
 }
 
 #include "patchlevel.h"
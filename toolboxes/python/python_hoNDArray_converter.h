@@ -12,14 +12,75 @@
 #include "log.h"
 
 #include <boost/python.hpp>
+#include <string>
+#include <typeinfo>
 namespace bp = boost::python;
 
 namespace Gadgetron {
 
+// -------------------------------------------------------------------------------
+/// Capsule owning an hoNDArray, used as the base object of NumPy arrays sharing its storage.
+/// The hoNDArray is deleted once the last NumPy array using the storage is garbage collected.
+template <typename T>
+struct hoNDArray_capsule {
+    static const char* name() {
+        static const std::string capsule_name = std::string("gadgetron.hoNDArray.") + typeid(T).name();
+        return capsule_name.c_str();
+    }
+
+    static PyObject* wrap(hoNDArray<T>* arr) {
+        return PyCapsule_New(arr, name(), &destroy);
+    }
+
+    /// The hoNDArray owning the storage of a NumPy array, or nullptr if the storage is owned by NumPy.
+    /// Views of views are followed down to the capsule. `unique` is set if the array and the views it is
+    /// based on are referenced by nothing but their successor in the chain.
+    static hoNDArray<T>* owner(PyObject* obj, bool& unique) {
+        unique = true;
+        while (obj && NumPyArray_Check(obj)) {
+            unique = unique && Py_REFCNT(obj) == 1;
+            obj = NumPyArray_BASE(obj);
+        }
+        if (!obj || !PyCapsule_IsValid(obj, name())) return nullptr;
+        return static_cast<hoNDArray<T>*>(PyCapsule_GetPointer(obj, name()));
+    }
+
+private:
+    static void destroy(PyObject* capsule) {
+        delete static_cast<hoNDArray<T>*>(PyCapsule_GetPointer(capsule, name()));
+    }
+};
+
 // -------------------------------------------------------------------------------
 /// Used for making a NumPy array from and hoNDArray
 template <typename T>
 struct hoNDArray_to_numpy_array {
+    /// Hands the storage of the array over to a NumPy array, without copying.
+    /// Arrays which do not own their storage are copied.
+    static PyObject* adopt(hoNDArray<T>&& arr) {
+        if (arr.empty() || !arr.delete_data_on_destruct())
+            return convert(arr);
+
+        size_t ndim = arr.get_number_of_dimensions();
+        std::vector<npy_intp> dims2(ndim);
+        for (size_t i = 0; i < ndim; i++) {
+            dims2[i] = static_cast<npy_intp>(arr.get_size(i));
+        }
+
+        auto owned = new hoNDArray<T>(std::move(arr));
+        PyObject *obj = NumPyArray_NewFromData(dims2.size(), dims2.data(), get_numpy_type<T>(), owned->get_data_ptr(), true);
+        if (!obj) {
+            delete owned;
+            throw std::runtime_error("hondarray_to_numpy_array: unable to create NumPy array");
+        }
+
+        if (NumPyArray_SetBaseObject(obj, hoNDArray_capsule<T>::wrap(owned)) < 0) {
+            Py_DECREF(obj);
+            throw std::runtime_error("hondarray_to_numpy_array: unable to set base object of NumPy array");
+        }
+        return obj;
+    }
+
     static PyObject* convert(const hoNDArray<T>& arr) {
         size_t ndim = arr.get_number_of_dimensions();
         std::vector<npy_intp> dims2(ndim);
@@ -121,11 +182,34 @@ struct hoNDArray_from_numpy_array {
         return obj;
     }
 
+    /// Whether the storage of the hoNDArray behind a NumPy array can be taken back without copying.
+    /// This requires the NumPy array to cover all of the storage in Fortran order, and nothing but the
+    /// object being converted to refer to it.
+    static bool adoptable(PyObject* obj, const hoNDArray<T>* owned, bool unique) {
+        return owned && unique && NumPyArray_TYPE(obj) == get_numpy_type<T>()
+            && NumPyArray_IS_F_CONTIGUOUS(obj) && NumPyArray_DATA(obj) == owned->get_data_ptr()
+            && size_t(NumPyArray_SIZE(obj)) == owned->get_number_of_elements();
+    }
+
     /// Construct an hoNDArray in-place
     static void construct(PyObject* obj_orig, bp::converter::rvalue_from_python_stage1_data* data) {
         void* storage = ((bp::converter::rvalue_from_python_storage<hoNDArray<T> >*)data)->storage.bytes;
         data->convertible = storage;
 
+        bool unique = false;
+        hoNDArray<T>* owned = hoNDArray_capsule<T>::owner(obj_orig, unique);
+        if (adoptable(obj_orig, owned, unique)) {
+            size_t ndim = NumPyArray_NDIM(obj_orig);
+            std::vector<size_t> dims(ndim);
+            for (size_t i = 0; i < ndim; i++) {
+                dims[i] = NumPyArray_DIM(obj_orig, i);
+            }
+            hoNDArray<T>* arr = new (storage) hoNDArray<T>(std::move(*owned));
+            arr->reshape(dims);
+            NumPyArray_Detach(obj_orig);
+            return;
+        }
+
         PyObject* obj =  NumPyArray_FromAny(obj_orig, nullptr, 1, 36,  NPY_ARRAY_IN_FARRAY, nullptr);
         size_t ndim = NumPyArray_NDIM(obj);
         std::vector<size_t> dims(ndim);
@@ -242,6 +326,20 @@ template <typename T> void create_hoNDArray_converter() {
     }
 }
 
+/// Makes a NumPy array sharing the storage of the array, without copying.
+/// Must be called with the GIL held.
+template <typename T>
+bp::object to_numpy(hoNDArray<T>&& arr) {
+    initialize_numpy();
+    return bp::object(bp::handle<>(hoNDArray_to_numpy_array<T>::adopt(std::move(arr))));
+}
+
+/// Passes an array given as an rvalue to Python without copying
+template <typename T>
+bp::object python_argument(hoNDArray<T>&& arr) {
+    return to_numpy(std::move(arr));
+}
+
 /// Partial specialization of `python_converter` for hoNDArray
 template <typename T>
 struct python_converter<hoNDArray<T> > {
@@ -20,6 +20,16 @@ EXPORTPYTHON npy_intp NumPyArray_SIZE(PyObject* obj);
 EXPORTPYTHON PyObject *NumPyArray_SimpleNew(int nd, npy_intp* dims, int typenum);
 EXPORTPYTHON PyObject *NumPyArray_EMPTY(int nd, npy_intp* dims, int typenum, int fortran);
 EXPORTPYTHON PyObject* NumPyArray_FromAny(PyObject* op, PyArray_Descr* dtype, int min_depth, int max_depth, int requirements, PyObject* context);
+EXPORTPYTHON bool NumPyArray_Check(PyObject* obj);
+EXPORTPYTHON int NumPyArray_TYPE(PyObject* obj);
+EXPORTPYTHON bool NumPyArray_IS_F_CONTIGUOUS(PyObject* obj);
+EXPORTPYTHON PyObject *NumPyArray_BASE(PyObject* obj);
+/// Creates an array on existing data, which NumPy does not own
+EXPORTPYTHON PyObject *NumPyArray_NewFromData(int nd, npy_intp* dims, int typenum, void* data, int fortran);
+/// Steals the reference to base, which keeps the data of the array alive
+EXPORTPYTHON int NumPyArray_SetBaseObject(PyObject* obj, PyObject* base);
+/// Sets all dimensions of the array to zero, so its data is never accessed again
+EXPORTPYTHON void NumPyArray_Detach(PyObject* obj);
 /// return the enumerated numpy type for a given C++ type
 template <typename T> int get_numpy_type() { return NPY_VOID; }
 template <> inline int get_numpy_type< bool >() { return NPY_BOOL; }
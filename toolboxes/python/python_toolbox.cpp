@@ -6,6 +6,7 @@
 
 #include <boost/thread/mutex.hpp>
 #include <boost/algorithm/string.hpp>
+#include <boost/dll/alias.hpp>
 
 // #include "Gadget.h"             // for GADGET_OK/FAIL
 
@@ -41,6 +42,9 @@ void initialize_python(void)
     }
 }
 
+// Used by pre-forked Gadgetron workers to initialize Python before a connection is handed to them
+BOOST_DLL_ALIAS(Gadgetron::initialize_python, initialize_python_export)
+
 void  initialize_numpy(void)
 {
     // lock here so only one thread can initialize NumPy
@@ -129,6 +133,44 @@ npy_intp* NumPyArray_STRIDES(PyObject* obj)
 PyObject* NumPyArray_FromAny(PyObject* op, PyArray_Descr* dtype, int min_depth, int max_depth, int requirements, PyObject* context){
   return PyArray_FromAny(op, dtype, min_depth, max_depth, requirements, context);
 }
+bool NumPyArray_Check(PyObject* obj)
+{
+    return PyArray_Check(obj);
+}
+
+int NumPyArray_TYPE(PyObject* obj)
+{
+    return PyArray_TYPE((PyArrayObject*)obj);
+}
+
+bool NumPyArray_IS_F_CONTIGUOUS(PyObject* obj)
+{
+    return PyArray_IS_F_CONTIGUOUS((PyArrayObject*)obj);
+}
+
+PyObject* NumPyArray_BASE(PyObject* obj)
+{
+    return PyArray_BASE((PyArrayObject*)obj);
+}
+
+PyObject* NumPyArray_NewFromData(int nd, npy_intp* dims, int typenum, void* data, int fortran)
+{
+    return PyArray_New(&PyArray_Type, nd, dims, typenum, nullptr, data, 0,
+        fortran ? NPY_ARRAY_FARRAY : NPY_ARRAY_CARRAY, nullptr);
+}
+
+int NumPyArray_SetBaseObject(PyObject* obj, PyObject* base)
+{
+    return PyArray_SetBaseObject((PyArrayObject*)obj, base);
+}
+
+void NumPyArray_Detach(PyObject* obj)
+{
+    npy_intp* dims = PyArray_DIMS((PyArrayObject*)obj);
+    for (int i = 0; i < PyArray_NDIM((PyArrayObject*)obj); i++)
+        dims[i] = 0;
+}
+
 /// Wraps PyArray_ITEMSIZE
 int NumPyArray_ITEMSIZE(PyObject* obj)
 {
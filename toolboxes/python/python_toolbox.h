@@ -73,6 +73,10 @@ protected:
 };
 
 /// PythonFunction for multiple return types (std::tuple)
+///
+/// Arrays, recon data and image arrays passed as rvalues (e.g. with std::move) are handed
+/// over to NumPy without copying. Returned arrays which share storage with an hoNDArray,
+/// and are not referenced from Python anymore, are taken back without copying.
 template <typename... ReturnTypes>
 class PythonFunction : public PythonFunctionBase
 {
@@ -87,14 +91,14 @@ public:
     }
 
     template <typename... TS>
-    TupleType operator()(const TS&... args)
+    TupleType operator()(TS&&... args)
     {
         // register type converter for each parameter type
-        register_converter<TS...>();
+        register_converter<std::decay_t<TS>...>();
         GILLock lg; // lock GIL and release at function exit
         try {
-            bp::object res = fn_(args...);
-            return bp::extract<TupleType>(res);
+            bp::object res = fn_(python_argument(std::forward<TS>(args))...);
+            return python_result<TupleType>(res);
         } catch (bp::error_already_set const &) {
             std::string err = pyerr_to_string();
             GERROR(err.c_str());
@@ -116,14 +120,14 @@ public:
     }
 
     template <typename... TS>
-    RetType operator()(const TS&... args)
+    RetType operator()(TS&&... args)
     {
         // register type converter for each parameter type
-        register_converter<TS...>();
+        register_converter<std::decay_t<TS>...>();
         GILLock lg; // lock GIL and release at function exit
         try {
-            bp::object res = fn_(args...);
-            return bp::extract<RetType>(res);
+            bp::object res = fn_(python_argument(std::forward<TS>(args))...);
+            return python_result<RetType>(res);
         } catch (bp::error_already_set const &) {
             std::string err = pyerr_to_string();
             GERROR(err.c_str());
@@ -143,13 +147,13 @@ public:
     }
 
     template <typename... TS>
-    bp::object operator()(const TS&... args)
+    bp::object operator()(TS&&... args)
     {
         // register type converter for each parameter type
-        register_converter<TS...>();
+        register_converter<std::decay_t<TS>...>();
         GILLock lg; // lock GIL and release at function exit
         try {
-            bp::object res = fn_(args...);
+            bp::object res = fn_(python_argument(std::forward<TS>(args))...);
             return res;
         }
         catch (bp::error_already_set const &) {
@@ -170,13 +174,13 @@ public:
       : PythonFunctionBase(module, funcname) {}
 
     template <typename... TS>
-    void operator()(const TS&... args)
+    void operator()(TS&&... args)
     {
         // register type converter for each parameter type
-        register_converter<TS...>();
+        register_converter<std::decay_t<TS>...>();
         GILLock lg; // lock GIL and release at function exit
         try {
-            bp::object res = fn_(args...);
+            bp::object res = fn_(python_argument(std::forward<TS>(args))...);
         } catch (bp::error_already_set const &) {
             std::string err = pyerr_to_string();
             GERROR(err.c_str());
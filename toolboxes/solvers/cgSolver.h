@@ -21,6 +21,8 @@
 #include "linearOperatorSolver.h"
 #include "cgCallback.h"
 #include "cgPreconditioner.h"
+#include "solverWorkspace.h"
+#include "solverKernels.h"
 #include "real_utilities.h"
 #include "complext.h"
 
@@ -98,6 +100,15 @@ namespace Gadgetron{
     virtual void solver_dump( ARRAY_TYPE* ) {}
 
 
+    // The iteration vectors are kept between solves with the same dimensions.
+    // Release their memory when the solver is kept around but not used.
+    //
+
+    virtual void release_workspace() { workspace_.release(); }
+
+    virtual const solverWorkspace<ARRAY_TYPE>& get_workspace() const { return workspace_; }
+
+
     //
     // Main solver interface
     //
@@ -107,8 +118,10 @@ namespace Gadgetron{
     
       // Compute right hand side...
       //
-      
-      boost::shared_ptr<ARRAY_TYPE> rhs = compute_rhs( d );
+
+      // The right hand side is computed into the residual vector, which it initializes
+      boost::shared_ptr<ARRAY_TYPE> rhs = workspace_.get( WS_R, get_image_dimensions() );
+      compute_rhs_into( d, rhs.get() );
 
       // ... and the result
       //
@@ -169,50 +182,54 @@ namespace Gadgetron{
 
     virtual boost::shared_ptr<ARRAY_TYPE> compute_rhs( ARRAY_TYPE *d )
     {
-    
+      boost::shared_ptr<ARRAY_TYPE> result = boost::shared_ptr<ARRAY_TYPE>(new ARRAY_TYPE(get_image_dimensions()));
+      compute_rhs_into( d, result.get() );
+      return result;
+    }
+
+  protected:
+  
+    //
+    // Everything beyond this point is internal to the implementation
+    // and not intended to be exposed as a public interface
+    //
+
+    // Workspace slots
+    //
+
+    enum { WS_R, WS_P, WS_Q, WS_MHM };
+
+    // Image space dimensions from the encoding operator
+    //
+
+    std::vector<size_t> get_image_dimensions()
+    {
       if( this->encoding_operator_.get() == 0 ){
       	throw std::runtime_error( "Error: cgSolver::compute_rhs : no encoding operator is set" );
-      } 
-        
-      // Get image space dimensions from the encoding operator
-      //
+      }
 
       std::vector<size_t> image_dims = this->encoding_operator_->get_domain_dimensions();
       if( image_dims.empty() ){
       	throw std::runtime_error( "Error: cgSolver::compute_rhs : encoding operator has not set domain dimension" );
       }
+      return image_dims;
+    }
 
-      // Create result array and clear
-      //
-
-      boost::shared_ptr<ARRAY_TYPE> result = boost::shared_ptr<ARRAY_TYPE>(new ARRAY_TYPE(image_dims));
-      clear(result.get());
-    
-      // Create temporary array
-      //
-
-      ARRAY_TYPE tmp(image_dims);
+    // Compute right hand side into rhs, which has the image space dimensions
+    //
 
-      // Compute operator adjoint
+    void compute_rhs_into( ARRAY_TYPE *d, ARRAY_TYPE *rhs )
+    {
+      // Compute operator adjoint and apply weight
       //
 
-      this->encoding_operator_->mult_MH( d, &tmp );
-    
-      // Apply weight
-      //
+      this->encoding_operator_->mult_MH( d, rhs );
 
-      axpy(ELEMENT_TYPE(this->encoding_operator_->get_weight()), &tmp, result.get() );
-    
-      return result;
+      const REAL weight = this->encoding_operator_->get_weight();
+      if( weight != REAL(1) )
+        *rhs *= ELEMENT_TYPE(weight);
     }
 
-  protected:
-  
-    //
-    // Everything beyond this point is internal to the implementation
-    // and not intended to be exposed as a public interface
-    //
-
     // Initialize solver
     //
 
@@ -234,8 +251,13 @@ namespace Gadgetron{
       // Initialize r,p,x
       //
 
-      r_ = boost::shared_ptr<ARRAY_TYPE>( new ARRAY_TYPE(*rhs) );
-      p_ = boost::shared_ptr<ARRAY_TYPE>( new ARRAY_TYPE(*r_) );
+      r_ = workspace_.get( WS_R, rhs->dimensions() );
+      p_ = workspace_.get( WS_P, rhs->dimensions() );
+      q_ = workspace_.get( WS_Q, rhs->dimensions() );
+
+      if( r_.get() != rhs )
+        *r_ = *rhs;
+      *p_ = *r_;
     
       if( !this->get_x0().get() ){ // no starting image provided      
 	clear(x_.get());
@@ -259,15 +281,13 @@ namespace Gadgetron{
 	
         *x_ = *(this->get_x0());
         
-        ARRAY_TYPE mhmX(rhs->dimensions());
-
         if( this->output_mode_ >= solver<ARRAY_TYPE,ARRAY_TYPE>::OUTPUT_VERBOSE ) {
           GDEBUG_STREAM("Preparing guess..." << std::endl);
         }
         
-        mult_MH_M( this->get_x0().get(), &mhmX );
+        mult_MH_M( this->get_x0().get(), q_.get() );
         
-        *r_ -= mhmX;
+        *r_ -= *q_;
         *p_ = *r_;
         
         // Apply preconditioning, twice (should change preconditioners to do this)
@@ -292,8 +312,10 @@ namespace Gadgetron{
 
     virtual void deinitialize()
     {
+      // The iteration vectors remain in the workspace for the next solve
       p_.reset();
       r_.reset();
+      q_.reset();
       x_.reset();
     }
 
@@ -302,43 +324,33 @@ namespace Gadgetron{
 
     virtual void iterate( unsigned int iteration, REAL *tc_metric, bool *tc_terminate )
     {
-      ARRAY_TYPE q = ARRAY_TYPE(x_->dimensions());
-
       // Perform one iteration of the solver
       //
 
-      mult_MH_M( p_.get(), &q );
-    
-      // Update solution
-      //
-
-      alpha_ = rq_/dot( p_.get(), &q );
-      axpy( alpha_, p_.get(), x_.get());
+      const ELEMENT_TYPE pq = mult_MH_M_dot( p_.get(), q_.get() );
 
-      // Update residual
+      // Update solution and residual, x += alpha*p and r -= alpha*q
       //
 
-      axpy( -alpha_, &q, r_.get());
+      alpha_ = rq_/pq;
+      const REAL rr = update_solution_and_residual( alpha_, p_.get(), q_.get(), x_.get(), r_.get() );
 
       // Apply preconditioning
       //
 
       if( precond_.get() ){
 
-        precond_->apply( r_.get(), &q );
-        precond_->apply( &q, &q );
+        precond_->apply( r_.get(), q_.get() );
+        precond_->apply( q_.get(), q_.get() );
         
-        REAL tmp_rq = real(dot( r_.get(), &q ));      
-        *p_ *= ELEMENT_TYPE((tmp_rq/rq_));
-        axpy( ELEMENT_TYPE(1), &q, p_.get() );
+        REAL tmp_rq = real(dot( r_.get(), q_.get() ));
+        axpby( ELEMENT_TYPE(1), q_.get(), ELEMENT_TYPE(tmp_rq/rq_), p_.get() );
         rq_ = tmp_rq;
       } 
       else{
         
-        REAL tmp_rq = real(dot( r_.get(), r_.get()) );
-        *p_ *= ELEMENT_TYPE((tmp_rq/rq_));           
-        axpy( ELEMENT_TYPE(1), r_.get(), p_.get() );
-        rq_ = tmp_rq;      
+        axpby( ELEMENT_TYPE(1), r_.get(), ELEMENT_TYPE(rr/rq_), p_.get() );
+        rq_ = rr;
       }
       
       // Invoke termination callback iteration
@@ -353,6 +365,27 @@ namespace Gadgetron{
     //
 
     void mult_MH_M( ARRAY_TYPE *in, ARRAY_TYPE *out )
+    {
+      mult_MH_M_accumulate( in, out, 0x0 );
+    }
+
+    // Perform mult_MH_M of the encoding and regularization matrices, and return dot(in, out)
+    //
+
+    ELEMENT_TYPE mult_MH_M_dot( ARRAY_TYPE *in, ARRAY_TYPE *out )
+    {
+      ELEMENT_TYPE result;
+      if( mult_MH_M_accumulate( in, out, &result ) )
+        return result;
+      return dot( in, out );
+    }
+
+    // Operators with unit weight accumulate directly into the output. For other weights, the operator output
+    // is added with axpy, which for the last operator is fused with the dot product if requested.
+    // Returns true if the dot product was computed.
+    //
+
+    bool mult_MH_M_accumulate( ARRAY_TYPE *in, ARRAY_TYPE *out, ELEMENT_TYPE *dot_in_out )
     {
       // Basic validity checks
       //
@@ -364,29 +397,44 @@ namespace Gadgetron{
       if( in->get_number_of_elements() != out->get_number_of_elements() ){
         throw std::runtime_error( "Error: cgSolver::mult_MH_M : array dimensionality mismatch" );
       }
-    
-      // Intermediate storage
-      //
-
-      ARRAY_TYPE q = ARRAY_TYPE(in->dimensions());
-
-      // Start by clearing the output
-      //
-      clear(out);
 
       // Apply encoding operator
       //
 
-      this->encoding_operator_->mult_MH_M( in, &q, false );
-      axpy( ELEMENT_TYPE (this->encoding_operator_->get_weight()), &q, out );
+      this->encoding_operator_->mult_MH_M( in, out, false );
+
+      const REAL encoding_weight = this->encoding_operator_->get_weight();
+      if( encoding_weight != REAL(1) )
+        *out *= ELEMENT_TYPE(encoding_weight);
 
       // Iterate over regularization operators
       //
 
-      for( unsigned int i=0; i<this->regularization_operators_.size(); i++ ){      
-        this->regularization_operators_[i]->mult_MH_M( in, &q, false );
-        axpy( ELEMENT_TYPE(this->regularization_operators_[i]->get_weight()), &q, out );
-      }      
+      bool computed_dot = false;
+
+      for( unsigned int i=0; i<this->regularization_operators_.size(); i++ ){
+        const REAL weight = this->regularization_operators_[i]->get_weight();
+
+        if( weight == REAL(1) ){
+          this->regularization_operators_[i]->mult_MH_M( in, out, true );
+          continue;
+        }
+
+        // Intermediate storage
+        //
+
+        boost::shared_ptr<ARRAY_TYPE> q = workspace_.get( WS_MHM, in->dimensions() );
+        this->regularization_operators_[i]->mult_MH_M( in, q.get(), false );
+
+        if( dot_in_out && i == this->regularization_operators_.size()-1 ){
+          *dot_in_out = axpy_dot( ELEMENT_TYPE(weight), q.get(), out, in );
+          computed_dot = true;
+        }
+        else
+          axpy( ELEMENT_TYPE(weight), q.get(), out );
+      }
+
+      return computed_dot;
     }
     
   protected:
@@ -407,6 +455,9 @@ namespace Gadgetron{
     REAL rq_;
     REAL rq0_;
     ELEMENT_TYPE alpha_;
-    boost::shared_ptr<ARRAY_TYPE> x_, p_, r_;
+    boost::shared_ptr<ARRAY_TYPE> x_, p_, r_, q_;
+
+    // Preallocated iteration vectors
+    solverWorkspace<ARRAY_TYPE> workspace_;
   };
 }
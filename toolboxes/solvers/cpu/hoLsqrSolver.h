@@ -11,6 +11,7 @@
 #pragma once
 
 #include "hoNDArray_math.h"
+#include "hoSolverUtils.h"
 #include "lsqrSolver.h"
 
 namespace Gadgetron{
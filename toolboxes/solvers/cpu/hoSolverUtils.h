@@ -3,6 +3,7 @@
 #include "hoNDArray.h"
 #include "hoNDArray_math.h"
 #include "complext.h"
+#include "solverKernels.h"
 
 #ifdef USE_OMP
 #include <omp.h>
@@ -53,5 +54,110 @@ template<class T> void updateFgroup(std::vector<hoNDArray<T> >& datas, typename
 
     }
 }
+
+//
+// Single pass implementations of the fused solver kernels (solverKernels.h) for hoNDArray.
+// Reductions are accumulated in double precision.
+//
+
+namespace solver_detail {
+  template<class T> inline T multiply(const T& a, const T& b) { return a*b; }
+
+  // Avoids the NaN checks of std::complex multiplication, which prevent vectorisation
+  template<class T> inline std::complex<T> multiply(const std::complex<T>& a, const std::complex<T>& b) {
+    return std::complex<T>(a.real()*b.real() - a.imag()*b.imag(), a.real()*b.imag() + a.imag()*b.real());
+  }
+
+  template<class T> inline double norm_sq(const T& a) { return double(norm(a)); }
+  inline double norm_sq(float a) { return double(a)*a; }
+  inline double norm_sq(double a) { return a*a; }
+
+  template<class T> inline T conj_value(const T& a) { return conj(a); }
+  template<class T> inline std::complex<T> conj_value(const std::complex<T>& a) { return std::conj(a); }
+
+  template<class T> struct accumulator { typedef double type; };
+  template<class T> struct accumulator<std::complex<T> > { typedef std::complex<double> type; };
+  template<class T> struct accumulator<complext<T> > { typedef complext<double> type; };
+}
+
+template<class T> void axpby(T a, hoNDArray<T>* x, T b, hoNDArray<T>* y)
+{
+  T* px = x->get_data_ptr();
+  T* py = y->get_data_ptr();
+  const long long N = (long long)y->get_number_of_elements();
+
+#ifdef USE_OMP
+#pragma omp parallel for if (N > (long long)Elemwise::parallel_threshold)
+#endif
+  for( long long i=0; i < N; i++ )
+    py[i] = solver_detail::multiply(a, px[i]) + solver_detail::multiply(b, py[i]);
+}
+
+template<class T> typename realType<T>::Type axpby_nrm2sq(T a, hoNDArray<T>* x, T b, hoNDArray<T>* y)
+{
+  T* px = x->get_data_ptr();
+  T* py = y->get_data_ptr();
+  const long long N = (long long)y->get_number_of_elements();
+  double sum = 0;
+
+#ifdef USE_OMP
+#pragma omp parallel for reduction(+:sum) if (N > (long long)Elemwise::parallel_threshold)
+#endif
+  for( long long i=0; i < N; i++ ){
+    const T v = solver_detail::multiply(a, px[i]) + solver_detail::multiply(b, py[i]);
+    py[i] = v;
+    sum += solver_detail::norm_sq(v);
+  }
+  return typename realType<T>::Type(sum);
+}
+
+template<class T> T axpy_dot(T a, hoNDArray<T>* x, hoNDArray<T>* y, hoNDArray<T>* z)
+{
+  typedef typename realType<T>::Type REAL;
+  T* px = x->get_data_ptr();
+  T* py = y->get_data_ptr();
+  T* pz = z->get_data_ptr();
+  const long long N = (long long)y->get_number_of_elements();
+
+  // OpenMP only reduces arithmetic types, so complex sums are reduced as real and imaginary parts
+  double sum_re = 0, sum_im = 0;
+
+#ifdef USE_OMP
+#pragma omp parallel for reduction(+:sum_re,sum_im) if (N > (long long)Elemwise::parallel_threshold)
+#endif
+  for( long long i=0; i < N; i++ ){
+    const T v = py[i] + solver_detail::multiply(a, px[i]);
+    py[i] = v;
+    const T d = solver_detail::multiply(solver_detail::conj_value(pz[i]), v);
+    sum_re += real(d);
+    sum_im += imag(d);
+  }
+
+  if constexpr (std::is_floating_point<T>::value)
+    return T(sum_re);
+  else
+    return T(REAL(sum_re), REAL(sum_im));
+}
+
+template<class T> typename realType<T>::Type update_solution_and_residual(T alpha, hoNDArray<T>* p, hoNDArray<T>* q, hoNDArray<T>* x, hoNDArray<T>* r)
+{
+  T* pp = p->get_data_ptr();
+  T* pq = q->get_data_ptr();
+  T* px = x->get_data_ptr();
+  T* pr = r->get_data_ptr();
+  const long long N = (long long)x->get_number_of_elements();
+  double sum = 0;
+
+#ifdef USE_OMP
+#pragma omp parallel for reduction(+:sum) if (N > (long long)Elemwise::parallel_threshold)
+#endif
+  for( long long i=0; i < N; i++ ){
+    px[i] += solver_detail::multiply(alpha, pp[i]);
+    const T v = pr[i] - solver_detail::multiply(alpha, pq[i]);
+    pr[i] = v;
+    sum += solver_detail::norm_sq(v);
+  }
+  return typename realType<T>::Type(sum);
+}
 }
 
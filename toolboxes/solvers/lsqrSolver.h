@@ -3,6 +3,7 @@
 #include "linearOperator.h"
 #include "linearOperatorSolver.h"
 #include "cgPreconditioner.h"
+#include "solverKernels.h"
 #include "real_utilities.h"
 
 #include <vector>
@@ -106,7 +107,7 @@ public:
             size_t iter = iterations_;
             size_t  maxstagsteps = 3;
 
-            ARRAY_TYPE z(v), dtmp(d), ztmp(v), vt(v), utmp(u);
+            ARRAY_TYPE z(v), vt(v), utmp(u);
             ARRAY_TYPE normaVec(3);
 
             REAL thet, rhot, rho, phi, tmp, tmp2;
@@ -117,10 +118,9 @@ public:
                 z = v;
 
                 this->encoding_operator_->mult_M(&z, &utmp);
-                Gadgetron::scal(alpha, u);
-                Gadgetron::subtract(utmp, u, u);
 
-                beta = Gadgetron::nrm2(&u);
+                // u = utmp - alpha*u, beta = ||u||
+                beta = std::sqrt(axpby_nrm2sq(ELEMENT_TYPE(1), &utmp, ELEMENT_TYPE(-alpha), &u));
                 Gadgetron::scal(REAL(1.0) / beta, u);
 
                 normaVec(0) = norma;
@@ -141,14 +141,10 @@ public:
 
                 phibar = s * phibar;
 
-                dtmp = d;
-                Gadgetron::scal(thet, dtmp);
-                Gadgetron::subtract(z, dtmp, ztmp);
-                Gadgetron::scal(REAL(1.0) / rho, ztmp);
-
-                d = ztmp;
-                tmp = Gadgetron::nrm2(&d);
-                sumnormd2 += (tmp*tmp);
+                // d = (z - thet*d) / rho
+                const REAL normd2 = axpby_nrm2sq(ELEMENT_TYPE(REAL(1) / rho), &z, ELEMENT_TYPE(-thet / rho), &d);
+                tmp = std::sqrt(normd2);
+                sumnormd2 += normd2;
 
                 // Check for stagnation of the method
                 tmp2 = Gadgetron::nrm2(x);
@@ -182,20 +178,14 @@ public:
                     break;
                 }
 
-                // memcpy(dtmp.begin(), d.begin(), d.get_number_of_bytes());
-                dtmp = d;
-
-                Gadgetron::scal(phi, dtmp);
-                Gadgetron::add(*x, dtmp, *x);
+                Gadgetron::axpy(ELEMENT_TYPE(phi), &d, x);
 
                 normr = (REAL)(std::abs((double)s) * normr);
 
                 this->encoding_operator_->mult_MH(&u, &vt);
 
-                Gadgetron::scal(beta, v);
-                Gadgetron::subtract(vt, v, v);
-
-                alpha = Gadgetron::nrm2(&v);
+                // v = vt - beta*v, alpha = ||v||
+                alpha = std::sqrt(axpby_nrm2sq(ELEMENT_TYPE(1), &vt, ELEMENT_TYPE(-beta), &v));
 
                 Gadgetron::scal(REAL(1.0) / alpha, v);
 
@@ -5,6 +5,7 @@
 #include "gpSolver.h"
 #include "linearOperatorSolver.h"
 #include "real_utilities.h"
+#include "solverWorkspace.h"
 
 #include <iostream>
 #include <numeric>
@@ -342,10 +343,10 @@ template <class ARRAY_TYPE> class nlcgSolver : public gpSolver<ARRAY_TYPE> {
     }
 
     void add_linear_gradient(std::vector<ARRAY_TYPE>& elems, ARRAY_TYPE* g) {
-        ARRAY_TYPE tmp(g->get_dimensions());
+        boost::shared_ptr<ARRAY_TYPE> tmp = workspace_.get(0, g->get_dimensions());
         for (int i = 0; i < elems.size(); i++) {
-            this->regularization_operators_[i]->mult_MH(&elems[i], &tmp);
-            axpy(ELEMENT_TYPE(std::sqrt(this->regularization_operators_[i]->get_weight())), &tmp, g);
+            this->regularization_operators_[i]->mult_MH(&elems[i], tmp.get());
+            axpy(ELEMENT_TYPE(std::sqrt(this->regularization_operators_[i]->get_weight())), tmp.get(), g);
         }
     }
 
@@ -717,5 +718,8 @@ template <class ARRAY_TYPE> class nlcgSolver : public gpSolver<ARRAY_TYPE> {
 
     std::vector<boost::shared_ptr<ARRAY_TYPE>> reg_priors;
     boost::shared_ptr<cgPreconditioner<ARRAY_TYPE>> precond_;
+
+    // Temporary of add_linear_gradient, reused across the line search and the iterations
+    solverWorkspace<ARRAY_TYPE> workspace_;
 };
 } // namespace Gadgetron
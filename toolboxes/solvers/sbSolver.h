@@ -688,6 +688,12 @@ class sbSolver : public linearOperatorSolver<ARRAY_TYPE_ELEMENT> {
             u_k_prev = *u_k;
         }
 
+        // Input vector to the encoding operator container (argument to the inner solver's solve),
+        // allocated once for all iterations
+        //
+
+        ARRAY_TYPE_ELEMENT data(enc_op_container_->get_codomain_dimensions());
+
         //
         // Outer loop
         //
@@ -706,12 +712,10 @@ class sbSolver : public linearOperatorSolver<ARRAY_TYPE_ELEMENT> {
                 if (this->output_mode_ >= solver<ARRAY_TYPE_ELEMENT, ARRAY_TYPE_ELEMENT>::OUTPUT_VERBOSE)
                     GDEBUG_STREAM(std::endl << "SB inner loop iteration " << inner_iteration << std::endl << std::endl);
 
-                { // Brackets used to free 'data' below as soon as it goes out of scope
-
-                    // Setup input vector to the encoding operator container (argument to the inner solver's solve)
+                {
+                    // Setup input vector to the encoding operator container
                     //
 
-                    ARRAY_TYPE_ELEMENT data(enc_op_container_->get_codomain_dimensions());
                     ARRAY_TYPE_ELEMENT tmp(f->dimensions(), data.get_data_ptr());
 
                     tmp = *f;
@@ -0,0 +1,57 @@
+/** \file solverKernels.h
+    \brief Fused BLAS-1 kernels of the iterative solvers.
+
+    Device independent implementations, composed of the basic axpy/dot/nrm2 functions of the array type.
+    Array types with a faster, single pass implementation provide overloads of the same functions
+    (see hoSolverUtils.h for hoNDArray), which are picked up when the solvers are instantiated.
+*/
+
+#pragma once
+
+#include "complext.h"
+
+namespace Gadgetron{
+
+  // y = a*x + b*y
+  //
+
+  template <class ARRAY_TYPE> void axpby( typename ARRAY_TYPE::element_type a, ARRAY_TYPE* x,
+                                          typename ARRAY_TYPE::element_type b, ARRAY_TYPE* y )
+  {
+    *y *= b;
+    axpy( a, x, y );
+  }
+
+  // y = a*x + b*y, returning the squared l2-norm of the updated y
+  //
+
+  template <class ARRAY_TYPE> typename realType<typename ARRAY_TYPE::element_type>::Type
+  axpby_nrm2sq( typename ARRAY_TYPE::element_type a, ARRAY_TYPE* x,
+                typename ARRAY_TYPE::element_type b, ARRAY_TYPE* y )
+  {
+    axpby( a, x, b, y );
+    return real( dot( y, y ) );
+  }
+
+  // y += a*x, returning dot(z, y) of the updated y
+  //
+
+  template <class ARRAY_TYPE> typename ARRAY_TYPE::element_type
+  axpy_dot( typename ARRAY_TYPE::element_type a, ARRAY_TYPE* x, ARRAY_TYPE* y, ARRAY_TYPE* z )
+  {
+    axpy( a, x, y );
+    return dot( z, y );
+  }
+
+  // The conjugate gradient update x += alpha*p and r -= alpha*q, returning the squared l2-norm of the updated r
+  //
+
+  template <class ARRAY_TYPE> typename realType<typename ARRAY_TYPE::element_type>::Type
+  update_solution_and_residual( typename ARRAY_TYPE::element_type alpha, ARRAY_TYPE* p, ARRAY_TYPE* q,
+                                ARRAY_TYPE* x, ARRAY_TYPE* r )
+  {
+    axpy( alpha, p, x );
+    axpy( -alpha, q, r );
+    return real( dot( r, r ) );
+  }
+}
@@ -0,0 +1,60 @@
+/** \file solverWorkspace.h
+    \brief Persistent storage for the iteration vectors of the iterative solvers.
+
+    A solver requests its vectors by slot index. Arrays are allocated on first use, and reused for every
+    later iteration and solve as long as the requested dimensions do not change, so the iteration loops do
+    not allocate.
+*/
+
+#pragma once
+
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+#include <vector>
+
+namespace Gadgetron{
+
+  template <class ARRAY_TYPE> class solverWorkspace
+  {
+  public:
+
+    solverWorkspace() : allocations_(0) {}
+
+    // Returns the array in the given slot with the given dimensions.
+    // The content is undefined unless the slot was used with the same dimensions before.
+    //
+
+    boost::shared_ptr<ARRAY_TYPE> get( size_t slot, const std::vector<size_t>& dims )
+    {
+      if( slot >= arrays_.size() )
+        arrays_.resize(slot+1);
+
+      boost::shared_ptr<ARRAY_TYPE>& array = arrays_[slot];
+
+      if( !array.get() ){
+        array = boost::make_shared<ARRAY_TYPE>(dims);
+        allocations_++;
+      }
+      else if( !array->dimensions_equal(dims) ){
+        array->create(dims);
+        allocations_++;
+      }
+
+      return array;
+    }
+
+    // Releases the memory of all slots
+    //
+
+    void release() { arrays_.clear(); }
+
+    // Number of arrays allocated since construction
+    //
+
+    size_t get_number_of_allocations() const { return allocations_; }
+
+  protected:
+    std::vector< boost::shared_ptr<ARRAY_TYPE> > arrays_;
+    size_t allocations_;
+  };
+}